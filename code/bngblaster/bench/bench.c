@@ -0,0 +1,735 @@
+/*
+ * BNG Blaster (BBL) - Micro-Benchmarks
+ *
+ * Reproducible micro-benchmarks for the packet
+ * encode/decode, stream scheduling, TXQ, timer
+ * and checksum paths with stable JSON output.
+ *
+ * agent, October 2026
+ *
+ * Copyright (C) 2020-2025, RtBrick, Inc.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <bbl.h>
+#include <bbl_stream.h>
+#include <io/io.h>
+#include <config.h>
+
+#include "ethernet_packets.h"
+
+#define BENCH_ITERATIONS    1000000
+#define BENCH_REPEATS       5
+#define BENCH_STREAMS       10000
+#define BENCH_TOLERANCE     10.0
+#define BENCH_CORPUS_MAX    65536
+#define BENCH_TIMER_BATCH   1024
+#define BENCH_SEED          0x5eed5eedULL
+
+#define PCAP_MAGIC          0xa1b2c3d4
+#define PCAP_MAGIC_SWAPPED  0xd4c3b2a1
+#define PCAP_MAGIC_NSEC     0xa1b23c4d
+#define PCAP_MAGIC_NSEC_SWAPPED 0x4d3cb2a1
+
+typedef struct bench_packet_ {
+    uint8_t *buf;
+    uint16_t len;
+} bench_packet_s;
+
+typedef struct bench_ {
+    const char *name;
+    bool packets; /* one operation is one packet */
+    bool (*init)();
+    uint64_t (*run)(uint64_t iterations);
+} bench_s;
+
+static struct {
+    uint64_t iterations;
+    uint32_t repeats;
+    uint32_t streams;
+    double tolerance;
+    int cpu;
+    char *filter;
+    char *pcap_file;
+    char *baseline_file;
+    char *output_file;
+} g_bench = {
+    .iterations = BENCH_ITERATIONS,
+    .repeats = BENCH_REPEATS,
+    .streams = BENCH_STREAMS,
+    .tolerance = BENCH_TOLERANCE,
+    .cpu = -1,
+};
+
+static uint64_t g_seed = BENCH_SEED;
+
+static bench_packet_s g_corpus[BENCH_CORPUS_MAX];
+static uint32_t g_corpus_count = 0;
+
+static uint8_t g_buf[BBL_TXQ_BUFFER_LEN];
+static uint8_t g_mac_src[ETH_ADDR_LEN] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+static uint8_t g_mac_dst[ETH_ADDR_LEN] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+static ipv6addr_t g_ipv6_src = {0xfc, 0x66, 0x13, 0x37, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1};
+static ipv6addr_t g_ipv6_dst = {0xfc, 0x66, 0x13, 0x37, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2};
+
+static io_handle_s *g_io = NULL;
+static bbl_txq_s g_txq = {0};
+static timer_s *g_timers[BENCH_TIMER_BATCH] = {0};
+static uint64_t g_timer_fired = 0;
+static uint64_t g_now = 0;
+
+/*
+ * Deterministic pseudo random numbers (xorshift64) used to
+ * make all generated input data reproducible between runs.
+ */
+static uint64_t
+bench_random()
+{
+    g_seed ^= g_seed << 13;
+    g_seed ^= g_seed >> 7;
+    g_seed ^= g_seed << 17;
+    return g_seed;
+}
+
+static uint64_t
+bench_nsec()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return timespec_to_nsec(&now);
+}
+
+/*
+ * Build a BBL stream packet (Ethernet/VLAN/IP/UDP/BBL)
+ * with the given length, similar to network streams.
+ */
+static protocol_error_t
+bench_encode_stream_packet(uint8_t *buf, uint16_t *len, bool ipv6,
+                           uint64_t flow_id, uint16_t length)
+{
+    bbl_ethernet_header_s eth = {0};
+    bbl_ipv4_s ipv4 = {0};
+    bbl_ipv6_s ipv6_hdr = {0};
+    bbl_udp_s udp = {0};
+    bbl_bbl_s bbl = {0};
+
+    eth.dst = g_mac_dst;
+    eth.src = g_mac_src;
+    eth.vlan_outer = 100;
+    udp.src = BBL_UDP_PORT;
+    udp.dst = BBL_UDP_PORT;
+    udp.protocol = UDP_PROTOCOL_BBL;
+    udp.next = &bbl;
+    bbl.type = BBL_TYPE_UNICAST;
+    bbl.direction = BBL_DIRECTION_DOWN;
+    bbl.flow_id = flow_id;
+    bbl.flow_seq = 1;
+    if(ipv6) {
+        eth.type = ETH_TYPE_IPV6;
+        eth.next = &ipv6_hdr;
+        ipv6_hdr.src = g_ipv6_src;
+        ipv6_hdr.dst = g_ipv6_dst;
+        ipv6_hdr.ttl = 64;
+        ipv6_hdr.protocol = IPV6_NEXT_HEADER_UDP;
+        ipv6_hdr.next = &udp;
+        bbl.sub_type = BBL_SUB_TYPE_IPV6;
+        if(length > 96) {
+            bbl.padding = length - 96;
+        }
+    } else {
+        eth.type = ETH_TYPE_IPV4;
+        eth.next = &ipv4;
+        ipv4.src = htobe32(0x0a000001);
+        ipv4.dst = htobe32(0x0a000002);
+        ipv4.ttl = 64;
+        ipv4.protocol = PROTOCOL_IPV4_UDP;
+        ipv4.next = &udp;
+        bbl.sub_type = BBL_SUB_TYPE_IPV4;
+        if(length > 76) {
+            bbl.padding = length - 76;
+        }
+    }
+    *len = 0;
+    return encode_ethernet(buf, len, &eth);
+}
+
+static bool
+bench_corpus_add(uint8_t *buf, uint16_t len)
+{
+    bench_packet_s *packet;
+    if(g_corpus_count >= BENCH_CORPUS_MAX) {
+        return false;
+    }
+    packet = &g_corpus[g_corpus_count++];
+    packet->buf = malloc(len);
+    packet->len = len;
+    memcpy(packet->buf, buf, len);
+    return true;
+}
+
+/*
+ * Load packets from a classic PCAP file (not PCAPNG)
+ * without adding libpcap as dependency.
+ */
+static bool
+bench_corpus_load_pcap(const char *filename)
+{
+    FILE *file;
+    uint32_t hdr[6];
+    uint32_t rec[4];
+    uint32_t caplen;
+    bool swapped;
+
+    file = fopen(filename, "r");
+    if(!file) {
+        fprintf(stderr, "Failed to open PCAP file %s\n", filename);
+        return false;
+    }
+    if(fread(hdr, sizeof(hdr), 1, file) != 1) {
+        fprintf(stderr, "Invalid PCAP file %s\n", filename);
+        fclose(file);
+        return false;
+    }
+    switch(hdr[0]) {
+        case PCAP_MAGIC:
+        case PCAP_MAGIC_NSEC:
+            swapped = false;
+            break;
+        case PCAP_MAGIC_SWAPPED:
+        case PCAP_MAGIC_NSEC_SWAPPED:
+            swapped = true;
+            break;
+        default:
+            fprintf(stderr, "Unsupported PCAP file %s (PCAPNG is not supported)\n", filename);
+            fclose(file);
+            return false;
+    }
+    while(fread(rec, sizeof(rec), 1, file) == 1) {
+        caplen = swapped ? __builtin_bswap32(rec[2]) : rec[2];
+        if(caplen > sizeof(g_buf) || fread(g_buf, caplen, 1, file) != 1) {
+            break;
+        }
+        if(!bench_corpus_add(g_buf, caplen)) {
+            break;
+        }
+    }
+    fclose(file);
+    if(!g_corpus_count) {
+        fprintf(stderr, "No packets found in PCAP file %s\n", filename);
+        return false;
+    }
+    return true;
+}
+
+/* DECODE */
+
+static bool
+bench_decode_init()
+{
+    uint16_t len;
+    if(g_corpus_count) {
+        return true;
+    }
+    if(g_bench.pcap_file) {
+        return bench_corpus_load_pcap(g_bench.pcap_file);
+    }
+    /* Default corpus of synthetic packets. */
+    bench_corpus_add(pppoe_ipcp_conf_request, sizeof(pppoe_ipcp_conf_request));
+    bench_encode_stream_packet(g_buf, &len, false, 1, 128);
+    bench_corpus_add(g_buf, len);
+    bench_encode_stream_packet(g_buf, &len, false, 2, 1500);
+    bench_corpus_add(g_buf, len);
+    bench_encode_stream_packet(g_buf, &len, true, 3, 128);
+    bench_corpus_add(g_buf, len);
+    bench_encode_stream_packet(g_buf, &len, true, 4, 1500);
+    bench_corpus_add(g_buf, len);
+    return true;
+}
+
+static uint64_t
+bench_decode_run(uint64_t iterations)
+{
+    bbl_ethernet_header_s *eth;
+    bench_packet_s *packet;
+    uint64_t i;
+    uint32_t c = 0;
+
+    for(i = 0; i < iterations; i++) {
+        packet = &g_corpus[c++];
+        if(c == g_corpus_count) c = 0;
+        decode_ethernet(packet->buf, packet->len, g_ctx->sp, SCRATCHPAD_LEN, &eth);
+    }
+    return iterations;
+}
+
+/* ENCODE */
+
+static uint64_t
+bench_encode_ipv4_run(uint64_t iterations)
+{
+    uint16_t len;
+    uint64_t i;
+    for(i = 0; i < iterations; i++) {
+        bench_encode_stream_packet(g_buf, &len, false, i, 128);
+    }
+    return iterations;
+}
+
+static uint64_t
+bench_encode_ipv6_run(uint64_t iterations)
+{
+    uint16_t len;
+    uint64_t i;
+    for(i = 0; i < iterations; i++) {
+        bench_encode_stream_packet(g_buf, &len, true, i, 128);
+    }
+    return iterations;
+}
+
+/* STREAMS */
+
+static bool
+bench_stream_init()
+{
+    static endpoint_state_t endpoint = ENDPOINT_ACTIVE;
+    static double pps[] = {1.0, 10.0, 100.0, 1000.0};
+    bbl_stream_config_s *config;
+    bbl_stream_s *stream;
+    uint32_t i;
+
+    if(g_io) {
+        return true;
+    }
+    g_io = calloc(1, sizeof(io_handle_s));
+    config = calloc(1, sizeof(bbl_stream_config_s));
+    config->name = "bench";
+    for(i = 0; i < g_bench.streams; i++) {
+        stream = bbl_arena_alloc(&g_ctx->stream_arena, sizeof(bbl_stream_s));
+        if(!stream) {
+            return false;
+        }
+        stream->flow_id = i + 1;
+        stream->flow_seq = 1;
+        stream->type = BBL_TYPE_UNICAST;
+        stream->sub_type = BBL_SUB_TYPE_IPV4;
+        stream->direction = BBL_DIRECTION_DOWN;
+        stream->config = config;
+        stream->endpoint = &endpoint;
+        stream->enabled = true;
+        stream->pps = pps[bench_random() % (sizeof(pps)/sizeof(pps[0]))];
+        stream->tx_mem = bbl_arena_alloc(&g_io->stream_arena, 256);
+        if(!stream->tx_mem) {
+            return false;
+        }
+        stream->tx_buf_size = 256;
+        stream->tx_buf = stream->tx_mem;
+        if(bench_encode_stream_packet(stream->tx_buf, &stream->tx_len, false,
+                                      stream->flow_id, 128) != PROTOCOL_SUCCESS) {
+            return false;
+        }
+        stream->tx_bbl_hdr_len = 128 - 76 + BBL_HEADER_LEN;
+        io_stream_add(g_io, stream);
+    }
+    io_stream_smear(g_io);
+    g_now = SEC;
+    return true;
+}
+
+/*
+ * Streams are sent with simulated time, advanced by 1ms each
+ * time the scheduler has nothing to send, such that the result
+ * is independent of the actual stream rates.
+ */
+static uint64_t
+bench_stream_run(uint64_t iterations)
+{
+    bbl_stream_s *stream;
+    uint64_t packets = 0;
+
+    while(packets < iterations) {
+        stream = bbl_stream_io_send_iter(g_io, g_now);
+        if(stream) {
+            stream->tx_packets++;
+            stream->flow_seq++;
+            packets++;
+        } else {
+            g_now += MSEC;
+            g_io->timestamp.tv_sec = g_now / SEC;
+            g_io->timestamp.tv_nsec = g_now % SEC;
+        }
+    }
+    return packets;
+}
+
+/* TXQ */
+
+static bool
+bench_txq_init()
+{
+    if(g_txq.ring) {
+        return true;
+    }
+    return bbl_txq_init(&g_txq, BBL_TXQ_DEFAULT_SIZE);
+}
+
+static uint64_t
+bench_txq_run(uint64_t iterations)
+{
+    bbl_ethernet_header_s eth = {0};
+    bbl_ipv4_s ipv4 = {0};
+    bbl_udp_s udp = {0};
+    bbl_bbl_s bbl = {0};
+    uint64_t i;
+
+    eth.dst = g_mac_dst;
+    eth.src = g_mac_src;
+    eth.type = ETH_TYPE_IPV4;
+    eth.next = &ipv4;
+    ipv4.src = htobe32(0x0a000001);
+    ipv4.dst = htobe32(0x0a000002);
+    ipv4.ttl = 64;
+    ipv4.protocol = PROTOCOL_IPV4_UDP;
+    ipv4.next = &udp;
+    udp.src = BBL_UDP_PORT;
+    udp.dst = BBL_UDP_PORT;
+    udp.protocol = UDP_PROTOCOL_BBL;
+    udp.next = &bbl;
+    bbl.type = BBL_TYPE_UNICAST;
+    bbl.sub_type = BBL_SUB_TYPE_IPV4;
+
+    for(i = 0; i < iterations; i++) {
+        bbl.flow_seq = i;
+        bbl_txq_to_buffer(&g_txq, &eth);
+        bbl_txq_from_buffer(&g_txq, g_buf);
+    }
+    return iterations;
+}
+
+/* TIMER */
+
+static void
+bench_timer_job(timer_s *timer __attribute__((unused)))
+{
+    g_timer_fired++;
+}
+
+static uint64_t
+bench_timer_run(uint64_t iterations)
+{
+    uint64_t timers = 0;
+    uint32_t i;
+
+    g_timer_fired = 0;
+    while(timers < iterations) {
+        /* Add a batch of expired timers and
+         * walk the timer queue to fire them. */
+        for(i = 0; i < BENCH_TIMER_BATCH; i++) {
+            timer_add(&g_ctx->timer_root, &g_timers[i], "BENCH",
+                      0, 0, NULL, &bench_timer_job);
+        }
+        timer_walk(&g_ctx->timer_root);
+        timers += BENCH_TIMER_BATCH;
+    }
+    return g_timer_fired;
+}
+
+/* CHECKSUM */
+
+static bool
+bench_checksum_init()
+{
+    uint16_t i;
+    for(i = 0; i < sizeof(g_buf); i++) {
+        g_buf[i] = bench_random();
+    }
+    return true;
+}
+
+static uint64_t
+bench_checksum_run(uint64_t iterations)
+{
+    uint64_t i;
+    for(i = 0; i < iterations; i++) {
+        g_buf[0] = i;
+        bbl_checksum(g_buf, 1500);
+    }
+    return iterations;
+}
+
+static uint64_t
+bench_fletcher_run(uint64_t iterations)
+{
+    uint64_t i;
+    for(i = 0; i < iterations; i++) {
+        g_buf[0] = i;
+        calculate_fletcher_checksum(g_buf, 12, 1492);
+    }
+    return iterations;
+}
+
+/* The order and names of the benchmarks are part of the JSON output
+ * and should not be changed to keep results comparable over time. */
+static bench_s g_benchmarks[] = {
+    { "decode-ethernet",        true,   bench_decode_init,      bench_decode_run },
+    { "encode-ethernet-ipv4",   true,   NULL,                   bench_encode_ipv4_run },
+    { "encode-ethernet-ipv6",   true,   NULL,                   bench_encode_ipv6_run },
+    { "stream-send-iter",       true,   bench_stream_init,      bench_stream_run },
+    { "txq",                    true,   bench_txq_init,         bench_txq_run },
+    { "timer",                  false,  NULL,                   bench_timer_run },
+    { "checksum-1500",          false,  bench_checksum_init,    bench_checksum_run },
+    { "fletcher-checksum-1492", false,  bench_checksum_init,    bench_fletcher_run },
+    { NULL, false, NULL, NULL }
+};
+
+static int
+bench_compare_double(const void *a, const void *b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * Run a single benchmark with warmup and return
+ * the median nanoseconds per operation.
+ */
+static json_t *
+bench_run(bench_s *bench)
+{
+    json_t *jobj;
+    double *result;
+    double median;
+    uint64_t start, ops = 0;
+    uint32_t r;
+
+    if(bench->init && !bench->init()) {
+        fprintf(stderr, "Failed to init benchmark %s\n", bench->name);
+        return NULL;
+    }
+
+    /* Warmup */
+    bench->run(g_bench.iterations / 10 + 1);
+
+    result = calloc(g_bench.repeats, sizeof(double));
+    for(r = 0; r < g_bench.repeats; r++) {
+        start = bench_nsec();
+        ops = bench->run(g_bench.iterations);
+        result[r] = (double)(bench_nsec() - start) / (ops ? ops : 1);
+    }
+    qsort(result, g_bench.repeats, sizeof(double), bench_compare_double);
+    median = result[g_bench.repeats / 2];
+
+    jobj = json_pack("{ss sI sf sf sf}",
+                     "name", bench->name,
+                     "operations", (json_int_t)ops,
+                     "ns-per-op", median,
+                     "ns-per-op-min", result[0],
+                     "ns-per-op-max", result[g_bench.repeats - 1]);
+    if(jobj) {
+        json_object_set_new(jobj, bench->packets ? "packets-per-second" : "ops-per-second",
+                            json_real(median > 0 ? SEC / median : 0));
+    }
+    free(result);
+    return jobj;
+}
+
+static json_t *
+bench_baseline_load()
+{
+    json_error_t error;
+    json_t *root = json_load_file(g_bench.baseline_file, 0, &error);
+    json_t *results;
+    if(!root) {
+        fprintf(stderr, "Failed to load baseline %s (line %d: %s)\n",
+                g_bench.baseline_file, error.line, error.text);
+        return NULL;
+    }
+    results = json_object_get(json_object_get(root, "bench"), "results");
+    if(!json_is_array(results)) {
+        fprintf(stderr, "Invalid baseline %s\n", g_bench.baseline_file);
+        json_decref(root);
+        return NULL;
+    }
+    json_incref(results);
+    json_decref(root);
+    return results;
+}
+
+/*
+ * Compare result with baseline and return
+ * true if this result is a regression.
+ */
+static bool
+bench_baseline_compare(json_t *baseline, json_t *result)
+{
+    double current = json_real_value(json_object_get(result, "ns-per-op"));
+    double base;
+    double change;
+    json_t *entry;
+    size_t i;
+
+    json_array_foreach(baseline, i, entry) {
+        if(!json_equal(json_object_get(entry, "name"), json_object_get(result, "name"))) {
+            continue;
+        }
+        base = json_number_value(json_object_get(entry, "ns-per-op"));
+        if(base <= 0) break;
+        change = (current - base) * 100.0 / base;
+        json_object_set_new(result, "baseline-ns-per-op", json_real(base));
+        json_object_set_new(result, "change-percent", json_real(change));
+        if(change > g_bench.tolerance) {
+            json_object_set_new(result, "regression", json_true());
+            return true;
+        }
+        return false;
+    }
+    return false;
+}
+
+static void
+bench_print_usage()
+{
+    printf("Usage: bngblaster-bench [OPTIONS]\n\n"
+           "  -h --help\n"
+           "  -i --iterations <number>     operations per run (default %u)\n"
+           "  -r --repeats <number>        runs per benchmark (default %u)\n"
+           "  -s --streams <number>        streams for stream-send-iter (default %u)\n"
+           "  -p --pcap <file>             decode corpus (classic PCAP)\n"
+           "  -n --name <string>           run only benchmarks containing string\n"
+           "  -c --cpu <id>                pin benchmark to CPU\n"
+           "  -b --baseline <file>         compare with previous JSON result\n"
+           "  -t --tolerance <percent>     allowed regression (default %.0f)\n"
+           "  -o --output <file>           write JSON result to file\n",
+           BENCH_ITERATIONS, BENCH_REPEATS, BENCH_STREAMS, BENCH_TOLERANCE);
+}
+
+static struct option long_options[] = {
+    { "help",       no_argument,        NULL, 'h' },
+    { "iterations", required_argument,  NULL, 'i' },
+    { "repeats",    required_argument,  NULL, 'r' },
+    { "streams",    required_argument,  NULL, 's' },
+    { "pcap",       required_argument,  NULL, 'p' },
+    { "name",       required_argument,  NULL, 'n' },
+    { "cpu",        required_argument,  NULL, 'c' },
+    { "baseline",   required_argument,  NULL, 'b' },
+    { "tolerance",  required_argument,  NULL, 't' },
+    { "output",     required_argument,  NULL, 'o' },
+    { NULL,         0,                  NULL,  0 }
+};
+
+int
+main(int argc, char *argv[])
+{
+    bench_s *bench;
+    json_t *root, *results, *result, *baseline = NULL;
+    cpu_set_t cpuset;
+    int ch, long_index = 0;
+    int exit_status = 0;
+    bool regression = false;
+
+    while((ch = getopt_long(argc, argv, "hi:r:s:p:n:c:b:t:o:", long_options, &long_index)) != -1) {
+        switch(ch) {
+            case 'i':
+                g_bench.iterations = strtoull(optarg, NULL, 10);
+                break;
+            case 'r':
+                g_bench.repeats = atoi(optarg);
+                break;
+            case 's':
+                g_bench.streams = atoi(optarg);
+                break;
+            case 'p':
+                g_bench.pcap_file = optarg;
+                break;
+            case 'n':
+                g_bench.filter = optarg;
+                break;
+            case 'c':
+                g_bench.cpu = atoi(optarg);
+                break;
+            case 'b':
+                g_bench.baseline_file = optarg;
+                break;
+            case 't':
+                g_bench.tolerance = atof(optarg);
+                break;
+            case 'o':
+                g_bench.output_file = optarg;
+                break;
+            default:
+                bench_print_usage();
+                exit(1);
+        }
+    }
+    if(!g_bench.iterations || !g_bench.repeats || !g_bench.streams) {
+        bench_print_usage();
+        exit(1);
+    }
+
+    if(g_bench.cpu >= 0) {
+        CPU_ZERO(&cpuset);
+        CPU_SET(g_bench.cpu, &cpuset);
+        if(sched_setaffinity(0, sizeof(cpuset), &cpuset) != 0) {
+            fprintf(stderr, "Failed to pin benchmark to CPU %d\n", g_bench.cpu);
+            exit(1);
+        }
+    }
+
+    checksum_set_impl(CHECKSUM_IMPL_AUTO);
+
+    if(g_bench.baseline_file) {
+        baseline = bench_baseline_load();
+        if(!baseline) exit(1);
+    }
+
+    if(!bbl_ctx_add()) {
+        fprintf(stderr, "Failed to add context\n");
+        exit(1);
+    }
+    g_ctx->config.stream_burst_ms = 100 * MSEC;
+
+    results = json_array();
+    for(bench = g_benchmarks; bench->name; bench++) {
+        if(g_bench.filter && !strstr(bench->name, g_bench.filter)) {
+            continue;
+        }
+        result = bench_run(bench);
+        if(!result) {
+            exit_status = 1;
+            continue;
+        }
+        if(baseline && bench_baseline_compare(baseline, result)) {
+            regression = true;
+        }
+        json_array_append_new(results, result);
+    }
+
+    root = json_pack("{s{ss ss ss sI si si so}}", "bench",
+                     "version", BNGBLASTER_VERSION,
+                     "compiler", COMPILER_ID " " COMPILER_VERSION,
+                     "checksum-impl", checksum_impl_name(),
+                     "iterations", (json_int_t)g_bench.iterations,
+                     "repeats", g_bench.repeats,
+                     "streams", g_bench.streams,
+                     "results", results);
+    if(root) {
+        if(g_bench.output_file) {
+            if(json_dump_file(root, g_bench.output_file, JSON_INDENT(4) | JSON_REAL_PRECISION(6)) != 0) {
+                fprintf(stderr, "Failed to write %s\n", g_bench.output_file);
+                exit_status = 1;
+            }
+        } else {
+            json_dumpf(root, stdout, JSON_INDENT(4) | JSON_REAL_PRECISION(6));
+            printf("\n");
+        }
+        json_decref(root);
+    }
+    if(baseline) {
+        json_decref(baseline);
+    }
+    if(regression) {
+        fprintf(stderr, "Performance regression detected (tolerance %.1f%%)\n", g_bench.tolerance);
+        exit_status = 2;
+    }
+    bbl_ctx_del();
+    return exit_status;
+}
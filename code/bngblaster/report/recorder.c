@@ -0,0 +1,233 @@
+/*
+ * BNG Blaster (BBL) - Time-Series Recorder Converter
+ *
+ * Decode all valid segments of a recorder file in
+ * sequence order. Values are only printed if changed.
+ *
+ * agent, October 2026
+ *
+ * Copyright (C) 2020-2025, RtBrick, Inc.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include "report.h"
+#include "bbl_recorder_def.h"
+
+typedef struct recorder_ {
+    bbl_recorder_header_s *header;
+    bbl_recorder_type_s *types[BBL_RECORDER_TYPE_MAX];
+    bbl_recorder_series_s *series;
+    bbl_recorder_segment_s **segments;
+    uint32_t segment_count;
+
+    uint64_t *last;
+    int64_t *delta;
+    uint64_t *printed;
+    bool *valid;
+    bool first;
+} recorder_s;
+
+static int
+segment_compare(const void *a, const void *b)
+{
+    uint64_t sa = (*(bbl_recorder_segment_s**)a)->sequence;
+    uint64_t sb = (*(bbl_recorder_segment_s**)b)->sequence;
+    return (sa > sb) - (sa < sb);
+}
+
+static const uint8_t *
+read_varint(const uint8_t *buf, const uint8_t *end, uint64_t *value)
+{
+    uint8_t shift = 0;
+
+    *value = 0;
+    while(buf < end && shift < 64) {
+        *value |= (uint64_t)(*buf & 0x7f) << shift;
+        if(!(*buf++ & 0x80)) return buf;
+        shift += 7;
+    }
+    return NULL;
+}
+
+static void
+print_row(recorder_s *recorder, FILE *out, format_t format,
+          uint64_t timestamp, bbl_recorder_series_s *series,
+          bbl_recorder_type_s *type, uint8_t metric, uint64_t value)
+{
+    const char *name = type->metrics[metric];
+
+    if(format == FORMAT_JSON) {
+        fprintf(out, "%s\n    { \"timestamp\": %" PRIu64 ", \"type\": ",
+                recorder->first ? "" : ",", timestamp);
+        print_string(out, format, type->name, strnlen(type->name, BBL_RECORDER_METRIC_NAME_LEN));
+        fprintf(out, ", \"id\": %" PRIu64 ", \"name\": ", series->id);
+        print_string(out, format, series->name, strnlen(series->name, BBL_RECORDER_NAME_LEN));
+        fputs(", \"metric\": ", out);
+        print_string(out, format, name, strnlen(name, BBL_RECORDER_METRIC_NAME_LEN));
+        fprintf(out, ", \"value\": %" PRIu64 " }", value);
+    } else {
+        fprintf(out, "%" PRIu64 ",%.*s,%" PRIu64 ",", timestamp,
+                BBL_RECORDER_METRIC_NAME_LEN, type->name, series->id);
+        print_string(out, format, series->name, strnlen(series->name, BBL_RECORDER_NAME_LEN));
+        fprintf(out, ",%.*s,%" PRIu64 "\n", BBL_RECORDER_METRIC_NAME_LEN, name, value);
+    }
+    recorder->first = false;
+}
+
+static bool
+decode_record(recorder_s *recorder, FILE *out, format_t format, const char *filter,
+              bbl_recorder_record_s *record, const uint8_t *end)
+{
+    bbl_recorder_header_s *header = recorder->header;
+    bbl_recorder_series_s *series;
+    bbl_recorder_type_s *type;
+    const uint8_t *buf = (const uint8_t*)(record+1);
+    bool keyframe = record->flags & BBL_RECORDER_KEYFRAME;
+    uint64_t token, run = 0;
+    int64_t delta, dod;
+    uint32_t s, i = 0;
+    uint8_t m;
+
+    for(s = 0; s < header->series_count; s++) {
+        series = &recorder->series[s];
+        type = recorder->types[series->type];
+        for(m = 0; m < type->metric_count; m++, i++) {
+            if(run) {
+                run--;
+                dod = 0;
+            } else {
+                buf = read_varint(buf, end, &token);
+                if(!buf) return false;
+                if(token & 1) {
+                    run = (token >> 1) - 1;
+                    dod = 0;
+                } else {
+                    token >>= 1;
+                    dod = (int64_t)(token >> 1) ^ -(int64_t)(token & 1);
+                }
+            }
+            if(keyframe) {
+                recorder->last[i] = 0;
+                recorder->delta[i] = 0;
+            }
+            delta = recorder->delta[i] + dod;
+            recorder->last[i] += delta;
+            recorder->delta[i] = keyframe ? 0 : delta;
+
+            if(filter && strncmp(filter, type->name, BBL_RECORDER_METRIC_NAME_LEN) != 0) {
+                continue;
+            }
+            if(!recorder->valid[i] || recorder->printed[i] != recorder->last[i]) {
+                print_row(recorder, out, format, record->timestamp, series, type, m, recorder->last[i]);
+                recorder->printed[i] = recorder->last[i];
+                recorder->valid[i] = true;
+            }
+        }
+    }
+    return true;
+}
+
+bool
+recorder_convert(uint8_t *buf, size_t len, FILE *out, format_t format, const char *type)
+{
+    recorder_s recorder = {0};
+    bbl_recorder_header_s *header = (bbl_recorder_header_s*)buf;
+    bbl_recorder_type_s *types;
+    bbl_recorder_segment_s *segment;
+    bbl_recorder_record_s *record;
+    uint8_t *data, *end;
+    uint32_t i, r;
+    bool result = false;
+
+    if(len < sizeof(bbl_recorder_header_s)) {
+        fprintf(stderr, "Invalid recorder file\n");
+        return false;
+    }
+    if(header->bom != BBL_RECORDER_BOM) {
+        fprintf(stderr, "Recorder file byte order not supported\n");
+        return false;
+    }
+    if(header->version != BBL_RECORDER_VERSION) {
+        fprintf(stderr, "Recorder file version %u not supported\n", header->version);
+        return false;
+    }
+    if(header->type_offset + header->type_count * sizeof(bbl_recorder_type_s) > len ||
+       header->series_offset + header->series_count * sizeof(bbl_recorder_series_s) > len ||
+       header->segment_offset + header->segment_count * header->segment_size > len ||
+       header->segment_size <= sizeof(bbl_recorder_segment_s)) {
+        fprintf(stderr, "Recorder file incomplete\n");
+        return false;
+    }
+    recorder.header = header;
+
+    types = (bbl_recorder_type_s*)(buf + header->type_offset);
+    for(i = 0; i < header->type_count; i++) {
+        if(types[i].type < BBL_RECORDER_TYPE_MAX && types[i].metric_count <= BBL_RECORDER_METRICS_MAX) {
+            recorder.types[types[i].type] = &types[i];
+        }
+    }
+    recorder.series = (bbl_recorder_series_s*)(buf + header->series_offset);
+    for(i = 0; i < header->series_count; i++) {
+        if(recorder.series[i].type >= BBL_RECORDER_TYPE_MAX || !recorder.types[recorder.series[i].type]) {
+            fprintf(stderr, "Invalid recorder series type %u\n", recorder.series[i].type);
+            return false;
+        }
+    }
+
+    recorder.segments = calloc(header->segment_count, sizeof(bbl_recorder_segment_s*));
+    recorder.last = calloc(header->value_count+1, sizeof(uint64_t));
+    recorder.delta = calloc(header->value_count+1, sizeof(int64_t));
+    recorder.printed = calloc(header->value_count+1, sizeof(uint64_t));
+    recorder.valid = calloc(header->value_count+1, sizeof(bool));
+    if(!(recorder.segments && recorder.last && recorder.delta && recorder.printed && recorder.valid)) {
+        goto CLEANUP;
+    }
+    for(i = 0; i < header->segment_count; i++) {
+        segment = (bbl_recorder_segment_s*)(buf + header->segment_offset + (i * header->segment_size));
+        if(segment->sequence && segment->records &&
+           segment->len <= header->segment_size - sizeof(bbl_recorder_segment_s)) {
+            recorder.segments[recorder.segment_count++] = segment;
+        }
+    }
+    qsort(recorder.segments, recorder.segment_count, sizeof(bbl_recorder_segment_s*), segment_compare);
+
+    recorder.first = true;
+    if(format == FORMAT_JSON) {
+        fprintf(out, "{\n  \"recorder\": [");
+    } else {
+        fprintf(out, "timestamp,type,id,name,metric,value\n");
+    }
+    for(i = 0; i < recorder.segment_count; i++) {
+        segment = recorder.segments[i];
+        data = (uint8_t*)(segment+1);
+        end = data + segment->len;
+        for(r = 0; r < segment->records; r++) {
+            record = (bbl_recorder_record_s*)data;
+            if(data + sizeof(bbl_recorder_record_s) > end || 
+               record->len < sizeof(bbl_recorder_record_s) || data + record->len > end) {
+                fprintf(stderr, "Invalid recorder record\n");
+                goto CLEANUP;
+            }
+            if(r == 0 && !(record->flags & BBL_RECORDER_KEYFRAME)) {
+                fprintf(stderr, "Invalid recorder segment\n");
+                goto CLEANUP;
+            }
+            if(!decode_record(&recorder, out, format, type, record, data + record->len)) {
+                fprintf(stderr, "Invalid recorder record\n");
+                goto CLEANUP;
+            }
+            data += record->len;
+        }
+    }
+    if(format == FORMAT_JSON) {
+        fprintf(out, "%s]\n}\n", recorder.first ? "" : "\n  ");
+    }
+    result = true;
+
+CLEANUP:
+    free(recorder.segments);
+    free(recorder.last);
+    free(recorder.delta);
+    free(recorder.printed);
+    free(recorder.valid);
+    return result;
+}
@@ -0,0 +1,363 @@
+/*
+ * BNG Blaster (BBL) - Binary Report Converter
+ *
+ * Convert binary report files (-B) and time-series
+ * recorder files into JSON or CSV using the schema
+ * stored in the file.
+ *
+ * agent, October 2026
+ *
+ * Copyright (C) 2020-2025, RtBrick, Inc.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <getopt.h>
+#include <arpa/inet.h>
+
+#include "report.h"
+#include "bbl_report_def.h"
+#include "bbl_recorder_def.h"
+
+typedef struct report_ {
+    uint8_t *buf;
+    size_t len;
+    char **strings;
+    uint16_t *strings_len;
+    uint32_t strings_count;
+} report_s;
+
+static const char *optstring = "hi:o:f:s:";
+static struct option long_options[] = {
+    { "help",       no_argument,        NULL, 'h' },
+    { "input",      required_argument,  NULL, 'i' },
+    { "output",     required_argument,  NULL, 'o' },
+    { "format",     required_argument,  NULL, 'f' },
+    { "section",    required_argument,  NULL, 's' },
+    { NULL,         0,                  NULL,  0 }
+};
+
+static void
+print_usage(void)
+{
+    printf("Usage: bngblaster-report [OPTIONS]\n\n");
+    printf("  -i --input <file>              binary report file\n");
+    printf("  -o --output <file>             output file (default stdout)\n");
+    printf("  -f --format json|csv           output format (default json)\n");
+    printf("  -s --section streams|sessions  section (default streams)\n");
+    printf("                                 or recorder type (default all)\n");
+}
+
+static bool
+report_load(report_s *report, const char *filename)
+{
+    FILE *fp;
+    long len;
+
+    fp = fopen(filename, "rb");
+    if(!fp) {
+        fprintf(stderr, "Failed to open %s\n", filename);
+        return false;
+    }
+    fseek(fp, 0, SEEK_END);
+    len = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    if(len < (long)(sizeof(bbl_report_header_s) + sizeof(bbl_report_trailer_s))) {
+        fprintf(stderr, "Invalid report file %s\n", filename);
+        fclose(fp);
+        return false;
+    }
+    report->buf = malloc(len);
+    report->len = len;
+    if(!report->buf || fread(report->buf, len, 1, fp) != 1) {
+        fprintf(stderr, "Failed to read %s\n", filename);
+        fclose(fp);
+        return false;
+    }
+    fclose(fp);
+    return true;
+}
+
+static bool
+report_strings(report_s *report)
+{
+    bbl_report_header_s *header = (bbl_report_header_s*)report->buf;
+    bbl_report_trailer_s *trailer;
+    uint64_t offset;
+    uint32_t i;
+    uint16_t len;
+
+    if(memcmp(header->magic, BBL_REPORT_MAGIC, sizeof(BBL_REPORT_MAGIC)) != 0) {
+        fprintf(stderr, "Invalid report file magic\n");
+        return false;
+    }
+    if(header->bom != BBL_REPORT_BOM) {
+        fprintf(stderr, "Report file byte order not supported\n");
+        return false;
+    }
+    if(header->version != BBL_REPORT_VERSION) {
+        fprintf(stderr, "Report file version %u not supported\n", header->version);
+        return false;
+    }
+    trailer = (bbl_report_trailer_s*)(report->buf + report->len - sizeof(bbl_report_trailer_s));
+    if(memcmp(trailer->magic, BBL_REPORT_END_MAGIC, sizeof(BBL_REPORT_END_MAGIC)) != 0) {
+        fprintf(stderr, "Report file incomplete\n");
+        return false;
+    }
+
+    offset = trailer->strings_offset + sizeof(bbl_report_section_s);
+    if(offset + sizeof(uint32_t) > report->len) return false;
+    memcpy(&report->strings_count, report->buf + offset, sizeof(uint32_t));
+    offset += sizeof(uint32_t);
+    report->strings = calloc(report->strings_count+1, sizeof(char*));
+    report->strings_len = calloc(report->strings_count+1, sizeof(uint16_t));
+    if(!(report->strings && report->strings_len)) return false;
+    for(i = 0; i < report->strings_count; i++) {
+        if(offset + sizeof(uint16_t) > report->len) return false;
+        memcpy(&len, report->buf + offset, sizeof(uint16_t));
+        offset += sizeof(uint16_t);
+        if(offset + len > report->len) return false;
+        report->strings[i] = (char*)report->buf + offset;
+        report->strings_len[i] = len;
+        offset += len;
+    }
+    return true;
+}
+
+void
+print_string(FILE *out, format_t format, const char *s, uint16_t len)
+{
+    uint16_t i;
+
+    fputc('"', out);
+    for(i = 0; i < len; i++) {
+        if(s[i] == '"') {
+            fputs(format == FORMAT_JSON ? "\\\"" : "\"\"", out);
+        } else if(format == FORMAT_JSON && s[i] == '\\') {
+            fputs("\\\\", out);
+        } else if(format == FORMAT_JSON && (uint8_t)s[i] < 0x20) {
+            fprintf(out, "\\u%04x", (uint8_t)s[i]);
+        } else {
+            fputc(s[i], out);
+        }
+    }
+    fputc('"', out);
+}
+
+static void
+print_value(report_s *report, FILE *out, format_t format, bbl_report_field_s *field, uint8_t *record)
+{
+    uint8_t *v = record + field->offset;
+    char addr[INET6_ADDRSTRLEN];
+    char str[INET6_ADDRSTRLEN+8];
+    uint8_t u8; uint16_t u16; uint32_t u32; uint64_t u64; int64_t i64; double f64;
+
+    switch(field->type) {
+        case BBL_REPORT_U8:
+            memcpy(&u8, v, sizeof(u8));
+            fprintf(out, "%u", u8);
+            break;
+        case BBL_REPORT_U16:
+            memcpy(&u16, v, sizeof(u16));
+            fprintf(out, "%u", u16);
+            break;
+        case BBL_REPORT_U32:
+            memcpy(&u32, v, sizeof(u32));
+            fprintf(out, "%u", u32);
+            break;
+        case BBL_REPORT_U64:
+            memcpy(&u64, v, sizeof(u64));
+            fprintf(out, "%" PRIu64, u64);
+            break;
+        case BBL_REPORT_I64:
+            memcpy(&i64, v, sizeof(i64));
+            fprintf(out, "%" PRId64, i64);
+            break;
+        case BBL_REPORT_F64:
+            memcpy(&f64, v, sizeof(f64));
+            fprintf(out, "%.2f", f64);
+            break;
+        case BBL_REPORT_STR:
+            memcpy(&u32, v, sizeof(u32));
+            if(u32 < report->strings_count) {
+                print_string(out, format, report->strings[u32], report->strings_len[u32]);
+            } else {
+                fputs(format == FORMAT_JSON ? "null" : "", out);
+            }
+            break;
+        case BBL_REPORT_IP:
+            if(memcmp(v, "\0\0\0\0\0\0\0\0\0\0\xff\xff", 12) == 0) {
+                inet_ntop(AF_INET, v+12, addr, sizeof(addr));
+            } else {
+                inet_ntop(AF_INET6, v, addr, sizeof(addr));
+            }
+            print_string(out, format, addr, strlen(addr));
+            break;
+        case BBL_REPORT_IPV6_PREFIX:
+            inet_ntop(AF_INET6, v, addr, sizeof(addr));
+            snprintf(str, sizeof(str), "%s/%u", addr, v[16]);
+            print_string(out, format, str, strlen(str));
+            break;
+        case BBL_REPORT_MAC:
+            snprintf(str, sizeof(str), "%02x:%02x:%02x:%02x:%02x:%02x",
+                     v[0], v[1], v[2], v[3], v[4], v[5]);
+            print_string(out, format, str, strlen(str));
+            break;
+        default:
+            fputs(format == FORMAT_JSON ? "null" : "", out);
+            break;
+    }
+}
+
+static bool
+report_section(report_s *report, FILE *out, format_t format, uint32_t type, const char *name)
+{
+    bbl_report_section_s *section;
+    bbl_report_field_s *fields;
+    bbl_report_chunk_s *chunk;
+    size_t offset = sizeof(bbl_report_header_s);
+    size_t end = ((bbl_report_trailer_s*)(report->buf + report->len - sizeof(bbl_report_trailer_s)))->strings_offset;
+    uint8_t *record;
+    uint32_t i;
+    uint16_t f;
+    bool first = true;
+
+    if(format == FORMAT_JSON) {
+        fprintf(out, "{\n  \"%s\": [", name);
+    }
+    while(offset + sizeof(bbl_report_section_s) <= end) {
+        section = (bbl_report_section_s*)(report->buf + offset);
+        offset += sizeof(bbl_report_section_s);
+        fields = (bbl_report_field_s*)(report->buf + offset);
+        offset += section->field_count * sizeof(bbl_report_field_s);
+        if(offset > end) break;
+        for(f = 0; f < section->field_count; f++) {
+            if(fields[f].offset + fields[f].len > section->record_len) {
+                fprintf(stderr, "Invalid field %.*s\n", BBL_REPORT_FIELD_NAME_LEN, fields[f].name);
+                return false;
+            }
+        }
+        if(section->type == type && format == FORMAT_CSV) {
+            for(f = 0; f < section->field_count; f++) {
+                fprintf(out, "%s%.*s", f ? "," : "", BBL_REPORT_FIELD_NAME_LEN, fields[f].name);
+            }
+            fputc('\n', out);
+        }
+        while(offset + sizeof(bbl_report_chunk_s) <= end) {
+            chunk = (bbl_report_chunk_s*)(report->buf + offset);
+            offset += sizeof(bbl_report_chunk_s);
+            if(chunk->records == 0) break;
+            if(chunk->compression) {
+                fprintf(stderr, "Compression %u not supported\n", chunk->compression);
+                return false;
+            }
+            if(offset + chunk->len > end || chunk->len != chunk->records * section->record_len) {
+                fprintf(stderr, "Invalid chunk\n");
+                return false;
+            }
+            if(section->type == type) {
+                for(i = 0; i < chunk->records; i++) {
+                    record = report->buf + offset + (i * section->record_len);
+                    if(format == FORMAT_JSON) {
+                        fprintf(out, "%s\n    {", first ? "" : ",");
+                        first = false;
+                    }
+                    for(f = 0; f < section->field_count; f++) {
+                        if(format == FORMAT_JSON) {
+                            fprintf(out, "%s\n      \"%.*s\": ", f ? "," : "",
+                                    BBL_REPORT_FIELD_NAME_LEN, fields[f].name);
+                        } else if(f) {
+                            fputc(',', out);
+                        }
+                        print_value(report, out, format, &fields[f], record);
+                    }
+                    fputs(format == FORMAT_JSON ? "\n    }" : "\n", out);
+                }
+            }
+            offset += chunk->len;
+        }
+    }
+    if(format == FORMAT_JSON) {
+        fprintf(out, "%s]\n}\n", first ? "" : "\n  ");
+    }
+    return true;
+}
+
+int
+main(int argc, char *argv[])
+{
+    report_s report = {0};
+    const char *input = NULL;
+    const char *output = NULL;
+    const char *name = NULL;
+    format_t format = FORMAT_JSON;
+    uint32_t type = BBL_REPORT_SECTION_STREAMS;
+    FILE *out = stdout;
+    int long_index = 0;
+    int ch = 0;
+    bool result;
+
+    while(true) {
+        ch = getopt_long(argc, argv, optstring, long_options, &long_index);
+        if(ch == -1) break;
+        switch(ch) {
+            case 'i':
+                input = optarg;
+                break;
+            case 'o':
+                output = optarg;
+                break;
+            case 'f':
+                if(strcmp(optarg, "json") == 0) {
+                    format = FORMAT_JSON;
+                } else if(strcmp(optarg, "csv") == 0) {
+                    format = FORMAT_CSV;
+                } else {
+                    fprintf(stderr, "Invalid format %s\n", optarg);
+                    exit(1);
+                }
+                break;
+            case 's':
+                if(strcmp(optarg, "sessions") == 0) {
+                    type = BBL_REPORT_SECTION_SESSIONS;
+                }
+                name = optarg;
+                break;
+            default:
+                print_usage();
+                exit(0);
+        }
+    }
+    if(!input) {
+        print_usage();
+        exit(1);
+    }
+    if(!report_load(&report, input)) {
+        exit(1);
+    }
+    if(memcmp(report.buf, BBL_RECORDER_MAGIC, sizeof(BBL_RECORDER_MAGIC)) != 0) {
+        if(!report_strings(&report)) {
+            exit(1);
+        }
+        if(!name) name = "streams";
+        if(strcmp(name, "streams") != 0 && strcmp(name, "sessions") != 0) {
+            fprintf(stderr, "Invalid section %s\n", name);
+            exit(1);
+        }
+    }
+    if(output) {
+        out = fopen(output, "w");
+        if(!out) {
+            fprintf(stderr, "Failed to open %s\n", output);
+            exit(1);
+        }
+    }
+    if(report.strings) {
+        result = report_section(&report, out, format, type, name);
+    } else {
+        result = recorder_convert(report.buf, report.len, out, format, name);
+    }
+    if(out != stdout) fclose(out);
+    free(report.strings);
+    free(report.strings_len);
+    free(report.buf);
+    return result ? 0 : 1;
+}
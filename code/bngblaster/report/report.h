@@ -0,0 +1,29 @@
+/*
+ * BNG Blaster (BBL) - Binary Report Converter
+ *
+ * agent, October 2026
+ *
+ * Copyright (C) 2020-2025, RtBrick, Inc.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef __BBL_REPORT_CONVERTER_H__
+#define __BBL_REPORT_CONVERTER_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+
+typedef enum {
+    FORMAT_JSON,
+    FORMAT_CSV,
+} format_t;
+
+void
+print_string(FILE *out, format_t format, const char *s, uint16_t len);
+
+bool
+recorder_convert(uint8_t *buf, size_t len, FILE *out, format_t format, const char *type);
+
+#endif
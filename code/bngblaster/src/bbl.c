@@ -107,34 +107,6 @@ global_traffic_enable(bool status)
     g_traffic = status;
 }
 
-/*
- * Command line options.
- */
-const char *optstring = "vhC:T:l:L:u:p:P:j:J:c:g:s:r:z:S:Ibf";
-static struct option long_options[] = {
-    { "version",                no_argument,        NULL, 'v' },
-    { "help",                   no_argument,        NULL, 'h' },
-    { "config",                 required_argument,  NULL, 'C' },
-    { "stream-config",          required_argument,  NULL, 'T' },
-    { "logging",                required_argument,  NULL, 'l' },
-    { "log-file",               required_argument,  NULL, 'L' },
-    { "username",               required_argument,  NULL, 'u' },
-    { "password",               required_argument,  NULL, 'p' },
-    { "pcap-capture",           required_argument,  NULL, 'P' },
-    { "json-report-content",    required_argument,  NULL, 'j' },
-    { "json-report-file",       required_argument,  NULL, 'J' },
-    { "session-count",          required_argument,  NULL, 'c' },
-    { "mc-group",               required_argument,  NULL, 'g' },
-    { "mc-source",              required_argument,  NULL, 's' },
-    { "mc-group-count",         required_argument,  NULL, 'r' },
-    { "mc-zapping-interval",    required_argument,  NULL, 'z' },
-    { "control-socket",         required_argument,  NULL, 'S' },
-    { "interactive",            no_argument,        NULL, 'I' },
-    { "hide-banner",            no_argument,        NULL, 'b' },
-    { "force",                  no_argument,        NULL, 'f' },
-    { NULL,                     0,                  NULL,  0 }
-};
-
 struct keyval_ log_names[] = {
     { DEBUG,         "debug" },
     { ERROR,         "error" },
@@ -164,6 +136,39 @@ struct keyval_ log_names[] = {
     { 0, NULL}
 };
 
+#ifndef BNGBLASTER_BENCH
+
+/*
+ * Command line options.
+ */
+const char *optstring = "vhC:T:l:L:Au:p:P:j:J:B:c:g:s:r:z:S:Ibf";
+static struct option long_options[] = {
+    { "version",                no_argument,        NULL, 'v' },
+    { "help",                   no_argument,        NULL, 'h' },
+    { "config",                 required_argument,  NULL, 'C' },
+    { "stream-config",          required_argument,  NULL, 'T' },
+    { "logging",                required_argument,  NULL, 'l' },
+    { "log-file",               required_argument,  NULL, 'L' },
+    { "log-async",              no_argument,        NULL, 'A' },
+    { "username",               required_argument,  NULL, 'u' },
+    { "password",               required_argument,  NULL, 'p' },
+    { "pcap-capture",           required_argument,  NULL, 'P' },
+    { "json-report-content",    required_argument,  NULL, 'j' },
+    { "json-report-file",       required_argument,  NULL, 'J' },
+    { "binary-report-file",     required_argument,  NULL, 'B' },
+    { "session-count",          required_argument,  NULL, 'c' },
+    { "mc-group",               required_argument,  NULL, 'g' },
+    { "mc-source",              required_argument,  NULL, 's' },
+    { "mc-group-count",         required_argument,  NULL, 'r' },
+    { "mc-zapping-interval",    required_argument,  NULL, 'z' },
+    { "control-socket",         required_argument,  NULL, 'S' },
+    { "interactive",            no_argument,        NULL, 'I' },
+    { "hide-banner",            no_argument,        NULL, 'b' },
+    { "force",                  no_argument,        NULL, 'f' },
+    { NULL,                     0,                  NULL,  0 }
+};
+
+
 static char *
 bbl_print_usage_arg(struct option *option)
 {
@@ -195,7 +200,7 @@ bbl_print_version (void)
         printf("  REF: %s\n", GIT_REF);
         printf("  SHA: %s\n", GIT_SHA);
     }
-    printf("IO Modes: packet_mmap_raw (default), packet_mmap, raw");
+    printf("IO Modes: packet_mmap_raw (default), packet_mmap, raw, loopback");
 #ifdef BNGBLASTER_DPDK
     printf(", dpdk");
 #endif
@@ -402,6 +407,7 @@ main(int argc, char *argv[])
     const char *igmp_group_count = NULL;
     const char *igmp_zap_interval = NULL;
     bool  interactive = false;
+    bool  async_logging = false;
 
     if(!bbl_ctx_add()) {
         exit(2);
@@ -415,6 +421,9 @@ main(int argc, char *argv[])
     /* Seed pseudo random generator. */
     srand(time(0));
 
+    /* Select checksum implementation before any threads are started. */
+    checksum_set_impl(CHECKSUM_IMPL_AUTO);
+
     /* Process config options. */
     while (true) {
         ch = getopt_long(argc, argv, optstring, long_options, &long_index);
@@ -441,6 +450,9 @@ main(int argc, char *argv[])
             case 'J':
                 g_ctx->config.json_report_filename = optarg;
                 break;
+            case 'B':
+                g_ctx->config.binary_report_filename = optarg;
+                break;
             case 'C':
                 config_file = optarg;
                 break;
@@ -453,6 +465,9 @@ main(int argc, char *argv[])
             case 'L':
                 g_log_file = optarg;
                 break;
+            case 'A':
+                async_logging = true;
+                break;
             case 'u':
                 username = optarg;
                 break;
@@ -501,6 +516,14 @@ main(int argc, char *argv[])
     /* Open logfile. */
     log_open();
 
+    /* Asynchronous logging is not supported in interactive mode. */
+    if(async_logging && !interactive) {
+        if(!log_async_start(true)) {
+            fprintf(stderr, "Error: Failed to start asynchronous logging\n");
+            goto CLEANUP;
+        }
+    }
+
     /* Init config. */
     bbl_config_init_defaults();
     if(!bbl_config_load_json(config_file)) {
@@ -590,11 +613,21 @@ main(int argc, char *argv[])
     }
     LOG(INFO, "Total PPS of all streams: %.2f\n", g_ctx->total_pps);
 
+    if(!bbl_stream_io_init()) {
+        fprintf(stderr, "Error: Failed to init stream IO\n");
+        goto CLEANUP;
+    }
+
     if(!bbl_stream_index_init()) {
         fprintf(stderr, "Error: Failed to init stream index\n");
         goto CLEANUP;
     }
 
+    if(!bbl_recorder_init()) {
+        fprintf(stderr, "Error: Failed to init recorder\n");
+        goto CLEANUP;
+    }
+
     /* Setup control job. */
     timer_add_periodic(&g_ctx->timer_root, &g_ctx->control_timer, "Control Timer", 
                        1, 0, g_ctx, &bbl_ctrl_job);
@@ -664,6 +697,9 @@ main(int argc, char *argv[])
 
     /* Stop threads. */
     io_thread_stop_all();
+#ifdef BNGBLASTER_DPDK
+    io_dpdk_close();
+#endif
 
     /* Stop curses. Do this before the final reports. */
     if(g_interactive) {
@@ -676,10 +712,12 @@ main(int argc, char *argv[])
     bbl_stats_generate(&stats);
     bbl_stats_stdout(&stats);
     bbl_stats_json(&stats);
+    bbl_report_close();
     exit_status = 0;
 
     /* Cleanup resources. */
 CLEANUP:
+    bbl_recorder_close();
     bbl_interface_unlock_all();
     if(g_ctx->ctrl_socket_path) {
         bbl_ctrl_socket_close();
@@ -688,3 +726,5 @@ CLEANUP:
     bbl_ctx_del();
     return exit_status;
 }
+
+#endif
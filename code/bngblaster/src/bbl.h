@@ -25,6 +25,8 @@
 #include "bbl_def.h"
 
 #include "bbl_protocols.h"
+#include "bbl_arena.h"
+#include "bbl_bitmap.h"
 #include "io/io_def.h"
 #include "bgp/bgp_def.h"
 #include "isis/isis_def.h"
@@ -32,6 +34,7 @@
 #include "ldp/ldp_def.h"
 
 #include "bbl_ctrl.h"
+#include "bbl_telemetry.h"
 #include "bbl_stats.h"
 #include "bbl_access_line.h"
 #include "bbl_config.h"
@@ -54,6 +57,9 @@
 #include "bbl_http_client.h"
 #include "bbl_http_server.h"
 #include "bbl_fragment.h"
+#include "bbl_mrt.h"
+#include "bbl_report.h"
+#include "bbl_recorder.h"
 
 #include "io/io.h"
 #include "bgp/bgp.h"
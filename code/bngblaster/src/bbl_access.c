@@ -210,6 +210,7 @@ void
 bbl_access_igmp_zapping(timer_s *timer)
 {
     bbl_session_s *session = timer->data;
+    bbl_session_igmp_s *igmp = session->igmp;
 
     uint32_t next_group;
     bbl_igmp_group_s *group;
@@ -232,23 +233,23 @@ bbl_access_igmp_zapping(timer_s *timer)
         }
     }
 
-    if(!session->zapping_joined_group || !session->zapping_leaved_group) {
+    if(!igmp || !igmp->zapping_joined_group || !igmp->zapping_leaved_group) {
         return;
     }
 
-    if(session->zapping_view_start_time.tv_sec) {
+    if(igmp->zapping_view_start_time.tv_sec) {
         clock_gettime(CLOCK_MONOTONIC, &time_now);
-        timespec_sub(&time_diff, &time_now, &session->zapping_view_start_time);
+        timespec_sub(&time_diff, &time_now, &igmp->zapping_view_start_time);
         if(time_diff.tv_sec >= g_ctx->config.igmp_zap_view_duration) {
-            session->zapping_view_start_time.tv_sec = 0;
-            session->zapping_count = 0;
+            igmp->zapping_view_start_time.tv_sec = 0;
+            igmp->zapping_count = 0;
         } else {
             return;
         }
     }
 
     /* Calculate last join delay... */
-    group = session->zapping_joined_group;
+    group = igmp->zapping_joined_group;
     if(group->first_mc_rx_time.tv_sec) {
         if(!group->zapping_result) {
             group->zapping_result = true;
@@ -257,15 +258,15 @@ bbl_access_igmp_zapping(timer_s *timer)
             if(time_diff.tv_nsec % 1000000) ms++; /* simple roundup function */
             join_delay = (time_diff.tv_sec * 1000) + ms;
             if(!join_delay) join_delay = 1; /* join delay must be at least one millisecond */
-            session->zapping_join_delay_sum += join_delay;
-            session->zapping_join_count++;
+            igmp->zapping_join_delay_sum += join_delay;
+            igmp->zapping_join_count++;
             if(join_delay > session->stats.max_join_delay) session->stats.max_join_delay = join_delay;
             if(session->stats.min_join_delay) {
                 if(join_delay < session->stats.min_join_delay) session->stats.min_join_delay = join_delay;
             } else {
                 session->stats.min_join_delay = join_delay;
             }
-            session->stats.avg_join_delay = session->zapping_join_delay_sum / session->zapping_join_count;
+            session->stats.avg_join_delay = igmp->zapping_join_delay_sum / igmp->zapping_join_count;
             
             if(g_ctx->config.igmp_max_join_delay && join_delay > g_ctx->config.igmp_max_join_delay) {
                 session->stats.join_delay_violations++;
@@ -304,7 +305,7 @@ bbl_access_igmp_zapping(timer_s *timer)
 
     /* Select next group to be joined ... */
     next_group = be32toh(group->group) + be32toh(g_ctx->config.igmp_group_iter);
-    if(next_group > session->zapping_group_max) {
+    if(next_group > igmp->zapping_group_max) {
         next_group = g_ctx->config.igmp_group;
     } else {
         next_group = htobe32(next_group);
@@ -320,22 +321,22 @@ bbl_access_igmp_zapping(timer_s *timer)
     group->last_mc_rx_time.tv_nsec = 0;
 
     /* Calculate last leave delay ... */
-    group = session->zapping_leaved_group;
+    group = igmp->zapping_leaved_group;
     if(group->group && group->last_mc_rx_time.tv_sec && group->leave_tx_time.tv_sec) {
         timespec_sub(&time_diff, &group->last_mc_rx_time, &group->leave_tx_time);
         ms = time_diff.tv_nsec / 1000000; /* convert nanoseconds to milliseconds */
         if(time_diff.tv_nsec % 1000000) ms++; /* simple roundup function */
         leave_delay = (time_diff.tv_sec * 1000) + ms;
         if(!leave_delay) leave_delay = 1; /* leave delay must be at least one millisecond */
-        session->zapping_leave_delay_sum += leave_delay;
-        session->zapping_leave_count++;
+        igmp->zapping_leave_delay_sum += leave_delay;
+        igmp->zapping_leave_count++;
         if(leave_delay > session->stats.max_leave_delay) session->stats.max_leave_delay = leave_delay;
         if(session->stats.min_leave_delay) {
             if(leave_delay < session->stats.min_leave_delay) session->stats.min_leave_delay = leave_delay;
         } else {
             session->stats.min_leave_delay = leave_delay;
         }
-        session->stats.avg_leave_delay = session->zapping_leave_delay_sum / session->zapping_leave_count;
+        session->stats.avg_leave_delay = igmp->zapping_leave_delay_sum / igmp->zapping_leave_count;
 
         LOG(IGMP, "IGMP (ID: %u) ZAPPING %u ms leave delay for group %s\n",
             session->session_id, leave_delay, format_ipv4_address(&group->group));
@@ -360,20 +361,20 @@ bbl_access_igmp_zapping(timer_s *timer)
         group->zapping_result = false;
 
         /* Swap join/leave */
-        session->zapping_leaved_group = session->zapping_joined_group;
-        session->zapping_joined_group = group;
+        igmp->zapping_leaved_group = igmp->zapping_joined_group;
+        igmp->zapping_joined_group = group;
 
         LOG(IGMP, "IGMP (ID: %u) ZAPPING leave %s join %s\n",
             session->session_id,
-            format_ipv4_address(&session->zapping_leaved_group->group),
-            format_ipv4_address(&session->zapping_joined_group->group));
+            format_ipv4_address(&igmp->zapping_leaved_group->group),
+            format_ipv4_address(&igmp->zapping_joined_group->group));
     } else {
         /* Zapping has stopped */
         group->last_mc_rx_time.tv_sec = 0;
         group->leave_tx_time.tv_sec = 0;
         LOG(IGMP, "IGMP (ID: %u) ZAPPING leave %s\n",
             session->session_id,
-            format_ipv4_address(&session->zapping_joined_group->group));
+            format_ipv4_address(&igmp->zapping_joined_group->group));
     }
 
     session->send_requests |= BBL_SEND_IGMP;
@@ -381,10 +382,10 @@ bbl_access_igmp_zapping(timer_s *timer)
 
 
     /* Handle viewing profile */
-    session->zapping_count++;
+    igmp->zapping_count++;
     if(g_ctx->config.igmp_zap_count && g_ctx->config.igmp_zap_view_duration) {
-        if(session->zapping_count >= g_ctx->config.igmp_zap_count) {
-            clock_gettime(CLOCK_MONOTONIC, &session->zapping_view_start_time);
+        if(igmp->zapping_count >= g_ctx->config.igmp_zap_count) {
+            clock_gettime(CLOCK_MONOTONIC, &igmp->zapping_view_start_time);
         }
     }
 }
@@ -393,6 +394,7 @@ void
 bbl_access_igmp_initial_join(timer_s *timer)
 {
     bbl_session_s *session = timer->data;
+    bbl_session_igmp_s *igmp;
     uint32_t initial_group;
     bbl_igmp_group_s *group;
 
@@ -404,20 +406,25 @@ bbl_access_igmp_initial_join(timer_s *timer)
         return;
     }
 
+    igmp = bbl_session_igmp(session);
+    if(!igmp) {
+        return;
+    }
+
     /* Get initial group */
     if(g_ctx->config.igmp_group_count > 1) {
         group_start_index = rand() % g_ctx->config.igmp_group_count;
     }
     initial_group = htobe32(be32toh(g_ctx->config.igmp_group) + (group_start_index * be32toh(g_ctx->config.igmp_group_iter)));
 
-    group = &session->igmp_groups[0];
+    group = &igmp->groups[0];
     memset(group, 0x0, sizeof(bbl_igmp_group_s));
     group->group = initial_group;
     group->source[0] = g_ctx->config.igmp_source;
     group->robustness_count = session->igmp_robustness;
     group->state = IGMP_GROUP_JOINING;
     group->send = true;
-    session->zapping_count = 1;
+    igmp->zapping_count = 1;
     session->send_requests |= BBL_SEND_IGMP;
     bbl_session_tx_qnode_insert(session);
 
@@ -427,15 +434,15 @@ bbl_access_igmp_initial_join(timer_s *timer)
     if(g_ctx->config.igmp_group_count > 1 && g_ctx->config.igmp_zap_interval > 0) {
         /* Start/Init Zapping Logic ... */
         group->zapping = true;
-        session->zapping_joined_group = group;
-        group = &session->igmp_groups[1];
-        session->zapping_leaved_group = group;
+        igmp->zapping_joined_group = group;
+        group = &igmp->groups[1];
+        igmp->zapping_leaved_group = group;
         memset(group, 0x0, sizeof(bbl_igmp_group_s));
         group->zapping = true;
         group->source[0] = g_ctx->config.igmp_source;
 
         if(g_ctx->config.igmp_zap_count && g_ctx->config.igmp_zap_view_duration) {
-            session->zapping_count = rand() % g_ctx->config.igmp_zap_count;
+            igmp->zapping_count = rand() % g_ctx->config.igmp_zap_count;
         }
 
         /* Adding 2 nanoseconds to enforce a dedicated timer bucket for zapping. */
@@ -616,12 +623,18 @@ bbl_access_rx_ipv4_mc(bbl_access_interface_s *interface,
                       bbl_ethernet_header_s *eth, bbl_ipv4_s *ipv4)
 {
     bbl_bbl_s *bbl = eth->bbl;
+    bbl_session_igmp_s *igmp = session->igmp;
     bbl_igmp_group_s *group = NULL;
     uint64_t loss;
     int i;
 
+    if(!igmp) {
+        /* No group joined. */
+        return;
+    }
+
     for(i=0; i < IGMP_MAX_GROUPS; i++) {
-        group = &session->igmp_groups[i];
+        group = &igmp->groups[i];
         if(ipv4->dst == group->group) {
             group->packets++;
             group->last_mc_rx_time.tv_sec = eth->timestamp.tv_sec;
@@ -631,22 +644,22 @@ bbl_access_rx_ipv4_mc(bbl_access_interface_s *interface,
                     group->first_mc_rx_time.tv_sec = eth->timestamp.tv_sec;
                     group->first_mc_rx_time.tv_nsec = eth->timestamp.tv_nsec;
                     if(bbl) {
-                        session->mc_rx_last_seq = bbl->flow_seq;
+                        igmp->mc_rx_last_seq = bbl->flow_seq;
                     }
                 } else if(bbl) {
-                    if((session->mc_rx_last_seq +1) < bbl->flow_seq) {
-                        loss = bbl->flow_seq - (session->mc_rx_last_seq +1);
+                    if((igmp->mc_rx_last_seq +1) < bbl->flow_seq) {
+                        loss = bbl->flow_seq - (igmp->mc_rx_last_seq +1);
                         interface->stats.mc_loss += loss;
                         session->stats.mc_loss += loss;
                         group->loss += loss;
                         LOG(LOSS, "LOSS (ID: %u) Multicast flow: %lu seq: %lu last: %lu\n",
-                            session->session_id, bbl->flow_id, bbl->flow_seq, session->mc_rx_last_seq);
+                            session->session_id, bbl->flow_id, bbl->flow_seq, igmp->mc_rx_last_seq);
                     }
-                    session->mc_rx_last_seq = bbl->flow_seq;
+                    igmp->mc_rx_last_seq = bbl->flow_seq;
                 }
             } else {
-                if(session->zapping_joined_group && (session->zapping_leaved_group == group)) {
-                    if(session->zapping_joined_group->first_mc_rx_time.tv_sec) {
+                if(igmp->zapping_joined_group && (igmp->zapping_leaved_group == group)) {
+                    if(igmp->zapping_joined_group->first_mc_rx_time.tv_sec) {
                         session->stats.mc_old_rx_after_first_new++;
                     }
                 }
@@ -752,7 +765,9 @@ bbl_access_l2tp_stream_force_verified(bbl_session_s *session, bbl_stream_s *stre
 {
     if(stream && stream->verified == false) {
         stream->verified = true;
+        bbl_bitmap_clear(&g_ctx->streams_pending, stream->flow_id-1);
         session->session_traffic.flows_verified++;
+        bbl_session_pending_update(session);
         g_ctx->stats.session_traffic_flows_verified++;
         if(g_ctx->stats.session_traffic_flows_verified == g_ctx->stats.session_traffic_flows) {
             LOG_NOARG(INFO, "ALL SESSION TRAFFIC FLOWS VERIFIED\n");
@@ -850,7 +865,7 @@ bbl_access_rx_pap(bbl_access_interface_s *interface,
             default:
                 bbl_session_update_state(session, BBL_PPP_TERMINATING);
                 session->lcp_request_code = PPP_CODE_TERM_REQUEST;
-                session->lcp_options_len = 0;
+                session->ppp->lcp_options_len = 0;
                 session->lcp_state = BBL_PPP_TERMINATE;
                 session->send_requests |= BBL_SEND_LCP_REQUEST;
                 bbl_session_tx_qnode_insert(session);
@@ -882,7 +897,7 @@ bbl_access_rx_chap(bbl_access_interface_s *interface,
                     LOG(PPPOE, "CHAP (ID: %u) CHAP challenge length must be greater than 0\n", session->session_id);
                     bbl_session_update_state(session, BBL_PPP_TERMINATING);
                     session->lcp_request_code = PPP_CODE_TERM_REQUEST;
-                    session->lcp_options_len = 0;
+                    session->ppp->lcp_options_len = 0;
                     session->lcp_state = BBL_PPP_TERMINATE;
                     session->send_requests |= BBL_SEND_LCP_REQUEST;
                     bbl_session_tx_qnode_insert(session);
@@ -929,7 +944,7 @@ bbl_access_rx_chap(bbl_access_interface_s *interface,
             default:
                 bbl_session_update_state(session, BBL_PPP_TERMINATING);
                 session->lcp_request_code = PPP_CODE_TERM_REQUEST;
-                session->lcp_options_len = 0;
+                session->ppp->lcp_options_len = 0;
                 session->lcp_state = BBL_PPP_TERMINATE;
                 session->send_requests |= BBL_SEND_LCP_REQUEST;
                 bbl_session_tx_qnode_insert(session);
@@ -1016,8 +1031,8 @@ bbl_access_rx_ip6cp(bbl_access_interface_s *interface,
     if(!g_ctx->config.ip6cp_enable) {
         /* Protocol Reject */
         LOG(PPPOE, "LCP PROTOCOL REJECT (ID: %u) Send IP6CP protocol reject\n", session->session_id);
-        *(uint16_t*)session->lcp_options = htobe16(PROTOCOL_IP6CP);
-        session->lcp_options_len = 2;
+        *(uint16_t*)session->ppp->lcp_options = htobe16(PROTOCOL_IP6CP);
+        session->ppp->lcp_options_len = 2;
         session->lcp_peer_identifier = ++session->lcp_identifier;
         session->lcp_response_code = PPP_CODE_PROT_REJECT;
         session->send_requests |= BBL_SEND_LCP_RESPONSE;
@@ -1034,8 +1049,8 @@ bbl_access_rx_ip6cp(bbl_access_interface_s *interface,
                 session->ip6cp_ipv6_peer_identifier = ip6cp->ipv6_identifier;
             }
             if(ip6cp->options_len <= PPP_OPTIONS_BUFFER) {
-                memcpy(session->ip6cp_options, ip6cp->options, ip6cp->options_len);
-                session->ip6cp_options_len = ip6cp->options_len;
+                memcpy(session->ppp->ip6cp_options, ip6cp->options, ip6cp->options_len);
+                session->ppp->ip6cp_options_len = ip6cp->options_len;
             } else {
                 ip6cp->options_len = 0;
             }
@@ -1117,14 +1132,14 @@ bbl_access_rx_ipcp_conf_reject(bbl_session_s *session, bbl_ipcp_s *ipcp)
 
     LOG(PPPOE, "IPCP (ID: %u) conf-reject send\n", session->session_id);
 
-    session->ipcp_options_len = 0;
+    session->ppp->ipcp_options_len = 0;
     while(len >= 2) {
         option_type = *buf;
         option_len = *(buf+1);
         if(option_type != PPP_IPCP_OPTION_ADDRESS) {
-            if((session->ipcp_options_len + option_len) <= PPP_OPTIONS_BUFFER) {
-                memcpy(session->ipcp_options+session->ipcp_options_len, buf, option_len);
-                session->ipcp_options_len += option_len;
+            if((session->ppp->ipcp_options_len + option_len) <= PPP_OPTIONS_BUFFER) {
+                memcpy(session->ppp->ipcp_options+session->ppp->ipcp_options_len, buf, option_len);
+                session->ppp->ipcp_options_len += option_len;
             }
         }
         buf = buf+option_len;
@@ -1152,8 +1167,8 @@ bbl_access_rx_ipcp(bbl_access_interface_s *interface,
     if(!g_ctx->config.ipcp_enable) {
         /* Protocol Reject */
         LOG(PPPOE, "LCP PROTOCOL REJECT (ID: %u) Send IPCP protocol reject\n", session->session_id);
-        *(uint16_t*)session->lcp_options = htobe16(PROTOCOL_IPCP);
-        session->lcp_options_len = 2;
+        *(uint16_t*)session->ppp->lcp_options = htobe16(PROTOCOL_IPCP);
+        session->ppp->lcp_options_len = 2;
         session->lcp_peer_identifier = ++session->lcp_identifier;
         session->lcp_response_code = PPP_CODE_PROT_REJECT;
         session->send_requests |= BBL_SEND_LCP_RESPONSE;
@@ -1174,8 +1189,8 @@ bbl_access_rx_ipcp(bbl_access_interface_s *interface,
                 session->peer_ip_address = ipcp->address;
             }
             if(ipcp->options_len <= PPP_OPTIONS_BUFFER) {
-                memcpy(session->ipcp_options, ipcp->options, ipcp->options_len);
-                session->ipcp_options_len = ipcp->options_len;
+                memcpy(session->ppp->ipcp_options, ipcp->options, ipcp->options_len);
+                session->ppp->ipcp_options_len = ipcp->options_len;
             } else {
                 ipcp->options_len = 0;
             }
@@ -1257,7 +1272,7 @@ bbl_access_rx_ipcp(bbl_access_interface_s *interface,
         case PPP_CODE_TERM_REQUEST:
             session->ipcp_peer_identifier = ipcp->identifier;
             session->ipcp_response_code = PPP_CODE_TERM_ACK;
-            session->ipcp_options_len = 0;
+            session->ppp->ipcp_options_len = 0;
             session->send_requests |= BBL_SEND_IPCP_RESPONSE;
             bbl_session_tx_qnode_insert(session);
             break;
@@ -1284,7 +1299,7 @@ bbl_access_rx_lcp_conf_reject(bbl_session_s *session, bbl_lcp_s *lcp)
 {
     uint8_t type;
     uint8_t len;
-    session->lcp_options_len = 0;
+    session->ppp->lcp_options_len = 0;
 
     for(int i=0; i < PPP_MAX_OPTIONS; i++) {
         if(lcp->option[i]) {
@@ -1296,9 +1311,9 @@ bbl_access_rx_lcp_conf_reject(bbl_session_s *session, bbl_lcp_s *lcp)
                 case PPP_LCP_OPTION_MAGIC:
                     break;
                 default:
-                    if((session->lcp_options_len + len) <= PPP_OPTIONS_BUFFER) {                        
-                        memcpy(&session->lcp_options[session->lcp_options_len], lcp->option[i], len);
-                        session->lcp_options_len += len;
+                    if((session->ppp->lcp_options_len + len) <= PPP_OPTIONS_BUFFER) {                        
+                        memcpy(&session->ppp->lcp_options[session->ppp->lcp_options_len], lcp->option[i], len);
+                        session->ppp->lcp_options_len += len;
                     }
                     break;
             }
@@ -1337,7 +1352,7 @@ bbl_access_lcp_echo(timer_s *timer)
         } else {
             session->lcp_request_code = PPP_CODE_ECHO_REQUEST;
             session->lcp_identifier++;
-            session->lcp_options_len = 0;
+            session->ppp->lcp_options_len = 0;
             session->send_requests |= BBL_SEND_LCP_REQUEST;
             bbl_session_tx_qnode_insert(session);
         }
@@ -1424,18 +1439,18 @@ bbl_access_rx_lcp(bbl_access_interface_s *interface,
                 memcpy(session->connections_status_message, lcp->vendor_value, lcp->vendor_value_len);
                 session->connections_status_message[lcp->vendor_value_len] = 0;
                 session->lcp_response_code = PPP_CODE_VENDOR_SPECIFIC;
-                *(uint32_t*)session->lcp_options = session->magic_number;
-                memcpy(session->lcp_options+sizeof(uint32_t), lcp->vendor_oui, OUI_LEN);
-                session->lcp_options[7] = 2;
-                session->lcp_options_len = 8;
+                *(uint32_t*)session->ppp->lcp_options = session->magic_number;
+                memcpy(session->ppp->lcp_options+sizeof(uint32_t), lcp->vendor_oui, OUI_LEN);
+                session->ppp->lcp_options[7] = 2;
+                session->ppp->lcp_options_len = 8;
             } else {
                 session->lcp_response_code = PPP_CODE_CODE_REJECT;
                 if(lcp->len > PPP_OPTIONS_BUFFER) {
-                    memcpy(session->lcp_options, lcp->start, PPP_OPTIONS_BUFFER);
-                    session->lcp_options_len = PPP_OPTIONS_BUFFER;
+                    memcpy(session->ppp->lcp_options, lcp->start, PPP_OPTIONS_BUFFER);
+                    session->ppp->lcp_options_len = PPP_OPTIONS_BUFFER;
                 } else {
-                    memcpy(session->lcp_options, lcp->start, lcp->len);
-                    session->lcp_options_len = lcp->len;
+                    memcpy(session->ppp->lcp_options, lcp->start, lcp->len);
+                    session->ppp->lcp_options_len = lcp->len;
                 }
             }
             session->lcp_peer_identifier = lcp->identifier;
@@ -1466,16 +1481,16 @@ bbl_access_rx_lcp(bbl_access_interface_s *interface,
                 if(!(session->auth_protocol == PROTOCOL_CHAP || session->auth_protocol == PROTOCOL_PAP)) {
                     /* Reject authentication protocol */
                     if(lcp->auth == PROTOCOL_CHAP) {
-                        session->lcp_options[0] = 3;
-                        session->lcp_options[1] = 5;
-                        *(uint16_t*)&session->lcp_options[2] = htobe16(PROTOCOL_CHAP);
-                        session->lcp_options[4] = 5;
-                        session->lcp_options_len = 5;
+                        session->ppp->lcp_options[0] = 3;
+                        session->ppp->lcp_options[1] = 5;
+                        *(uint16_t*)&session->ppp->lcp_options[2] = htobe16(PROTOCOL_CHAP);
+                        session->ppp->lcp_options[4] = 5;
+                        session->ppp->lcp_options_len = 5;
                     } else {
-                        session->lcp_options[0] = 3;
-                        session->lcp_options[1] = 4;
-                        *(uint16_t*)&session->lcp_options[2] = htobe16(PROTOCOL_PAP);
-                        session->lcp_options_len = 4;
+                        session->ppp->lcp_options[0] = 3;
+                        session->ppp->lcp_options[1] = 4;
+                        *(uint16_t*)&session->ppp->lcp_options[2] = htobe16(PROTOCOL_PAP);
+                        session->ppp->lcp_options_len = 4;
                     }
                     session->lcp_peer_identifier = lcp->identifier;
                     session->lcp_response_code = PPP_CODE_CONF_NAK;
@@ -1491,8 +1506,8 @@ bbl_access_rx_lcp(bbl_access_interface_s *interface,
                 session->peer_magic_number = lcp->magic;
             }
             if(lcp->options_len <= PPP_OPTIONS_BUFFER) {
-                memcpy(session->lcp_options, lcp->options, lcp->options_len);
-                session->lcp_options_len = lcp->options_len;
+                memcpy(session->ppp->lcp_options, lcp->options, lcp->options_len);
+                session->ppp->lcp_options_len = lcp->options_len;
             } else {
                 lcp->options_len = 0;
             }
@@ -1599,7 +1614,7 @@ bbl_access_rx_lcp(bbl_access_interface_s *interface,
             if(!session->lcp_echo_request_ignore) {
                 session->lcp_peer_identifier = lcp->identifier;
                 session->lcp_response_code = PPP_CODE_ECHO_REPLY;
-                session->lcp_options_len = 0;
+                session->ppp->lcp_options_len = 0;
                 session->send_requests |= BBL_SEND_LCP_RESPONSE;
                 bbl_session_tx_qnode_insert(session);
             }
@@ -1610,7 +1625,7 @@ bbl_access_rx_lcp(bbl_access_interface_s *interface,
         case PPP_CODE_TERM_REQUEST:
             session->lcp_peer_identifier = lcp->identifier;
             session->lcp_response_code = PPP_CODE_TERM_ACK;
-            session->lcp_options_len = 0;
+            session->ppp->lcp_options_len = 0;
             session->lcp_state = BBL_PPP_TERMINATE;
             session->send_requests = BBL_SEND_LCP_RESPONSE;
             if(session->session_state != BBL_PPP_TERMINATING) {
@@ -1649,11 +1664,11 @@ bbl_access_rx_lcp(bbl_access_interface_s *interface,
         default:
             session->lcp_response_code = PPP_CODE_CODE_REJECT;
             if(lcp->len > PPP_OPTIONS_BUFFER) {
-                memcpy(session->lcp_options, lcp->start, PPP_OPTIONS_BUFFER);
-                session->lcp_options_len = PPP_OPTIONS_BUFFER;
+                memcpy(session->ppp->lcp_options, lcp->start, PPP_OPTIONS_BUFFER);
+                session->ppp->lcp_options_len = PPP_OPTIONS_BUFFER;
             } else {
-                memcpy(session->lcp_options, lcp->start, lcp->len);
-                session->lcp_options_len = lcp->len;
+                memcpy(session->ppp->lcp_options, lcp->start, lcp->len);
+                session->ppp->lcp_options_len = lcp->len;
             }
             session->lcp_peer_identifier = lcp->identifier;
             session->send_requests |= BBL_SEND_LCP_RESPONSE;
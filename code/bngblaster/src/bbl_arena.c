@@ -0,0 +1,53 @@
+/*
+ * BNG Blaster (BBL) - Arena Allocator
+ *
+ * agent, October 2026
+ *
+ * Copyright (C) 2020-2025, RtBrick, Inc.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include "bbl.h"
+
+/**
+ * bbl_arena_alloc
+ *
+ * Allocate zeroed and cache line aligned memory from arena.
+ * The chunk memory is zeroed by the calling thread, which
+ * places the pages on the NUMA node of this thread (first touch).
+ *
+ * @param arena arena
+ * @param size requested size in bytes
+ * @return pointer to memory or NULL
+ */
+void *
+bbl_arena_alloc(bbl_arena_s *arena, size_t size)
+{
+    bbl_arena_chunk_s *chunk = arena->chunk;
+    size_t chunk_size;
+    void *ptr;
+
+    /* Round up to cache line to prevent false sharing
+     * between objects used by different threads. */
+    size = (size + CACHE_LINE_SIZE - 1) & ~((size_t)CACHE_LINE_SIZE - 1);
+    if(!size) return NULL;
+
+    if(!chunk || chunk->size - chunk->used < size) {
+        chunk_size = BBL_ARENA_CHUNK_SIZE;
+        if(size > chunk_size) chunk_size = size;
+        if(posix_memalign(&ptr, CACHE_LINE_SIZE, sizeof(bbl_arena_chunk_s) + chunk_size) != 0) {
+            return NULL;
+        }
+        chunk = ptr;
+        memset(chunk, 0x0, sizeof(bbl_arena_chunk_s) + chunk_size);
+        chunk->size = chunk_size;
+        /* Remaining space of previous chunk is
+         * not used anymore. */
+        chunk->next = arena->chunk;
+        arena->chunk = chunk;
+        arena->allocated += chunk_size;
+    }
+    ptr = chunk->data + chunk->used;
+    chunk->used += size;
+    arena->used += size;
+    return ptr;
+}
@@ -0,0 +1,35 @@
+/*
+ * BNG Blaster (BBL) - Arena Allocator
+ *
+ * Objects with (at least) the same lifetime as the
+ * arena are allocated from large chunks instead of
+ * individual heap allocations. There is no free for
+ * single objects, the owner must reuse them.
+ *
+ * agent, October 2026
+ *
+ * Copyright (C) 2020-2025, RtBrick, Inc.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef __BBL_ARENA_H__
+#define __BBL_ARENA_H__
+
+#define BBL_ARENA_CHUNK_SIZE (1024*1024)
+
+typedef struct bbl_arena_chunk_ {
+    struct bbl_arena_chunk_ *next;
+    size_t size;
+    size_t used;
+    uint8_t data[] __attribute__((__aligned__(CACHE_LINE_SIZE)));
+} bbl_arena_chunk_s;
+
+typedef struct bbl_arena_ {
+    bbl_arena_chunk_s *chunk; /* current chunk */
+    size_t allocated; /* bytes allocated from system */
+    size_t used; /* bytes handed out */
+} bbl_arena_s;
+
+void *
+bbl_arena_alloc(bbl_arena_s *arena, size_t size);
+
+#endif
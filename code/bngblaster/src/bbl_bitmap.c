@@ -0,0 +1,137 @@
+/*
+ * BNG Blaster (BBL) - Bitmap
+ *
+ * agent, October 2026
+ *
+ * Copyright (C) 2020-2025, RtBrick, Inc.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include "bbl.h"
+
+/**
+ * bbl_bitmap_init
+ *
+ * @param bitmap bitmap
+ * @param size number of bits
+ * @param set initialize all bits set if true
+ * @return true if successful
+ */
+bool
+bbl_bitmap_init(bbl_bitmap_s *bitmap, uint32_t size, bool set)
+{
+    uint32_t words = (size + 63) / 64;
+    uint32_t blocks = (size + BBL_BITMAP_BLOCK_BITS - 1) / BBL_BITMAP_BLOCK_BITS;
+    uint32_t i;
+
+    bbl_bitmap_free(bitmap);
+    if(!size || size == BBL_BITMAP_END) {
+        return false;
+    }
+    bitmap->words = calloc(words, sizeof(uint64_t));
+    bitmap->blocks = calloc(blocks, sizeof(uint32_t));
+    if(!(bitmap->words && bitmap->blocks)) {
+        bbl_bitmap_free(bitmap);
+        return false;
+    }
+    bitmap->size = size;
+    if(set) {
+        for(i = 0; i < size / 64; i++) {
+            bitmap->words[i] = UINT64_MAX;
+        }
+        if(size % 64) {
+            bitmap->words[i] = (1ULL << (size % 64)) - 1;
+        }
+        for(i = 0; i < blocks; i++) {
+            bitmap->blocks[i] = BBL_BITMAP_BLOCK_BITS;
+        }
+        if(size % BBL_BITMAP_BLOCK_BITS) {
+            bitmap->blocks[blocks-1] = size % BBL_BITMAP_BLOCK_BITS;
+        }
+        bitmap->count = size;
+    }
+    return true;
+}
+
+void
+bbl_bitmap_free(bbl_bitmap_s *bitmap)
+{
+    if(bitmap->words) free(bitmap->words);
+    if(bitmap->blocks) free(bitmap->blocks);
+    memset(bitmap, 0x0, sizeof(bbl_bitmap_s));
+}
+
+void
+bbl_bitmap_set(bbl_bitmap_s *bitmap, uint32_t bit)
+{
+    uint64_t mask = 1ULL << (bit % 64);
+    if(bit >= bitmap->size) return;
+    if(!(bitmap->words[bit / 64] & mask)) {
+        bitmap->words[bit / 64] |= mask;
+        bitmap->blocks[bit / BBL_BITMAP_BLOCK_BITS]++;
+        bitmap->count++;
+    }
+}
+
+void
+bbl_bitmap_clear(bbl_bitmap_s *bitmap, uint32_t bit)
+{
+    uint64_t mask = 1ULL << (bit % 64);
+    if(bit >= bitmap->size) return;
+    if(bitmap->words[bit / 64] & mask) {
+        bitmap->words[bit / 64] &= ~mask;
+        bitmap->blocks[bit / BBL_BITMAP_BLOCK_BITS]--;
+        bitmap->count--;
+    }
+}
+
+bool
+bbl_bitmap_test(bbl_bitmap_s *bitmap, uint32_t bit)
+{
+    if(bit >= bitmap->size) return false;
+    return bitmap->words[bit / 64] & (1ULL << (bit % 64));
+}
+
+/**
+ * bbl_bitmap_next
+ *
+ * Search next bit set starting from given bit (inclusive),
+ * skipping all blocks and words without any bit set.
+ *
+ * @param bitmap bitmap
+ * @param bit start bit
+ * @return next bit set or BBL_BITMAP_END
+ */
+uint32_t
+bbl_bitmap_next(bbl_bitmap_s *bitmap, uint32_t bit)
+{
+    uint32_t word;
+    uint32_t words;
+    uint32_t block;
+    uint64_t value;
+
+    if(bit >= bitmap->size || !bitmap->count) {
+        return BBL_BITMAP_END;
+    }
+    words = (bitmap->size + 63) / 64;
+    word = bit / 64;
+    value = bitmap->words[word] & (UINT64_MAX << (bit % 64));
+    while(!value) {
+        word++;
+        if(word >= words) {
+            return BBL_BITMAP_END;
+        }
+        if(!(word % BBL_BITMAP_BLOCK_WORDS)) {
+            /* Skip empty blocks. */
+            block = word / BBL_BITMAP_BLOCK_WORDS;
+            while(!bitmap->blocks[block]) {
+                block++;
+                word = block * BBL_BITMAP_BLOCK_WORDS;
+                if(word >= words) {
+                    return BBL_BITMAP_END;
+                }
+            }
+        }
+        value = bitmap->words[word];
+    }
+    return word * 64 + __builtin_ctzll(value);
+}
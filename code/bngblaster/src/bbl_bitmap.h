@@ -0,0 +1,47 @@
+/*
+ * BNG Blaster (BBL) - Bitmap
+ *
+ * Flat bitmap with per-block popcounts, used to track
+ * pending entries (e.g. unverified streams) by index.
+ * Empty blocks are skipped when iterating, so that walking
+ * all set bits is proportional to the number of set bits
+ * rather than to the size of the bitmap.
+ *
+ * agent, October 2026
+ *
+ * Copyright (C) 2020-2025, RtBrick, Inc.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef __BBL_BITMAP_H__
+#define __BBL_BITMAP_H__
+
+#define BBL_BITMAP_BLOCK_WORDS  64
+#define BBL_BITMAP_BLOCK_BITS   (BBL_BITMAP_BLOCK_WORDS*64)
+#define BBL_BITMAP_END          UINT32_MAX
+
+typedef struct bbl_bitmap_ {
+    uint64_t *words;
+    uint32_t *blocks; /* bits set per block */
+    uint32_t size; /* number of bits */
+    uint32_t count; /* bits set */
+} bbl_bitmap_s;
+
+bool
+bbl_bitmap_init(bbl_bitmap_s *bitmap, uint32_t size, bool set);
+
+void
+bbl_bitmap_free(bbl_bitmap_s *bitmap);
+
+void
+bbl_bitmap_set(bbl_bitmap_s *bitmap, uint32_t bit);
+
+void
+bbl_bitmap_clear(bbl_bitmap_s *bitmap, uint32_t bit);
+
+bool
+bbl_bitmap_test(bbl_bitmap_s *bitmap, uint32_t bit);
+
+uint32_t
+bbl_bitmap_next(bbl_bitmap_s *bitmap, uint32_t bit);
+
+#endif
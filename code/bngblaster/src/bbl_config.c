@@ -473,6 +473,8 @@ link_add(char *interface_name)
     link_config->io_slots_rx = g_ctx->config.io_slots;
     link_config->io_slots_tx = g_ctx->config.io_slots;
     link_config->qdisc_bypass = g_ctx->config.qdisc_bypass;
+    link_config->io_timestamping = g_ctx->config.io_timestamping;
+    link_config->io_poll = g_ctx->config.io_poll;
     link_config->tx_interval = g_ctx->config.tx_interval;
     link_config->rx_interval = g_ctx->config.rx_interval;
     link_config->tx_threads = g_ctx->config.tx_threads;
@@ -481,6 +483,38 @@ link_add(char *interface_name)
     g_ctx->config.link_config = link_config;
 }
 
+static bool
+json_parse_io_timestamping(const char *s, io_timestamping_t *timestamping)
+{
+    if(strcmp(s, "user") == 0) {
+        *timestamping = IO_TIMESTAMPING_USER;
+    } else if(strcmp(s, "kernel") == 0) {
+        *timestamping = IO_TIMESTAMPING_KERNEL;
+    } else if(strcmp(s, "hardware") == 0) {
+        *timestamping = IO_TIMESTAMPING_HARDWARE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool
+json_parse_io_poll(const char *s, io_poll_t *poll)
+{
+    if(strcmp(s, "sleep") == 0) {
+        *poll = IO_POLL_SLEEP;
+    } else if(strcmp(s, "busy") == 0) {
+        *poll = IO_POLL_BUSY;
+    } else if(strcmp(s, "hybrid") == 0) {
+        *poll = IO_POLL_HYBRID;
+    } else if(strcmp(s, "timer") == 0) {
+        *poll = IO_POLL_TIMER;
+    } else {
+        return false;
+    }
+    return true;
+}
+
 static bool
 json_parse_link(json_t *link, bbl_link_config_s *link_config)
 {
@@ -492,11 +526,12 @@ json_parse_link(json_t *link, bbl_link_config_s *link_config)
         "interface", "description", "mac",
         "io-mode", "io-slots", "io-burst", 
         "io-slots-tx", "io-slots-rx", 
-        "qdisc-bypass", 
+        "qdisc-bypass", "io-timestamping", "io-poll",
         "tx-interval","rx-interval", 
         "tx-threads", "rx-threads",
         "rx-cpuset", "tx-cpuset", 
-        "lag-interface", "lacp-priority"
+        "lag-interface", "lacp-priority",
+        "loopback-peer", "loopback-reflector"
     };
     if(!schema_validate(link, "links", schema, 
     sizeof(schema)/sizeof(schema[0]))) {
@@ -538,6 +573,9 @@ json_parse_link(json_t *link, bbl_link_config_s *link_config)
             io_packet_mmap_set_max_stream_len();
         } else if(strcmp(s, "raw") == 0) {
             link_config->io_mode = IO_MODE_RAW;
+        } else if(strcmp(s, "loopback") == 0) {
+            link_config->io_mode = IO_MODE_LOOPBACK;
+            io_loopback_set_max_stream_len();
 #if BNGBLASTER_DPDK
         } else if(strcmp(s, "dpdk") == 0) {
             link_config->io_mode = IO_MODE_DPDK;
@@ -578,6 +616,22 @@ json_parse_link(json_t *link, bbl_link_config_s *link_config)
     } else {
         link_config->qdisc_bypass = g_ctx->config.qdisc_bypass;
     }
+    if(json_unpack(link, "{s:s}", "io-timestamping", &s) == 0) {
+        if(!json_parse_io_timestamping(s, &link_config->io_timestamping)) {
+            fprintf(stderr, "JSON config error: Invalid value for links->io-timestamping\n");
+            return false;
+        }
+    } else {
+        link_config->io_timestamping = g_ctx->config.io_timestamping;
+    }
+    if(json_unpack(link, "{s:s}", "io-poll", &s) == 0) {
+        if(!json_parse_io_poll(s, &link_config->io_poll)) {
+            fprintf(stderr, "JSON config error: Invalid value for links->io-poll\n");
+            return false;
+        }
+    } else {
+        link_config->io_poll = g_ctx->config.io_poll;
+    }
 
     value = json_object_get(link, "tx-interval");
     if(json_is_number(value)) {
@@ -663,6 +717,15 @@ json_parse_link(json_t *link, bbl_link_config_s *link_config)
             link_config->lacp_priority = 32768;
         }
     }
+
+    /* Loopback Configuration */
+    if(json_unpack(link, "{s:s}", "loopback-peer", &s) == 0) {
+        link_config->loopback_peer = strdup(s);
+    }
+    JSON_OBJ_GET_BOOL(link, value, "links", "loopback-reflector");
+    if(value) {
+        link_config->loopback_reflector = json_boolean_value(value);
+    }
     return true;
 }
 
@@ -2360,7 +2423,11 @@ json_parse_stream(json_t *stream, bbl_stream_config_s *stream_config)
         "destination-ipv6-address", "ipv4-df", "tx-label1",
         "tx-label1-exp", "tx-label1-ttl", "tx-label2",
         "tx-label2-exp", "tx-label2-ttl", "rx-label1",
-        "rx-label2", "nat", "raw-tcp", "setup-interval"
+        "rx-label2", "nat", "raw-tcp", "setup-interval",
+        "range-count", "network-ipv4-address-iter", "network-ipv6-address-iter",
+        "destination-ipv4-address-iter", "destination-ipv6-address-iter",
+        "source-port-step", "destination-port-step", "vlan-step",
+        "dscp-step", "tx-label1-step", "tx-label2-step"
     };
     if(!schema_validate(stream, "streams", schema, 
     sizeof(schema)/sizeof(schema[0]))) {
@@ -2727,6 +2794,66 @@ json_parse_stream(json_t *stream, bbl_stream_config_s *stream_config)
         stream_config->raw_tcp = json_boolean_value(value);
     }
 
+    /* Stream range configuration */
+    JSON_OBJ_GET_NUMBER(stream, value, "stream", "range-count", 1, 1048576);
+    if(value) {
+        stream_config->range_count = json_number_value(value);
+    } else {
+        stream_config->range_count = 1;
+    }
+    if(json_unpack(stream, "{s:s}", "network-ipv4-address-iter", &s) == 0) {
+        if(!inet_pton(AF_INET, s, &stream_config->range_ipv4_network_iter)) {
+            fprintf(stderr, "JSON config error: Invalid value for stream->network-ipv4-address-iter\n");
+            return false;
+        }
+    }
+    if(json_unpack(stream, "{s:s}", "network-ipv6-address-iter", &s) == 0) {
+        if(!inet_pton(AF_INET6, s, &stream_config->range_ipv6_network_iter)) {
+            fprintf(stderr, "JSON config error: Invalid value for stream->network-ipv6-address-iter\n");
+            return false;
+        }
+    }
+    if(json_unpack(stream, "{s:s}", "destination-ipv4-address-iter", &s) == 0) {
+        if(!inet_pton(AF_INET, s, &stream_config->range_ipv4_destination_iter)) {
+            fprintf(stderr, "JSON config error: Invalid value for stream->destination-ipv4-address-iter\n");
+            return false;
+        }
+    }
+    if(json_unpack(stream, "{s:s}", "destination-ipv6-address-iter", &s) == 0) {
+        if(!inet_pton(AF_INET6, s, &stream_config->range_ipv6_destination_iter)) {
+            fprintf(stderr, "JSON config error: Invalid value for stream->destination-ipv6-address-iter\n");
+            return false;
+        }
+    }
+    JSON_OBJ_GET_NUMBER(stream, value, "stream", "source-port-step", 0, 65535);
+    if(value) {
+        stream_config->range_src_port_step = json_number_value(value);
+    }
+    JSON_OBJ_GET_NUMBER(stream, value, "stream", "destination-port-step", 0, 65535);
+    if(value) {
+        stream_config->range_dst_port_step = json_number_value(value);
+    }
+    JSON_OBJ_GET_NUMBER(stream, value, "stream", "vlan-step", 0, 4095);
+    if(value) {
+        stream_config->range_vlan_step = json_number_value(value);
+    }
+    JSON_OBJ_GET_NUMBER(stream, value, "stream", "dscp-step", 0, 63);
+    if(value) {
+        stream_config->range_dscp_step = json_number_value(value);
+    }
+    JSON_OBJ_GET_NUMBER(stream, value, "stream", "tx-label1-step", 0, 1048575);
+    if(value) {
+        stream_config->range_mpls1_step = json_number_value(value);
+    }
+    JSON_OBJ_GET_NUMBER(stream, value, "stream", "tx-label2-step", 0, 1048575);
+    if(value) {
+        stream_config->range_mpls2_step = json_number_value(value);
+    }
+    if(stream_config->range_count > 1 && stream_config->stream_group_id) {
+        fprintf(stderr, "JSON config error: Stream range is supported for RAW streams only (stream %s)\n", stream_config->name);
+        return false;
+    }
+
     if(stream_config->stream_group_id == 0) {
         /* RAW stream */
         if(stream_config->type == BBL_SUB_TYPE_IPV4) {
@@ -3804,6 +3931,49 @@ json_parse_config(json_t *root)
         }
     }
 
+    /* Time-Series Recorder Configuration */
+    section = json_object_get(root, "recorder");
+    if(json_is_object(section)) {
+
+        const char *schema[] = {
+            "file", "interval", "ring-size",
+            "streams", "interfaces", "sessions",
+            "protocols"
+        };
+        if(!schema_validate(section, "recorder", schema, 
+        sizeof(schema)/sizeof(schema[0]))) {
+            return false;
+        }
+
+        if(json_unpack(section, "{s:s}", "file", &s) == 0) {
+            g_ctx->config.recorder_filename = strdup(s);
+        }
+        JSON_OBJ_GET_NUMBER(section, value, "recorder", "interval", 0.01, 3600);
+        if(value) {
+            g_ctx->config.recorder_interval = json_number_value(value) * SEC;
+        }
+        JSON_OBJ_GET_NUMBER(section, value, "recorder", "ring-size", 2, 65536);
+        if(value) {
+            g_ctx->config.recorder_ring_size = json_number_value(value) * 1024 * 1024;
+        }
+        JSON_OBJ_GET_BOOL(section, value, "recorder", "streams");
+        if(value) {
+            g_ctx->config.recorder_streams = json_boolean_value(value);
+        }
+        JSON_OBJ_GET_BOOL(section, value, "recorder", "interfaces");
+        if(value) {
+            g_ctx->config.recorder_interfaces = json_boolean_value(value);
+        }
+        JSON_OBJ_GET_BOOL(section, value, "recorder", "sessions");
+        if(value) {
+            g_ctx->config.recorder_sessions = json_boolean_value(value);
+        }
+        JSON_OBJ_GET_BOOL(section, value, "recorder", "protocols");
+        if(value) {
+            g_ctx->config.recorder_protocols = json_boolean_value(value);
+        }
+    }
+
     /* Session Traffic Configuration */
     section = json_object_get(root, "session-traffic");
     if(json_is_object(section)) {
@@ -4003,7 +4173,7 @@ json_parse_config(json_t *root)
 
         const char *schema[] = {
             "io-mode", "io-slots", "io-burst", "qdisc-bypass",
-            "tx-interval", "rx-interval", "tx-threads",
+            "io-timestamping", "io-poll", "tx-interval", "rx-interval", "tx-threads",
             "rx-threads", "capture-include-streams", "mac-modifier",
             "lag", "network", "access", "a10nsp", "links"
         };
@@ -4021,6 +4191,9 @@ json_parse_config(json_t *root)
                 io_packet_mmap_set_max_stream_len();
             } else if(strcmp(s, "raw") == 0) {
                 g_ctx->config.io_mode = IO_MODE_RAW;
+            } else if(strcmp(s, "loopback") == 0) {
+                g_ctx->config.io_mode = IO_MODE_LOOPBACK;
+                io_loopback_set_max_stream_len();
 #if BNGBLASTER_DPDK
             } else if(strcmp(s, "dpdk") == 0) {
                 g_ctx->config.io_mode = IO_MODE_DPDK;
@@ -4048,6 +4221,18 @@ json_parse_config(json_t *root)
         if(value) {
             g_ctx->config.qdisc_bypass = json_boolean_value(value);
         }
+        if(json_unpack(section, "{s:s}", "io-timestamping", &s) == 0) {
+            if(!json_parse_io_timestamping(s, &g_ctx->config.io_timestamping)) {
+                fprintf(stderr, "JSON config error: Invalid value for interfaces->io-timestamping\n");
+                return false;
+            }
+        }
+        if(json_unpack(section, "{s:s}", "io-poll", &s) == 0) {
+            if(!json_parse_io_poll(s, &g_ctx->config.io_poll)) {
+                fprintf(stderr, "JSON config error: Invalid value for interfaces->io-poll\n");
+                return false;
+            }
+        }
         value = json_object_get(section, "tx-interval");
         if(json_is_number(value)) {
             g_ctx->config.tx_interval = json_number_value(value) * MSEC;
@@ -4580,6 +4765,12 @@ bbl_config_init_defaults()
     g_ctx->config.stream_rate_calc = true;
     g_ctx->config.stream_delay_calc = true;
     g_ctx->config.stream_burst_ms = 100 * MSEC;
+    g_ctx->config.recorder_interval = 100 * MSEC;
+    g_ctx->config.recorder_ring_size = 256 * 1024 * 1024;
+    g_ctx->config.recorder_streams = true;
+    g_ctx->config.recorder_interfaces = true;
+    g_ctx->config.recorder_sessions = true;
+    g_ctx->config.recorder_protocols = true;
     g_ctx->config.multicast_traffic_autostart = true;
     g_ctx->config.session_traffic_autostart = true;
 }
@@ -110,6 +110,12 @@ typedef struct bbl_access_config_
 
     uint16_t ppp_mru;
 
+    /* PPPoE discovery templates per number of VLAN tags */
+    bbl_pppoe_template_s *pppoe_template[4];
+    /* DHCP and DHCPv6 templates per number of VLAN tags */
+    bbl_dhcp_template_s *dhcp_template[4];
+    bbl_dhcp_template_s *dhcpv6_template[4];
+
     void *next; /* pointer to next access config element */
     bbl_access_interface_s *access_interface;
 } bbl_access_config_s;
@@ -190,6 +196,9 @@ typedef struct bbl_link_config_
 
     bool qdisc_bypass;
 
+    io_timestamping_t io_timestamping;
+    io_poll_t io_poll;
+
     uint64_t tx_interval; /* TX interval in nsec */
     uint64_t rx_interval; /* RX interval in nsec */
 
@@ -206,6 +215,9 @@ typedef struct bbl_link_config_
     char *lag_interface;
     uint16_t lacp_priority;
 
+    char *loopback_peer;
+    bool loopback_reflector;
+
     void *next; /* pointer to next link config element */
     bbl_interface_s *link;
 } bbl_link_config_s;
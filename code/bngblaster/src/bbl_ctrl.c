@@ -17,6 +17,8 @@
 #include <signal.h>
 #include <errno.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
 
 #include "bbl.h"
 #include "bbl_ctrl.h"
@@ -25,7 +27,7 @@
 #include "bbl_dhcp.h"
 #include "bbl_dhcpv6.h"
 
-#define BACKLOG 4
+#define BACKLOG 64
 
 extern volatile bool g_monkey;
 
@@ -43,7 +45,7 @@ const char *schema_all_args[] = {
     "disconnect-direction", "disconnect-message",
     "ldp-instance-id", "tcp-flags", "debug", "detail",
     "verified-only", "bidirectional-verified-only",
-    "network-interface",
+    "network-interface", "cursor", "limit",
     NULL
 };
 
@@ -214,7 +216,8 @@ struct action actions[] = {
     {"stream-stats", bbl_stream_ctrl_stats, schema_all_args, true},
     {"stream-reset", bbl_stream_ctrl_reset, schema_all_args, false},
     {"stream-summary", bbl_stream_ctrl_summary, schema_all_args, true},
-    {"streams-pending", bbl_stream_ctrl_pending, schema_no_args, true},
+    {"stream-outages", bbl_stream_ctrl_outages, schema_all_args, true},
+    {"streams-pending", bbl_stream_ctrl_pending, schema_all_args, true},
     {"session-traffic", bbl_session_ctrl_traffic_stats, schema_all_args, true},
     {"session-traffic-reset", bbl_session_ctrl_traffic_reset, schema_all_args, false},
     {"interfaces", bbl_interface_ctrl, schema_no_args, true},
@@ -223,7 +226,7 @@ struct action actions[] = {
     {"a10nsp-interfaces", bbl_a10nsp_ctrl_interfaces, schema_no_args, true},
     {"interface-enable", bbl_interface_ctrl_enable, schema_all_args, false},
     {"interface-disable", bbl_interface_ctrl_disable, schema_all_args, false},
-    {"sessions-pending", bbl_session_ctrl_pending, schema_no_args, true},
+    {"sessions-pending", bbl_session_ctrl_pending, schema_all_args, true},
     {"session-info", bbl_session_ctrl_info, schema_all_args, true},
     {"session-counters", bbl_session_ctrl_counters, schema_no_args, true},
     {"session-start", bbl_session_ctrl_start, schema_all_args, true},
@@ -278,6 +281,9 @@ struct action actions[] = {
     {"monkey-start", bbl_ctrl_monkey_start, schema_all_args, false},
     {"monkey-stop", bbl_ctrl_monkey_stop, schema_all_args, false},
     {"lag-info", bbl_lag_ctrl_info, schema_all_args, true},
+    {"profiling-start", io_profile_ctrl_start, schema_no_args, true},
+    {"profiling-stop", io_profile_ctrl_stop, schema_no_args, true},
+    {"profiling-reset", io_profile_ctrl_reset, schema_no_args, true},
     {"icmp-clients", bbl_icmp_client_ctrl, schema_all_args, true},
     {"icmp-clients-start", bbl_icmp_client_ctrl_start, schema_all_args, false},
     {"icmp-clients-stop", bbl_icmp_client_ctrl_stop, schema_all_args, false},
@@ -303,18 +309,195 @@ struct action actions[] = {
     {NULL, NULL, NULL, false},
 };
 
+static const char *
+bbl_ctrl_stream_process(bbl_ctrl_thread_s *ctrl, bbl_ctrl_batch_s *batch)
+{
+    const char *error = NULL;
+    uint8_t *pdu;
+    uint16_t pdu_len;
+    uint32_t offset = 0;
+
+    /* Batches contain complete frames only. */
+    while(offset + 2 <= batch->len) {
+        pdu_len = read_be_uint(batch->data+offset, 2);
+        pdu = batch->data+offset+2;
+        offset += 2 + pdu_len;
+        if(offset > batch->len) {
+            return "invalid PDU stream";
+        }
+        switch(ctrl->stream.protocol) {
+            case CTRL_PDU_STREAM_ISIS:
+                error = isis_ctrl_lsp_update_pdu(ctrl->stream.instance, pdu, pdu_len);
+                break;
+            case CTRL_PDU_STREAM_OSPF:
+                error = ospf_ctrl_pdu_update_pdu(ctrl->stream.instance, pdu, pdu_len);
+                break;
+            default:
+                error = "invalid PDU stream protocol";
+                break;
+        }
+        if(error) {
+            return error;
+        }
+        ctrl->stream.pdus++;
+    }
+    return NULL;
+}
+
+/**
+ * bbl_ctrl_stream_job
+ *
+ * Process all pending PDU stream batches in
+ * the main thread. The timer stops itself once
+ * the stream is closed and all batches are done.
+ */
+static void
+bbl_ctrl_stream_job(timer_s *timer)
+{
+    bbl_ctrl_thread_s *ctrl = timer->data;
+    bbl_ctrl_batch_s *batch;
+    bbl_ctrl_batch_s *next;
+    uint32_t count = 0;
+    uint64_t event = 1;
+
+    pthread_mutex_lock(&ctrl->stream.mutex);
+    batch = ctrl->stream.head;
+    ctrl->stream.head = NULL;
+    ctrl->stream.tail = NULL;
+    pthread_mutex_unlock(&ctrl->stream.mutex);
+
+    while(batch) {
+        if(!ctrl->stream.error) {
+            ctrl->stream.error = bbl_ctrl_stream_process(ctrl, batch);
+        }
+        next = batch->next;
+        free(batch->data);
+        free(batch);
+        batch = next;
+        count++;
+    }
+
+    pthread_mutex_lock(&ctrl->stream.mutex);
+    ctrl->stream.pending -= count;
+    if(!ctrl->stream.active && !ctrl->stream.pending) {
+        timer->periodic = false;
+        timer->ptimer = NULL; /* Reset field such that timer library does not late ref */
+        ctrl->stream.timer = NULL;
+    }
+    pthread_mutex_unlock(&ctrl->stream.mutex);
+
+    /* Notify ctrl thread to continue reading the stream. */
+    if(count && write(ctrl->main.eventfd, &event, sizeof(event)) != sizeof(event)) {
+        LOG(ERROR, "Failed to notify ctrl thread (error %d)\n", errno);
+    }
+}
+
+static bool
+bbl_ctrl_stream_enqueue(bbl_ctrl_thread_s *ctrl, uint8_t *data, uint32_t len)
+{
+    bbl_ctrl_batch_s *batch = calloc(1, sizeof(bbl_ctrl_batch_s));
+    if(!batch) {
+        free(data);
+        return false;
+    }
+    batch->data = data;
+    batch->len = len;
+
+    pthread_mutex_lock(&ctrl->stream.mutex);
+    if(ctrl->stream.tail) {
+        ctrl->stream.tail->next = batch;
+    } else {
+        ctrl->stream.head = batch;
+    }
+    ctrl->stream.tail = batch;
+    ctrl->stream.pending++;
+    pthread_mutex_unlock(&ctrl->stream.mutex);
+    return true;
+}
+
+static bool
+bbl_ctrl_stream_detect(int fd)
+{
+    uint8_t first;
+    if(recv(fd, &first, sizeof(first), MSG_PEEK) != sizeof(first)) {
+        return false;
+    }
+    return first == (CTRL_PDU_STREAM_MAGIC >> 24);
+}
+
+/**
+ * bbl_ctrl_capture
+ *
+ * Commands write their responses directly to
+ * the given file descriptor. All commands are
+ * executed with a memory file descriptor and
+ * the response is copied to the job afterwards.
+ *
+ * @param memfd memory file descriptor
+ * @param job ctrl job
+ */
+static void
+bbl_ctrl_capture(int memfd, bbl_ctrl_job_s *job)
+{
+    off_t len = lseek(memfd, 0, SEEK_CUR);
+    if(len <= 0) {
+        bbl_ctrl_status(memfd, "error", 500, "no response");
+        len = lseek(memfd, 0, SEEK_CUR);
+    }
+    if(len > 0) {
+        job->response = malloc(len);
+        if(job->response && pread(memfd, job->response, len, 0) == len) {
+            job->response_len = len;
+        }
+    }
+    if(ftruncate(memfd, 0) != 0) {
+        LOG(ERROR, "Failed to reset ctrl response buffer (error %d)\n", errno);
+    }
+    lseek(memfd, 0, SEEK_SET);
+}
+
 static void
 bbl_ctrl_socket_main(bbl_ctrl_thread_s *ctrl)
 {
-    if(ctrl->main.fd) {
-        pthread_mutex_lock(&ctrl->mutex);
-        actions[ctrl->main.action].fn(ctrl->main.fd, ctrl->main.session_id, (json_t*)ctrl->main.arguments);
-        ctrl->main.action = 0;
-        ctrl->main.fd = 0;
-        ctrl->main.session_id = 0;
-        ctrl->main.arguments = NULL;
-        pthread_cond_signal(&ctrl->cond);
-        pthread_mutex_unlock(&ctrl->mutex);
+    bbl_ctrl_job_s *job;
+    bbl_ctrl_job_s *next;
+    bbl_ctrl_job_s *done = NULL;
+    bbl_ctrl_job_s *last = NULL;
+    uint64_t event = 1;
+
+    if((ctrl->stream.active || ctrl->stream.pending) && ctrl->active && !ctrl->stream.timer) {
+        timer_add_periodic(&g_ctx->timer_root, &ctrl->stream.timer, "CTRL Socket Stream Timer", 
+                           0, BBL_CTRL_STREAM_INTERVAL, ctrl, &bbl_ctrl_stream_job);
+    }
+
+    pthread_mutex_lock(&ctrl->mutex);
+    job = ctrl->main.head;
+    ctrl->main.head = NULL;
+    ctrl->main.tail = NULL;
+    pthread_mutex_unlock(&ctrl->mutex);
+    if(!job) {
+        return;
+    }
+    while(job) {
+        next = job->queue_next;
+        actions[job->action].fn(ctrl->main.memfd, job->session_id, job->arguments);
+        bbl_ctrl_capture(ctrl->main.memfd, job);
+        json_decref(job->request);
+        job->request = NULL;
+        job->arguments = NULL;
+        job->queue_next = done;
+        if(!last) last = job;
+        done = job;
+        job = next;
+    }
+
+    /* Pass completed jobs back to the ctrl thread. */
+    pthread_mutex_lock(&ctrl->mutex);
+    last->queue_next = ctrl->main.done;
+    ctrl->main.done = done;
+    pthread_mutex_unlock(&ctrl->mutex);
+    if(write(ctrl->main.eventfd, &event, sizeof(event)) != sizeof(event)) {
+        LOG(ERROR, "Failed to notify ctrl thread (error %d)\n", errno);
     }
 }
 
@@ -324,173 +507,955 @@ bbl_ctrl_socket_main_job(timer_s *timer)
     bbl_ctrl_socket_main(timer->data);
 }
 
-void *
-bbl_ctrl_socket_thread(void *thread_data)
+/**
+ * bbl_ctrl_session_id
+ *
+ * Resolve the session-id of a command either from
+ * argument session-id or from interface and VLAN.
+ *
+ * @param fd response file descriptor
+ * @param arguments command arguments
+ * @param session_id resolved session-id
+ * @return false if an error response was written
+ */
+static bool
+bbl_ctrl_session_id(int fd, json_t *arguments, uint32_t *session_id)
 {
-    bbl_ctrl_thread_s *ctrl = thread_data;
+    json_t* value = NULL;
+    bbl_access_interface_s *access_interface;
+    vlan_session_key_t key = {0};
+    bbl_session_s *session;
+    void **search;
 
-    size_t i;
-    size_t flags = JSON_DISABLE_EOF_CHECK;
-    json_error_t error;
-    json_t *root = NULL;
+    *session_id = 0;
+    if(!arguments) {
+        return true;
+    }
+    value = json_object_get(arguments, "session-id");
+    if(value) {
+        if(json_is_number(value)) {
+            *session_id = json_number_value(value);
+            return true;
+        }
+        bbl_ctrl_status(fd, "error", 400, "invalid session-id");
+        return false;
+    }
+    /* Deprecated!
+     * For backward compatibility with version 0.4.X, we still
+     * support per session commands using VLAN index instead of
+     * new session-id. */
+    value = json_object_get(arguments, "ifindex");
+    if(value) {
+        if(json_is_number(value)) {
+            key.ifindex = json_number_value(value);
+        } else {
+            bbl_ctrl_status(fd, "error", 400, "invalid ifindex");
+            return false;
+        }
+    } else {
+        value = json_object_get(arguments, "interface");
+        if(value && json_is_string(value)) {
+            access_interface = bbl_access_interface_get((char*)json_string_value(value));
+        } else {
+            /* Use first interface as default. */
+            access_interface = bbl_access_interface_get(NULL);
+        }
+        if(access_interface) {
+            key.ifindex = access_interface->ifindex;
+        }
+    }
+    value = json_object_get(arguments, "outer-vlan");
+    if(value) {
+        if(json_is_number(value)) {
+            key.outer_vlan_id = json_number_value(value);
+        } else {
+            bbl_ctrl_status(fd, "error", 400, "invalid outer-vlan");
+            return false;
+        }
+    }
+    value = json_object_get(arguments, "inner-vlan");
+    if(value) {
+        if(json_is_number(value)) {
+            key.inner_vlan_id = json_number_value(value);
+        } else {
+            bbl_ctrl_status(fd, "error", 400, "invalid inner-vlan");
+            return false;
+        }
+    }
+    if(key.outer_vlan_id) {
+        search = dict_search(g_ctx->vlan_session_dict, &key);
+        if(search && *search) {
+            session = *search;
+            *session_id = session->session_id;
+        } else {
+            bbl_ctrl_status(fd, "warning", 404, "session not found");
+            return false;
+        }
+    }
+    return true;
+}
+
+static bbl_ctrl_job_s *
+bbl_ctrl_job_add(bbl_ctrl_conn_s *conn, char prefix, const char *suffix)
+{
+    bbl_ctrl_job_s *job = calloc(1, sizeof(bbl_ctrl_job_s));
+    if(!job) {
+        return NULL;
+    }
+    job->conn = conn;
+    job->prefix = prefix;
+    job->suffix = suffix;
+    if(conn->tail) {
+        conn->tail->next = job;
+    } else {
+        conn->head = job;
+    }
+    conn->tail = job;
+    return job;
+}
+
+static void
+bbl_ctrl_job_free(bbl_ctrl_job_s *job)
+{
+    if(job->request) {
+        json_decref(job->request);
+    }
+    if(job->response) {
+        free(job->response);
+    }
+    free(job);
+}
+
+/**
+ * bbl_ctrl_command
+ *
+ * Execute a single command request. Thread safe commands
+ * are executed directly, all others are queued for the
+ * main thread and completed asynchronously.
+ *
+ * Each command request should be formatted as shown in the example below
+ * with a mandatory command element and optional arguments.
+ * {
+ *    "command": "session-info",
+ *    "arguments": {
+ *        "outer-vlan": 1,
+ *        "inner-vlan": 2
+ *    }
+ * }
+ */
+static void
+bbl_ctrl_command(bbl_ctrl_thread_s *ctrl, bbl_ctrl_job_s *job, json_t *request)
+{
     json_t* arguments = NULL;
-    json_t* value = NULL;
     const char *command = NULL;
     uint32_t session_id = 0;
+    size_t i;
 
-    fd_set read_fds;
+    job->done = true;
+    if(json_unpack(request, "{s:s, s?o}", "command", &command, "arguments", &arguments) != 0) {
+        LOG_NOARG(ERROR, "Invalid command via ctrl socket\n");
+        bbl_ctrl_status(ctrl->memfd, "error", 400, "invalid request");
+        goto CAPTURE;
+    }
+    if(json_is_true(json_object_get(request, "keepalive"))) {
+        job->conn->keepalive = true;
+    }
+    if(!bbl_ctrl_session_id(ctrl->memfd, arguments, &session_id)) {
+        goto CAPTURE;
+    }
+    if(strcmp(command, "telemetry-subscribe") == 0) {
+        /* Telemetry is bound to the connection. */
+        bbl_telemetry_free(job->conn->telemetry);
+        job->conn->telemetry = bbl_telemetry_subscribe(ctrl->memfd, arguments);
+        if(job->conn->telemetry) {
+            job->conn->keepalive = true;
+        }
+        goto CAPTURE;
+    } else if(strcmp(command, "telemetry-unsubscribe") == 0) {
+        bbl_telemetry_free(job->conn->telemetry);
+        job->conn->telemetry = NULL;
+        bbl_ctrl_status(ctrl->memfd, "ok", 200, NULL);
+        goto CAPTURE;
+    }
+    for(i = 0; true; i++) {
+        if(actions[i].name == NULL) {
+            bbl_ctrl_status(ctrl->memfd, "error", 400, "unknown command");
+            break;
+        } else if(strcmp(actions[i].name, command) == 0) {
+            if(actions[i].schema && !bbl_ctrl_schema(arguments, actions[i].schema)) {
+                bbl_ctrl_status(ctrl->memfd, "error", 400, "invalid argument");
+                break;
+            }
+            if(actions[i].thread_safe) {
+                actions[i].fn(ctrl->memfd, session_id, arguments);
+            } else {
+                job->done = false;
+                job->action = i;
+                job->session_id = session_id;
+                job->request = json_incref(request);
+                job->arguments = arguments;
+                pthread_mutex_lock(&ctrl->mutex);
+                if(ctrl->main.tail) {
+                    ctrl->main.tail->queue_next = job;
+                } else {
+                    ctrl->main.head = job;
+                }
+                ctrl->main.tail = job;
+                pthread_mutex_unlock(&ctrl->mutex);
+                return;
+            }
+            break;
+        }
+    }
+CAPTURE:
+    bbl_ctrl_capture(ctrl->memfd, job);
+}
 
-    bbl_access_interface_s *access_interface;
+/**
+ * bbl_ctrl_request
+ *
+ * Handle a request, which is either a single command
+ * or a batch of commands (array of command requests)
+ * answered with an array of responses in the same order.
+ */
+static void
+bbl_ctrl_request(bbl_ctrl_thread_s *ctrl, bbl_ctrl_conn_s *conn, json_t *root)
+{
+    bbl_ctrl_job_s *job;
+    size_t count;
+    size_t i;
 
-    vlan_session_key_t key = {0};
-    bbl_session_s *session;
-    void **search;
+    conn->requests++;
+    if(json_is_array(root)) {
+        count = json_array_size(root);
+        if(count == 0) {
+            job = bbl_ctrl_job_add(conn, 0, "\n");
+            if(job) {
+                job->response = strdup("[]");
+                job->response_len = job->response ? 2 : 0;
+                job->done = true;
+            }
+            return;
+        }
+        for(i = 0; i < count; i++) {
+            job = bbl_ctrl_job_add(conn, i ? ',' : '[', i+1 < count ? NULL : "]\n");
+            if(job) {
+                bbl_ctrl_command(ctrl, job, json_array_get(root, i));
+            }
+        }
+    } else {
+        job = bbl_ctrl_job_add(conn, 0, "\n");
+        if(job) {
+            bbl_ctrl_command(ctrl, job, root);
+        }
+    }
+    if(!conn->keepalive) {
+        /* Close connection after response. */
+        conn->closing = true;
+    }
+}
+
+static void
+bbl_ctrl_error(bbl_ctrl_thread_s *ctrl, bbl_ctrl_conn_s *conn, uint32_t code, const char *message)
+{
+    bbl_ctrl_job_s *job = bbl_ctrl_job_add(conn, 0, "\n");
+    if(job) {
+        bbl_ctrl_status(ctrl->memfd, "error", code, message);
+        bbl_ctrl_capture(ctrl->memfd, job);
+        job->done = true;
+    }
+    conn->closing = true;
+}
+
+static bool
+bbl_ctrl_conn_append(bbl_ctrl_conn_s *conn, const void *data, size_t len)
+{
+    uint8_t *out;
+    size_t size;
+
+    if(len == 0) {
+        return true;
+    }
+    if(conn->out_len + len > conn->out_size) {
+        size = conn->out_size ? conn->out_size : BBL_CTRL_BUF;
+        while(size < conn->out_len + len) size *= 2;
+        out = realloc(conn->out, size);
+        if(!out) {
+            return false;
+        }
+        conn->out = out;
+        conn->out_size = size;
+    }
+    memcpy(conn->out+conn->out_len, data, len);
+    conn->out_len += len;
+    return true;
+}
+
+static void
+bbl_ctrl_conn_free(bbl_ctrl_thread_s *ctrl, bbl_ctrl_conn_s *conn)
+{
+    bbl_ctrl_job_s *job;
+
+    while(conn->head) {
+        job = conn->head;
+        conn->head = job->next;
+        bbl_ctrl_job_free(job);
+    }
+    if(conn->prev) {
+        conn->prev->next = conn->next;
+    } else {
+        ctrl->conn = conn->next;
+    }
+    if(conn->next) {
+        conn->next->prev = conn->prev;
+    }
+    if(ctrl->stream.conn == conn) {
+        /* Batches already queued are still processed. */
+        pthread_mutex_lock(&ctrl->stream.mutex);
+        ctrl->stream.active = false;
+        pthread_mutex_unlock(&ctrl->stream.mutex);
+        ctrl->stream.conn = NULL;
+    }
+    bbl_telemetry_free(conn->telemetry);
+    if(conn->batch) free(conn->batch);
+    if(conn->in) free(conn->in);
+    if(conn->out) free(conn->out);
+    free(conn);
+}
+
+/**
+ * bbl_ctrl_conn_close
+ *
+ * Close the client socket. The connection itself is
+ * freed after all jobs pending in the main thread
+ * are completed.
+ */
+static void
+bbl_ctrl_conn_close(bbl_ctrl_thread_s *ctrl, bbl_ctrl_conn_s *conn)
+{
+    bbl_ctrl_job_s *job;
+
+    if(conn->fd >= 0) {
+        epoll_ctl(ctrl->epoll, EPOLL_CTL_DEL, conn->fd, NULL);
+        close(conn->fd);
+        conn->fd = -1;
+    }
+    while(conn->head && conn->head->done) {
+        job = conn->head;
+        conn->head = job->next;
+        bbl_ctrl_job_free(job);
+    }
+    if(!conn->head) {
+        bbl_ctrl_conn_free(ctrl, conn);
+    }
+}
+
+/**
+ * bbl_ctrl_conn_flush
+ *
+ * Send all completed responses in request order.
+ *
+ * @return false if connection was closed
+ */
+static bool
+bbl_ctrl_conn_flush(bbl_ctrl_thread_s *ctrl, bbl_ctrl_conn_s *conn)
+{
+    bbl_ctrl_job_s *job;
+    struct epoll_event ev = {0};
+    ssize_t res;
+
+    if(conn->fd < 0) {
+        bbl_ctrl_conn_close(ctrl, conn);
+        return false;
+    }
+    while(conn->head && conn->head->done) {
+        job = conn->head;
+        if(!((job->prefix == 0 || bbl_ctrl_conn_append(conn, &job->prefix, 1)) &&
+             bbl_ctrl_conn_append(conn, job->response, job->response_len) &&
+             (job->suffix == NULL || bbl_ctrl_conn_append(conn, job->suffix, strlen(job->suffix))))) {
+            LOG_NOARG(ERROR, "Failed to allocate ctrl response buffer\n");
+            bbl_ctrl_conn_close(ctrl, conn);
+            return false;
+        }
+        conn->head = job->next;
+        if(!conn->head) conn->tail = NULL;
+        bbl_ctrl_job_free(job);
+    }
+    while(conn->out_offset < conn->out_len) {
+        res = send(conn->fd, conn->out+conn->out_offset, conn->out_len-conn->out_offset, MSG_NOSIGNAL);
+        if(res < 0) {
+            if(errno == EINTR) continue;
+            if(errno == EAGAIN || errno == EWOULDBLOCK) break;
+            bbl_ctrl_conn_close(ctrl, conn);
+            return false;
+        }
+        conn->out_offset += res;
+    }
+    if(conn->out_offset == conn->out_len) {
+        conn->out_offset = 0;
+        conn->out_len = 0;
+        if(conn->closing && !conn->head && !conn->stream) {
+            bbl_ctrl_conn_close(ctrl, conn);
+            return false;
+        }
+    }
+    /* Wait for socket to become writable if the response
+     * could not be sent at once and stop reading if no
+     * further requests are accepted. */
+    ev.events = (conn->closing || conn->paused) ? 0 : EPOLLIN;
+    if(conn->out_len) ev.events |= EPOLLOUT;
+    if(ev.events != conn->events) {
+        conn->events = ev.events;
+        ev.data.ptr = conn;
+        epoll_ctl(ctrl->epoll, EPOLL_CTL_MOD, conn->fd, &ev);
+    }
+    return true;
+}
+
+/**
+ * bbl_ctrl_conn_frame
+ *
+ * Search for the end of the next JSON object or array
+ * in the receive buffer. The scan state is kept in the
+ * connection, such that every byte is scanned only once.
+ *
+ * @return 1 if frame is complete, 0 if more data is needed
+ * and -1 if the data is not valid JSON.
+ */
+static int
+bbl_ctrl_conn_frame(bbl_ctrl_conn_s *conn)
+{
+    uint8_t c;
+    while(conn->in_scan < conn->in_len) {
+        c = conn->in[conn->in_scan++];
+        if(conn->string) {
+            if(conn->escape) {
+                conn->escape = false;
+            } else if(c == '\\') {
+                conn->escape = true;
+            } else if(c == '"') {
+                conn->string = false;
+            }
+            continue;
+        }
+        switch(c) {
+            case '{':
+            case '[':
+                conn->depth++;
+                break;
+            case '}':
+            case ']':
+                if(conn->depth == 0) return -1;
+                if(--conn->depth == 0) return 1;
+                break;
+            case '"':
+                if(conn->depth == 0) return -1;
+                conn->string = true;
+                break;
+            case ' ':
+            case '\t':
+            case '\r':
+            case '\n':
+                if(conn->depth == 0) {
+                    /* Skip whitespace between requests. */
+                    conn->in_start = conn->in_scan;
+                }
+                break;
+            default:
+                if(conn->depth == 0) return -1;
+                break;
+        }
+    }
+    return 0;
+}
+
+static void
+bbl_ctrl_conn_process(bbl_ctrl_thread_s *ctrl, bbl_ctrl_conn_s *conn)
+{
+    json_error_t error;
+    json_t *root;
+    int frame;
+
+    while(!conn->closing) {
+        frame = bbl_ctrl_conn_frame(conn);
+        if(frame == 0) {
+            break;
+        }
+        if(frame < 0) {
+            LOG_NOARG(ERROR, "Invalid json via ctrl socket\n");
+            bbl_ctrl_error(ctrl, conn, 400, "invalid json");
+            break;
+        }
+        root = json_loadb((char*)conn->in+conn->in_start, conn->in_scan-conn->in_start, 0, &error);
+        conn->in_start = conn->in_scan;
+        if(!root) {
+            LOG(ERROR, "Invalid json via ctrl socket: line %d: %s\n", error.line, error.text);
+            bbl_ctrl_error(ctrl, conn, 400, "invalid json");
+            break;
+        }
+        bbl_ctrl_request(ctrl, conn, root);
+        json_decref(root);
+    }
+    if(conn->in_start) {
+        memmove(conn->in, conn->in+conn->in_start, conn->in_len-conn->in_start);
+        conn->in_len -= conn->in_start;
+        conn->in_scan -= conn->in_start;
+        conn->in_start = 0;
+    }
+}
+
+/**
+ * bbl_ctrl_stream_finish
+ *
+ * Send the PDU stream result and close the connection
+ * once the main thread has processed all batches.
+ *
+ * @return false if connection was closed
+ */
+static bool
+bbl_ctrl_stream_finish(bbl_ctrl_thread_s *ctrl, bbl_ctrl_conn_s *conn)
+{
+    bbl_ctrl_job_s *job;
+    const char *error;
+    uint32_t pending;
+
+    if(!conn->stream_done) {
+        conn->stream_done = true;
+        conn->paused = true;
+        if(conn->batch) {
+            if(conn->batch_offset && !conn->stream_status) {
+                bbl_ctrl_stream_enqueue(ctrl, conn->batch, conn->batch_offset);
+            } else {
+                free(conn->batch);
+            }
+            conn->batch = NULL;
+        }
+    }
+
+    pthread_mutex_lock(&ctrl->stream.mutex);
+    ctrl->stream.active = false;
+    pending = ctrl->stream.pending;
+    error = ctrl->stream.error;
+    pthread_mutex_unlock(&ctrl->stream.mutex);
+    if(pending) {
+        /* Continued by bbl_ctrl_complete. */
+        return bbl_ctrl_conn_flush(ctrl, conn);
+    }
+
+    job = bbl_ctrl_job_add(conn, 0, NULL);
+    if(job) {
+        if(conn->stream_status) {
+            bbl_ctrl_status(ctrl->memfd, "error", 400, conn->stream_status);
+        } else if(error) {
+            LOG(ERROR, "Failed to process PDU stream via ctrl socket (%s)\n", error);
+            bbl_ctrl_status(ctrl->memfd, "error", 500, error);
+        } else if(!conn->stream_end) {
+            bbl_ctrl_status(ctrl->memfd, "error", 500, "incomplete PDU stream");
+        } else {
+            LOG(INFO, "Processed %lu PDUs from PDU stream via ctrl socket\n", ctrl->stream.pdus);
+            bbl_ctrl_status(ctrl->memfd, "ok", 200, NULL);
+        }
+        bbl_ctrl_capture(ctrl->memfd, job);
+        job->done = true;
+    }
+    ctrl->stream.conn = NULL;
+    conn->stream = false;
+    conn->closing = true;
+    return bbl_ctrl_conn_flush(ctrl, conn);
+}
+
+/**
+ * bbl_ctrl_stream_header
+ *
+ * @return false if the stream header is invalid
+ */
+static bool
+bbl_ctrl_stream_header(bbl_ctrl_thread_s *ctrl, bbl_ctrl_conn_s *conn)
+{
+    uint8_t *hdr = conn->batch;
+
+    if(read_be_uint(hdr, 4) != CTRL_PDU_STREAM_MAGIC ||
+       hdr[4] != CTRL_PDU_STREAM_VERSION) {
+        conn->stream_status = "invalid PDU stream";
+        return false;
+    }
+    if(!(hdr[5] == CTRL_PDU_STREAM_ISIS || hdr[5] == CTRL_PDU_STREAM_OSPF)) {
+        conn->stream_status = "invalid PDU stream protocol";
+        return false;
+    }
+
+    pthread_mutex_lock(&ctrl->stream.mutex);
+    ctrl->stream.protocol = hdr[5];
+    ctrl->stream.instance = read_be_uint(hdr+6, 2);
+    ctrl->stream.error = NULL;
+    ctrl->stream.pdus = 0;
+    ctrl->stream.active = true;
+    pthread_mutex_unlock(&ctrl->stream.mutex);
+
+    conn->batch_fill -= CTRL_PDU_STREAM_HDR_LEN;
+    memmove(conn->batch, conn->batch+CTRL_PDU_STREAM_HDR_LEN, conn->batch_fill);
+    conn->stream_header = true;
+    return true;
+}
+
+/**
+ * bbl_ctrl_stream_read
+ *
+ * Receive a binary PDU stream (e.g. from LSPGEN) with raw
+ * PDUs instead of hex encoded PDUs in JSON commands. Complete
+ * frames are passed in batches to the main thread. The 
+ * connection stops reading (back-pressure) while too many 
+ * batches are pending and is continued by bbl_ctrl_complete.
+ *
+ * @return false if connection was closed
+ */
+static bool
+bbl_ctrl_stream_read(bbl_ctrl_thread_s *ctrl, bbl_ctrl_conn_s *conn)
+{
+    uint8_t *next;
+    uint16_t pdu_len;
+    uint32_t pending;
+    const char *error;
+    ssize_t res;
+
+    if(conn->stream_done) {
+        return bbl_ctrl_stream_finish(ctrl, conn);
+    }
+    while(true) {
+        pthread_mutex_lock(&ctrl->stream.mutex);
+        pending = ctrl->stream.pending;
+        error = ctrl->stream.error;
+        pthread_mutex_unlock(&ctrl->stream.mutex);
+        if(error) {
+            break;
+        }
+        if(pending >= BBL_CTRL_STREAM_PENDING) {
+            conn->paused = true;
+            return bbl_ctrl_conn_flush(ctrl, conn);
+        }
+        conn->paused = false;
+        if(!conn->batch) {
+            conn->batch = malloc(BBL_CTRL_STREAM_BATCH);
+            if(!conn->batch) {
+                break;
+            }
+        }
+        res = recv(conn->fd, conn->batch+conn->batch_fill, BBL_CTRL_STREAM_BATCH-conn->batch_fill, 0);
+        if(res < 0) {
+            if(errno == EINTR) continue;
+            if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                return bbl_ctrl_conn_flush(ctrl, conn);
+            }
+            bbl_ctrl_conn_close(ctrl, conn);
+            return false;
+        }
+        if(res == 0) {
+            /* Connection closed without end of stream. */
+            break;
+        }
+        conn->batch_fill += res;
+        if(!conn->stream_header) {
+            if(conn->batch_fill < CTRL_PDU_STREAM_HDR_LEN) {
+                continue;
+            }
+            if(!bbl_ctrl_stream_header(ctrl, conn)) {
+                break;
+            }
+        }
+
+        /* Search for the end of the last complete frame. */
+        while(conn->batch_fill - conn->batch_offset >= 2) {
+            pdu_len = read_be_uint(conn->batch+conn->batch_offset, 2);
+            if(pdu_len == 0) {
+                conn->stream_end = true;
+                break;
+            }
+            if(conn->batch_fill - conn->batch_offset - 2 < pdu_len) {
+                break;
+            }
+            conn->batch_offset += 2 + pdu_len;
+        }
+        if(conn->stream_end) {
+            break;
+        }
+        if(BBL_CTRL_STREAM_BATCH - conn->batch_fill >= CTRL_PDU_STREAM_FRAME_MAX) {
+            /* Continue reading until the batch is full. */
+            continue;
+        }
+        /* Move incomplete frame to the next batch. */
+        next = malloc(BBL_CTRL_STREAM_BATCH);
+        if(!next) {
+            break;
+        }
+        memcpy(next, conn->batch+conn->batch_offset, conn->batch_fill-conn->batch_offset);
+        if(!bbl_ctrl_stream_enqueue(ctrl, conn->batch, conn->batch_offset)) {
+            conn->batch = NULL;
+            free(next);
+            break;
+        }
+        conn->batch = next;
+        conn->batch_fill -= conn->batch_offset;
+        conn->batch_offset = 0;
+    }
+    return bbl_ctrl_stream_finish(ctrl, conn);
+}
+
+/**
+ * bbl_ctrl_stream_start
+ *
+ * Only one PDU stream is processed at a time.
+ *
+ * @return false if connection was closed
+ */
+static bool
+bbl_ctrl_stream_start(bbl_ctrl_thread_s *ctrl, bbl_ctrl_conn_s *conn)
+{
+    uint32_t pending;
+
+    pthread_mutex_lock(&ctrl->stream.mutex);
+    pending = ctrl->stream.pending;
+    pthread_mutex_unlock(&ctrl->stream.mutex);
+    if(ctrl->stream.conn || pending) {
+        bbl_ctrl_error(ctrl, conn, 409, "PDU stream busy");
+        return bbl_ctrl_conn_flush(ctrl, conn);
+    }
+    ctrl->stream.conn = conn;
+    conn->stream = true;
+    return bbl_ctrl_stream_read(ctrl, conn);
+}
+
+/**
+ * bbl_ctrl_conn_read
+ *
+ * Read all pending data and process complete requests.
+ * Multiple requests can be sent (pipelined) over the same
+ * connection without waiting for the responses.
+ *
+ * @return false if connection was closed
+ */
+static bool
+bbl_ctrl_conn_read(bbl_ctrl_thread_s *ctrl, bbl_ctrl_conn_s *conn)
+{
+    uint8_t *in;
+    ssize_t res;
+
+    if(conn->stream) {
+        return bbl_ctrl_stream_read(ctrl, conn);
+    }
+    if(conn->requests == 0 && conn->in_len == 0 && !conn->closing && 
+       bbl_ctrl_stream_detect(conn->fd)) {
+        /* Binary PDU stream. */
+        return bbl_ctrl_stream_start(ctrl, conn);
+    }
+    while(!conn->closing) {
+        if(conn->in_len == conn->in_size) {
+            if(conn->in_size >= BBL_CTRL_REQUEST_MAX) {
+                bbl_ctrl_error(ctrl, conn, 413, "request too large");
+                break;
+            }
+            in = realloc(conn->in, conn->in_size ? conn->in_size * 2 : BBL_CTRL_BUF);
+            if(!in) {
+                bbl_ctrl_error(ctrl, conn, 500, "out of memory");
+                break;
+            }
+            conn->in = in;
+            conn->in_size = conn->in_size ? conn->in_size * 2 : BBL_CTRL_BUF;
+        }
+        res = recv(conn->fd, conn->in+conn->in_len, conn->in_size-conn->in_len, 0);
+        if(res < 0) {
+            if(errno == EINTR) continue;
+            if(errno == EAGAIN || errno == EWOULDBLOCK) break;
+            bbl_ctrl_conn_close(ctrl, conn);
+            return false;
+        }
+        if(res == 0) {
+            /* Connection closed by client, send 
+             * pending responses before closing. */
+            if(conn->in_len && !conn->head) {
+                /* Incomplete request. */
+                bbl_ctrl_error(ctrl, conn, 400, "invalid json");
+            }
+            conn->closing = true;
+            break;
+        }
+        conn->in_len += res;
+        bbl_ctrl_conn_process(ctrl, conn);
+    }
+    return bbl_ctrl_conn_flush(ctrl, conn);
+}
+
+static void
+bbl_ctrl_conn_accept(bbl_ctrl_thread_s *ctrl)
+{
+    bbl_ctrl_conn_s *conn;
+    struct epoll_event ev = {0};
+    int fd;
+
+    while(true) {
+        fd = accept4(ctrl->socket, NULL, NULL, SOCK_NONBLOCK|SOCK_CLOEXEC);
+        if(fd < 0) {
+            if(errno == EINTR) continue;
+            return;
+        }
+        conn = calloc(1, sizeof(bbl_ctrl_conn_s));
+        if(!conn) {
+            close(fd);
+            continue;
+        }
+        conn->fd = fd;
+        conn->events = EPOLLIN;
+        ev.events = EPOLLIN;
+        ev.data.ptr = conn;
+        if(epoll_ctl(ctrl->epoll, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            close(fd);
+            free(conn);
+            continue;
+        }
+        conn->next = ctrl->conn;
+        if(ctrl->conn) ctrl->conn->prev = conn;
+        ctrl->conn = conn;
+    }
+}
+
+/**
+ * bbl_ctrl_complete
+ *
+ * Send responses of commands completed by the main thread.
+ */
+static void
+bbl_ctrl_complete(bbl_ctrl_thread_s *ctrl)
+{
+    bbl_ctrl_conn_s *conn;
+    bbl_ctrl_conn_s *conn_next;
+    bbl_ctrl_job_s *job;
+    bbl_ctrl_job_s *next;
+    uint64_t event;
+
+    if(read(ctrl->main.eventfd, &event, sizeof(event)) < 0 && errno != EAGAIN) {
+        LOG(ERROR, "Failed to read ctrl event (error %d)\n", errno);
+    }
+    pthread_mutex_lock(&ctrl->mutex);
+    job = ctrl->main.done;
+    ctrl->main.done = NULL;
+    pthread_mutex_unlock(&ctrl->mutex);
+    while(job) {
+        next = job->queue_next;
+        job->queue_next = NULL;
+        job->done = true;
+        job = next;
+    }
+    conn = ctrl->conn;
+    while(conn) {
+        conn_next = conn->next;
+        if(conn->head && conn->head->done) {
+            bbl_ctrl_conn_flush(ctrl, conn);
+        }
+        conn = conn_next;
+    }
+    conn = ctrl->stream.conn;
+    if(conn && conn->paused && ctrl->active) {
+        /* Continue PDU stream after back-pressure. */
+        bbl_ctrl_stream_read(ctrl, conn);
+    }
+}
 
-    /* ToDo: Add connection manager!
-     * This is just a temporary workaround! Finally we need
-     * to create a connection manager. */
-    static int fd = 0;
+/**
+ * bbl_ctrl_telemetry
+ *
+ * Send telemetry samples of all subscriptions due.
+ *
+ * @return milliseconds until next sample
+ */
+static int
+bbl_ctrl_telemetry(bbl_ctrl_thread_s *ctrl)
+{
+    bbl_ctrl_conn_s *conn = ctrl->conn;
+    bbl_ctrl_conn_s *next;
+    struct timespec now;
+    int64_t due;
+    int timeout = 100;
+    size_t len;
 
-    // Set timeout for 1s
-    struct timeval timeout;
-    timeout.tv_sec = 1;
-    timeout.tv_usec = 0;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    while(conn) {
+        next = conn->next;
+        /* Samples are not sent while responses are pending,
+         * which would break the framing of batch responses. 
+         * The ctrl thread is woken up once jobs are completed. */
+        if(conn->telemetry && conn->fd >= 0 && !conn->head) {
+            due = bbl_telemetry_due(conn->telemetry, &now);
+            if(due <= 0) {
+                if(conn->out_len > BBL_TELEMETRY_BACKLOG) {
+                    /* Slow client, skip sample. */
+                    conn->telemetry->full = true;
+                    len = 0;
+                } else {
+                    len = bbl_telemetry_sample(conn->telemetry, &now);
+                }
+                if(len && !bbl_ctrl_conn_append(conn, conn->telemetry->buf, len)) {
+                    conn->telemetry->full = true;
+                }
+                due = bbl_telemetry_due(conn->telemetry, &now);
+                if(len && !bbl_ctrl_conn_flush(ctrl, conn)) {
+                    conn = next;
+                    continue;
+                }
+            }
+            if(due < (int64_t)timeout * MSEC) {
+                timeout = due > 0 ? (due + MSEC - 1) / MSEC : 0;
+            }
+        }
+        conn = next;
+    }
+    return timeout;
+}
 
-    struct timespec sleep, rem;
-    sleep.tv_sec = 0;
-    sleep.tv_nsec = 10 * MSEC;
+void *
+bbl_ctrl_socket_thread(void *thread_data)
+{
+    bbl_ctrl_thread_s *ctrl = thread_data;
+    bbl_ctrl_conn_s *conn;
+    struct epoll_event events[BBL_CTRL_EVENTS];
+    bool complete;
+    int timeout = 100;
+    int count;
+    int i;
 
     ctrl->active = true;
     while(ctrl->active) {
-        fd = accept(ctrl->socket, 0, 0);
-        if(fd > 0) {
-            /* New connection. */
-            FD_ZERO(&read_fds);
-            FD_SET(fd, &read_fds);
-            root = json_loadfd(fd, flags, &error);
-            if(!root) {
-                LOG(ERROR, "Invalid json via ctrl socket: line %d: %s\n", error.line, error.text);
-                bbl_ctrl_status(fd, "error", 400, "invalid json");
+        count = epoll_wait(ctrl->epoll, events, BBL_CTRL_EVENTS, timeout);
+        complete = false;
+        for(i = 0; i < count; i++) {
+            if(events[i].data.ptr == NULL) {
+                bbl_ctrl_conn_accept(ctrl);
+            } else if(events[i].data.ptr == &ctrl->main) {
+                /* Connections might be freed while flushing
+                 * completed jobs, which must not happen before
+                 * all events of this round are processed. */
+                complete = true;
             } else {
-                    /* Each command request should be formatted as shown in the example below
-                    * with a mandatory command element and optional arguments.
-                    * {
-                    *    "command": "session-info",
-                    *    "arguments": {
-                    *        "outer-vlan": 1,
-                    *        "inner-vlan": 2
-                    *    }
-                    * }
-                    */
-                command = NULL;
-                arguments = NULL;
-                session_id = 0;
-                key.ifindex = 0;
-                key.inner_vlan_id = 0;
-                key.outer_vlan_id = 0;
-                if(json_unpack(root, "{s:s, s?o}", "command", &command, "arguments", &arguments) != 0) {
-                    LOG_NOARG(ERROR, "Invalid command via ctrl socket\n");
-                    bbl_ctrl_status(fd, "error", 400, "invalid request");
-                } else {
-                    if(arguments) {
-                        value = json_object_get(arguments, "session-id");
-                        if(value) {
-                            if(json_is_number(value)) {
-                                session_id = json_number_value(value);
-                            } else {
-                                bbl_ctrl_status(fd, "error", 400, "invalid session-id");
-                                goto CLOSE;
-                            }
-                        } else {
-                            /* Deprecated!
-                             * For backward compatibility with version 0.4.X, we still
-                             * support per session commands using VLAN index instead of
-                             * new session-id. */
-                            value = json_object_get(arguments, "ifindex");
-                            if(value) {
-                                if(json_is_number(value)) {
-                                    key.ifindex = json_number_value(value);
-                                } else {
-                                    bbl_ctrl_status(fd, "error", 400, "invalid ifindex");
-                                    goto CLOSE;
-                                }
-                            } else {
-                                value = json_object_get(arguments, "interface");
-                                if(value && json_is_string(value)) {
-                                    access_interface = bbl_access_interface_get((char*)json_string_value(value));
-                                } else {
-                                    /* Use first interface as default. */
-                                    access_interface = bbl_access_interface_get(NULL);
-                                }
-                                if(access_interface) {
-                                    key.ifindex = access_interface->ifindex;
-                                }
-                            }
-                            value = json_object_get(arguments, "outer-vlan");
-                            if(value) {
-                                if(json_is_number(value)) {
-                                    key.outer_vlan_id = json_number_value(value);
-                                } else {
-                                    bbl_ctrl_status(fd, "error", 400, "invalid outer-vlan");
-                                    goto CLOSE;
-                                }
-                            }
-                            value = json_object_get(arguments, "inner-vlan");
-                            if(value) {
-                                if(json_is_number(value)) {
-                                    key.inner_vlan_id = json_number_value(value);
-                                } else {
-                                    bbl_ctrl_status(fd, "error", 400, "invalid inner-vlan");
-                                    goto CLOSE;
-                                }
-                            }
-                            if(key.outer_vlan_id) {
-                                search = dict_search(g_ctx->vlan_session_dict, &key);
-                                if(search && *search) {
-                                    session = *search;
-                                    session_id = session->session_id;
-                                } else {
-                                    bbl_ctrl_status(fd, "warning", 404, "session not found");
-                                    goto CLOSE;
-                                }
-                            }
-                        }
-                    }
-                    for(i = 0; true; i++) {
-                        if(actions[i].name == NULL) {
-                            bbl_ctrl_status(fd, "error", 400, "unknown command");
-                            break;
-                        } else if(strcmp(actions[i].name, command) == 0) {
-                            if(actions[i].schema && !bbl_ctrl_schema(arguments, actions[i].schema)) {
-                                bbl_ctrl_status(fd, "error", 400, "invalid argument");
-                                break;
-                            }
-                            if(actions[i].thread_safe) {
-                                actions[i].fn(fd, session_id, arguments);
-                            } else {
-                                pthread_mutex_lock(&ctrl->mutex);
-                                ctrl->main.fd = fd;
-                                ctrl->main.action = i;
-                                ctrl->main.session_id = session_id;
-                                ctrl->main.arguments = (void*)arguments;
-                                pthread_cond_wait(&ctrl->cond, &ctrl->mutex);
-                                pthread_mutex_unlock(&ctrl->mutex);
-                            }
-                            break;
-                        }
+                conn = events[i].data.ptr;
+                if(events[i].events & EPOLLIN) {
+                    if(!bbl_ctrl_conn_read(ctrl, conn)) {
+                        continue;
                     }
                 }
-CLOSE:
-                json_decref(root);
-                root = NULL;
+                if(events[i].events & (EPOLLHUP|EPOLLERR)) {
+                    /* Client has gone. */
+                    bbl_ctrl_conn_close(ctrl, conn);
+                } else if(events[i].events & EPOLLOUT) {
+                    bbl_ctrl_conn_flush(ctrl, conn);
+                }
             }
-            shutdown(fd, SHUT_WR);
-            select(fd + 1, &read_fds, NULL, NULL, &timeout);
-            close(fd);
-        } else {
-            nanosleep(&sleep, &rem);
         }
+        if(complete) {
+            bbl_ctrl_complete(ctrl);
+        }
+        timeout = bbl_ctrl_telemetry(ctrl);
     }
+
+    /* Connections and jobs still pending are 
+     * completed by bbl_ctrl_socket_close. */
     return NULL;
 }
 
@@ -499,6 +1464,7 @@ bbl_ctrl_socket_init()
 {
     bbl_ctrl_thread_s *ctrl;
     struct sockaddr_un addr = {0};
+    struct epoll_event ev = {0};
 
     if(!g_ctx->ctrl_socket_path) {
         return true;
@@ -531,13 +1497,43 @@ bbl_ctrl_socket_init()
     /* Change socket to non-blocking */
     fcntl(ctrl->socket, F_SETFL, O_NONBLOCK);
 
+    /* Responses are written to memory file descriptors,
+     * one for the ctrl thread and one for the main thread. */
+    ctrl->memfd = memfd_create("bbl-ctrl", MFD_CLOEXEC);
+    ctrl->main.memfd = memfd_create("bbl-ctrl-main", MFD_CLOEXEC);
+    if(ctrl->memfd < 0 || ctrl->main.memfd < 0) {
+        fprintf(stderr, "Error: Failed to create ctrl response buffer (error %d)\n", errno);
+        return false;
+    }
+    ctrl->main.eventfd = eventfd(0, EFD_NONBLOCK|EFD_CLOEXEC);
+    if(ctrl->main.eventfd < 0) {
+        fprintf(stderr, "Error: Failed to create ctrl event (error %d)\n", errno);
+        return false;
+    }
+    ctrl->epoll = epoll_create1(EPOLL_CLOEXEC);
+    if(ctrl->epoll < 0) {
+        fprintf(stderr, "Error: Failed to create ctrl epoll (error %d)\n", errno);
+        return false;
+    }
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    if(epoll_ctl(ctrl->epoll, EPOLL_CTL_ADD, ctrl->socket, &ev) != 0) {
+        fprintf(stderr, "Error: Failed to add ctrl socket to epoll (error %d)\n", errno);
+        return false;
+    }
+    ev.data.ptr = &ctrl->main;
+    if(epoll_ctl(ctrl->epoll, EPOLL_CTL_ADD, ctrl->main.eventfd, &ev) != 0) {
+        fprintf(stderr, "Error: Failed to add ctrl event to epoll (error %d)\n", errno);
+        return false;
+    }
+
     /* Create ctrl thread */
     if(pthread_mutex_init(&ctrl->mutex, NULL) != 0) {
         LOG_NOARG(ERROR, "Failed to init ctrl mutex\n");
         return false;
     }
-    if(pthread_cond_init(&ctrl->cond, NULL) != 0) {
-        LOG_NOARG(ERROR, "Failed to init ctrl condition\n");
+    if(pthread_mutex_init(&ctrl->stream.mutex, NULL) != 0) {
+        LOG_NOARG(ERROR, "Failed to init ctrl stream mutex\n");
         return false;
     }
     if(pthread_create(&ctrl->thread, NULL, bbl_ctrl_socket_thread, (void *)ctrl) != 0) {
@@ -546,7 +1542,7 @@ bbl_ctrl_socket_init()
     }
 
     /* Start ctrl main job */
-    timer_add_periodic(&g_ctx->timer_root, &ctrl->main.timer, "CTRL Socket Main Timer", 0, 1000 * MSEC, ctrl, &bbl_ctrl_socket_main_job);
+    timer_add_periodic(&g_ctx->timer_root, &ctrl->main.timer, "CTRL Socket Main Timer", 0, BBL_CTRL_MAIN_INTERVAL, ctrl, &bbl_ctrl_socket_main_job);
 
     LOG(INFO, "Opened control socket %s\n", g_ctx->ctrl_socket_path);
 
@@ -559,21 +1555,45 @@ bool
 bbl_ctrl_socket_close()
 {
     bbl_ctrl_thread_s *ctrl;
+    bbl_ctrl_conn_s *conn;
+    bbl_ctrl_batch_s *batch;
+
     if(g_ctx->ctrl_thread) {
         ctrl = g_ctx->ctrl_thread;
         if(ctrl->active) {
             ctrl->active = false;
-            bbl_ctrl_socket_main(ctrl);
             pthread_join(ctrl->thread, NULL);
+
+            /* Execute jobs still queued for the main thread
+             * and send the responses (best effort). */
+            bbl_ctrl_socket_main(ctrl);
+            bbl_ctrl_complete(ctrl);
+            while(ctrl->conn) {
+                conn = ctrl->conn;
+                if(conn->fd >= 0) {
+                    close(conn->fd);
+                }
+                bbl_ctrl_conn_free(ctrl, conn);
+            }
+            while(ctrl->stream.head) {
+                batch = ctrl->stream.head;
+                ctrl->stream.head = batch->next;
+                free(batch->data);
+                free(batch);
+            }
             pthread_mutex_destroy(&ctrl->mutex);
-            pthread_cond_destroy(&ctrl->cond);
+            pthread_mutex_destroy(&ctrl->stream.mutex);
         }
         if(ctrl->socket) {
             close(ctrl->socket);
         }
+        if(ctrl->epoll > 0) close(ctrl->epoll);
+        if(ctrl->memfd > 0) close(ctrl->memfd);
+        if(ctrl->main.memfd > 0) close(ctrl->main.memfd);
+        if(ctrl->main.eventfd > 0) close(ctrl->main.eventfd);
         unlink(g_ctx->ctrl_socket_path);
         free(g_ctx->ctrl_thread);
         g_ctx->ctrl_thread = NULL;
     }
     return true;
-}
\ No newline at end of file
+}
@@ -10,23 +10,118 @@
 #ifndef __BBL_CTRL_H__
 #define __BBL_CTRL_H__
 
+#define BBL_CTRL_STREAM_BATCH       (1024*1024) /* Bytes per PDU stream batch */
+#define BBL_CTRL_STREAM_PENDING     8           /* Max PDU stream batches pending */
+#define BBL_CTRL_STREAM_INTERVAL    (1 * MSEC)
+
+#define BBL_CTRL_MAIN_INTERVAL      (1 * MSEC)
+#define BBL_CTRL_EVENTS             64
+#define BBL_CTRL_BUF                (64*1024)   /* Initial connection buffer size */
+#define BBL_CTRL_REQUEST_MAX        (16*1024*1024) /* Max request size in bytes */
+
+/** Chunk of complete PDU stream frames */
+typedef struct bbl_ctrl_batch_ {
+    uint8_t *data;
+    uint32_t len;
+    struct bbl_ctrl_batch_ *next;
+} bbl_ctrl_batch_s;
+
+/** Single command of a request, responses are sent in order */
+typedef struct bbl_ctrl_job_ {
+    struct bbl_ctrl_conn_ *conn;
+    json_t *request;
+    json_t *arguments;
+    size_t action;
+    uint32_t session_id;
+
+    char *response;
+    size_t response_len;
+    char prefix;
+    const char *suffix;
+    bool done;
+
+    struct bbl_ctrl_job_ *next; /* connection */
+    struct bbl_ctrl_job_ *queue_next; /* main thread queue */
+} bbl_ctrl_job_s;
+
+/** Client connection */
+typedef struct bbl_ctrl_conn_ {
+    int fd;
+    bool keepalive;
+    bool closing;
+    uint32_t events;
+
+    uint8_t *in;
+    size_t in_size;
+    size_t in_len;
+    size_t in_start;
+    size_t in_scan;
+    uint32_t depth;
+    bool string;
+    bool escape;
+
+    uint8_t *out;
+    size_t out_size;
+    size_t out_len;
+    size_t out_offset;
+
+    uint64_t requests;
+    bbl_ctrl_job_s *head;
+    bbl_ctrl_job_s *tail;
+
+    /* Binary PDU stream */
+    bool stream; /* connection is a PDU stream */
+    bool stream_header; /* stream header received */
+    bool stream_end; /* end of stream received */
+    bool stream_done; /* no further data is read */
+    bool paused; /* back-pressure, do not read */
+    const char *stream_status; /* invalid stream header */
+    uint8_t *batch;
+    uint32_t batch_fill;
+    uint32_t batch_offset; /* end of last complete frame */
+
+    struct bbl_telemetry_ *telemetry;
+
+    struct bbl_ctrl_conn_ *prev;
+    struct bbl_ctrl_conn_ *next;
+} bbl_ctrl_conn_s;
+
 typedef struct bbl_ctrl_thread_ {
     int socket;
+    int epoll;
+    int memfd;
 
     pthread_t thread;
     pthread_mutex_t mutex;
-    pthread_cond_t cond;
 
     volatile bool active;
 
+    bbl_ctrl_conn_s *conn;
+
     /** Commands to be executed in main thread */
     struct {
         struct timer_ *timer;
-        volatile size_t action;
-        volatile int fd;
-        volatile uint32_t session_id;
-        volatile json_t *arguments;
+        int memfd;
+        int eventfd;
+        bbl_ctrl_job_s *head; /* protected by mutex */
+        bbl_ctrl_job_s *tail; /* protected by mutex */
+        bbl_ctrl_job_s *done; /* protected by mutex */
     } main;
+
+    /** Binary PDU stream batches to be processed in main thread */
+    struct {
+        struct timer_ *timer;
+        pthread_mutex_t mutex;
+        struct bbl_ctrl_conn_ *conn; /* ctrl thread only */
+        volatile bool active;
+        uint8_t protocol;
+        uint16_t instance;
+        bbl_ctrl_batch_s *head;
+        bbl_ctrl_batch_s *tail;
+        volatile uint32_t pending;
+        const char * volatile error;
+        uint64_t pdus;
+    } stream;
 } bbl_ctrl_thread_s;
 
 int
@@ -63,17 +63,21 @@ typedef struct bbl_ctx_
     CIRCLEQ_HEAD(a10nsp_interface_, bbl_a10nsp_interface_ ) a10nsp_interface_qhead; /* list of interfaces */
 
     bbl_session_s *session_list; /* list of sessions */
+    bbl_bitmap_s sessions_pending; /* sessions not established or not verified */
 
     dict *vlan_session_dict; /* hashtable for 1:1 vlan sessions */
     dict *l2tp_session_dict; /* hashtable for L2TP sessions */
     dict *li_flow_dict; /* hashtable for LI flows */
 
     bbl_stream_s **stream_index;
+    bbl_bitmap_s streams_pending; /* streams not verified */
     bbl_stream_s *stream_head;
     bbl_stream_s *stream_tail;
+    bbl_arena_s stream_arena;
     uint64_t streams;
 
     bbl_stream_group_s *stream_groups;
+    bbl_stream_group_s *stream_groups_open; /* groups with free slots */
 
     uint16_t next_tunnel_id;
 
@@ -85,6 +89,7 @@ typedef struct bbl_ctx_
     io_bucket_s *io_bucket;
 
     bool tcp;
+    volatile bool profiling;
     bool dpdk;
 
     bbl_arp_client_s *arp_clients;
@@ -150,6 +155,9 @@ typedef struct bbl_ctx_
 
         bool qdisc_bypass;
 
+        io_timestamping_t io_timestamping;
+        io_poll_t io_poll;
+
         uint64_t tx_interval; /* TX interval in nsec */
         uint64_t rx_interval; /* RX interval in nsec */
 
@@ -159,6 +167,7 @@ typedef struct bbl_ctx_
         char *json_report_filename;
         bool json_report_sessions; /* Include sessions */
         bool json_report_streams; /* Include streams */
+        char *binary_report_filename;
 
         /* LAG */
         bbl_lag_config_s *lag_config;
@@ -351,6 +360,15 @@ typedef struct bbl_ctx_
         bool stream_udp_checksum; /* Enable/disable stream UDP checksum calculation */
         uint64_t stream_burst_ms; /* Max bust size per stream in milliseconds */
 
+        /* Time-Series Recorder */
+        char *recorder_filename;
+        uint64_t recorder_interval; /* Sample interval in nsec */
+        uint64_t recorder_ring_size; /* Ring size in bytes */
+        bool recorder_streams;
+        bool recorder_interfaces;
+        bool recorder_sessions;
+        bool recorder_protocols;
+
         /* Session Traffic */
         bool session_traffic_autostart;
         uint16_t    session_traffic_ipv4_pps;
@@ -112,7 +112,9 @@ static const ipv6_prefix mock_ipv6_ia_pd = {
 #define BBL_IF_SEND_CFM_CC          0x00000400
 
 #define BBL_AVG_SAMPLES             5
+#define BBL_OUTAGE_BUCKETS          12
 #define BBL_MAX_STREAM_OVERHEAD     128
+#define BBL_STREAM_GROUP_SIZE       256
 
 #define DUID_LEN                    10
 #define DHCPV6_BUFFER               64
@@ -35,11 +35,13 @@ bbl_dhcp_stop(bbl_session_s *session)
     /* Stop multicast ... */
     timer_del(session->timer_igmp);
     timer_del(session->timer_zapping);
-    session->zapping_joined_group = NULL;
-    session->zapping_leaved_group = NULL;
-    session->zapping_count = 0;
-    session->zapping_view_start_time.tv_sec = 0;
-    session->zapping_view_start_time.tv_nsec = 0;
+    if(session->igmp) {
+        session->igmp->zapping_joined_group = NULL;
+        session->igmp->zapping_leaved_group = NULL;
+        session->igmp->zapping_count = 0;
+        session->igmp->zapping_view_start_time.tv_sec = 0;
+        session->igmp->zapping_view_start_time.tv_nsec = 0;
+    }
 
     /* Reset DHCP */
     timer_del(session->timer_dhcp_retry);
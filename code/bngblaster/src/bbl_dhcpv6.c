@@ -57,14 +57,16 @@ bbl_dhcpv6_stop(bbl_session_s *session)
     timer_del(session->timer_dhcpv6_t2);
     session->version++;
     session->dhcpv6_state = BBL_DHCP_INIT;
-    session->dhcpv6_ia_na_option_len = 0;
-    session->dhcpv6_ia_pd_option_len = 0;
+    if(session->dhcpv6) {
+        session->dhcpv6->ia_na_option_len = 0;
+        session->dhcpv6->ia_pd_option_len = 0;
+        memset(session->dhcpv6->server_duid, 0x0, DHCPV6_BUFFER);
+        session->dhcpv6->server_duid_len = 0;
+    }
     session->dhcpv6_t1 = 0;
     session->dhcpv6_t2 = 0;
     memset(session->dhcpv6_dns1, 0x0, IPV6_ADDR_LEN);
     memset(session->dhcpv6_dns2, 0x0, IPV6_ADDR_LEN);
-    memset(session->dhcpv6_server_duid, 0x0, DHCPV6_BUFFER);
-    session->dhcpv6_server_duid_len = 0;
     session->dhcpv6_lease_time = 0;
     session->dhcpv6_lease_timestamp.tv_sec = 0;
     session->dhcpv6_lease_timestamp.tv_nsec = 0;
@@ -207,7 +209,7 @@ bbl_dhcpv6_rx(bbl_session_s *session, bbl_ethernet_header_s *eth, bbl_dhcpv6_s *
     bbl_access_interface_s *interface = session->access_interface;
 
     /* Ignore packets received in wrong state */
-    if(session->dhcpv6_state <= BBL_DHCP_INIT) {
+    if(session->dhcpv6_state <= BBL_DHCP_INIT || !session->dhcpv6) {
         return;
     }
 
@@ -225,16 +227,16 @@ bbl_dhcpv6_rx(bbl_session_s *session, bbl_ethernet_header_s *eth, bbl_dhcpv6_s *
     }
 
     if(dhcpv6->server_duid_len && dhcpv6->server_duid_len < DHCPV6_BUFFER) {
-        memcpy(session->dhcpv6_server_duid, dhcpv6->server_duid, dhcpv6->server_duid_len);
-        session->dhcpv6_server_duid_len = dhcpv6->server_duid_len;
+        memcpy(session->dhcpv6->server_duid, dhcpv6->server_duid, dhcpv6->server_duid_len);
+        session->dhcpv6->server_duid_len = dhcpv6->server_duid_len;
     }
     if(dhcpv6->ia_na_address && dhcpv6->ia_na_option_len && dhcpv6->ia_na_option_len < DHCPV6_BUFFER) {
-        memcpy(session->dhcpv6_ia_na_option, dhcpv6->ia_na_option, dhcpv6->ia_na_option_len);
-        session->dhcpv6_ia_na_option_len = dhcpv6->ia_na_option_len;
+        memcpy(session->dhcpv6->ia_na_option, dhcpv6->ia_na_option, dhcpv6->ia_na_option_len);
+        session->dhcpv6->ia_na_option_len = dhcpv6->ia_na_option_len;
     }
     if(dhcpv6->ia_pd_prefix && dhcpv6->ia_pd_prefix->len && dhcpv6->ia_pd_option_len && dhcpv6->ia_pd_option_len < DHCPV6_BUFFER) {
-        memcpy(session->dhcpv6_ia_pd_option, dhcpv6->ia_pd_option, dhcpv6->ia_pd_option_len);
-        session->dhcpv6_ia_pd_option_len = dhcpv6->ia_pd_option_len;
+        memcpy(session->dhcpv6->ia_pd_option, dhcpv6->ia_pd_option, dhcpv6->ia_pd_option_len);
+        session->dhcpv6->ia_pd_option_len = dhcpv6->ia_pd_option_len;
     }
 
     if(dhcpv6->type == DHCPV6_MESSAGE_REPLY) {
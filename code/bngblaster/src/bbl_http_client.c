@@ -264,7 +264,7 @@ bbl_http_client_add(bbl_http_client_config_s *config, bbl_session_s *session)
 {
     bbl_http_client_s *client;
 
-    if(!session->netif.state) {
+    if(!session->netif) {
         return false;
     }
 
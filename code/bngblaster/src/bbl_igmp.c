@@ -37,11 +37,15 @@ bbl_igmp_rx(bbl_session_s *session, bbl_ipv4_s *ipv4)
         if(igmp->robustness) {
             session->igmp_robustness = igmp->robustness;
         }
+        if(!session->igmp) {
+            /* No group joined. */
+            return;
+        }
 
         if(igmp->group) {
             /* Group Specific Query */
             for(i=0; i < IGMP_MAX_GROUPS; i++) {
-                group = &session->igmp_groups[i];
+                group = &session->igmp->groups[i];
                 if(group->group == igmp->group &&
                    group->state == IGMP_GROUP_ACTIVE) {
                     group->send = true;
@@ -51,7 +55,7 @@ bbl_igmp_rx(bbl_session_s *session, bbl_ipv4_s *ipv4)
         } else {
             /* General Query */
             for(i=0; i < IGMP_MAX_GROUPS; i++) {
-                group = &session->igmp_groups[i];
+                group = &session->igmp->groups[i];
                 if(group->state == IGMP_GROUP_ACTIVE) {
                     group->send = true;
                     send = true;
@@ -77,6 +81,7 @@ bbl_igmp_ctrl_join(int fd, uint32_t session_id, json_t *arguments)
     uint32_t source1 = 0;
     uint32_t source2 = 0;
     uint32_t source3 = 0;
+    bbl_session_igmp_s *igmp;
     bbl_igmp_group_s *group = NULL;
     int i;
 
@@ -111,18 +116,22 @@ bbl_igmp_ctrl_join(int fd, uint32_t session_id, json_t *arguments)
     /* Search session */
     session = bbl_session_get(session_id);
     if(session) {
+        igmp = bbl_session_igmp(session);
+        if(!igmp) {
+            return bbl_ctrl_status(fd, "error", 500, "internal error");
+        }
         /* Search for free slot ... */
         for(i=0; i < IGMP_MAX_GROUPS; i++) {
-            if(!session->igmp_groups[i].zapping) {
-                if(session->igmp_groups[i].group == group_address) {
-                    group = &session->igmp_groups[i];
+            if(!igmp->groups[i].zapping) {
+                if(igmp->groups[i].group == group_address) {
+                    group = &igmp->groups[i];
                     if(group->state == IGMP_GROUP_IDLE) {
                         break;
                     } else {
                         return bbl_ctrl_status(fd, "error", 409, "group already exists");
                     }
-                } else if(session->igmp_groups[i].state == IGMP_GROUP_IDLE) {
-                    group = &session->igmp_groups[i];
+                } else if(igmp->groups[i].state == IGMP_GROUP_IDLE) {
+                    group = &igmp->groups[i];
                 }
             }
         }
@@ -156,6 +165,7 @@ bbl_igmp_ctrl_join_iter(int fd, uint32_t session_id __attribute__((unused)), jso
     uint32_t group_address = 0;
     uint32_t group_iter = 1;
     int group_count = 0;
+    bbl_session_igmp_s *igmp;
     bbl_igmp_group_s *group = NULL;
     uint32_t source1 = 0;
     uint32_t source2 = 0;
@@ -203,9 +213,13 @@ bbl_igmp_ctrl_join_iter(int fd, uint32_t session_id __attribute__((unused)), jso
         for(i = 0; i < g_ctx->sessions; i++) {
             session = &g_ctx->session_list[i];
             if(session) {
+                igmp = bbl_session_igmp(session);
+                if(!igmp) {
+                    return bbl_ctrl_status(fd, "error", 500, "internal error");
+                }
                 /* Search for free slot ... */
                 for(i2=0; i2 < IGMP_MAX_GROUPS; i2++) {
-                    group = &session->igmp_groups[i2];
+                    group = &igmp->groups[i2];
                     if(group->zapping) {
                         continue;
                     }
@@ -272,9 +286,9 @@ bbl_igmp_ctrl_leave(int fd, uint32_t session_id, json_t *arguments)
     session = bbl_session_get(session_id);
     if(session) {
         /* Search for group ... */
-        for(i=0; i < IGMP_MAX_GROUPS; i++) {
-            if(session->igmp_groups[i].group == group_address) {
-                group = &session->igmp_groups[i];
+        for(i=0; session->igmp && i < IGMP_MAX_GROUPS; i++) {
+            if(session->igmp->groups[i].group == group_address) {
+                group = &session->igmp->groups[i];
                 break;
             }
         }
@@ -314,10 +328,10 @@ bbl_igmp_ctrl_leave_all(int fd, uint32_t session_id __attribute__((unused)), jso
     /* Iterate over all sessions */
     for(i = 0; i < g_ctx->sessions; i++) {
         session = &g_ctx->session_list[i];
-        if(session) {
+        if(session && session->igmp) {
             /* Search for group ... */
             for(i2=0; i2 < IGMP_MAX_GROUPS; i2++) {
-                group = &session->igmp_groups[i2];
+                group = &session->igmp->groups[i2];
                 if(group->zapping || group->state <= IGMP_GROUP_LEAVING) {
                     continue;
                 }
@@ -360,8 +374,8 @@ bbl_igmp_ctrl_info(int fd, uint32_t session_id, json_t *arguments __attribute__(
     if(session) {
         groups = json_array();
         /* Add group informations */
-        for(i=0; i < IGMP_MAX_GROUPS; i++) {
-            group = &session->igmp_groups[i];
+        for(i=0; session->igmp && i < IGMP_MAX_GROUPS; i++) {
+            group = &session->igmp->groups[i];
             if(group->group) {
                 sources = json_array();
                 for(i2=0; i2 < IGMP_MAX_SOURCES; i2++) {
@@ -162,7 +162,9 @@ bbl_interface_links_add()
         }
         link_config = link_config->next;
     }
-    return true;
+    /* Loopback interfaces are connected after
+     * all links are added. */
+    return io_loopback_connect();
 }
 
 /**
@@ -281,7 +283,7 @@ bbl_interface_ctrl(int fd, uint32_t session_id __attribute__((unused)), json_t *
     bbl_interface_s *interface;
 
     io_handle_s *io;
-    json_t *root, *jobj, *jobj_array;
+    json_t *root, *jobj, *jobj_array, *profile;
 
     jobj_array = json_array();
 
@@ -321,6 +323,14 @@ bbl_interface_ctrl(int fd, uint32_t session_id __attribute__((unused)), json_t *
             "rx-packets", rx_packets,
             "rx-bytes", rx_bytes);
         if(jobj) {
+            profile = io_profile_json(interface->io.tx);
+            if(profile) {
+                json_object_set_new(jobj, "tx-profile", profile);
+            }
+            profile = io_profile_json(interface->io.rx);
+            if(profile) {
+                json_object_set_new(jobj, "rx-profile", profile);
+            }
             json_array_append_new(jobj_array, jobj);
         }
     }
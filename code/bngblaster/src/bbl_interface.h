@@ -34,6 +34,8 @@ typedef struct bbl_interface_
 
     uint8_t mac[ETH_ADDR_LEN];
     uint32_t send_requests;
+
+    bbl_outage_s stream_outage; /* Outages of streams received on this interface */
     
     CIRCLEQ_ENTRY(bbl_interface_) interface_qnode;
     struct {
@@ -0,0 +1,168 @@
+/*
+ * BNG Blaster (BBL) - MRT Files
+ *
+ * MRT files are mapped into memory and indexed
+ * in chunks, which allows to start processing
+ * (e.g. flooding) the first records while the
+ * rest of the file is still being indexed. 
+ *
+ * agent, October 2026
+ *
+ * Copyright (C) 2020-2025, RtBrick, Inc.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <fcntl.h>
+#include "bbl.h"
+
+/**
+ * bbl_mrt_open
+ * 
+ * @param file_path MRT file path
+ * @return MRT file or NULL
+ */
+bbl_mrt_file_s *
+bbl_mrt_open(char *file_path)
+{
+    bbl_mrt_file_s *mrt;
+    struct stat st;
+    uint8_t *map;
+    int fd;
+
+    fd = open(file_path, O_RDONLY);
+    if(fd == -1) {
+        LOG(ERROR, "Failed to open MRT file %s - %s (%d)\n", 
+            file_path, strerror(errno), errno);
+        return NULL;
+    }
+    if(fstat(fd, &st) == -1 || st.st_size == 0) {
+        LOG(ERROR, "Failed to open MRT file %s (empty file)\n", file_path);
+        close(fd);
+        return NULL;
+    }
+
+    /* The mapping is private and writable as some 
+     * decoders temporarily modify the records 
+     * (e.g. checksum verification). */
+    map = mmap(NULL, st.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED) {
+        LOG(ERROR, "Failed to map MRT file %s - %s (%d)\n", 
+            file_path, strerror(errno), errno);
+        return NULL;
+    }
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+    madvise(map, st.st_size, MADV_WILLNEED);
+
+    mrt = calloc(1, sizeof(bbl_mrt_file_s));
+    mrt->file_path = strdup(file_path);
+    mrt->map = map;
+    mrt->size = st.st_size;
+    return mrt;
+}
+
+/**
+ * bbl_mrt_index
+ * 
+ * Index the next chunk of up to BBL_MRT_CHUNK records.
+ * The previous chunk is released before.
+ * 
+ * @param mrt MRT file
+ * @return number of indexed records or -1 on error
+ */
+int
+bbl_mrt_index(bbl_mrt_file_s *mrt)
+{
+    bbl_mrt_hdr_t *hdr;
+    uint32_t length;
+
+    bbl_mrt_release(mrt);
+    mrt->index_count = 0;
+    while(mrt->index_count < BBL_MRT_CHUNK) {
+        if(mrt->offset == mrt->size) {
+            break;
+        }
+        if(mrt->size - mrt->offset < sizeof(bbl_mrt_hdr_t)) {
+            LOG(ERROR, "Invalid MRT file %s (truncated MRT header)\n", mrt->file_path);
+            return -1;
+        }
+        hdr = (bbl_mrt_hdr_t*)(mrt->map + mrt->offset);
+        length = be32toh(hdr->length);
+        if(mrt->size - mrt->offset - sizeof(bbl_mrt_hdr_t) < length) {
+            LOG(ERROR, "Invalid MRT file %s (truncated MRT record)\n", mrt->file_path);
+            return -1;
+        }
+        if(be16toh(hdr->type) == BBL_MRT_TYPE_LSPGEN) {
+            /* Skip LSDB records of LSPGEN cache files. */
+            mrt->offset += sizeof(bbl_mrt_hdr_t) + length;
+            continue;
+        }
+        mrt->index[mrt->index_count++] = mrt->offset;
+        mrt->offset += sizeof(bbl_mrt_hdr_t) + length;
+        mrt->records++;
+    }
+    return mrt->index_count;
+}
+
+/**
+ * bbl_mrt_record
+ * 
+ * @param mrt MRT file
+ * @param index record index of current chunk
+ * @param record record (returned)
+ */
+void
+bbl_mrt_record(bbl_mrt_file_s *mrt, uint32_t index, bbl_mrt_record_s *record)
+{
+    bbl_mrt_hdr_t *hdr = (bbl_mrt_hdr_t*)(mrt->map + mrt->index[index]);
+    record->type = be16toh(hdr->type);
+    record->subtype = be16toh(hdr->subtype);
+    record->length = be32toh(hdr->length);
+    record->data = (uint8_t*)hdr + sizeof(bbl_mrt_hdr_t);
+}
+
+/**
+ * bbl_mrt_done
+ * 
+ * @param mrt MRT file
+ * @return true if all records are indexed
+ */
+bool
+bbl_mrt_done(bbl_mrt_file_s *mrt)
+{
+    return mrt->offset == mrt->size;
+}
+
+/**
+ * bbl_mrt_release
+ * 
+ * Release all pages of already indexed chunks, 
+ * so that the file is not kept in memory twice
+ * (file mapping and LSDB).
+ * 
+ * @param mrt MRT file
+ */
+void
+bbl_mrt_release(bbl_mrt_file_s *mrt)
+{
+    size_t page_size = getpagesize();
+    size_t offset = mrt->offset & ~(page_size-1);
+
+    if(offset > mrt->released) {
+        madvise(mrt->map + mrt->released, offset - mrt->released, MADV_DONTNEED);
+        mrt->released = offset;
+    }
+}
+
+/**
+ * bbl_mrt_close
+ * 
+ * @param mrt MRT file
+ */
+void
+bbl_mrt_close(bbl_mrt_file_s *mrt)
+{
+    if(!mrt) return;
+    munmap(mrt->map, mrt->size);
+    free(mrt->file_path);
+    free(mrt);
+}
@@ -0,0 +1,67 @@
+/*
+ * BNG Blaster (BBL) - MRT Files
+ *
+ * agent, October 2026
+ *
+ * Copyright (C) 2020-2025, RtBrick, Inc.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef __BBL_MRT_H__
+#define __BBL_MRT_H__
+
+/* Number of MRT records indexed and loaded 
+ * with each run of the MRT load job. */
+#define BBL_MRT_CHUNK           4096
+#define BBL_MRT_LOAD_INTERVAL   (1 * MSEC)
+#define BBL_MRT_TYPE_LSPGEN     0xff00 /* LSPGEN cache records */
+
+typedef struct bbl_mrt_hdr_ {
+    uint32_t  timestamp;
+    uint16_t  type;
+    uint16_t  subtype;
+    uint32_t  length;
+} __attribute__ ((__packed__)) bbl_mrt_hdr_t;
+
+typedef struct bbl_mrt_record_ {
+    uint16_t  type;
+    uint16_t  subtype;
+    uint32_t  length;
+    uint8_t  *data; /* points into the file mapping */
+} bbl_mrt_record_s;
+
+/*
+ * MRT file mapped into memory which is indexed
+ * and loaded in chunks of BBL_MRT_CHUNK records.
+ */
+typedef struct bbl_mrt_file_ {
+    char     *file_path;
+    uint8_t  *map;
+    size_t    size;
+    size_t    offset;   /* offset of next record to be indexed */
+    size_t    released; /* mapping released up to this offset */
+    uint64_t  records;  /* total number of indexed records */
+
+    /* Offset index of current chunk. */
+    uint32_t  index_count;
+    size_t    index[BBL_MRT_CHUNK];
+} bbl_mrt_file_s;
+
+bbl_mrt_file_s *
+bbl_mrt_open(char *file_path);
+
+int
+bbl_mrt_index(bbl_mrt_file_s *mrt);
+
+void
+bbl_mrt_record(bbl_mrt_file_s *mrt, uint32_t index, bbl_mrt_record_s *record);
+
+bool
+bbl_mrt_done(bbl_mrt_file_s *mrt);
+
+void
+bbl_mrt_release(bbl_mrt_file_s *mrt);
+
+void
+bbl_mrt_close(bbl_mrt_file_s *mrt);
+
+#endif
@@ -12,6 +12,7 @@
 #include "isis/isis_def.h"
 #include "ospf/ospf_def.h"
 #include "ldp/ldp_def.h"
+#include <checksum.h>
 
 static protocol_error_t decode_l2tp(uint8_t *buf, uint16_t len, uint8_t *sp, uint16_t sp_len, bbl_ethernet_header_s *eth, bbl_l2tp_s **_l2tp);
 static protocol_error_t encode_l2tp(uint8_t *buf, uint16_t *len, bbl_l2tp_s *l2tp);
@@ -41,20 +42,15 @@ packet_is_bbl(uint8_t *buf, uint16_t len)
  * CHECKSUM
  * ------------------------------------------------------------------------*/
 
-static uint32_t
-_checksum(void *buf, ssize_t len)
+/* One's complement sum using the SIMD
+ * kernels of the common checksum library. */
+static inline uint32_t
+_checksum(const void *buf, ssize_t len)
 {
-    uint32_t result = 0;
-    uint16_t *cur = buf;
-    while (len > 1) {
-        result += *cur++;
-        len -= 2;
-    }
-    /*  Add left-over byte, if any */
-    if(len) {
-        result += *(uint8_t*)cur;
+    if(len <= 0) {
+        return 0;
     }
-    return result;
+    return checksum_partial(buf, len);
 }
 
 static uint32_t
@@ -258,6 +254,10 @@ encode_dhcpv6_access_line(uint8_t *buf, access_line_s *access_line)
     return 0;
 }
 
+static protocol_error_t
+encode_dhcpv6_options(uint8_t *buf, uint16_t *len,
+                      bbl_dhcpv6_s *dhcpv6);
+
 /*
  * encode_dhcpv6
  */
@@ -265,8 +265,6 @@ static protocol_error_t
 encode_dhcpv6(uint8_t *buf, uint16_t *len,
               bbl_dhcpv6_s *dhcpv6)
 {
-    uint16_t value_len;
-
     if(dhcpv6->type == DHCPV6_MESSAGE_RELAY_FORW || 
        dhcpv6->type == DHCPV6_MESSAGE_RELAY_REPL) {
         /* Type */
@@ -302,6 +300,19 @@ encode_dhcpv6(uint8_t *buf, uint16_t *len,
         *(uint16_t*)buf = htobe16(dhcpv6->elapsed);
         BUMP_WRITE_BUFFER(buf, len, sizeof(uint16_t));
     }
+    return encode_dhcpv6_options(buf, len, dhcpv6);
+}
+
+/*
+ * encode_dhcpv6_options
+ *
+ * Encode all DHCPv6 options following the elapsed time option.
+ */
+static protocol_error_t
+encode_dhcpv6_options(uint8_t *buf, uint16_t *len,
+                      bbl_dhcpv6_s *dhcpv6)
+{
+    uint16_t value_len;
 
     /* Relay Message */
     if(dhcpv6->relay_message) {
@@ -517,6 +528,10 @@ encode_dhcp_access_line(uint8_t *buf, access_line_s *access_line)
     return 0;
 }
 
+static protocol_error_t
+encode_dhcp_options(uint8_t *buf, uint16_t *len,
+                    bbl_dhcp_s *dhcp);
+
 /*
  * encode_dhcp
  */
@@ -526,7 +541,6 @@ encode_dhcp(uint8_t *buf, uint16_t *len,
 {
     if(!dhcp->header) return ENCODE_ERROR;
 
-    uint8_t  value_len;
     uint8_t  option_len;
     uint8_t *option_len_ptr;
 
@@ -572,6 +586,23 @@ encode_dhcp(uint8_t *buf, uint16_t *len,
         }
         *option_len_ptr = option_len;
     }
+    return encode_dhcp_options(buf, len, dhcp);
+}
+
+/*
+ * encode_dhcp_options
+ *
+ * Encode all DHCP options following the
+ * parameter request list option.
+ */
+static protocol_error_t
+encode_dhcp_options(uint8_t *buf, uint16_t *len,
+                    bbl_dhcp_s *dhcp)
+{
+    uint8_t  value_len;
+    uint8_t  option_len;
+    uint8_t *option_len_ptr;
+
     if(dhcp->client_identifier) {
         *buf = DHCP_OPTION_CLIENT_IDENTIFIER;
         BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
@@ -1624,6 +1655,404 @@ encode_l2tp(uint8_t *buf, uint16_t *len, bbl_l2tp_s *l2tp)
     return result;
 }
 
+/*
+ * encode_pppoe_access_line
+ *
+ * Encode PPPoE vendor tag with access line attributes
+ * (TR-101) and return the length of the tag.
+ */
+uint16_t
+encode_pppoe_access_line(uint8_t *buf, uint16_t *len,
+                         access_line_s *access_line)
+{
+    uint16_t *vendor_len_field;
+    uint16_t  vendor_len;
+    uint8_t   str_len;
+
+    bbl_access_line_profile_s *access_line_profile;
+
+    *(uint16_t*)buf = htobe16(PPPOE_TAG_VENDOR);
+    BUMP_WRITE_BUFFER(buf, len, sizeof(uint16_t));
+    vendor_len_field = (uint16_t*)buf;
+    BUMP_WRITE_BUFFER(buf, len, sizeof(uint16_t));
+    *(uint32_t*)buf = htobe32(BROADBAND_FORUM_VENDOR_ID);
+    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+    vendor_len = 4;
+    if(access_line->aci) {
+        *buf = ACCESS_LINE_ACI;
+        BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+        str_len = strnlen(access_line->aci, 128);
+        *buf = str_len;
+        BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+        memcpy(buf, access_line->aci, str_len);
+        BUMP_WRITE_BUFFER(buf, len, str_len);
+        vendor_len += 2 + str_len;
+    }
+    if(access_line->ari) {
+        *buf = ACCESS_LINE_ARI;
+        BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+        str_len = strnlen(access_line->ari, 128);
+        *buf = str_len;
+        BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+        memcpy(buf, access_line->ari, str_len);
+        BUMP_WRITE_BUFFER(buf, len, str_len);
+        vendor_len += 2 + str_len;
+    }
+    if(access_line->aaci) {
+        *buf = ACCESS_LINE_AGG_ACC_CIRCUIT_ID_ASCII;
+        BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+        str_len = strnlen(access_line->aaci, 128);
+        *buf = str_len;
+        BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+        memcpy(buf, access_line->aaci, str_len);
+        BUMP_WRITE_BUFFER(buf, len, str_len);
+        vendor_len += 2 + str_len;
+    }
+    if(access_line->up) {
+        *buf = ACCESS_LINE_ACT_UP;
+        BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+        *buf = 4;
+        BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+        *(uint32_t*)buf = htobe32(access_line->up);
+        BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+        vendor_len += 6;
+    }
+    if(access_line->down) {
+        *buf = ACCESS_LINE_ACT_DOWN;
+        BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+        *buf = 4;
+        BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+        *(uint32_t*)buf = htobe32(access_line->down);
+        BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+        vendor_len += 6;
+    }
+    if(access_line->dsl_type) {
+        *buf = ACCESS_LINE_DSL_TYPE;
+        BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+        *buf = 4;
+        BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+        *(uint32_t*)buf = htobe32(access_line->dsl_type);
+        BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+        vendor_len += 6;
+    }
+    access_line_profile = access_line->profile;
+    if(access_line_profile) {
+        if(access_line_profile->min_up) {
+            *buf = ACCESS_LINE_MIN_UP;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->min_up);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->min_down) {
+            *buf = ACCESS_LINE_MIN_DOWN;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->min_down);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->att_up) {
+            *buf = ACCESS_LINE_ATT_UP;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->att_up);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->att_down) {
+            *buf = ACCESS_LINE_ATT_DOWN;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->att_down);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->max_up) {
+            *buf = ACCESS_LINE_MAX_UP;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->max_up);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->max_down) {
+            *buf = ACCESS_LINE_MAX_DOWN;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->max_down);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->min_up_low) {
+            *buf = ACCESS_LINE_MIN_UP_LOW;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->min_up_low);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->min_down_low) {
+            *buf = ACCESS_LINE_MIN_DOWN_LOW;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->min_down_low);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->max_interl_delay_up) {
+            *buf = ACCESS_LINE_MAX_INTERL_DELAY_UP;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->max_interl_delay_up);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->act_interl_delay_up) {
+            *buf = ACCESS_LINE_ACT_INTERL_DELAY_UP;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->act_interl_delay_up);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->max_interl_delay_down) {
+            *buf = ACCESS_LINE_MAX_INTERL_DELAY_DOWN;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->max_interl_delay_down);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->act_interl_delay_down) {
+            *buf = ACCESS_LINE_ACT_INTERL_DELAY_DOWN;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->act_interl_delay_down);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->data_link_encaps) {
+            *buf = ACCESS_LINE_DATA_LINK_ENCAPS;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            /* (1)byte   + (1)byte  + (1)byte
+            * data link   encaps 1   encaps 2 */
+            *(uint32_t*)buf = htobe32(access_line_profile->data_link_encaps);
+            *buf = 3;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 5;
+        }
+        if(access_line_profile->dsl_type) {
+            *buf = ACCESS_LINE_DSL_TYPE;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->dsl_type);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->pon_type) {
+            switch(access_line_profile->pon_access_line_version) {
+              case DRAFT_LIHAWI_00:
+                  *buf = ACCESS_LINE_PON_TYPE_LIHAWI_00;
+                   break;
+              default:
+                  *buf = ACCESS_LINE_PON_TYPE;
+                   break;
+            }
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->pon_type);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->etr_up) {
+            *buf = ACCESS_LINE_ETR_UP;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->etr_up);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->etr_down) {
+            *buf = ACCESS_LINE_ETR_DOWN;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->etr_down);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->attetr_up) {
+            *buf = ACCESS_LINE_ATTETR_UP;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->attetr_up);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->attetr_down) {
+            *buf = ACCESS_LINE_ATTETR_DOWN;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->attetr_down);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->gdr_up) {
+            *buf = ACCESS_LINE_GDR_UP;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->gdr_up);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->gdr_down) {
+            *buf = ACCESS_LINE_GDR_DOWN;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->gdr_down);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->attgdr_up) {
+            *buf = ACCESS_LINE_ATTGDR_UP;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->attgdr_up);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->attgdr_down) {
+            *buf = ACCESS_LINE_ATTGDR_DOWN;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->attgdr_down);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->ont_onu_avg_down) {
+            switch(access_line_profile->pon_access_line_version) {
+              case DRAFT_LIHAWI_00:
+                  *buf = ACCESS_LINE_ONT_ONU_AVG_DOWN_LIHAWI_00;
+                   break;
+              default:
+                  *buf = ACCESS_LINE_ONT_ONU_AVG_DOWN;
+                   break;
+            }
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->ont_onu_avg_down);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->ont_onu_peak_down) {
+            switch(access_line_profile->pon_access_line_version) {
+              case DRAFT_LIHAWI_00:
+                  *buf = ACCESS_LINE_ONT_ONU_PEAK_DOWN_LIHAWI_00;
+                   break;
+              default:
+                  *buf = ACCESS_LINE_ONT_ONU_PEAK_DOWN;
+                   break;
+            }
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->ont_onu_peak_down);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->ont_onu_max_up) {
+            switch(access_line_profile->pon_access_line_version) {
+              case DRAFT_LIHAWI_00:
+                  *buf = ACCESS_LINE_ONT_ONU_MAX_UP_LIHAWI_00;
+                   break;
+              default:
+                  *buf = ACCESS_LINE_ONT_ONU_MAX_UP;
+                   break;
+            }
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->ont_onu_max_up);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->ont_onu_ass_up) {
+            switch(access_line_profile->pon_access_line_version) {
+              case DRAFT_LIHAWI_00:
+                  *buf = ACCESS_LINE_ONT_ONU_ASS_UP_LIHAWI_00;
+                   break;
+              default:
+                  *buf = ACCESS_LINE_ONT_ONU_ASS_UP;
+                   break;
+            }
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->ont_onu_ass_up);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->pon_max_up) {
+            switch(access_line_profile->pon_access_line_version) {
+              case DRAFT_LIHAWI_00:
+                  *buf = ACCESS_LINE_PON_MAX_UP_LIHAWI_00;
+                   break;
+              default:
+                  *buf = ACCESS_LINE_PON_MAX_UP;
+                   break;
+            }
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->pon_max_up);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+        if(access_line_profile->pon_max_down) {
+            switch(access_line_profile->pon_access_line_version) {
+              case DRAFT_LIHAWI_00:
+                  *buf = ACCESS_LINE_PON_MAX_DOWN_LIHAWI_00;
+                   break;
+              default:
+                  *buf = ACCESS_LINE_PON_MAX_DOWN;
+                   break;
+            }
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *buf = 4;
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
+            *(uint32_t*)buf = htobe32(access_line_profile->pon_max_down);
+            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
+            vendor_len += 6;
+        }
+    }
+    *vendor_len_field = htobe16(vendor_len);
+    return 4 + vendor_len;
+}
+
 /*
  * encode_pppoe_discovery
  *
@@ -1639,12 +2068,7 @@ encode_pppoe_discovery(uint8_t *buf, uint16_t *len,
                        bbl_pppoe_discovery_s *pppoe)
 {
     uint16_t *pppoe_len_field;
-    uint16_t *vendor_len_field;
     uint16_t  pppoe_len = 0;
-    uint16_t  vendor_len;
-    uint8_t   str_len;
-
-    bbl_access_line_profile_s *access_line_profile;
 
     /* Set version and type to 1 */
     *buf = 17;
@@ -1700,386 +2124,7 @@ encode_pppoe_discovery(uint8_t *buf, uint16_t *len,
             pppoe_len += pppoe->ac_cookie_len;
         }
         if(pppoe->access_line) {
-            *(uint16_t*)buf = htobe16(PPPOE_TAG_VENDOR);
-            BUMP_WRITE_BUFFER(buf, len, sizeof(uint16_t));
-            vendor_len_field = (uint16_t*)buf;
-            BUMP_WRITE_BUFFER(buf, len, sizeof(uint16_t));
-            *(uint32_t*)buf = htobe32(BROADBAND_FORUM_VENDOR_ID);
-            BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-            vendor_len = 4;
-            if(pppoe->access_line->aci) {
-                *buf = ACCESS_LINE_ACI;
-                BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                str_len = strnlen(pppoe->access_line->aci, 128);
-                *buf = str_len;
-                BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                memcpy(buf, pppoe->access_line->aci, str_len);
-                BUMP_WRITE_BUFFER(buf, len, str_len);
-                vendor_len += 2 + str_len;
-            }
-            if(pppoe->access_line->ari) {
-                *buf = ACCESS_LINE_ARI;
-                BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                str_len = strnlen(pppoe->access_line->ari, 128);
-                *buf = str_len;
-                BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                memcpy(buf, pppoe->access_line->ari, str_len);
-                BUMP_WRITE_BUFFER(buf, len, str_len);
-                vendor_len += 2 + str_len;
-            }
-            if(pppoe->access_line->aaci) {
-                *buf = ACCESS_LINE_AGG_ACC_CIRCUIT_ID_ASCII;
-                BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                str_len = strnlen(pppoe->access_line->aaci, 128);
-                *buf = str_len;
-                BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                memcpy(buf, pppoe->access_line->aaci, str_len);
-                BUMP_WRITE_BUFFER(buf, len, str_len);
-                vendor_len += 2 + str_len;
-            }
-            if(pppoe->access_line->up) {
-                *buf = ACCESS_LINE_ACT_UP;
-                BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                *buf = 4;
-                BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                *(uint32_t*)buf = htobe32(pppoe->access_line->up);
-                BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                vendor_len += 6;
-            }
-            if(pppoe->access_line->down) {
-                *buf = ACCESS_LINE_ACT_DOWN;
-                BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                *buf = 4;
-                BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                *(uint32_t*)buf = htobe32(pppoe->access_line->down);
-                BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                vendor_len += 6;
-            }
-            if(pppoe->access_line->dsl_type) {
-                *buf = ACCESS_LINE_DSL_TYPE;
-                BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                *buf = 4;
-                BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                *(uint32_t*)buf = htobe32(pppoe->access_line->dsl_type);
-                BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                vendor_len += 6;
-            }
-            access_line_profile = pppoe->access_line->profile;
-            if(access_line_profile) {
-                if(access_line_profile->min_up) {
-                    *buf = ACCESS_LINE_MIN_UP;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->min_up);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->min_down) {
-                    *buf = ACCESS_LINE_MIN_DOWN;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->min_down);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->att_up) {
-                    *buf = ACCESS_LINE_ATT_UP;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->att_up);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->att_down) {
-                    *buf = ACCESS_LINE_ATT_DOWN;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->att_down);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->max_up) {
-                    *buf = ACCESS_LINE_MAX_UP;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->max_up);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->max_down) {
-                    *buf = ACCESS_LINE_MAX_DOWN;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->max_down);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->min_up_low) {
-                    *buf = ACCESS_LINE_MIN_UP_LOW;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->min_up_low);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->min_down_low) {
-                    *buf = ACCESS_LINE_MIN_DOWN_LOW;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->min_down_low);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->max_interl_delay_up) {
-                    *buf = ACCESS_LINE_MAX_INTERL_DELAY_UP;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->max_interl_delay_up);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->act_interl_delay_up) {
-                    *buf = ACCESS_LINE_ACT_INTERL_DELAY_UP;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->act_interl_delay_up);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->max_interl_delay_down) {
-                    *buf = ACCESS_LINE_MAX_INTERL_DELAY_DOWN;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->max_interl_delay_down);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->act_interl_delay_down) {
-                    *buf = ACCESS_LINE_ACT_INTERL_DELAY_DOWN;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->act_interl_delay_down);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->data_link_encaps) {
-                    *buf = ACCESS_LINE_DATA_LINK_ENCAPS;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    /* (1)byte   + (1)byte  + (1)byte
-                    * data link   encaps 1   encaps 2 */
-                    *(uint32_t*)buf = htobe32(access_line_profile->data_link_encaps);
-                    *buf = 3;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 5;
-                }
-                if(access_line_profile->dsl_type) {
-                    *buf = ACCESS_LINE_DSL_TYPE;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->dsl_type);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->pon_type) {
-                    switch(access_line_profile->pon_access_line_version) {
-                      case DRAFT_LIHAWI_00:
-                          *buf = ACCESS_LINE_PON_TYPE_LIHAWI_00;
-                           break;
-                      default:
-                          *buf = ACCESS_LINE_PON_TYPE;
-                           break;
-                    }
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->pon_type);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->etr_up) {
-                    *buf = ACCESS_LINE_ETR_UP;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->etr_up);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->etr_down) {
-                    *buf = ACCESS_LINE_ETR_DOWN;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->etr_down);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->attetr_up) {
-                    *buf = ACCESS_LINE_ATTETR_UP;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->attetr_up);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->attetr_down) {
-                    *buf = ACCESS_LINE_ATTETR_DOWN;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->attetr_down);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->gdr_up) {
-                    *buf = ACCESS_LINE_GDR_UP;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->gdr_up);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->gdr_down) {
-                    *buf = ACCESS_LINE_GDR_DOWN;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->gdr_down);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->attgdr_up) {
-                    *buf = ACCESS_LINE_ATTGDR_UP;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->attgdr_up);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->attgdr_down) {
-                    *buf = ACCESS_LINE_ATTGDR_DOWN;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->attgdr_down);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->ont_onu_avg_down) {
-                    switch(access_line_profile->pon_access_line_version) {
-                      case DRAFT_LIHAWI_00:
-                          *buf = ACCESS_LINE_ONT_ONU_AVG_DOWN_LIHAWI_00;
-                           break;
-                      default:
-                          *buf = ACCESS_LINE_ONT_ONU_AVG_DOWN;
-                           break;
-                    }
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->ont_onu_avg_down);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->ont_onu_peak_down) {
-                    switch(access_line_profile->pon_access_line_version) {
-                      case DRAFT_LIHAWI_00:
-                          *buf = ACCESS_LINE_ONT_ONU_PEAK_DOWN_LIHAWI_00;
-                           break;
-                      default:
-                          *buf = ACCESS_LINE_ONT_ONU_PEAK_DOWN;
-                           break;
-                    }
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->ont_onu_peak_down);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->ont_onu_max_up) {
-                    switch(access_line_profile->pon_access_line_version) {
-                      case DRAFT_LIHAWI_00:
-                          *buf = ACCESS_LINE_ONT_ONU_MAX_UP_LIHAWI_00;
-                           break;
-                      default:
-                          *buf = ACCESS_LINE_ONT_ONU_MAX_UP;
-                           break;
-                    }
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->ont_onu_max_up);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->ont_onu_ass_up) {
-                    switch(access_line_profile->pon_access_line_version) {
-                      case DRAFT_LIHAWI_00:
-                          *buf = ACCESS_LINE_ONT_ONU_ASS_UP_LIHAWI_00;
-                           break;
-                      default:
-                          *buf = ACCESS_LINE_ONT_ONU_ASS_UP;
-                           break;
-                    }
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->ont_onu_ass_up);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->pon_max_up) {
-                    switch(access_line_profile->pon_access_line_version) {
-                      case DRAFT_LIHAWI_00:
-                          *buf = ACCESS_LINE_PON_MAX_UP_LIHAWI_00;
-                           break;
-                      default:
-                          *buf = ACCESS_LINE_PON_MAX_UP;
-                           break;
-                    }
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->pon_max_up);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-                if(access_line_profile->pon_max_down) {
-                    switch(access_line_profile->pon_access_line_version) {
-                      case DRAFT_LIHAWI_00:
-                          *buf = ACCESS_LINE_PON_MAX_DOWN_LIHAWI_00;
-                           break;
-                      default:
-                          *buf = ACCESS_LINE_PON_MAX_DOWN;
-                           break;
-                    }
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *buf = 4;
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint8_t));
-                    *(uint32_t*)buf = htobe32(access_line_profile->pon_max_down);
-                    BUMP_WRITE_BUFFER(buf, len, sizeof(uint32_t));
-                    vendor_len += 6;
-                }
-            }
-            *vendor_len_field = htobe16(vendor_len);
-            pppoe_len += 4 + vendor_len;
+            pppoe_len += encode_pppoe_access_line(buf, len, pppoe->access_line);
         }
     }
     *pppoe_len_field = htobe16(pppoe_len);
@@ -2400,6 +2445,413 @@ encode_ethernet(uint8_t *buf, uint16_t *len,
     }
 }
 
+static uint8_t
+encode_template_vlans(bbl_ethernet_header_s *eth)
+{
+    uint8_t vlans = 0;
+    if(eth->vlan_outer) {
+        vlans++;
+        if(eth->vlan_inner) {
+            vlans++;
+            if(eth->vlan_three) vlans++;
+        }
+    }
+    return vlans;
+}
+
+/*
+ * encode_template_ethernet
+ *
+ * Patch MAC addresses and VLAN identifiers
+ * of a pre-encoded Ethernet header.
+ */
+static void
+encode_template_ethernet(uint8_t *buf, uint8_t vlans,
+                         bbl_ethernet_header_s *eth)
+{
+    uint8_t *tci = buf + ETH_ADDR_LEN*2 + sizeof(uint16_t);
+
+    if(eth->dst) {
+        memcpy(buf, eth->dst, ETH_ADDR_LEN);
+    } else {
+        /* Default broadcast */
+        memset(buf, 0xff, ETH_ADDR_LEN);
+    }
+    memcpy(buf+ETH_ADDR_LEN, eth->src, ETH_ADDR_LEN);
+    if(vlans) {
+        *(uint16_t*)tci = htobe16(eth->vlan_outer | eth->vlan_outer_priority << 13);
+        if(vlans > 1) {
+            *(uint16_t*)(tci+4) = htobe16(eth->vlan_inner | eth->vlan_inner_priority << 13);
+            if(vlans > 2) {
+                *(uint16_t*)(tci+8) = htobe16(eth->vlan_three);
+            }
+        }
+    }
+}
+
+/*
+ * encode_pppoe_template
+ *
+ * Build PPPoE discovery template from the given Ethernet header
+ * with PPPoE discovery. Only the number of VLAN tags, the QinQ
+ * flag and the service-name, host-uniq length and max-payload
+ * tags are taken into account.
+ */
+protocol_error_t
+encode_pppoe_template(bbl_pppoe_template_s *template,
+                      bbl_ethernet_header_s *eth)
+{
+    bbl_ethernet_header_s t_eth = {0};
+    bbl_pppoe_discovery_s t_pppoe = {0};
+    bbl_pppoe_discovery_s *pppoe = eth->next;
+    uint8_t host_uniq[PPPOE_TEMPLATE_LEN] = {0};
+
+    if(eth->type != ETH_TYPE_PPPOE_DISCOVERY || eth->mpls || eth->raw_len || !pppoe) {
+        return ENCODE_ERROR;
+    }
+    /* Ethernet with 3 VLAN tags and PPPoE discovery
+     * tags without service name and host-uniq value
+     * take less than 64 bytes. */
+    if(pppoe->service_name_len + pppoe->host_uniq_len > PPPOE_TEMPLATE_LEN - 64) {
+        return ENCODE_ERROR;
+    }
+
+    memset(template, 0x0, sizeof(bbl_pppoe_template_s));
+    template->vlans = encode_template_vlans(eth);
+    template->qinq = eth->qinq;
+    template->service_name_len = pppoe->service_name_len;
+    template->host_uniq_len = pppoe->host_uniq_len;
+    template->max_payload = pppoe->max_payload;
+
+    /* Dummy MAC addresses, VLAN identifiers and
+     * host-uniq are replaced per packet. */
+    t_eth.src = (uint8_t*)broadcast_mac;
+    t_eth.qinq = eth->qinq;
+    t_eth.vlan_outer = template->vlans > 0 ? 1 : 0;
+    t_eth.vlan_inner = template->vlans > 1 ? 1 : 0;
+    t_eth.vlan_three = template->vlans > 2 ? 1 : 0;
+    t_eth.type = ETH_TYPE_PPPOE_DISCOVERY;
+    t_eth.next = &t_pppoe;
+    t_pppoe.code = PPPOE_PADI;
+    t_pppoe.service_name = pppoe->service_name;
+    t_pppoe.service_name_len = pppoe->service_name_len;
+    t_pppoe.host_uniq = host_uniq;
+    t_pppoe.host_uniq_len = pppoe->host_uniq_len;
+    t_pppoe.max_payload = pppoe->max_payload;
+    if(encode_ethernet(template->buf, &template->len, &t_eth) != PROTOCOL_SUCCESS) {
+        return ENCODE_ERROR;
+    }
+    template->pppoe_offset = ETH_ADDR_LEN*2 + template->vlans*4 + sizeof(uint16_t);
+    if(template->host_uniq_len) {
+        /* PPPoE header (6) + service name tag + host-uniq tag header (4) */
+        template->host_uniq_offset = template->pppoe_offset + 10 +
+                                     template->service_name_len + 4;
+    }
+    return PROTOCOL_SUCCESS;
+}
+
+/*
+ * encode_pppoe_discovery_template
+ *
+ * Encode PPPoE discovery packet by copying the template and
+ * patching the per-packet fields, which results in the same
+ * packet as encoded by encode_ethernet.
+ *
+ * Returns ENCODE_ERROR without writing anything if the template
+ * does not match the Ethernet header and PPPoE discovery tags.
+ */
+protocol_error_t
+encode_pppoe_discovery_template(uint8_t *buf, uint16_t *len,
+                                bbl_pppoe_template_s *template,
+                                bbl_ethernet_header_s *eth)
+{
+    bbl_pppoe_discovery_s *pppoe = eth->next;
+    uint8_t *start = buf;
+    uint16_t pppoe_len;
+
+    if(eth->type != ETH_TYPE_PPPOE_DISCOVERY || eth->mpls || eth->raw_len || !pppoe ||
+       pppoe->code == PPPOE_PADT ||
+       template->vlans != encode_template_vlans(eth) ||
+       (template->vlans && template->qinq != eth->qinq) ||
+       template->service_name_len != pppoe->service_name_len ||
+       template->host_uniq_len != pppoe->host_uniq_len ||
+       template->max_payload != pppoe->max_payload) {
+        return ENCODE_ERROR;
+    }
+    /* The service name might be replaced by the name received with PADO. */
+    if(template->service_name_len &&
+       memcmp(template->buf + template->pppoe_offset + 10, pppoe->service_name,
+              template->service_name_len) != 0) {
+        return ENCODE_ERROR;
+    }
+
+    memcpy(buf, template->buf, template->len);
+    encode_template_ethernet(buf, template->vlans, eth);
+    *(buf + template->pppoe_offset + 1) = pppoe->code;
+    *(uint16_t*)(buf + template->pppoe_offset + 2) = htobe16(pppoe->session_id);
+    if(template->host_uniq_len) {
+        memcpy(buf + template->host_uniq_offset, pppoe->host_uniq, template->host_uniq_len);
+    }
+    BUMP_WRITE_BUFFER(buf, len, template->len);
+
+    pppoe_len = template->len - template->pppoe_offset - 6;
+    if(pppoe->ac_cookie) {
+        *(uint16_t*)buf = htobe16(PPPOE_TAG_AC_COOKIE);
+        BUMP_WRITE_BUFFER(buf, len, sizeof(uint16_t));
+        *(uint16_t*)buf = htobe16(pppoe->ac_cookie_len);
+        BUMP_WRITE_BUFFER(buf, len, sizeof(uint16_t));
+        memcpy(buf, pppoe->ac_cookie, pppoe->ac_cookie_len);
+        BUMP_WRITE_BUFFER(buf, len, pppoe->ac_cookie_len);
+        pppoe_len += 4 + pppoe->ac_cookie_len;
+    }
+    if(pppoe->access_line) {
+        pppoe_len += encode_pppoe_access_line(buf, len, pppoe->access_line);
+    }
+    *(uint16_t*)(start + template->pppoe_offset + 4) = htobe16(pppoe_len);
+    return PROTOCOL_SUCCESS;
+}
+
+/*
+ * encode_dhcp_template_key
+ *
+ * Returns the UDP header of DHCP or DHCPv6 (except relay)
+ * messages which can be encoded from a template or NULL.
+ */
+static bbl_udp_s *
+encode_dhcp_template_key(bbl_dhcp_template_key_s *key,
+                         bbl_ethernet_header_s *eth)
+{
+    bbl_pppoe_session_s *pppoe;
+    bbl_ipv4_s *ipv4;
+    bbl_ipv6_s *ipv6;
+    bbl_udp_s *udp;
+    bbl_dhcp_s *dhcp;
+    bbl_dhcpv6_s *dhcpv6;
+    uint16_t ip_type = eth->type;
+    void *ip = eth->next;
+
+    memset(key, 0x0, sizeof(bbl_dhcp_template_key_s));
+    if(eth->mpls || eth->raw_len || eth->lwip || !ip) {
+        return NULL;
+    }
+    if(eth->type == ETH_TYPE_PPPOE_SESSION) {
+        pppoe = ip;
+        if(pppoe->raw_len || pppoe->lwip || !pppoe->next) {
+            return NULL;
+        }
+        if(pppoe->protocol == PROTOCOL_IPV4) {
+            ip_type = ETH_TYPE_IPV4;
+        } else if(pppoe->protocol == PROTOCOL_IPV6) {
+            ip_type = ETH_TYPE_IPV6;
+        } else {
+            return NULL;
+        }
+        key->ppp_protocol = pppoe->protocol;
+        ip = pppoe->next;
+    }
+    if(ip_type == ETH_TYPE_IPV4) {
+        ipv4 = ip;
+        if(ipv4->protocol != PROTOCOL_IPV4_UDP || ipv4->router_alert_option ||
+           ipv4->id || ipv4->offset || !ipv4->next) {
+            return NULL;
+        }
+        udp = ipv4->next;
+        dhcp = udp->next;
+        if(udp->protocol != UDP_PROTOCOL_DHCP || !dhcp || !dhcp->header) {
+            return NULL;
+        }
+        key->tos = ipv4->tos;
+        key->ttl = ipv4->ttl;
+        if(dhcp->parameter_request_list) {
+            key->prl = 0x01;
+            if(dhcp->option_netmask) key->prl |= 0x02;
+            if(dhcp->option_router) key->prl |= 0x04;
+            if(dhcp->option_dns1 || dhcp->option_dns2) key->prl |= 0x08;
+            if(dhcp->option_domain_name) key->prl |= 0x10;
+        }
+    } else if(ip_type == ETH_TYPE_IPV6) {
+        ipv6 = ip;
+        if(ipv6->protocol != IPV6_NEXT_HEADER_UDP || !ipv6->next) {
+            return NULL;
+        }
+        udp = ipv6->next;
+        dhcpv6 = udp->next;
+        if(udp->protocol != UDP_PROTOCOL_DHCPV6 || !dhcpv6 ||
+           dhcpv6->type == DHCPV6_MESSAGE_RELAY_FORW ||
+           dhcpv6->type == DHCPV6_MESSAGE_RELAY_REPL) {
+            return NULL;
+        }
+        key->tos = ipv6->tos;
+        key->ttl = ipv6->ttl;
+    } else {
+        return NULL;
+    }
+    key->eth_type = eth->type;
+    key->vlans = encode_template_vlans(eth);
+    key->qinq = key->vlans ? eth->qinq : false;
+    key->udp_src = udp->src;
+    key->udp_dst = udp->dst;
+    key->udp_protocol = udp->protocol;
+    return udp;
+}
+
+/*
+ * encode_dhcp_template
+ *
+ * Build DHCP or DHCPv6 template from the given Ethernet
+ * header with DHCP over IPv4 or DHCPv6 over IPv6, both
+ * optionally over PPPoE session.
+ */
+protocol_error_t
+encode_dhcp_template(bbl_dhcp_template_s *template,
+                     bbl_ethernet_header_s *eth)
+{
+    bbl_ethernet_header_s t_eth;
+    bbl_udp_s *udp;
+    bbl_dhcp_template_key_s key;
+    uint8_t buf[IO_BUFFER_LEN];
+    uint16_t len = 0;
+    uint16_t prefix_len;
+    uint8_t prl;
+
+    udp = encode_dhcp_template_key(&key, eth);
+    if(!udp) {
+        return ENCODE_ERROR;
+    }
+
+    memset(template, 0x0, sizeof(bbl_dhcp_template_s));
+    memcpy(&template->key, &key, sizeof(bbl_dhcp_template_key_s));
+    template->ip_offset = ETH_ADDR_LEN*2 + key.vlans*4 + sizeof(uint16_t);
+    if(key.ppp_protocol) {
+        /* PPPoE session (6) and PPP header (2) */
+        template->pppoe_offset = template->ip_offset;
+        template->ip_offset += 8;
+    }
+    if(key.udp_protocol == UDP_PROTOCOL_DHCP) {
+        template->udp_offset = template->ip_offset + 20;
+        /* BOOTP header, magic cookie, message type
+         * option and parameter request list option */
+        prefix_len = sizeof(struct dhcp_header) + 4 + 3;
+        if(key.prl) {
+            /* Option code, length and one byte per flag */
+            prefix_len += 2;
+            for(prl = key.prl >> 1; prl; prl >>= 1) {
+                prefix_len += prl & 0x01;
+            }
+        }
+    } else {
+        template->udp_offset = template->ip_offset + IPV6_HDR_LEN;
+        /* Message type, transaction ID and elapsed time option */
+        prefix_len = 10;
+    }
+    template->len = template->udp_offset + 8 + prefix_len;
+    if(template->len > DHCP_TEMPLATE_LEN) {
+        return ENCODE_ERROR;
+    }
+
+    /* The Ethernet header is copied as VLAN
+     * priorities are merged by encode_ethernet. */
+    memcpy(&t_eth, eth, sizeof(bbl_ethernet_header_s));
+    if(encode_ethernet(buf, &len, &t_eth) != PROTOCOL_SUCCESS || len < template->len) {
+        return ENCODE_ERROR;
+    }
+    memcpy(template->buf, buf, template->len);
+    return PROTOCOL_SUCCESS;
+}
+
+/*
+ * encode_dhcp_ethernet_template
+ *
+ * Encode DHCP or DHCPv6 packet by copying the template,
+ * patching the per-packet fields and appending all remaining
+ * options, which results in the same packet as encoded
+ * by encode_ethernet.
+ *
+ * Returns an error without advancing the buffer if the
+ * template does not match the given Ethernet header or
+ * if the options could not be encoded.
+ */
+protocol_error_t
+encode_dhcp_ethernet_template(uint8_t *buf, uint16_t *len,
+                              bbl_dhcp_template_s *template,
+                              bbl_ethernet_header_s *eth)
+{
+    bbl_dhcp_template_key_s key;
+    bbl_pppoe_session_s *pppoe;
+    bbl_ipv4_s *ipv4;
+    bbl_ipv6_s *ipv6;
+    bbl_udp_s *udp;
+    bbl_dhcp_s *dhcp;
+    bbl_dhcpv6_s *dhcpv6;
+    protocol_error_t result;
+
+    uint8_t *start = buf;
+    uint8_t *ip = buf + template->ip_offset;
+    uint8_t *udp_buf = buf + template->udp_offset;
+    uint16_t start_len = *len;
+    uint16_t ip_len;
+    uint16_t udp_len;
+    void *next = eth->next;
+
+    udp = encode_dhcp_template_key(&key, eth);
+    if(!udp || memcmp(&key, &template->key, sizeof(bbl_dhcp_template_key_s)) != 0) {
+        return ENCODE_ERROR;
+    }
+
+    memcpy(buf, template->buf, template->len);
+    encode_template_ethernet(buf, key.vlans, eth);
+    if(template->pppoe_offset) {
+        pppoe = next;
+        *(uint16_t*)(buf + template->pppoe_offset + 2) = htobe16(pppoe->session_id);
+        next = pppoe->next;
+    }
+    BUMP_WRITE_BUFFER(buf, len, template->len);
+
+    if(key.udp_protocol == UDP_PROTOCOL_DHCP) {
+        ipv4 = next;
+        dhcp = udp->next;
+        *(uint32_t*)(ip + 12) = ipv4->src;
+        *(uint32_t*)(ip + 16) = ipv4->dst;
+        memcpy(udp_buf + 8, dhcp->header, sizeof(struct dhcp_header));
+        /* Message type option value */
+        *(udp_buf + 8 + sizeof(struct dhcp_header) + 6) = dhcp->type;
+        result = encode_dhcp_options(buf, len, dhcp);
+
+        ip_len = *len - start_len - template->ip_offset;
+        udp_len = *len - start_len - template->udp_offset;
+        *(uint16_t*)(udp_buf + 4) = htobe16(udp_len);
+        *(uint16_t*)(udp_buf + 6) = bbl_ipv4_udp_checksum(ipv4->src, ipv4->dst, udp_buf, udp_len);
+        *(uint16_t*)(ip + 2) = htobe16(ip_len);
+        *(uint16_t*)(ip + 10) = 0;
+        *(uint16_t*)(ip + 10) = bbl_checksum(ip, 20);
+    } else {
+        ipv6 = next;
+        dhcpv6 = udp->next;
+        memcpy(ip + 8, ipv6->src, IPV6_ADDR_LEN);
+        memcpy(ip + 24, ipv6->dst, IPV6_ADDR_LEN);
+        *(uint32_t*)(udp_buf + 8) = htobe32(dhcpv6->xid);
+        *(udp_buf + 8) = dhcpv6->type;
+        /* Elapsed time option value */
+        *(uint16_t*)(udp_buf + 16) = htobe16(dhcpv6->elapsed);
+        result = encode_dhcpv6_options(buf, len, dhcpv6);
+
+        ip_len = *len - start_len - template->ip_offset;
+        udp_len = *len - start_len - template->udp_offset;
+        *(uint16_t*)(udp_buf + 4) = htobe16(udp_len);
+        *(uint16_t*)(udp_buf + 6) = bbl_ipv6_udp_checksum(ipv6->src, ipv6->dst, udp_buf, udp_len);
+        *(uint16_t*)(ip + 4) = htobe16(udp_len);
+    }
+    if(result != PROTOCOL_SUCCESS) {
+        *len = start_len;
+        return result;
+    }
+    if(template->pppoe_offset) {
+        /* PPP header */
+        *(uint16_t*)(start + template->pppoe_offset + 4) = htobe16(ip_len + 2);
+    }
+    return PROTOCOL_SUCCESS;
+}
+
 /*
  * DECODE
  * ------------------------------------------------------------------------*/
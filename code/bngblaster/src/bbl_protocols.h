@@ -110,6 +110,9 @@
 #define PPPOE_TAG_VENDOR                0x0105
 #define PPPOE_TAG_MAX_PAYLOAD           0x0120
 
+#define PPPOE_TEMPLATE_LEN              256
+#define DHCP_TEMPLATE_LEN               384
+
 #define PPPOE_PADI                      0x09
 #define PPPOE_PADO                      0x07
 #define PPPOE_PADR                      0x19
@@ -670,6 +673,66 @@ typedef struct bbl_pppoe_discovery_ {
     access_line_s *access_line;
 } bbl_pppoe_discovery_s;
 
+/*
+ * PPPoE Discovery Template
+ *
+ * Pre-encoded Ethernet and PPPoE discovery header
+ * with service-name, host-uniq and max-payload tags.
+ * The per-packet fields are patched at fixed offsets
+ * and the AC-Cookie and access line tags are appended.
+ */
+typedef struct bbl_pppoe_template_ {
+    uint8_t   vlans; /* number of VLAN tags */
+    bool      qinq;
+    uint16_t  service_name_len;
+    uint16_t  host_uniq_len;
+    uint16_t  max_payload;
+    uint16_t  pppoe_offset; /* PPPoE header */
+    uint16_t  host_uniq_offset; /* zero if not present */
+    uint16_t  len;
+    uint8_t   buf[PPPOE_TEMPLATE_LEN];
+} bbl_pppoe_template_s;
+
+/*
+ * DHCP/DHCPv6 Template Key
+ *
+ * All fields of the pre-encoded headers which
+ * are not patched per packet.
+ */
+typedef struct bbl_dhcp_template_key_ {
+    uint16_t  eth_type;
+    uint16_t  ppp_protocol; /* PPPoE session only */
+    uint8_t   vlans; /* number of VLAN tags */
+    bool      qinq;
+    uint8_t   tos;
+    uint8_t   ttl;
+    uint16_t  udp_src;
+    uint16_t  udp_dst;
+    uint8_t   udp_protocol;
+    uint8_t   prl; /* DHCP parameter request list flags */
+} bbl_dhcp_template_key_s;
+
+/*
+ * DHCP/DHCPv6 Template
+ *
+ * Pre-encoded Ethernet, optional PPPoE session, IP and UDP
+ * header followed by the fixed part of the DHCP message.
+ * For DHCP this is the BOOTP header, magic cookie, message
+ * type and parameter request list option. For DHCPv6 this
+ * is the message type, transaction ID and elapsed time option.
+ * The per-packet fields are patched at fixed offsets, the
+ * remaining options are appended and the lengths and
+ * checksums are updated.
+ */
+typedef struct bbl_dhcp_template_ {
+    bbl_dhcp_template_key_s key;
+    uint16_t  pppoe_offset; /* PPPoE header (zero if not present) */
+    uint16_t  ip_offset; /* IPv4 or IPv6 header */
+    uint16_t  udp_offset; /* UDP header */
+    uint16_t  len;
+    uint8_t   buf[DHCP_TEMPLATE_LEN];
+} bbl_dhcp_template_s;
+
 /*
  * PPPoE Session Structure
  *
@@ -1070,4 +1133,26 @@ protocol_error_t
 encode_ethernet(uint8_t *buf, uint16_t *len,
                 bbl_ethernet_header_s *eth);
 
+uint16_t
+encode_pppoe_access_line(uint8_t *buf, uint16_t *len,
+                         access_line_s *access_line);
+
+protocol_error_t
+encode_pppoe_template(bbl_pppoe_template_s *template,
+                      bbl_ethernet_header_s *eth);
+
+protocol_error_t
+encode_pppoe_discovery_template(uint8_t *buf, uint16_t *len,
+                                bbl_pppoe_template_s *template,
+                                bbl_ethernet_header_s *eth);
+
+protocol_error_t
+encode_dhcp_template(bbl_dhcp_template_s *template,
+                     bbl_ethernet_header_s *eth);
+
+protocol_error_t
+encode_dhcp_ethernet_template(uint8_t *buf, uint16_t *len,
+                              bbl_dhcp_template_s *template,
+                              bbl_ethernet_header_s *eth);
+
 #endif
@@ -0,0 +1,439 @@
+/*
+ * BNG Blaster (BBL) - Time-Series Recorder
+ *
+ * Periodically sample stream, interface, session and
+ * adjacency counters into a memory-mapped ring file
+ * (see bbl_recorder_def.h for the file format).
+ *
+ * Counters are written by the IO threads and read here
+ * without locking, using relaxed atomic loads to prevent
+ * torn values.
+ *
+ * agent, October 2026
+ *
+ * Copyright (C) 2020-2025, RtBrick, Inc.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include "bbl.h"
+#include "bbl_stream.h"
+#include <sys/mman.h>
+#include <fcntl.h>
+
+#define RECORDER_LOAD(_x) __atomic_load_n(&(_x), __ATOMIC_RELAXED)
+#define RECORDER_SEGMENT_MIN (1024*1024)
+
+static const bbl_recorder_type_s g_recorder_types[] = {
+    { BBL_RECORDER_STREAM, 3, 0, "stream", { "tx-packets", "rx-packets", "rx-loss" } },
+    { BBL_RECORDER_INTERFACE, 5, 0, "interface", { "tx-packets", "tx-bytes", "rx-packets", "rx-bytes", "state" } },
+    { BBL_RECORDER_SESSIONS, 4, 0, "sessions", { "established", "outstanding", "terminated", "flapped" } },
+    { BBL_RECORDER_BGP, 1, 0, "bgp", { "state" } },
+    { BBL_RECORDER_ISIS, 1, 0, "isis", { "state" } },
+    { BBL_RECORDER_OSPF, 2, 0, "ospf", { "state", "neighbors-full" } },
+    { BBL_RECORDER_LDP, 1, 0, "ldp", { "state" } },
+};
+
+typedef struct bbl_recorder_object_ {
+    uint8_t type;
+    void *object;
+} bbl_recorder_object_s;
+
+typedef struct bbl_recorder_ {
+    uint8_t *map;
+    size_t map_len;
+    int fd;
+
+    bbl_recorder_header_s *header;
+    uint32_t segment; /* current segment */
+    uint64_t sequence;
+    size_t record_max_len;
+
+    bbl_recorder_object_s *objects;
+    uint32_t object_count;
+
+    uint32_t value_count;
+    uint64_t *values;
+    uint64_t *last;
+    int64_t *delta;
+
+    struct timer_ *timer;
+} bbl_recorder_s;
+
+static bbl_recorder_s *g_recorder = NULL;
+
+static uint8_t
+bbl_recorder_metric_count(uint8_t type)
+{
+    return g_recorder_types[type-1].metric_count;
+}
+
+static void
+bbl_recorder_add(bbl_recorder_s *recorder, uint8_t type, void *object, uint64_t id, const char *name)
+{
+    bbl_recorder_series_s *series;
+
+    if(recorder->header) {
+        series = (bbl_recorder_series_s*)(recorder->map + recorder->header->series_offset);
+        series += recorder->object_count;
+        series->type = type;
+        series->id = id;
+        if(name) {
+            strncpy(series->name, name, BBL_RECORDER_NAME_LEN-1);
+        }
+        recorder->objects[recorder->object_count].type = type;
+        recorder->objects[recorder->object_count].object = object;
+    }
+    recorder->object_count++;
+    recorder->value_count += bbl_recorder_metric_count(type);
+}
+
+/*
+ * Collect all objects to be recorded. This function is
+ * called twice, first to count and then to add objects.
+ */
+static void
+bbl_recorder_objects(bbl_recorder_s *recorder)
+{
+    bbl_interface_s *interface;
+    bbl_network_interface_s *network_interface;
+    bbl_stream_s *stream;
+    bgp_session_s *bgp_session;
+    ospf_interface_s *ospf_interface;
+    uint64_t index = 0;
+    uint8_t level;
+
+    recorder->object_count = 0;
+    recorder->value_count = 0;
+
+    if(g_ctx->config.recorder_sessions) {
+        bbl_recorder_add(recorder, BBL_RECORDER_SESSIONS, NULL, 0, "sessions");
+    }
+    if(g_ctx->config.recorder_interfaces) {
+        CIRCLEQ_FOREACH(interface, &g_ctx->interface_qhead, interface_qnode) {
+            bbl_recorder_add(recorder, BBL_RECORDER_INTERFACE, interface, interface->ifindex, interface->name);
+        }
+    }
+    if(g_ctx->config.recorder_protocols) {
+        bgp_session = g_ctx->bgp_sessions;
+        while(bgp_session) {
+            bbl_recorder_add(recorder, BBL_RECORDER_BGP, bgp_session, index++, bgp_session->peer_address_str);
+            bgp_session = bgp_session->next;
+        }
+        CIRCLEQ_FOREACH(interface, &g_ctx->interface_qhead, interface_qnode) {
+            network_interface = interface->network;
+            while(network_interface) {
+                for(level = 0; level < ISIS_LEVELS; level++) {
+                    if(network_interface->isis_adjacency[level]) {
+                        bbl_recorder_add(recorder, BBL_RECORDER_ISIS, network_interface->isis_adjacency[level],
+                                         level+1, network_interface->name);
+                    }
+                }
+                ospf_interface = network_interface->ospfv2_interface;
+                if(ospf_interface) {
+                    bbl_recorder_add(recorder, BBL_RECORDER_OSPF, ospf_interface, 2, network_interface->name);
+                }
+                ospf_interface = network_interface->ospfv3_interface;
+                if(ospf_interface) {
+                    bbl_recorder_add(recorder, BBL_RECORDER_OSPF, ospf_interface, 3, network_interface->name);
+                }
+                if(network_interface->ldp_adjacency) {
+                    bbl_recorder_add(recorder, BBL_RECORDER_LDP, network_interface->ldp_adjacency, 0, network_interface->name);
+                }
+                network_interface = network_interface->next;
+            }
+        }
+    }
+    if(g_ctx->config.recorder_streams) {
+        stream = g_ctx->stream_head;
+        while(stream) {
+            bbl_recorder_add(recorder, BBL_RECORDER_STREAM, stream, stream->flow_id, stream->config->name);
+            stream = stream->next;
+        }
+    }
+}
+
+static void
+bbl_recorder_sample(bbl_recorder_s *recorder)
+{
+    bbl_recorder_object_s *object;
+    bbl_interface_s *interface;
+    bbl_stream_s *stream;
+    ospf_interface_s *ospf_interface;
+    io_handle_s *io;
+    uint64_t *v = recorder->values;
+    uint64_t packets, bytes;
+    uint32_t i;
+
+    for(i = 0; i < recorder->object_count; i++) {
+        object = &recorder->objects[i];
+        switch(object->type) {
+            case BBL_RECORDER_STREAM:
+                stream = object->object;
+                *v++ = RECORDER_LOAD(stream->tx_packets) - stream->reset_packets_tx;
+                *v++ = RECORDER_LOAD(stream->rx_packets) - stream->reset_packets_rx;
+                *v++ = RECORDER_LOAD(stream->rx_loss) - stream->reset_loss;
+                break;
+            case BBL_RECORDER_INTERFACE:
+                interface = object->object;
+                packets = 0; bytes = 0;
+                for(io = interface->io.tx; io; io = io->next) {
+                    packets += RECORDER_LOAD(io->stats.packets);
+                    bytes += RECORDER_LOAD(io->stats.bytes);
+                }
+                *v++ = packets;
+                *v++ = bytes;
+                packets = 0; bytes = 0;
+                for(io = interface->io.rx; io; io = io->next) {
+                    packets += RECORDER_LOAD(io->stats.packets);
+                    bytes += RECORDER_LOAD(io->stats.bytes);
+                }
+                *v++ = packets;
+                *v++ = bytes;
+                *v++ = interface->state;
+                break;
+            case BBL_RECORDER_SESSIONS:
+                *v++ = g_ctx->sessions_established;
+                *v++ = g_ctx->sessions_outstanding;
+                *v++ = g_ctx->sessions_terminated;
+                *v++ = g_ctx->sessions_flapped;
+                break;
+            case BBL_RECORDER_BGP:
+                *v++ = ((bgp_session_s*)object->object)->state;
+                break;
+            case BBL_RECORDER_ISIS:
+                *v++ = ((isis_adjacency_s*)object->object)->state;
+                break;
+            case BBL_RECORDER_OSPF:
+                ospf_interface = object->object;
+                *v++ = ospf_interface->state;
+                *v++ = ospf_interface->neighbors_full;
+                break;
+            case BBL_RECORDER_LDP:
+                *v++ = ((ldp_adjacency_s*)object->object)->state;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static inline uint8_t *
+bbl_recorder_varint(uint8_t *buf, uint64_t value)
+{
+    while(value >= 0x80) {
+        *buf++ = (value & 0x7f) | 0x80;
+        value >>= 7;
+    }
+    *buf++ = value;
+    return buf;
+}
+
+static uint8_t *
+bbl_recorder_encode(bbl_recorder_s *recorder, uint8_t *buf, bool keyframe)
+{
+    uint64_t run = 0;
+    int64_t delta, dod;
+    uint32_t i;
+
+    for(i = 0; i < recorder->value_count; i++) {
+        if(keyframe) {
+            recorder->last[i] = 0;
+            recorder->delta[i] = 0;
+        }
+        delta = recorder->values[i] - recorder->last[i];
+        dod = delta - recorder->delta[i];
+        recorder->last[i] = recorder->values[i];
+        recorder->delta[i] = keyframe ? 0 : delta;
+        if(dod == 0) {
+            run++;
+            continue;
+        }
+        if(run) {
+            buf = bbl_recorder_varint(buf, (run << 1) | 1);
+            run = 0;
+        }
+        buf = bbl_recorder_varint(buf, (((uint64_t)dod << 1) ^ (uint64_t)(dod >> 63)) << 1);
+    }
+    if(run) {
+        buf = bbl_recorder_varint(buf, (run << 1) | 1);
+    }
+    return buf;
+}
+
+static bbl_recorder_segment_s *
+bbl_recorder_segment(bbl_recorder_s *recorder, uint32_t index)
+{
+    return (bbl_recorder_segment_s*)(recorder->map + recorder->header->segment_offset +
+                                     (index * recorder->header->segment_size));
+}
+
+static void
+bbl_recorder_job(timer_s *timer)
+{
+    bbl_recorder_s *recorder = timer->data;
+    bbl_recorder_segment_s *segment;
+    bbl_recorder_record_s *record;
+    struct timespec now;
+    uint8_t *end;
+    bool keyframe;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    bbl_recorder_sample(recorder);
+
+    segment = bbl_recorder_segment(recorder, recorder->segment);
+    if(segment->len + recorder->record_max_len > recorder->header->segment_size - sizeof(bbl_recorder_segment_s)) {
+        /* Continue with next (oldest) segment. */
+        recorder->segment = (recorder->segment + 1) % recorder->header->segment_count;
+        segment = bbl_recorder_segment(recorder, recorder->segment);
+        __atomic_store_n(&segment->sequence, 0, __ATOMIC_RELEASE);
+        segment->records = 0;
+        segment->len = 0;
+    }
+    keyframe = segment->records == 0;
+
+    record = (bbl_recorder_record_s*)((uint8_t*)(segment+1) + segment->len);
+    record->flags = keyframe ? BBL_RECORDER_KEYFRAME : 0;
+    record->timestamp = (now.tv_sec * SEC) + now.tv_nsec;
+    end = bbl_recorder_encode(recorder, (uint8_t*)(record+1), keyframe);
+    record->len = end - (uint8_t*)record;
+
+    __atomic_store_n(&segment->len, segment->len + record->len, __ATOMIC_RELEASE);
+    __atomic_store_n(&segment->records, segment->records + 1, __ATOMIC_RELEASE);
+    if(keyframe) {
+        __atomic_store_n(&segment->sequence, recorder->sequence, __ATOMIC_RELEASE);
+    }
+    recorder->sequence++;
+}
+
+/**
+ * bbl_recorder_init
+ *
+ * Create recorder file and start recorder job
+ * if enabled.
+ *
+ * @return true if successful
+ */
+bool
+bbl_recorder_init()
+{
+    bbl_recorder_s *recorder;
+    bbl_recorder_header_s *header;
+    size_t segment_offset;
+    size_t segment_size;
+    uint64_t segment_count;
+
+    if(!g_ctx->config.recorder_filename) {
+        return true;
+    }
+
+    recorder = calloc(1, sizeof(bbl_recorder_s));
+    if(!recorder) return false;
+    recorder->fd = -1;
+    recorder->sequence = 1;
+
+    /* Count objects to calculate file layout. */
+    bbl_recorder_objects(recorder);
+    recorder->record_max_len = sizeof(bbl_recorder_record_s) + (recorder->value_count * 10);
+
+    segment_offset = sizeof(bbl_recorder_header_s) + sizeof(g_recorder_types) +
+                     (recorder->object_count * sizeof(bbl_recorder_series_s));
+    segment_offset = (segment_offset + 4095) & ~4095;
+    segment_size = recorder->record_max_len * 4;
+    if(segment_size < RECORDER_SEGMENT_MIN) segment_size = RECORDER_SEGMENT_MIN;
+    segment_size = (segment_size + 4095) & ~4095;
+    segment_count = g_ctx->config.recorder_ring_size / segment_size;
+    if(segment_count < 2) {
+        LOG(ERROR, "Recorder ring size too small (%u values require at least %lu MB)\n",
+            recorder->value_count, ((segment_size * 2) >> 20) + 1);
+        free(recorder);
+        return false;
+    }
+
+    recorder->map_len = segment_offset + (segment_count * segment_size);
+    recorder->fd = open(g_ctx->config.recorder_filename, O_RDWR|O_CREAT|O_TRUNC, 0666);
+    if(recorder->fd < 0 || ftruncate(recorder->fd, recorder->map_len) != 0) {
+        LOG(ERROR, "Failed to create recorder file %s (%s)\n",
+            g_ctx->config.recorder_filename, strerror(errno));
+        goto ERROR;
+    }
+    recorder->map = mmap(NULL, recorder->map_len, PROT_READ|PROT_WRITE, MAP_SHARED, recorder->fd, 0);
+    if(recorder->map == MAP_FAILED) {
+        LOG(ERROR, "Failed to map recorder file %s (%s)\n",
+            g_ctx->config.recorder_filename, strerror(errno));
+        recorder->map = NULL;
+        goto ERROR;
+    }
+
+    recorder->objects = calloc(recorder->object_count, sizeof(bbl_recorder_object_s));
+    recorder->values = calloc(recorder->value_count, sizeof(uint64_t));
+    recorder->last = calloc(recorder->value_count, sizeof(uint64_t));
+    recorder->delta = calloc(recorder->value_count, sizeof(int64_t));
+    if(!(recorder->objects && recorder->values && recorder->last && recorder->delta)) {
+        goto ERROR;
+    }
+
+    header = (bbl_recorder_header_s*)recorder->map;
+    memcpy(header->magic, BBL_RECORDER_MAGIC, sizeof(BBL_RECORDER_MAGIC));
+    header->version = BBL_RECORDER_VERSION;
+    header->bom = BBL_RECORDER_BOM;
+    header->type_count = sizeof(g_recorder_types)/sizeof(g_recorder_types[0]);
+    header->interval = g_ctx->config.recorder_interval;
+    header->timestamp = time(NULL);
+    header->type_offset = sizeof(bbl_recorder_header_s);
+    header->series_offset = header->type_offset + sizeof(g_recorder_types);
+    header->segment_offset = segment_offset;
+    header->segment_size = segment_size;
+    header->segment_count = segment_count;
+    memcpy(recorder->map + header->type_offset, g_recorder_types, sizeof(g_recorder_types));
+    recorder->header = header;
+
+    /* Add objects and series. */
+    bbl_recorder_objects(recorder);
+    header->series_count = recorder->object_count;
+    header->value_count = recorder->value_count;
+
+    LOG(INFO, "Recorder started with %u series and %u values every %lu ms\n",
+        recorder->object_count, recorder->value_count, g_ctx->config.recorder_interval / MSEC);
+
+    g_recorder = recorder;
+    timer_add_periodic(&g_ctx->timer_root, &recorder->timer, "Recorder",
+                       g_ctx->config.recorder_interval / SEC,
+                       g_ctx->config.recorder_interval % SEC,
+                       recorder, &bbl_recorder_job);
+    return true;
+
+ERROR:
+    if(recorder->map) munmap(recorder->map, recorder->map_len);
+    if(recorder->fd >= 0) close(recorder->fd);
+    free(recorder->objects);
+    free(recorder->values);
+    free(recorder->last);
+    free(recorder->delta);
+    free(recorder);
+    return false;
+}
+
+/**
+ * bbl_recorder_close
+ *
+ * Record final sample and close recorder file.
+ */
+void
+bbl_recorder_close()
+{
+    bbl_recorder_s *recorder = g_recorder;
+
+    if(!recorder) return;
+    g_recorder = NULL;
+
+    if(recorder->timer) {
+        bbl_recorder_job(recorder->timer);
+        timer_del(recorder->timer);
+    }
+    munmap(recorder->map, recorder->map_len);
+    close(recorder->fd);
+    free(recorder->objects);
+    free(recorder->values);
+    free(recorder->last);
+    free(recorder->delta);
+    free(recorder);
+}
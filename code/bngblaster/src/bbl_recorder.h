@@ -0,0 +1,20 @@
+/*
+ * BNG Blaster (BBL) - Time-Series Recorder
+ *
+ * agent, October 2026
+ *
+ * Copyright (C) 2020-2025, RtBrick, Inc.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef __BBL_RECORDER_H__
+#define __BBL_RECORDER_H__
+
+#include "bbl_recorder_def.h"
+
+bool
+bbl_recorder_init();
+
+void
+bbl_recorder_close();
+
+#endif
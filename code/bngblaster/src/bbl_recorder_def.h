@@ -0,0 +1,98 @@
+/*
+ * BNG Blaster (BBL) - Time-Series Recorder Format
+ *
+ * The recorder file is memory-mapped and split into a fixed
+ * number of segments used as ring. Each segment starts with
+ * a keyframe record followed by delta records, so that each
+ * segment can be decoded independently after the oldest
+ * segment was overwritten.
+ *
+ * FILE    := HEADER TYPE* SERIES* SEGMENT*
+ * SEGMENT := SEGMENT-HEADER RECORD*
+ * RECORD  := RECORD-HEADER TOKEN*
+ *
+ * The values of a record are stored in series order with
+ * all metrics of a series (see type) in sequence. Values
+ * are encoded as delta of delta to the previous record,
+ * which is zero for counters with constant rate. For
+ * keyframes, the previous value and delta are zero.
+ *
+ * TOKEN   := VARINT(ZIGZAG(delta-of-delta) << 1)
+ *          | VARINT(zero-run-length << 1 | 1)
+ *
+ * agent, October 2026
+ *
+ * Copyright (C) 2020-2025, RtBrick, Inc.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef __BBL_RECORDER_DEF_H__
+#define __BBL_RECORDER_DEF_H__
+
+#include <stdint.h>
+
+#define BBL_RECORDER_MAGIC              "BBLRECD"
+#define BBL_RECORDER_VERSION            1
+#define BBL_RECORDER_BOM                0x0102
+#define BBL_RECORDER_NAME_LEN           48
+#define BBL_RECORDER_METRIC_NAME_LEN    24
+#define BBL_RECORDER_METRICS_MAX        8
+#define BBL_RECORDER_KEYFRAME           0x01
+
+typedef enum {
+    BBL_RECORDER_STREAM = 1,
+    BBL_RECORDER_INTERFACE,
+    BBL_RECORDER_SESSIONS,
+    BBL_RECORDER_BGP,
+    BBL_RECORDER_ISIS,
+    BBL_RECORDER_OSPF,
+    BBL_RECORDER_LDP,
+    BBL_RECORDER_TYPE_MAX
+} bbl_recorder_type_t;
+
+typedef struct __attribute__((__packed__)) bbl_recorder_header_ {
+    char magic[8];
+    uint16_t version;
+    uint16_t bom;
+    uint16_t type_count;
+    uint16_t reserved;
+    uint32_t series_count;
+    uint32_t value_count; /* values per record */
+    uint64_t interval; /* nsec */
+    int64_t timestamp; /* epoch seconds */
+    uint64_t type_offset;
+    uint64_t series_offset;
+    uint64_t segment_offset;
+    uint64_t segment_size;
+    uint32_t segment_count;
+    uint32_t reserved2;
+} bbl_recorder_header_s;
+
+typedef struct __attribute__((__packed__)) bbl_recorder_type_ {
+    uint8_t type;
+    uint8_t metric_count;
+    uint16_t reserved;
+    char name[BBL_RECORDER_METRIC_NAME_LEN];
+    char metrics[BBL_RECORDER_METRICS_MAX][BBL_RECORDER_METRIC_NAME_LEN];
+} bbl_recorder_type_s;
+
+typedef struct __attribute__((__packed__)) bbl_recorder_series_ {
+    uint8_t type;
+    uint8_t reserved[7];
+    uint64_t id;
+    char name[BBL_RECORDER_NAME_LEN];
+} bbl_recorder_series_s;
+
+typedef struct __attribute__((__packed__)) bbl_recorder_segment_ {
+    uint64_t sequence; /* sequence of first record (zero if empty) */
+    uint32_t records;
+    uint32_t len; /* bytes used after segment header */
+} bbl_recorder_segment_s;
+
+typedef struct __attribute__((__packed__)) bbl_recorder_record_ {
+    uint32_t len; /* including record header */
+    uint8_t flags;
+    uint8_t reserved[3];
+    uint64_t timestamp; /* epoch nsec */
+} bbl_recorder_record_s;
+
+#endif
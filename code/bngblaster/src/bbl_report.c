@@ -0,0 +1,496 @@
+/*
+ * BNG Blaster (BBL) - Binary Report
+ *
+ * Stream records are written incrementally while streams
+ * are finalized followed by session records and the string
+ * table if report is closed. See bbl_report_def.h for the
+ * file format and bngblaster-report to convert into
+ * JSON or CSV.
+ *
+ * agent, October 2026
+ *
+ * Copyright (C) 2020-2025, RtBrick, Inc.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include "bbl.h"
+#include "bbl_stream.h"
+#include "bbl_session.h"
+#include <stddef.h>
+
+typedef struct __attribute__((__packed__)) bbl_report_stream_ {
+    uint64_t flow_id;
+    uint32_t name;
+    uint32_t type;
+    uint32_t sub_type;
+    uint32_t direction;
+    uint32_t protocol;
+    uint32_t session_id;
+    uint8_t  enabled;
+    uint8_t  verified;
+    uint8_t  source_address[IPV6_ADDR_LEN];
+    uint16_t source_port;
+    uint8_t  destination_address[IPV6_ADDR_LEN];
+    uint16_t destination_port;
+    uint32_t tx_interface;
+    uint32_t rx_interface;
+    uint16_t tx_len;
+    uint16_t rx_len;
+    uint64_t tx_packets;
+    uint64_t rx_packets;
+    uint64_t rx_loss;
+    uint64_t rx_wrong_order;
+    uint64_t rx_first_seq;
+    uint64_t rx_last_seq;
+    uint64_t rx_delay_us_min;
+    uint64_t rx_delay_us_max;
+    uint32_t rx_outages;
+    uint64_t rx_outage_max_ns;
+    uint64_t rx_outage_max_start_ns;
+    uint64_t rx_outage_total_ns;
+    uint8_t  rx_tos_tc;
+    uint8_t  rx_ttl;
+    uint8_t  rx_outer_vlan_pbit;
+    uint8_t  rx_inner_vlan_pbit;
+    uint32_t rx_mpls1_label;
+    uint32_t rx_mpls2_label;
+    double   tx_pps;
+    double   rx_pps;
+    int64_t  tx_first_epoch;
+    int64_t  rx_first_epoch;
+    int64_t  rx_last_epoch;
+} bbl_report_stream_s;
+
+typedef struct __attribute__((__packed__)) bbl_report_session_ {
+    uint32_t session_id;
+    uint32_t type;
+    uint32_t session_state;
+    uint32_t session_version;
+    uint32_t flapped;
+    uint32_t interface;
+    uint16_t outer_vlan;
+    uint16_t inner_vlan;
+    uint8_t  mac[ETH_ADDR_LEN];
+    uint32_t username;
+    uint32_t agent_circuit_id;
+    uint32_t agent_remote_id;
+    uint8_t  ipv4_address[IPV6_ADDR_LEN];
+    uint8_t  ipv6_prefix[IPV6_ADDR_LEN+1];
+    uint8_t  ipv6_delegated_prefix[IPV6_ADDR_LEN+1];
+    uint64_t tx_packets;
+    uint64_t rx_packets;
+    uint64_t tx_bytes;
+    uint64_t rx_bytes;
+    uint32_t total_flows;
+    uint32_t verified_flows;
+} bbl_report_session_s;
+
+#define BBL_REPORT_FIELD(_name, _type, _struct, _member) \
+    { _name, _type, sizeof(((_struct *)0)->_member), offsetof(_struct, _member) }
+
+static const bbl_report_field_s g_report_stream_fields[] = {
+    BBL_REPORT_FIELD("flow-id", BBL_REPORT_U64, bbl_report_stream_s, flow_id),
+    BBL_REPORT_FIELD("name", BBL_REPORT_STR, bbl_report_stream_s, name),
+    BBL_REPORT_FIELD("type", BBL_REPORT_STR, bbl_report_stream_s, type),
+    BBL_REPORT_FIELD("sub-type", BBL_REPORT_STR, bbl_report_stream_s, sub_type),
+    BBL_REPORT_FIELD("direction", BBL_REPORT_STR, bbl_report_stream_s, direction),
+    BBL_REPORT_FIELD("protocol", BBL_REPORT_STR, bbl_report_stream_s, protocol),
+    BBL_REPORT_FIELD("session-id", BBL_REPORT_U32, bbl_report_stream_s, session_id),
+    BBL_REPORT_FIELD("enabled", BBL_REPORT_U8, bbl_report_stream_s, enabled),
+    BBL_REPORT_FIELD("verified", BBL_REPORT_U8, bbl_report_stream_s, verified),
+    BBL_REPORT_FIELD("source-address", BBL_REPORT_IP, bbl_report_stream_s, source_address),
+    BBL_REPORT_FIELD("source-port", BBL_REPORT_U16, bbl_report_stream_s, source_port),
+    BBL_REPORT_FIELD("destination-address", BBL_REPORT_IP, bbl_report_stream_s, destination_address),
+    BBL_REPORT_FIELD("destination-port", BBL_REPORT_U16, bbl_report_stream_s, destination_port),
+    BBL_REPORT_FIELD("tx-interface", BBL_REPORT_STR, bbl_report_stream_s, tx_interface),
+    BBL_REPORT_FIELD("rx-interface", BBL_REPORT_STR, bbl_report_stream_s, rx_interface),
+    BBL_REPORT_FIELD("tx-len", BBL_REPORT_U16, bbl_report_stream_s, tx_len),
+    BBL_REPORT_FIELD("rx-len", BBL_REPORT_U16, bbl_report_stream_s, rx_len),
+    BBL_REPORT_FIELD("tx-packets", BBL_REPORT_U64, bbl_report_stream_s, tx_packets),
+    BBL_REPORT_FIELD("rx-packets", BBL_REPORT_U64, bbl_report_stream_s, rx_packets),
+    BBL_REPORT_FIELD("rx-loss", BBL_REPORT_U64, bbl_report_stream_s, rx_loss),
+    BBL_REPORT_FIELD("rx-wrong-order", BBL_REPORT_U64, bbl_report_stream_s, rx_wrong_order),
+    BBL_REPORT_FIELD("rx-first-seq", BBL_REPORT_U64, bbl_report_stream_s, rx_first_seq),
+    BBL_REPORT_FIELD("rx-last-seq", BBL_REPORT_U64, bbl_report_stream_s, rx_last_seq),
+    BBL_REPORT_FIELD("rx-delay-us-min", BBL_REPORT_U64, bbl_report_stream_s, rx_delay_us_min),
+    BBL_REPORT_FIELD("rx-delay-us-max", BBL_REPORT_U64, bbl_report_stream_s, rx_delay_us_max),
+    BBL_REPORT_FIELD("rx-outages", BBL_REPORT_U32, bbl_report_stream_s, rx_outages),
+    BBL_REPORT_FIELD("rx-outage-max-ns", BBL_REPORT_U64, bbl_report_stream_s, rx_outage_max_ns),
+    BBL_REPORT_FIELD("rx-outage-max-start-ns", BBL_REPORT_U64, bbl_report_stream_s, rx_outage_max_start_ns),
+    BBL_REPORT_FIELD("rx-outage-total-ns", BBL_REPORT_U64, bbl_report_stream_s, rx_outage_total_ns),
+    BBL_REPORT_FIELD("rx-tos-tc", BBL_REPORT_U8, bbl_report_stream_s, rx_tos_tc),
+    BBL_REPORT_FIELD("rx-ttl", BBL_REPORT_U8, bbl_report_stream_s, rx_ttl),
+    BBL_REPORT_FIELD("rx-outer-vlan-pbit", BBL_REPORT_U8, bbl_report_stream_s, rx_outer_vlan_pbit),
+    BBL_REPORT_FIELD("rx-inner-vlan-pbit", BBL_REPORT_U8, bbl_report_stream_s, rx_inner_vlan_pbit),
+    BBL_REPORT_FIELD("rx-mpls1", BBL_REPORT_U32, bbl_report_stream_s, rx_mpls1_label),
+    BBL_REPORT_FIELD("rx-mpls2", BBL_REPORT_U32, bbl_report_stream_s, rx_mpls2_label),
+    BBL_REPORT_FIELD("tx-pps", BBL_REPORT_F64, bbl_report_stream_s, tx_pps),
+    BBL_REPORT_FIELD("rx-pps", BBL_REPORT_F64, bbl_report_stream_s, rx_pps),
+    BBL_REPORT_FIELD("tx-first-epoch", BBL_REPORT_I64, bbl_report_stream_s, tx_first_epoch),
+    BBL_REPORT_FIELD("rx-first-epoch", BBL_REPORT_I64, bbl_report_stream_s, rx_first_epoch),
+    BBL_REPORT_FIELD("rx-last-epoch", BBL_REPORT_I64, bbl_report_stream_s, rx_last_epoch),
+};
+
+static const bbl_report_field_s g_report_session_fields[] = {
+    BBL_REPORT_FIELD("session-id", BBL_REPORT_U32, bbl_report_session_s, session_id),
+    BBL_REPORT_FIELD("type", BBL_REPORT_STR, bbl_report_session_s, type),
+    BBL_REPORT_FIELD("session-state", BBL_REPORT_STR, bbl_report_session_s, session_state),
+    BBL_REPORT_FIELD("session-version", BBL_REPORT_U32, bbl_report_session_s, session_version),
+    BBL_REPORT_FIELD("flapped", BBL_REPORT_U32, bbl_report_session_s, flapped),
+    BBL_REPORT_FIELD("interface", BBL_REPORT_STR, bbl_report_session_s, interface),
+    BBL_REPORT_FIELD("outer-vlan", BBL_REPORT_U16, bbl_report_session_s, outer_vlan),
+    BBL_REPORT_FIELD("inner-vlan", BBL_REPORT_U16, bbl_report_session_s, inner_vlan),
+    BBL_REPORT_FIELD("mac", BBL_REPORT_MAC, bbl_report_session_s, mac),
+    BBL_REPORT_FIELD("username", BBL_REPORT_STR, bbl_report_session_s, username),
+    BBL_REPORT_FIELD("agent-circuit-id", BBL_REPORT_STR, bbl_report_session_s, agent_circuit_id),
+    BBL_REPORT_FIELD("agent-remote-id", BBL_REPORT_STR, bbl_report_session_s, agent_remote_id),
+    BBL_REPORT_FIELD("ipv4-address", BBL_REPORT_IP, bbl_report_session_s, ipv4_address),
+    BBL_REPORT_FIELD("ipv6-prefix", BBL_REPORT_IPV6_PREFIX, bbl_report_session_s, ipv6_prefix),
+    BBL_REPORT_FIELD("ipv6-delegated-prefix", BBL_REPORT_IPV6_PREFIX, bbl_report_session_s, ipv6_delegated_prefix),
+    BBL_REPORT_FIELD("tx-packets", BBL_REPORT_U64, bbl_report_session_s, tx_packets),
+    BBL_REPORT_FIELD("rx-packets", BBL_REPORT_U64, bbl_report_session_s, rx_packets),
+    BBL_REPORT_FIELD("tx-bytes", BBL_REPORT_U64, bbl_report_session_s, tx_bytes),
+    BBL_REPORT_FIELD("rx-bytes", BBL_REPORT_U64, bbl_report_session_s, rx_bytes),
+    BBL_REPORT_FIELD("total-flows", BBL_REPORT_U32, bbl_report_session_s, total_flows),
+    BBL_REPORT_FIELD("verified-flows", BBL_REPORT_U32, bbl_report_session_s, verified_flows),
+};
+
+typedef struct bbl_report_ {
+    FILE *fp;
+    char *filename;
+
+    /* Current section */
+    uint32_t section;
+    uint16_t record_len;
+    uint32_t chunk_records;
+    uint8_t *chunk;
+
+    /* String table with hash index by pointer,
+     * as most strings are shared (e.g. names). */
+    const char **strings;
+    uint32_t strings_count;
+    uint32_t strings_size;
+    uint32_t *strings_hash; /* index + 1 */
+    uint32_t strings_hash_size;
+} bbl_report_s;
+
+static bbl_report_s *g_report = NULL;
+
+static uint32_t
+bbl_report_string(const char *s)
+{
+    bbl_report_s *report = g_report;
+    uint32_t *hash;
+    uint32_t i, slot;
+
+    if(!s) return BBL_REPORT_STRING_NONE;
+
+    /* Resize hash if more than half used. */
+    if((report->strings_count+1) * 2 > report->strings_hash_size) {
+        hash = calloc(report->strings_hash_size * 2, sizeof(uint32_t));
+        if(!hash) return BBL_REPORT_STRING_NONE;
+        for(i = 0; i < report->strings_count; i++) {
+            slot = ((uintptr_t)report->strings[i] >> 3) & (report->strings_hash_size*2-1);
+            while(hash[slot]) slot = (slot+1) & (report->strings_hash_size*2-1);
+            hash[slot] = i+1;
+        }
+        free(report->strings_hash);
+        report->strings_hash = hash;
+        report->strings_hash_size *= 2;
+    }
+    slot = ((uintptr_t)s >> 3) & (report->strings_hash_size-1);
+    while(report->strings_hash[slot]) {
+        if(report->strings[report->strings_hash[slot]-1] == s) {
+            return report->strings_hash[slot]-1;
+        }
+        slot = (slot+1) & (report->strings_hash_size-1);
+    }
+    if(report->strings_count == report->strings_size) {
+        report->strings_size *= 2;
+        report->strings = realloc(report->strings, report->strings_size * sizeof(char*));
+        if(!report->strings) return BBL_REPORT_STRING_NONE;
+    }
+    report->strings[report->strings_count] = s;
+    report->strings_hash[slot] = ++report->strings_count;
+    return report->strings_count-1;
+}
+
+static void
+bbl_report_ipv4(uint8_t *dst, uint32_t ipv4)
+{
+    /* IPv4-mapped IPv6 address */
+    memset(dst, 0x0, 10);
+    dst[10] = 0xff;
+    dst[11] = 0xff;
+    memcpy(dst+12, &ipv4, IPV4_ADDR_LEN);
+}
+
+static void
+bbl_report_chunk_flush()
+{
+    bbl_report_s *report = g_report;
+    bbl_report_chunk_s chunk = {0};
+
+    if(!report->chunk_records) return;
+    chunk.records = report->chunk_records;
+    chunk.len = report->chunk_records * report->record_len;
+    fwrite(&chunk, sizeof(chunk), 1, report->fp);
+    fwrite(report->chunk, chunk.len, 1, report->fp);
+    report->chunk_records = 0;
+}
+
+static void
+bbl_report_section_end()
+{
+    bbl_report_s *report = g_report;
+    bbl_report_chunk_s chunk = {0};
+
+    if(!report->section) return;
+    bbl_report_chunk_flush();
+    fwrite(&chunk, sizeof(chunk), 1, report->fp);
+    report->section = 0;
+}
+
+static bool
+bbl_report_section_start(uint32_t section, const bbl_report_field_s *fields, uint16_t field_count, uint16_t record_len)
+{
+    bbl_report_s *report = g_report;
+    bbl_report_section_s header = {0};
+
+    bbl_report_section_end();
+    free(report->chunk);
+    report->chunk = malloc(BBL_REPORT_CHUNK_RECORDS * record_len);
+    if(!report->chunk) return false;
+    report->section = section;
+    report->record_len = record_len;
+    report->chunk_records = 0;
+
+    header.type = section;
+    header.field_count = field_count;
+    header.record_len = record_len;
+    fwrite(&header, sizeof(header), 1, report->fp);
+    fwrite(fields, sizeof(bbl_report_field_s), field_count, report->fp);
+    return true;
+}
+
+static void *
+bbl_report_record()
+{
+    bbl_report_s *report = g_report;
+    void *record;
+
+    if(report->chunk_records == BBL_REPORT_CHUNK_RECORDS) {
+        bbl_report_chunk_flush();
+    }
+    record = report->chunk + (report->chunk_records++ * report->record_len);
+    memset(record, 0x0, report->record_len);
+    return record;
+}
+
+/**
+ * bbl_report_open
+ *
+ * @param filename binary report file
+ * @return true if successful
+ */
+bool
+bbl_report_open(const char *filename)
+{
+    bbl_report_s *report;
+    bbl_report_header_s header = {0};
+
+    if(!filename) return false;
+    report = calloc(1, sizeof(bbl_report_s));
+    if(!report) return false;
+    report->fp = fopen(filename, "wb");
+    if(!report->fp) {
+        LOG(ERROR, "Failed to create binary report file %s\n", filename);
+        free(report);
+        return false;
+    }
+    report->filename = strdup(filename);
+    report->strings_size = 1024;
+    report->strings = calloc(report->strings_size, sizeof(char*));
+    report->strings_hash_size = 2048;
+    report->strings_hash = calloc(report->strings_hash_size, sizeof(uint32_t));
+    g_report = report;
+
+    memcpy(header.magic, BBL_REPORT_MAGIC, sizeof(BBL_REPORT_MAGIC));
+    header.version = BBL_REPORT_VERSION;
+    header.bom = BBL_REPORT_BOM;
+    header.timestamp = time(NULL);
+    fwrite(&header, sizeof(header), 1, report->fp);
+    return true;
+}
+
+/**
+ * bbl_report_stream
+ *
+ * Add stream record to binary report if open.
+ *
+ * @param stream traffic stream
+ */
+void
+bbl_report_stream(bbl_stream_s *stream)
+{
+    bbl_report_stream_s *record;
+    const char *rx_interface = NULL;
+    uint16_t src_port, dst_port;
+
+    if(!g_report) return;
+    if(g_report->section != BBL_REPORT_SECTION_STREAMS) {
+        if(!bbl_report_section_start(BBL_REPORT_SECTION_STREAMS, g_report_stream_fields,
+                                     sizeof(g_report_stream_fields)/sizeof(g_report_stream_fields[0]),
+                                     sizeof(bbl_report_stream_s))) {
+            return;
+        }
+    }
+    record = bbl_report_record();
+    record->flow_id = stream->flow_id;
+    record->name = bbl_report_string(stream->config->name);
+    record->type = bbl_report_string(stream_type_string(stream));
+    record->sub_type = bbl_report_string(stream_sub_type_string(stream));
+    record->direction = bbl_report_string(stream->direction == BBL_DIRECTION_UP ? "upstream" : "downstream");
+    record->protocol = bbl_report_string(stream->tcp ? "tcp" : "udp");
+    if(stream->session) {
+        record->session_id = stream->session->session_id;
+    }
+    record->enabled = stream->enabled;
+    record->verified = stream->verified;
+    if(stream->ipv6_src && stream->ipv6_dst) {
+        memcpy(record->source_address, stream->ipv6_src, IPV6_ADDR_LEN);
+        memcpy(record->destination_address, stream->ipv6_dst, IPV6_ADDR_LEN);
+    } else {
+        bbl_report_ipv4(record->source_address, stream->ipv4_src);
+        bbl_report_ipv4(record->destination_address, stream->ipv4_dst);
+    }
+    bbl_stream_ports(stream, &src_port, &dst_port);
+    record->source_port = src_port;
+    record->destination_port = dst_port;
+    record->tx_interface = bbl_report_string(stream->tx_interface ? stream->tx_interface->name : NULL);
+    if(stream->rx_access_interface) {
+        rx_interface = stream->rx_access_interface->name;
+    } else if(stream->rx_network_interface) {
+        rx_interface = stream->rx_network_interface->name;
+    } else if(stream->rx_a10nsp_interface) {
+        rx_interface = stream->rx_a10nsp_interface->name;
+    }
+    record->rx_interface = bbl_report_string(rx_interface);
+    record->tx_len = stream->tx_len;
+    record->rx_len = stream->rx_len;
+    record->tx_packets = stream->tx_packets - stream->reset_packets_tx;
+    record->rx_packets = stream->rx_packets - stream->reset_packets_rx;
+    record->rx_loss = stream->rx_loss - stream->reset_loss;
+    record->rx_wrong_order = stream->rx_wrong_order;
+    record->rx_first_seq = stream->rx_first_seq;
+    record->rx_last_seq = stream->rx_last_seq;
+    record->rx_delay_us_min = stream->rx_min_delay_us;
+    record->rx_delay_us_max = stream->rx_max_delay_us;
+    record->rx_outages = stream->rx_outages;
+    record->rx_outage_max_ns = stream->rx_outage_max_ns;
+    record->rx_outage_max_start_ns = stream->rx_outage_max_start_ns;
+    record->rx_outage_total_ns = stream->rx_outage_total_ns;
+    record->rx_tos_tc = stream->rx_priority;
+    record->rx_ttl = stream->rx_ttl;
+    record->rx_outer_vlan_pbit = stream->rx_outer_vlan_pbit;
+    record->rx_inner_vlan_pbit = stream->rx_inner_vlan_pbit;
+    record->rx_mpls1_label = stream->rx_mpls1_label;
+    record->rx_mpls2_label = stream->rx_mpls2_label;
+    record->tx_pps = stream->rate_packets_tx.avg;
+    record->rx_pps = stream->rate_packets_rx.avg;
+    record->tx_first_epoch = stream->tx_first_epoch;
+    record->rx_first_epoch = stream->rx_first_epoch;
+    record->rx_last_epoch = stream->rx_last_epoch;
+}
+
+static void
+bbl_report_session(bbl_session_s *session)
+{
+    bbl_report_session_s *record = bbl_report_record();
+
+    record->session_id = session->session_id;
+    record->type = bbl_report_string(session->access_type == ACCESS_TYPE_PPPOE ? "pppoe" : "ipoe");
+    record->session_state = bbl_report_string(session_state_string(session->session_state));
+    record->session_version = session->version;
+    record->flapped = session->stats.flapped;
+    record->interface = bbl_report_string(session->access_interface->name);
+    record->outer_vlan = session->vlan_key.outer_vlan_id;
+    record->inner_vlan = session->vlan_key.inner_vlan_id;
+    memcpy(record->mac, session->client_mac, ETH_ADDR_LEN);
+    record->username = bbl_report_string(session->username);
+    record->agent_circuit_id = bbl_report_string(session->agent_circuit_id);
+    record->agent_remote_id = bbl_report_string(session->agent_remote_id);
+    if(session->ip_address) {
+        bbl_report_ipv4(record->ipv4_address, session->ip_address);
+    }
+    if(session->ipv6_prefix.len) {
+        memcpy(record->ipv6_prefix, session->ipv6_prefix.address, IPV6_ADDR_LEN);
+        record->ipv6_prefix[IPV6_ADDR_LEN] = session->ipv6_prefix.len;
+    }
+    if(session->delegated_ipv6_prefix.len) {
+        memcpy(record->ipv6_delegated_prefix, session->delegated_ipv6_prefix.address, IPV6_ADDR_LEN);
+        record->ipv6_delegated_prefix[IPV6_ADDR_LEN] = session->delegated_ipv6_prefix.len;
+    }
+    record->tx_packets = session->stats.packets_tx;
+    record->rx_packets = session->stats.packets_rx;
+    record->tx_bytes = session->stats.bytes_tx;
+    record->rx_bytes = session->stats.bytes_rx;
+    record->total_flows = session->session_traffic.flows;
+    record->verified_flows = session->session_traffic.flows_verified;
+}
+
+/**
+ * bbl_report_close
+ *
+ * Add session records, string table and
+ * trailer to binary report and close file.
+ */
+void
+bbl_report_close()
+{
+    bbl_report_s *report = g_report;
+    bbl_report_section_s header = {0};
+    bbl_report_trailer_s trailer = {0};
+    uint32_t i;
+    uint16_t len;
+    long offset;
+
+    if(!report) return;
+
+    if(g_ctx->sessions) {
+        if(bbl_report_section_start(BBL_REPORT_SECTION_SESSIONS, g_report_session_fields,
+                                    sizeof(g_report_session_fields)/sizeof(g_report_session_fields[0]),
+                                    sizeof(bbl_report_session_s))) {
+            for(i = 0; i < g_ctx->sessions; i++) {
+                bbl_report_session(&g_ctx->session_list[i]);
+            }
+        }
+    }
+    bbl_report_section_end();
+
+    /* String table */
+    offset = ftell(report->fp);
+    header.type = BBL_REPORT_SECTION_STRINGS;
+    fwrite(&header, sizeof(header), 1, report->fp);
+    fwrite(&report->strings_count, sizeof(uint32_t), 1, report->fp);
+    for(i = 0; i < report->strings_count; i++) {
+        len = strnlen(report->strings[i], UINT16_MAX);
+        fwrite(&len, sizeof(len), 1, report->fp);
+        fwrite(report->strings[i], len, 1, report->fp);
+    }
+    trailer.strings_offset = offset;
+    memcpy(trailer.magic, BBL_REPORT_END_MAGIC, sizeof(BBL_REPORT_END_MAGIC));
+    fwrite(&trailer, sizeof(trailer), 1, report->fp);
+
+    if(ferror(report->fp)) {
+        LOG(ERROR, "Failed to write binary report file %s\n", report->filename);
+    }
+    fclose(report->fp);
+    chmod(report->filename, 0666);
+
+    free(report->filename);
+    free(report->chunk);
+    free(report->strings);
+    free(report->strings_hash);
+    free(report);
+    g_report = NULL;
+}
@@ -0,0 +1,23 @@
+/*
+ * BNG Blaster (BBL) - Binary Report
+ *
+ * agent, October 2026
+ *
+ * Copyright (C) 2020-2025, RtBrick, Inc.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef __BBL_REPORT_H__
+#define __BBL_REPORT_H__
+
+#include "bbl_report_def.h"
+
+bool
+bbl_report_open(const char *filename);
+
+void
+bbl_report_stream(bbl_stream_s *stream);
+
+void
+bbl_report_close();
+
+#endif
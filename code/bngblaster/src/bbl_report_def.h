@@ -0,0 +1,89 @@
+/*
+ * BNG Blaster (BBL) - Binary Report Format
+ *
+ * The binary report is an alternative to the JSON report for
+ * large numbers of sessions and streams. All values are stored
+ * in host byte order (except addresses) which is verified by
+ * the converter using the byte order mark of the file header.
+ *
+ * FILE    := HEADER SECTION* STRINGS TRAILER
+ * SECTION := SECTION-HEADER FIELD* CHUNK* END-CHUNK
+ * CHUNK   := CHUNK-HEADER RECORD*
+ * STRINGS := SECTION-HEADER (STRINGS) COUNT (LEN STRING)*
+ *
+ * Each record of a section has the same fixed length as
+ * described by the fields of the section (schema). Strings
+ * are stored as index into the string table, which is
+ * written at the end of the file.
+ *
+ * agent, October 2026
+ *
+ * Copyright (C) 2020-2025, RtBrick, Inc.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef __BBL_REPORT_DEF_H__
+#define __BBL_REPORT_DEF_H__
+
+#include <stdint.h>
+
+#define BBL_REPORT_MAGIC            "BBLREPT"
+#define BBL_REPORT_END_MAGIC        "BBLREND"
+#define BBL_REPORT_VERSION          1
+#define BBL_REPORT_BOM              0x0102
+#define BBL_REPORT_FIELD_NAME_LEN   32
+#define BBL_REPORT_CHUNK_RECORDS    4096
+#define BBL_REPORT_STRING_NONE      UINT32_MAX
+
+typedef enum {
+    BBL_REPORT_SECTION_STREAMS = 1,
+    BBL_REPORT_SECTION_SESSIONS = 2,
+    BBL_REPORT_SECTION_STRINGS = 255,
+} bbl_report_section_t;
+
+typedef enum {
+    BBL_REPORT_U8 = 1,
+    BBL_REPORT_U16,
+    BBL_REPORT_U32,
+    BBL_REPORT_U64,
+    BBL_REPORT_I64,
+    BBL_REPORT_F64,
+    BBL_REPORT_STR, /* uint32_t string index */
+    BBL_REPORT_IP, /* IPv6 or IPv4-mapped IPv6 address */
+    BBL_REPORT_IPV6_PREFIX, /* IPv6 address followed by prefix length */
+    BBL_REPORT_MAC,
+} bbl_report_type_t;
+
+typedef struct __attribute__((__packed__)) bbl_report_header_ {
+    char magic[8];
+    uint16_t version;
+    uint16_t bom;
+    uint32_t reserved;
+    int64_t timestamp; /* epoch seconds */
+} bbl_report_header_s;
+
+typedef struct __attribute__((__packed__)) bbl_report_section_ {
+    uint32_t type;
+    uint16_t field_count;
+    uint16_t record_len;
+} bbl_report_section_s;
+
+typedef struct __attribute__((__packed__)) bbl_report_field_ {
+    char name[BBL_REPORT_FIELD_NAME_LEN];
+    uint8_t type;
+    uint8_t len;
+    uint16_t offset;
+} bbl_report_field_s;
+
+typedef struct __attribute__((__packed__)) bbl_report_chunk_ {
+    uint32_t records; /* zero for last chunk of section */
+    uint32_t compression; /* zero for uncompressed */
+    uint32_t len; /* data length */
+    uint32_t reserved;
+} bbl_report_chunk_s;
+
+typedef struct __attribute__((__packed__)) bbl_report_trailer_ {
+    uint64_t strings_offset;
+    char magic[8];
+} bbl_report_trailer_s;
+
+#endif
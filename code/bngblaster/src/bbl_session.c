@@ -188,7 +188,7 @@ bbl_session_monkey_pppoe(bbl_session_s *session) {
         case 40:
             /* Send random terminate request */
             session->lcp_request_code = PPP_CODE_TERM_REQUEST;
-            session->lcp_options_len = 0;
+            session->ppp->lcp_options_len = 0;
             session->send_requests |= BBL_SEND_LCP_REQUEST;
             bbl_session_tx_qnode_insert(session);
             break;
@@ -303,6 +303,31 @@ bbl_session_get(uint32_t session_id)
     return &g_ctx->session_list[session_id-1];
 }
 
+/**
+ * bbl_session_igmp
+ *
+ * Get the IGMP state of a session, which is
+ * allocated on first use (join or zapping).
+ *
+ * @param session session
+ * @return IGMP state or NULL if allocation failed
+ */
+bbl_session_igmp_s *
+bbl_session_igmp(bbl_session_s *session)
+{
+    bbl_session_igmp_s *igmp = session->igmp;
+    if(!igmp) {
+        igmp = calloc(1, sizeof(bbl_session_igmp_s));
+        if(!igmp) {
+            LOG(ERROR, "IGMP (ID: %u) failed to allocate IGMP state\n", session->session_id);
+            return NULL;
+        }
+        igmp->zapping_group_max = be32toh(g_ctx->config.igmp_group) + ((g_ctx->config.igmp_group_count - 1) * be32toh(g_ctx->config.igmp_group_iter));
+        session->igmp = igmp;
+    }
+    return igmp;
+}
+
 void
 bbl_session_free(bbl_session_s *session) 
 {
@@ -334,6 +359,18 @@ bbl_session_free(bbl_session_s *session)
         free(session->cfm);
         session->cfm = NULL;
     }
+    if(session->igmp) {
+        free(session->igmp);
+        session->igmp = NULL;
+    }
+    if(session->dhcpv6) {
+        free(session->dhcpv6);
+        session->dhcpv6 = NULL;
+    }
+    if(session->ppp) {
+        free(session->ppp);
+        session->ppp = NULL;
+    }
 
     if(session->pppoe_ac_cookie) {
         free(session->pppoe_ac_cookie);
@@ -360,6 +397,26 @@ bbl_session_free(bbl_session_s *session)
     }
 }
 
+/**
+ * bbl_session_pending_update
+ *
+ * Update session in pending bitmap, which contains
+ * all sessions not established or with session traffic
+ * flows not verified.
+ *
+ * @param session session
+ */
+void
+bbl_session_pending_update(bbl_session_s *session)
+{
+    if(session->session_state != BBL_ESTABLISHED ||
+       session->session_traffic.flows != session->session_traffic.flows_verified) {
+        bbl_bitmap_set(&g_ctx->sessions_pending, session->session_id-1);
+    } else {
+        bbl_bitmap_clear(&g_ctx->sessions_pending, session->session_id-1);
+    }
+}
+
 /**
  * bbl_session_reset
  * 
@@ -378,7 +435,9 @@ bbl_session_reset(bbl_session_s *session) {
 
     session->pppoe_retries = 0;
     session->lcp_retries = 0;
-    session->lcp_options_len = 0;
+    if(session->ppp) {
+        session->ppp->lcp_options_len = 0;
+    }
     session->lcp_response_code = 0;
     session->lcp_request_code = 0;
     session->auth_protocol = 0;
@@ -417,19 +476,23 @@ bbl_session_reset(bbl_session_s *session) {
     }
     session->dhcpv6_requested = false;
     session->dhcpv6_established = false;
-    session->dhcpv6_ia_na_option_len = 0;
-    session->dhcpv6_ia_pd_option_len = 0;
+    if(session->dhcpv6) {
+        session->dhcpv6->ia_na_option_len = 0;
+        session->dhcpv6->ia_pd_option_len = 0;
+    }
     memset(session->ipv6_address, 0x0, IPV6_ADDR_LEN);
     memset(session->delegated_ipv6_address, 0x0, IPV6_ADDR_LEN);
     memset(session->ipv6_dns1, 0x0, IPV6_ADDR_LEN);
     memset(session->ipv6_dns2, 0x0, IPV6_ADDR_LEN);
     memset(session->dhcpv6_dns1, 0x0, IPV6_ADDR_LEN);
     memset(session->dhcpv6_dns2, 0x0, IPV6_ADDR_LEN);
-    session->zapping_joined_group = NULL;
-    session->zapping_leaved_group = NULL;
-    session->zapping_count = 0;
-    session->zapping_view_start_time.tv_sec = 0;
-    session->zapping_view_start_time.tv_nsec = 0;
+    if(session->igmp) {
+        session->igmp->zapping_joined_group = NULL;
+        session->igmp->zapping_leaved_group = NULL;
+        session->igmp->zapping_count = 0;
+        session->igmp->zapping_view_start_time.tv_sec = 0;
+        session->igmp->zapping_view_start_time.tv_nsec = 0;
+    }
 
     if(session->reply_message) {
         free(session->reply_message);
@@ -453,6 +516,7 @@ bbl_session_reset(bbl_session_s *session) {
         g_ctx->stats.session_traffic_flows_verified -= session->session_traffic.flows_verified;
     }
     session->session_traffic.flows_verified = 0;
+    bbl_session_pending_update(session);
 
     ENABLE_ENDPOINT(session->endpoint.ipv4);
     ENABLE_ENDPOINT(session->endpoint.ipv6);
@@ -527,6 +591,7 @@ bbl_session_update_state(bbl_session_s *session, session_state_t new_state)
         /* State has changed ... */
         session->session_state = new_state;
         session->version++;
+        bbl_session_pending_update(session);
         assert(session->session_state > BBL_IDLE && session->session_state < BBL_MAX);
 
         if(old_state == BBL_ESTABLISHED) {
@@ -690,7 +755,7 @@ bbl_session_clear(bbl_session_s *session)
             case BBL_PPP_TERMINATING:
                 bbl_session_update_state(session, BBL_PPP_TERMINATING);
                 session->lcp_request_code = PPP_CODE_TERM_REQUEST;
-                session->lcp_options_len = 0;
+                session->ppp->lcp_options_len = 0;
                 session->lcp_state = BBL_PPP_TERMINATE;
                 session->send_requests |= BBL_SEND_LCP_REQUEST;
                 bbl_session_tx_qnode_insert(session);
@@ -805,6 +870,10 @@ bbl_sessions_init()
 
     /* Init list of sessions */
     g_ctx->session_list = calloc(g_ctx->config.sessions, sizeof(bbl_session_s));
+    if(g_ctx->config.sessions && !bbl_bitmap_init(&g_ctx->sessions_pending, g_ctx->config.sessions, false)) {
+        LOG_NOARG(ERROR, "Failed to create session pending bitmap!\n");
+        return false;
+    }
     access_config = g_ctx->config.access_config;
 
     /* For equal distribution of sessions over access configurations
@@ -911,11 +980,6 @@ bbl_sessions_init()
         session->link_local_ipv6_address[14] = session->client_mac[4];
         session->link_local_ipv6_address[15] = session->client_mac[5];
 
-        /* Set DHCPv6 DUID */
-        session->dhcpv6_duid[1] = 3;
-        session->dhcpv6_duid[3] = 1;
-        memcpy(&session->dhcpv6_duid[4], session->client_mac, ETH_ADDR_LEN);
-
         /* Init string variables/iterators */
         update_strings(NULL, NULL, &i, access_config);
 
@@ -976,10 +1040,14 @@ bbl_sessions_init()
         session->igmp_autostart = access_config->igmp_autostart;
         session->igmp_version = access_config->igmp_version;
         session->igmp_robustness = 2; /* init robustness with 2 */
-        session->zapping_group_max = be32toh(g_ctx->config.igmp_group) + ((g_ctx->config.igmp_group_count - 1) * be32toh(g_ctx->config.igmp_group_iter));
 
         /* Set access type specific values */
         if(session->access_type == ACCESS_TYPE_PPPOE) {
+            session->ppp = calloc(1, sizeof(bbl_session_ppp_s));
+            if(!session->ppp) {
+                LOG(ERROR, "Failed to create session %u (PPP)!\n", i);
+                return false;
+            }
             session->mru = access_config->ppp_mru;
             session->magic_number = htobe32(i);
             session->lcp_state = BBL_PPP_CLOSED;
@@ -1031,7 +1099,19 @@ bbl_sessions_init()
         }
         session->access_interface = access_config->access_interface;
         session->network_interface = bbl_network_interface_get(access_config->network_interface);
-        
+
+        if(session->dhcpv6_state != BBL_DHCP_DISABLED) {
+            session->dhcpv6 = calloc(1, sizeof(bbl_session_dhcpv6_s));
+            if(!session->dhcpv6) {
+                LOG(ERROR, "Failed to create session %u (DHCPv6)!\n", i);
+                return false;
+            }
+            /* Set DHCPv6 DUID */
+            session->dhcpv6->duid[1] = 3;
+            session->dhcpv6->duid[3] = 1;
+            memcpy(&session->dhcpv6->duid[4], session->client_mac, ETH_ADDR_LEN);
+        }
+
         if(g_ctx->config.sessions_autostart) {
             session->session_state = BBL_IDLE;
             CIRCLEQ_INSERT_TAIL(&g_ctx->sessions_idle_qhead, session, session_idle_qnode);
@@ -1077,6 +1157,7 @@ bbl_sessions_init()
             return false;
         }
         bbl_session_traffic_enable(access_config->session_traffic_autostart, session, BBL_DIRECTION_BOTH);
+        bbl_session_pending_update(session);
 
         if(!bbl_tcp_session_init(session)) {
             LOG_NOARG(ERROR, "Failed to create session TCP interface!\n");
@@ -1457,36 +1538,53 @@ bbl_session_json(bbl_session_s *session)
 /* Control Socket Commands */
 
 int
-bbl_session_ctrl_pending(int fd, uint32_t session_id __attribute__((unused)), json_t *arguments __attribute__((unused)))
+bbl_session_ctrl_pending(int fd, uint32_t session_id __attribute__((unused)), json_t *arguments)
 {
     int result = 0;
     json_t *root, *json_session, *json_sessions;
 
     bbl_session_s *session;
-    uint32_t i;
+    json_int_t cursor = 1;
+    json_int_t limit = 0;
+    json_int_t count = 0;
+    uint32_t bit;
+
+    json_unpack(arguments, "{s:I}", "cursor", &cursor);
+    json_unpack(arguments, "{s:I}", "limit", &limit);
+    if(cursor < 1) {
+        return bbl_ctrl_status(fd, "error", 400, "invalid cursor");
+    }
+    if(limit < 0) {
+        return bbl_ctrl_status(fd, "error", 400, "invalid limit");
+    }
 
     json_sessions = json_array();
 
-    /* Iterate over all sessions */
-    for(i = 0; i < g_ctx->sessions; i++) {
-        session = &g_ctx->session_list[i];
-        if(!session) continue;
-        
-        if(session->session_state != BBL_ESTABLISHED || 
-           session->session_traffic.flows != session->session_traffic.flows_verified) {
-            json_session = json_pack("{si ss si si}",
-                                     "session-id", session->session_id,
-                                     "session-state", session_state_string(session->session_state),
-                                     "session-traffic-flows", session->session_traffic.flows,
-                                     "session-traffic-flows-verified", session->session_traffic.flows_verified);
-            json_array_append_new(json_sessions, json_session);
+    /* Iterate over all pending sessions (session-id >= cursor) */
+    bit = bbl_bitmap_next(&g_ctx->sessions_pending, cursor > UINT32_MAX ? BBL_BITMAP_END : cursor-1);
+    while(bit != BBL_BITMAP_END) {
+        if(limit && count == limit) {
+            break;
         }
-    }
-
-    root = json_pack("{ss si so}",
+        session = &g_ctx->session_list[bit];
+        json_session = json_pack("{si ss si si}",
+                                 "session-id", session->session_id,
+                                 "session-state", session_state_string(session->session_state),
+                                 "session-traffic-flows", session->session_traffic.flows,
+                                 "session-traffic-flows-verified", session->session_traffic.flows_verified);
+        json_array_append_new(json_sessions, json_session);
+        count++;
+        bit = bbl_bitmap_next(&g_ctx->sessions_pending, bit+1);
+    }
+
+    root = json_pack("{ss si so si}",
                      "status", "ok",
                      "code", 200,
-                     "sessions-pending", json_sessions);
+                     "sessions-pending", json_sessions,
+                     "sessions-pending-count", g_ctx->sessions_pending.count);
+    if(root && bit != BBL_BITMAP_END) {
+        json_object_set_new(root, "next-cursor", json_integer(bit+1));
+    }
     if(root) {
         result = json_dumpfd(root, fd, 0);
         json_decref(root);
@@ -1912,6 +2010,7 @@ bbl_session_ctrl_traffic_reset(int fd, uint32_t session_id __attribute__((unused
                 g_ctx->stats.session_traffic_flows_verified -= session->session_traffic.flows_verified;
             }
             session->session_traffic.flows_verified = 0;
+            bbl_session_pending_update(session);
             bbl_stream_reset(session->session_traffic.ipv4_up);
             bbl_stream_reset(session->session_traffic.ipv4_down);
             bbl_stream_reset(session->session_traffic.ipv6_up);
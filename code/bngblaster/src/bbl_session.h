@@ -16,6 +16,59 @@ typedef struct vlan_session_key_ {
     uint16_t inner_vlan_id;
 } __attribute__ ((__packed__)) vlan_session_key_t;
 
+/*
+ * IGMP state of a session, allocated on first
+ * join via bbl_session_igmp to keep the session
+ * structure compact if IGMP is not used.
+ */
+typedef struct bbl_session_igmp_
+{
+    bbl_igmp_group_s groups[IGMP_MAX_GROUPS];
+
+    /* IGMP Zapping */
+    bbl_igmp_group_s *zapping_joined_group;
+    bbl_igmp_group_s *zapping_leaved_group;
+    uint32_t zapping_group_max;
+    uint8_t  zapping_count;
+    uint64_t zapping_join_delay_sum;
+    uint32_t zapping_join_count;
+    uint64_t zapping_leave_delay_sum;
+    uint32_t zapping_leave_count;
+    struct timespec zapping_view_start_time;
+
+    /* Multicast Traffic */
+    uint64_t mc_rx_last_seq;
+} bbl_session_igmp_s;
+
+/*
+ * PPP option buffers of a session,
+ * allocated only for PPPoE sessions.
+ */
+typedef struct bbl_session_ppp_
+{
+    uint8_t  lcp_options[PPP_OPTIONS_BUFFER];
+    uint16_t lcp_options_len;
+    uint8_t  ipcp_options[PPP_OPTIONS_BUFFER];
+    uint16_t ipcp_options_len;
+    uint8_t  ip6cp_options[PPP_OPTIONS_BUFFER];
+    uint16_t ip6cp_options_len;
+} bbl_session_ppp_s;
+
+/*
+ * DHCPv6 buffers of a session, allocated
+ * only if DHCPv6 is enabled for the session.
+ */
+typedef struct bbl_session_dhcpv6_
+{
+    uint8_t duid[DUID_LEN];
+    uint8_t server_duid[DHCPV6_BUFFER];
+    uint8_t server_duid_len;
+    uint8_t ia_na_option[DHCPV6_BUFFER];
+    uint8_t ia_na_option_len;
+    uint8_t ia_pd_option[DHCPV6_BUFFER];
+    uint8_t ia_pd_option_len;
+} bbl_session_dhcpv6_s;
+
 /*
  * Client Session to a BNG device
  */
@@ -123,7 +176,7 @@ typedef struct bbl_session_
 
     /* TCP */
     bbl_http_client_s *http_client;
-    struct netif netif; /* LwIP interface */
+    struct netif *netif; /* LwIP interface (allocated if TCP is enabled) */
     
     /* Ethernet */
     uint8_t server_mac[ETH_ADDR_LEN];
@@ -133,6 +186,7 @@ typedef struct bbl_session_
     bbl_cfm_session_s *cfm;
 
     /* PPPoE */
+    bbl_session_ppp_s *ppp;
     uint16_t pppoe_session_id;
     uint8_t *pppoe_ac_cookie;
     uint16_t pppoe_ac_cookie_len;
@@ -145,8 +199,6 @@ typedef struct bbl_session_
     ppp_state_t lcp_state;
     uint8_t     lcp_response_code;
     uint8_t     lcp_request_code;
-    uint8_t     lcp_options[PPP_OPTIONS_BUFFER];
-    uint16_t    lcp_options_len;
     uint8_t     lcp_identifier;
     uint8_t     lcp_peer_identifier;
     uint8_t     lcp_retries;
@@ -165,8 +217,6 @@ typedef struct bbl_session_
     ppp_state_t ipcp_state;
     uint8_t     ipcp_response_code;
     uint8_t     ipcp_request_code;
-    uint8_t     ipcp_options[PPP_OPTIONS_BUFFER];
-    uint16_t    ipcp_options_len;
     uint8_t     ipcp_identifier;
     uint8_t     ipcp_peer_identifier;
     uint8_t     ipcp_retries;
@@ -177,8 +227,6 @@ typedef struct bbl_session_
     ppp_state_t ip6cp_state;
     uint8_t     ip6cp_response_code;
     uint8_t     ip6cp_request_code;
-    uint8_t     ip6cp_options[PPP_OPTIONS_BUFFER];
-    uint16_t    ip6cp_options_len;
     uint8_t     ip6cp_identifier;
     uint8_t     ip6cp_peer_identifier;
     uint8_t     ip6cp_retries;
@@ -229,9 +277,7 @@ typedef struct bbl_session_
     bool dhcpv6_requested;
     bool dhcpv6_established;
     uint8_t dhcpv6_retry;
-    uint8_t dhcpv6_duid[DUID_LEN];
-    uint8_t dhcpv6_server_duid[DHCPV6_BUFFER];
-    uint8_t dhcpv6_server_duid_len;
+    bbl_session_dhcpv6_s *dhcpv6;
     ipv6addr_t dhcpv6_dns1;
     ipv6addr_t dhcpv6_dns2;
     uint32_t dhcpv6_xid;
@@ -240,10 +286,6 @@ typedef struct bbl_session_
     uint32_t dhcpv6_t2;
     uint32_t dhcpv6_ia_na_iaid;
     uint32_t dhcpv6_ia_pd_iaid;
-    uint8_t dhcpv6_ia_na_option[DHCPV6_BUFFER];
-    uint8_t dhcpv6_ia_na_option_len;
-    uint8_t dhcpv6_ia_pd_option[DHCPV6_BUFFER];
-    uint8_t dhcpv6_ia_pd_option_len;
     struct timespec dhcpv6_lease_timestamp;
     struct timespec dhcpv6_request_timestamp;
 
@@ -251,21 +293,7 @@ typedef struct bbl_session_
     bool     igmp_autostart;
     uint8_t  igmp_version;
     uint8_t  igmp_robustness;
-    bbl_igmp_group_s igmp_groups[IGMP_MAX_GROUPS];
-
-    /* IGMP Zapping */
-    bbl_igmp_group_s *zapping_joined_group;
-    bbl_igmp_group_s *zapping_leaved_group;
-    uint32_t zapping_group_max;
-    uint8_t  zapping_count;
-    uint64_t zapping_join_delay_sum;
-    uint32_t zapping_join_count;
-    uint64_t zapping_leave_delay_sum;
-    uint32_t zapping_leave_count;
-    struct timespec zapping_view_start_time;
-
-    /* Multicast Traffic */
-    uint64_t mc_rx_last_seq;
+    bbl_session_igmp_s *igmp;
 
     struct {
         uint16_t group_id;
@@ -373,12 +401,18 @@ bbl_session_ncp_close(bbl_session_s *session, bool ipcp);
 bbl_session_s *
 bbl_session_get(uint32_t session_id);
 
+bbl_session_igmp_s *
+bbl_session_igmp(bbl_session_s *session);
+
 void
 bbl_session_free(bbl_session_s *session);
 
 void
 bbl_session_update_state(bbl_session_s *session, session_state_t state);
 
+void
+bbl_session_pending_update(bbl_session_s *session);
+
 void
 bbl_session_clear(bbl_session_s *session);
 
@@ -65,6 +65,9 @@ bbl_stats_generate_interface(io_handle_s *io, bbl_interface_stats_s *stats)
         stats->to_long += io->stats.to_long;
         stats->no_buffer += io->stats.no_buffer;
         stats->polled += io->stats.polled;
+        stats->work_ns += io->stats.work_ns;
+        stats->poll_ns += io->stats.poll_ns;
+        stats->sleep_ns += io->stats.sleep_ns;
         io = io->next;
     }
 }
@@ -81,7 +84,7 @@ bbl_stats_generate_multicast(bbl_stats_s *stats, bool reset)
     /* Iterate over all sessions */
     for(i = 0; i < g_ctx->sessions; i++) {
         session = &g_ctx->session_list[i];
-        if(session) {
+        if(session && session->igmp) {
             /* Multicast */
             stats->mc_old_rx_after_first_new += session->stats.mc_old_rx_after_first_new;
             stats->mc_not_received += session->stats.mc_not_received;
@@ -115,15 +118,15 @@ bbl_stats_generate_multicast(bbl_stats_s *stats, bool reset)
             stats->join_delay_violations_1s += session->stats.join_delay_violations_1s;
             stats->join_delay_violations_2s += session->stats.join_delay_violations_2s;
 
-            stats->zapping_join_count += session->zapping_join_count;
-            stats->zapping_leave_count += session->zapping_leave_count;
+            stats->zapping_join_count += session->igmp->zapping_join_count;
+            stats->zapping_leave_count += session->igmp->zapping_leave_count;
 
             if(reset) {
-                session->zapping_count = 0;
-                session->zapping_join_delay_sum = 0;
-                session->zapping_join_count = 0;
-                session->zapping_leave_delay_sum = 0;
-                session->zapping_leave_count = 0;
+                session->igmp->zapping_count = 0;
+                session->igmp->zapping_join_delay_sum = 0;
+                session->igmp->zapping_join_count = 0;
+                session->igmp->zapping_leave_delay_sum = 0;
+                session->igmp->zapping_leave_count = 0;
                 session->stats.min_join_delay = 0;
                 session->stats.avg_join_delay = 0;
                 session->stats.max_join_delay = 0;
@@ -471,6 +474,11 @@ bbl_stats_stdout(bbl_stats_s *stats) {
             if(interface_stats_tx.no_buffer) {
                 printf("  TX No Buffer:      %10lu\n", interface_stats_tx.no_buffer);
             }
+            if(interface_stats_tx.work_ns || interface_stats_tx.poll_ns || interface_stats_tx.sleep_ns) {
+                printf("  TX Threads:        %10lu ms work %10lu ms poll %10lu ms sleep\n",
+                    interface_stats_tx.work_ns / MSEC, interface_stats_tx.poll_ns / MSEC,
+                    interface_stats_tx.sleep_ns / MSEC);
+            }
             printf("  RX:                %10lu packets %16lu bytes\n",
                 interface_stats_rx.packets, interface_stats_rx.bytes);
             printf("  RX Protocol Error: %10lu packets\n", interface_stats_rx.protocol_errors);
@@ -482,6 +490,11 @@ bbl_stats_stdout(bbl_stats_s *stats) {
             if(interface_stats_rx.no_buffer) {
                 printf("  RX No Buffer:      %10lu\n", interface_stats_rx.no_buffer);
             }
+            if(interface_stats_rx.work_ns || interface_stats_rx.poll_ns || interface_stats_rx.sleep_ns) {
+                printf("  RX Threads:        %10lu ms work %10lu ms poll %10lu ms sleep\n",
+                    interface_stats_rx.work_ns / MSEC, interface_stats_rx.poll_ns / MSEC,
+                    interface_stats_rx.sleep_ns / MSEC);
+            }
         }
 
         if(interface->type == LAG_MEMBER_INTERFACE && 
@@ -871,6 +884,9 @@ bbl_stats_json(bbl_stats_s * stats)
             json_object_set_new(jobj_sub, "tx-io-error", json_integer(interface_stats_tx.io_errors));
             json_object_set_new(jobj_sub, "tx-to-long", json_integer(interface_stats_tx.to_long));
             json_object_set_new(jobj_sub, "tx-no-buffer", json_integer(interface_stats_tx.no_buffer));
+            json_object_set_new(jobj_sub, "tx-thread-work-ms", json_integer(interface_stats_tx.work_ns / MSEC));
+            json_object_set_new(jobj_sub, "tx-thread-poll-ms", json_integer(interface_stats_tx.poll_ns / MSEC));
+            json_object_set_new(jobj_sub, "tx-thread-sleep-ms", json_integer(interface_stats_tx.sleep_ns / MSEC));
 
             json_object_set_new(jobj_sub, "rx-packets", json_integer(interface_stats_rx.packets));
             json_object_set_new(jobj_sub, "rx-bytes", json_integer(interface_stats_rx.bytes));
@@ -879,6 +895,18 @@ bbl_stats_json(bbl_stats_s * stats)
             json_object_set_new(jobj_sub, "rx-polled", json_integer(interface_stats_rx.bytes));
             json_object_set_new(jobj_sub, "rx-io-error", json_integer(interface_stats_rx.io_errors));
             json_object_set_new(jobj_sub, "rx-no-buffer", json_integer(interface_stats_rx.no_buffer));
+            json_object_set_new(jobj_sub, "rx-thread-work-ms", json_integer(interface_stats_rx.work_ns / MSEC));
+            json_object_set_new(jobj_sub, "rx-thread-poll-ms", json_integer(interface_stats_rx.poll_ns / MSEC));
+            json_object_set_new(jobj_sub, "rx-thread-sleep-ms", json_integer(interface_stats_rx.sleep_ns / MSEC));
+
+            jobj_sub2 = io_profile_json(interface->io.tx);
+            if(jobj_sub2) {
+                json_object_set_new(jobj_sub, "tx-profile", jobj_sub2);
+            }
+            jobj_sub2 = io_profile_json(interface->io.rx);
+            if(jobj_sub2) {
+                json_object_set_new(jobj_sub, "rx-profile", jobj_sub2);
+            }
         }
         if(interface->type == LAG_MEMBER_INTERFACE && 
            interface->lag_member->lacp_state) {
@@ -1245,4 +1273,77 @@ bbl_compute_avg_rate(bbl_rate_s *rate, uint64_t current_value)
     }
 
     rate->last_value = current_value;
-}
\ No newline at end of file
+}
+
+/* Outage histogram bucket upper bounds in milliseconds. */
+static const uint32_t g_outage_bucket_ms[BBL_OUTAGE_BUCKETS-1] = {
+    1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 5000
+};
+
+/**
+ * bbl_outage_add
+ *
+ * Add outage to histogram. This function might be
+ * called from multiple RX threads concurrently.
+ *
+ * @param outage outage histogram
+ * @param duration_ns outage duration in nanoseconds
+ */
+void
+bbl_outage_add(bbl_outage_s *outage, uint64_t duration_ns)
+{
+    uint64_t max_ns = __atomic_load_n(&outage->max_ns, __ATOMIC_RELAXED);
+    uint8_t bucket = 0;
+
+    while(bucket < BBL_OUTAGE_BUCKETS-1 &&
+          duration_ns > (uint64_t)g_outage_bucket_ms[bucket] * MSEC) {
+        bucket++;
+    }
+    __atomic_fetch_add(&outage->buckets[bucket], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&outage->count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&outage->total_ns, duration_ns, __ATOMIC_RELAXED);
+    while(duration_ns > max_ns) {
+        if(__atomic_compare_exchange_n(&outage->max_ns, &max_ns, duration_ns, true,
+                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+}
+
+void
+bbl_outage_sum(bbl_outage_s *sum, bbl_outage_s *outage)
+{
+    uint8_t bucket;
+
+    sum->count += outage->count;
+    sum->total_ns += outage->total_ns;
+    if(outage->max_ns > sum->max_ns) {
+        sum->max_ns = outage->max_ns;
+    }
+    for(bucket = 0; bucket < BBL_OUTAGE_BUCKETS; bucket++) {
+        sum->buckets[bucket] += outage->buckets[bucket];
+    }
+}
+
+json_t *
+bbl_outage_json(bbl_outage_s *outage)
+{
+    json_t *histogram;
+    char key[16];
+    uint8_t bucket;
+
+    histogram = json_object();
+    for(bucket = 0; bucket < BBL_OUTAGE_BUCKETS; bucket++) {
+        if(bucket < BBL_OUTAGE_BUCKETS-1) {
+            snprintf(key, sizeof(key), "le-%ums", g_outage_bucket_ms[bucket]);
+        } else {
+            snprintf(key, sizeof(key), "gt-%ums", g_outage_bucket_ms[bucket-1]);
+        }
+        json_object_set_new(histogram, key, json_integer(outage->buckets[bucket]));
+    }
+    return json_pack("{sI sf sf so}",
+                     "outages", outage->count,
+                     "outage-max-ms", (double)outage->max_ns / MSEC,
+                     "outage-total-ms", (double)outage->total_ns / MSEC,
+                     "histogram", histogram);
+}
@@ -21,6 +21,14 @@ typedef struct bbl_rate_
     uint64_t avg_max;
 } bbl_rate_s;
 
+typedef struct bbl_outage_
+{
+    uint64_t count;
+    uint64_t max_ns;
+    uint64_t total_ns;
+    uint64_t buckets[BBL_OUTAGE_BUCKETS];
+} bbl_outage_s;
+
 typedef struct bbl_stats_ 
 {
     /* Multicast */
@@ -153,11 +161,23 @@ typedef struct bbl_interface_stats_ {
     uint64_t to_long;
     uint64_t no_buffer;
     uint64_t polled;
+    uint64_t work_ns;
+    uint64_t poll_ns;
+    uint64_t sleep_ns;
 } bbl_interface_stats_s;
 
 void 
 bbl_compute_avg_rate(bbl_rate_s *rate, uint64_t current_value);
 
+void
+bbl_outage_add(bbl_outage_s *outage, uint64_t duration_ns);
+
+void
+bbl_outage_sum(bbl_outage_s *sum, bbl_outage_s *outage);
+
+json_t *
+bbl_outage_json(bbl_outage_s *outage);
+
 void 
 bbl_stats_update_cps();
 
@@ -49,13 +49,19 @@ bbl_stream_index_init()
     bbl_stream_s *stream = g_ctx->stream_head;
 
     g_ctx->stream_index = calloc(g_ctx->streams, sizeof(bbl_stream_s*));
-    
+    if(g_ctx->streams && !bbl_bitmap_init(&g_ctx->streams_pending, g_ctx->streams, false)) {
+        return false;
+    }
+
     while(stream) {
         flow_id = stream->flow_id;
         if(flow_id > g_ctx->streams || flow_id < 1) {
             return false;
         }
         g_ctx->stream_index[flow_id-1] = stream;
+        if(!stream->verified) {
+            bbl_bitmap_set(&g_ctx->streams_pending, flow_id-1);
+        }
         stream = stream->next;
     }
     return true;
@@ -83,6 +89,85 @@ bbl_stream_delay(bbl_stream_s *stream, struct timespec *rx_timestamp, struct tim
     }
 }
 
+/**
+ * bbl_stream_tx_buf
+ *
+ * Packet buffers are allocated once per stream from 
+ * the arena of the TX IO handle and reused, such that 
+ * packets are rebuilt in place after invalidation
+ * (tx_buf set to NULL) without free/malloc cycles.
+ *
+ * @param stream stream
+ * @param len required buffer length
+ * @return packet buffer or NULL
+ */
+static uint8_t *
+bbl_stream_tx_buf(bbl_stream_s *stream, uint16_t len)
+{
+    if(len > stream->tx_buf_size) {
+        stream->tx_mem = bbl_arena_alloc(&stream->io->stream_arena, len);
+        if(!stream->tx_mem) {
+            stream->tx_buf_size = 0;
+            return NULL;
+        }
+        stream->tx_buf_size = len;
+    }
+    return stream->tx_mem;
+}
+
+/**
+ * bbl_stream_alloc
+ *
+ * Streams are never freed and therefore allocated
+ * from arena (cache line aligned) in the main thread.
+ *
+ * @return zeroed stream or NULL
+ */
+static bbl_stream_s *
+bbl_stream_alloc()
+{
+    return bbl_arena_alloc(&g_ctx->stream_arena, sizeof(bbl_stream_s));
+}
+
+/**
+ * bbl_stream_range_ipv6
+ *
+ * Add index times iterator to IPv6 base address.
+ *
+ * @param result resulting IPv6 address
+ * @param base IPv6 base address
+ * @param iter IPv6 address iterator
+ * @param index flow index of stream range
+ */
+static void
+bbl_stream_range_ipv6(uint8_t *result, const uint8_t *base, const uint8_t *iter, uint32_t index)
+{
+    uint64_t carry = 0;
+    int i;
+
+    for(i = IPV6_ADDR_LEN-1; i >= 0; i--) {
+        carry += base[i] + (uint64_t)iter[i] * index;
+        result[i] = carry & 0xff;
+        carry >>= 8;
+    }
+}
+
+/**
+ * bbl_stream_range_ipv4
+ *
+ * Add index times iterator to IPv4 base address.
+ *
+ * @param base IPv4 base address (network byte order)
+ * @param iter IPv4 address iterator (network byte order)
+ * @param index flow index of stream range
+ * @return IPv4 address (network byte order)
+ */
+static uint32_t
+bbl_stream_range_ipv4(uint32_t base, uint32_t iter, uint32_t index)
+{
+    return htobe32(be32toh(base) + be32toh(iter) * index);
+}
+
 static bool
 bbl_stream_build_access_pppoe_packet(bbl_stream_s *stream)
 {
@@ -219,14 +304,16 @@ bbl_stream_build_access_pppoe_packet(bbl_stream_s *stream)
 
     buf_len = config->length + BBL_MAX_STREAM_OVERHEAD;
     if(buf_len < 256) buf_len = 256;
-    stream->tx_buf = malloc(buf_len);
+    stream->tx_buf = bbl_stream_tx_buf(stream, buf_len);
+    if(!stream->tx_buf) {
+        return false;
+    }
     stream->tx_bbl_hdr_len = bbl.padding+BBL_HEADER_LEN;
     stream->ipv4_src = ipv4.src;
     stream->ipv4_dst = ipv4.dst;
     stream->ipv6_src = ipv6.src;
     stream->ipv6_dst = ipv6.dst;
     if(encode_ethernet(stream->tx_buf, &tx_len, &eth) != PROTOCOL_SUCCESS) {
-        free(stream->tx_buf);
         stream->tx_buf = NULL;
         return false;
     }
@@ -358,14 +445,16 @@ bbl_stream_build_a10nsp_pppoe_packet(bbl_stream_s *stream)
 
     buf_len = config->length + BBL_MAX_STREAM_OVERHEAD;
     if(buf_len < 256) buf_len = 256;
-    stream->tx_buf = malloc(buf_len);
+    stream->tx_buf = bbl_stream_tx_buf(stream, buf_len);
+    if(!stream->tx_buf) {
+        return false;
+    }
     stream->tx_bbl_hdr_len = bbl.padding+BBL_HEADER_LEN;
     stream->ipv4_src = ipv4.src;
     stream->ipv4_dst = ipv4.dst;
     stream->ipv6_src = ipv6.src;
     stream->ipv6_dst = ipv6.dst;
     if(encode_ethernet(stream->tx_buf, &tx_len, &eth) != PROTOCOL_SUCCESS) {
-        free(stream->tx_buf);
         stream->tx_buf = NULL;
         return false;
     }
@@ -493,14 +582,16 @@ bbl_stream_build_a10nsp_ipoe_packet(bbl_stream_s *stream)
 
     buf_len = config->length + BBL_MAX_STREAM_OVERHEAD;
     if(buf_len < 256) buf_len = 256;
-    stream->tx_buf = malloc(buf_len);
+    stream->tx_buf = bbl_stream_tx_buf(stream, buf_len);
+    if(!stream->tx_buf) {
+        return false;
+    }
     stream->tx_bbl_hdr_len = bbl.padding+BBL_HEADER_LEN;
     stream->ipv4_src = ipv4.src;
     stream->ipv4_dst = ipv4.dst;
     stream->ipv6_src = ipv6.src;
     stream->ipv6_dst = ipv6.dst;
     if(encode_ethernet(stream->tx_buf, &tx_len, &eth) != PROTOCOL_SUCCESS) {
-        free(stream->tx_buf);
         stream->tx_buf = NULL;
         return false;
     }
@@ -639,14 +730,16 @@ bbl_stream_build_access_ipoe_packet(bbl_stream_s *stream)
 
     buf_len = config->length + BBL_MAX_STREAM_OVERHEAD;
     if(buf_len < 256) buf_len = 256;
-    stream->tx_buf = malloc(buf_len);
+    stream->tx_buf = bbl_stream_tx_buf(stream, buf_len);
+    if(!stream->tx_buf) {
+        return false;
+    }
     stream->tx_bbl_hdr_len = bbl.padding+BBL_HEADER_LEN;
     stream->ipv4_src = ipv4.src;
     stream->ipv4_dst = ipv4.dst;
     stream->ipv6_src = ipv6.src;
     stream->ipv6_dst = ipv6.dst;
     if(encode_ethernet(stream->tx_buf, &tx_len, &eth) != PROTOCOL_SUCCESS) {
-        free(stream->tx_buf);
         stream->tx_buf = NULL;
         return false;
     }
@@ -672,6 +765,7 @@ bbl_stream_build_network_packet(bbl_stream_s *stream)
     bbl_bbl_s bbl = {0};
 
     uint8_t mac[ETH_ADDR_LEN] = {0};
+    uint8_t tos;
 
     bbl_network_interface_s *network_interface = stream->tx_network_interface;
 
@@ -683,6 +777,9 @@ bbl_stream_build_network_packet(bbl_stream_s *stream)
     eth.vlan_outer = network_interface->vlan;
     eth.vlan_outer_priority = config->vlan_priority;
     eth.vlan_inner = 0;
+    if(stream->range_index && config->range_vlan_step) {
+        eth.vlan_outer = (eth.vlan_outer + stream->range_index * config->range_vlan_step) & BBL_ETH_VLAN_ID_MAX;
+    }
 
     /* Add MPLS labels */
     if(config->tx_mpls1 || stream->ldp_entry) {
@@ -690,13 +787,13 @@ bbl_stream_build_network_packet(bbl_stream_s *stream)
         if(stream->ldp_entry) {
             mpls1.label = stream->ldp_entry->label;
         } else {
-            mpls1.label = config->tx_mpls1_label;
+            mpls1.label = (config->tx_mpls1_label + stream->range_index * config->range_mpls1_step) & 0xfffff;
         }
         mpls1.exp = config->tx_mpls1_exp;
         mpls1.ttl = config->tx_mpls1_ttl;
         if(config->tx_mpls2) {
             mpls1.next = &mpls2;
-            mpls2.label = config->tx_mpls2_label;
+            mpls2.label = (config->tx_mpls2_label + stream->range_index * config->range_mpls2_step) & 0xfffff;
             mpls2.exp = config->tx_mpls2_exp;
             mpls2.ttl = config->tx_mpls2_ttl;
         }
@@ -706,8 +803,12 @@ bbl_stream_build_network_packet(bbl_stream_s *stream)
         udp.src = config->dst_port;
         udp.dst = config->src_port;
     } else {
-        udp.src = config->src_port;
-        udp.dst = config->dst_port;
+        udp.src = config->src_port + stream->range_index * config->range_src_port_step;
+        udp.dst = config->dst_port + stream->range_index * config->range_dst_port_step;
+    }
+    tos = config->priority;
+    if(stream->range_index && config->range_dscp_step) {
+        tos = (((tos >> 2) + stream->range_index * config->range_dscp_step) << 2) | (tos & 0x03);
     }
 
     udp.protocol = UDP_PROTOCOL_BBL;
@@ -721,7 +822,7 @@ bbl_stream_build_network_packet(bbl_stream_s *stream)
         bbl.inner_vlan_id = session->vlan_key.inner_vlan_id;
     }
     bbl.flow_id = stream->flow_id;
-    bbl.tos = config->priority;
+    bbl.tos = tos;
     bbl.direction = BBL_DIRECTION_DOWN;
     switch(stream->sub_type) {
         case BBL_SUB_TYPE_IPV4:
@@ -735,12 +836,16 @@ bbl_stream_build_network_packet(bbl_stream_s *stream)
             } else {
                 ipv4.src = network_interface->ip.address;
             }
+            if(stream->range_index && config->range_ipv4_network_iter) {
+                ipv4.src = bbl_stream_range_ipv4(ipv4.src, config->range_ipv4_network_iter, stream->range_index);
+            }
             /* Destination address */
             if(stream->nat && stream->reverse) {
                 ipv4.dst = stream->reverse->rx_source_ip;
                 udp.dst = stream->reverse->rx_source_port;
             } else if(stream->config->ipv4_destination_address) {
-                ipv4.dst = stream->config->ipv4_destination_address;
+                ipv4.dst = bbl_stream_range_ipv4(stream->config->ipv4_destination_address, 
+                                                 config->range_ipv4_destination_iter, stream->range_index);
             } else {
                 if(session) {
                     ipv4.dst = session->ip_address;
@@ -756,7 +861,7 @@ bbl_stream_build_network_packet(bbl_stream_s *stream)
                 ipv4.offset = IPV4_DF;
             }
             ipv4.ttl = config->ttl;
-            ipv4.tos = config->priority;
+            ipv4.tos = tos;
             if(stream->tcp) {
                 ipv4.protocol = PROTOCOL_IPV4_TCP;
             } else {
@@ -799,8 +904,24 @@ bbl_stream_build_network_packet(bbl_stream_s *stream)
                     return false;
                 }
             }
+            if(stream->range_index &&
+               (*(uint64_t*)config->range_ipv6_network_iter || *(uint64_t*)&config->range_ipv6_network_iter[8] ||
+                *(uint64_t*)config->range_ipv6_destination_iter || *(uint64_t*)&config->range_ipv6_destination_iter[8])) {
+                /* Per-flow addresses must persist as those
+                 * are referenced for TCP checksum and stream info. */
+                if(!stream->range_ipv6) {
+                    stream->range_ipv6 = bbl_arena_alloc(&stream->io->stream_arena, IPV6_ADDR_LEN*2);
+                    if(!stream->range_ipv6) {
+                        return false;
+                    }
+                }
+                bbl_stream_range_ipv6(stream->range_ipv6, ipv6.src, config->range_ipv6_network_iter, stream->range_index);
+                bbl_stream_range_ipv6(stream->range_ipv6+IPV6_ADDR_LEN, ipv6.dst, config->range_ipv6_destination_iter, stream->range_index);
+                ipv6.src = stream->range_ipv6;
+                ipv6.dst = stream->range_ipv6+IPV6_ADDR_LEN;
+            }
             ipv6.ttl = config->ttl;
-            ipv6.tos = config->priority;
+            ipv6.tos = tos;
             if(stream->tcp) {
                 ipv6.protocol = IPV6_NEXT_HEADER_TCP;
             } else {
@@ -817,14 +938,16 @@ bbl_stream_build_network_packet(bbl_stream_s *stream)
 
     buf_len = config->length + BBL_MAX_STREAM_OVERHEAD;
     if(buf_len < 256) buf_len = 256;
-    stream->tx_buf = malloc(buf_len);
+    stream->tx_buf = bbl_stream_tx_buf(stream, buf_len);
+    if(!stream->tx_buf) {
+        return false;
+    }
     stream->tx_bbl_hdr_len = bbl.padding+BBL_HEADER_LEN;
     stream->ipv4_src = ipv4.src;
     stream->ipv4_dst = ipv4.dst;
     stream->ipv6_src = ipv6.src;
     stream->ipv6_dst = ipv6.dst;
     if(encode_ethernet(stream->tx_buf, &tx_len, &eth) != PROTOCOL_SUCCESS) {
-        free(stream->tx_buf);
         stream->tx_buf = NULL;
         return false;
     }
@@ -917,12 +1040,14 @@ bbl_stream_build_l2tp_packet(bbl_stream_s *stream)
     }
     buf_len = config->length + BBL_MAX_STREAM_OVERHEAD;
     if(buf_len < 256) buf_len = 256;
-    stream->tx_buf = malloc(buf_len);
+    stream->tx_buf = bbl_stream_tx_buf(stream, buf_len);
+    if(!stream->tx_buf) {
+        return false;
+    }
     stream->tx_bbl_hdr_len = bbl.padding+BBL_HEADER_LEN;
     stream->ipv4_src = ipv4.src;
     stream->ipv4_dst = ipv4.dst;
     if(encode_ethernet(stream->tx_buf, &tx_len, &eth) != PROTOCOL_SUCCESS) {
-        free(stream->tx_buf);
         stream->tx_buf = NULL;
         return false;
     }
@@ -1272,8 +1397,10 @@ bbl_stream_ctrl(bbl_stream_s *stream)
                 if(stream->session_traffic) {
                     if(session) {
                         stream->verified = true;
+                        bbl_bitmap_clear(&g_ctx->streams_pending, stream->flow_id-1);
                         bbl_stream_setup_established(stream);
                         session->session_traffic.flows_verified++;
+                        bbl_session_pending_update(session);
                         g_ctx->stats.session_traffic_flows_verified++;
                         if(g_ctx->stats.session_traffic_flows_verified == g_ctx->stats.session_traffic_flows) {
                             LOG_NOARG(INFO, "ALL SESSION TRAFFIC FLOWS VERIFIED\n");
@@ -1281,6 +1408,7 @@ bbl_stream_ctrl(bbl_stream_s *stream)
                     }
                 } else {
                     stream->verified = true;
+                    bbl_bitmap_clear(&g_ctx->streams_pending, stream->flow_id-1);
                     bbl_stream_setup_established(stream);
                     g_ctx->stats.stream_traffic_flows_verified++;
                     if(g_ctx->stats.stream_traffic_flows_verified == g_ctx->stats.stream_traffic_flows) {
@@ -1304,8 +1432,14 @@ void
 bbl_stream_final()
 {
     bbl_stream_s *stream = g_ctx->stream_head;
+    bool report = false;
+
+    if(g_ctx->config.binary_report_filename) {
+        report = bbl_report_open(g_ctx->config.binary_report_filename);
+    }
     while(stream) {
         bbl_stream_ctrl(stream);
+        if(report) bbl_report_stream(stream);
         stream = stream->next;
     }
 }
@@ -1330,11 +1464,8 @@ bbl_stream_ldp_lookup(bbl_stream_s *stream)
     }
     if(stream->ldp_entry->version != stream->ldp_entry_version) {
         stream->ldp_entry_version = stream->ldp_entry->version;
-        /* Free packet if LDP entry has changed. */
-        if(stream->tx_buf) {
-            free(stream->tx_buf);
-            stream->tx_buf = NULL;
-        }
+        /* Rebuild packet if LDP entry has changed. */
+        stream->tx_buf = NULL;
     }
     return true;
 }
@@ -1359,11 +1490,8 @@ bbl_stream_can_send(bbl_stream_s *stream)
         }
     }
 
-    /* Free packet if not ready to send. */
-    if(stream->tx_buf) {
-        free(stream->tx_buf);
-        stream->tx_buf = NULL;
-    }
+    /* Rebuild packet if ready to send again. */
+    stream->tx_buf = NULL;
     return false;
 }
 
@@ -1503,10 +1631,7 @@ bbl_stream_io_send(bbl_stream_s *stream)
     
     session = stream->session;
     if(session && session->version != stream->session_version) {
-        if(stream->tx_buf) {
-            free(stream->tx_buf);
-            stream->tx_buf = NULL;
-        }
+        stream->tx_buf = NULL;
         stream->session_version = session->version;
     }
 
@@ -1646,23 +1771,39 @@ bbl_stream_group_init(double pps)
 static void
 bbl_stream_add_group(bbl_stream_s *stream)
 {
-    bbl_stream_group_s *group = g_ctx->stream_groups;
+    bbl_stream_group_s *group = g_ctx->stream_groups_open;
+    bbl_stream_group_s *prev = NULL;
+
+    /* Only the last group added per PPS could have free slots,
+     * which keeps the list of open groups short. */
     while(group) {
-        if(group->count < 256 && group->pps == stream->pps) {
+        if(group->pps == stream->pps) {
             break;
         }
-        group = group->next;
+        prev = group;
+        group = group->open_next;
     }
     if(!group) {
         group = bbl_stream_group_init(stream->pps);
         group->next = g_ctx->stream_groups;
         g_ctx->stream_groups = group;
+        group->open_next = g_ctx->stream_groups_open;
+        g_ctx->stream_groups_open = group;
+        prev = NULL;
     }
     stream->group = group;
     stream->group_next = group->head;
 
     group->head = stream;
     group->count++;
+    if(group->count >= BBL_STREAM_GROUP_SIZE) {
+        if(prev) {
+            prev->open_next = group->open_next;
+        } else {
+            g_ctx->stream_groups_open = group->open_next;
+        }
+        group->open_next = NULL;
+    }
 }
 
 static void
@@ -1700,6 +1841,13 @@ bbl_stream_select_io_lag(bbl_stream_s *stream)
     io_stream_add(io, stream);
 }
 
+/**
+ * bbl_stream_select_io
+ *
+ * Select TX IO handle of interface with lowest PPS. 
+ * The stream is added to the IO handle later, therefore
+ * the PPS of selected streams is accumulated separately.
+ */
 static void
 bbl_stream_select_io(bbl_stream_s *stream)
 {
@@ -1708,15 +1856,38 @@ bbl_stream_select_io(bbl_stream_s *stream)
 
     assert(io);
     while(io_iter) {
-        if(io_iter->stream_pps < io->stream_pps) {
+        if(io_iter->stream_pps_selected < io->stream_pps_selected) {
             io = io_iter;
         }
         io_iter = io_iter->next;
     }
+    io->stream_pps_selected += stream->pps;
     if(io->thread) {
         stream->threaded = true;
     }
-    io_stream_add(io, stream);
+    stream->io = io;
+}
+
+/**
+ * bbl_stream_io_init
+ *
+ * Add all streams to the buckets of their TX IO handles,
+ * which were already selected by bbl_stream_select_io.
+ *
+ * @return true if successful
+ */
+bool
+bbl_stream_io_init()
+{
+    bbl_stream_s *stream = g_ctx->stream_head;
+
+    while(stream) {
+        if(!stream->lag) {
+            io_stream_add(stream->io, stream);
+        }
+        stream = stream->next;
+    }
+    return true;
 }
 
 static void
@@ -1726,6 +1897,8 @@ bbl_stream_add(bbl_stream_s *stream)
     if(stream->tx_interface->type == LAG_INTERFACE) {
         bbl_stream_select_io_lag(stream);
     } else {
+        /* Stream is added to the IO handle
+         * later in bbl_stream_io_init. */
         bbl_stream_select_io(stream);
     }
     stream->max_packets = stream->config->max_packets;
@@ -1800,7 +1973,10 @@ bbl_stream_session_add(bbl_stream_config_s *config, bbl_session_s *session)
                 return false;
             }
         }
-        stream_up = calloc(1, sizeof(bbl_stream_s));
+        stream_up = bbl_stream_alloc();
+        if(!stream_up) {
+            return false;
+        }
         stream_up->enabled = config->autostart;
         stream_up->endpoint = &g_endpoint;
         stream_up->flow_id = g_ctx->flow_id++;
@@ -1846,7 +2022,10 @@ bbl_stream_session_add(bbl_stream_config_s *config, bbl_session_s *session)
         }
     }
     if(config->direction & BBL_DIRECTION_DOWN) {
-        stream_down = calloc(1, sizeof(bbl_stream_s));
+        stream_down = bbl_stream_alloc();
+        if(!stream_down) {
+            return false;
+        }
         stream_down->enabled = config->autostart;
         stream_down->endpoint = &g_endpoint;
         stream_down->flow_id = g_ctx->flow_id++;
@@ -1992,8 +2171,10 @@ bbl_stream_init() {
 
     uint32_t group;
     uint32_t source;
+    uint32_t index;
 
-    /* Add RAW streams */
+    /* Add RAW streams, where a stream range expands to one
+     * flow per index all sharing the same configuration. */
     config = g_ctx->config.stream_config;
     while(config) {
         if(config->stream_group_id == 0) {
@@ -2004,44 +2185,50 @@ bbl_stream_init() {
             }
 
             if(config->direction & BBL_DIRECTION_DOWN) {
-                stream = calloc(1, sizeof(bbl_stream_s));
-                stream->enabled = config->autostart;
-                stream->endpoint = &g_endpoint;
-                stream->flow_id = g_ctx->flow_id++;
-                stream->flow_seq = 1;
-                stream->config = config;
-                stream->pps = config->pps;
-                stream->type = BBL_TYPE_UNICAST;
-                stream->sub_type = config->type;
-                if(config->type == BBL_SUB_TYPE_IPV4) {
-                    /* All IPv4 multicast addresses start with 1110 */
-                    if((config->ipv4_destination_address & htobe32(0xf0000000)) == htobe32(0xe0000000)) {
-                        stream->enabled = true;
-                        stream->endpoint = &(g_ctx->multicast_endpoint);
-                        stream->type = BBL_TYPE_MULTICAST;
+                for(index = 0; index < config->range_count; index++) {
+                    stream = bbl_stream_alloc();
+                    if(!stream) {
+                        return false;
                     }
+                    stream->enabled = config->autostart;
+                    stream->endpoint = &g_endpoint;
+                    stream->flow_id = g_ctx->flow_id++;
+                    stream->flow_seq = 1;
+                    stream->config = config;
+                    stream->range_index = index;
+                    stream->pps = config->pps;
+                    stream->type = BBL_TYPE_UNICAST;
+                    stream->sub_type = config->type;
+                    if(config->type == BBL_SUB_TYPE_IPV4) {
+                        /* All IPv4 multicast addresses start with 1110 */
+                        if((config->ipv4_destination_address & htobe32(0xf0000000)) == htobe32(0xe0000000)) {
+                            stream->enabled = true;
+                            stream->endpoint = &(g_ctx->multicast_endpoint);
+                            stream->type = BBL_TYPE_MULTICAST;
+                        }
+                    }
+                    stream->direction = BBL_DIRECTION_DOWN;
+                    stream->tx_network_interface = network_interface;
+                    stream->tx_interface = network_interface->interface;
+                    if(network_interface->ldp_adjacency && 
+                       (config->ipv4_ldp_lookup_address || 
+                        *(uint64_t*)stream->config->ipv6_ldp_lookup_address)) {
+                        stream->ldp_lookup = true;
+                    }
+                    if(config->raw_tcp) {
+                        stream->tcp = true;
+                    }
+                    bbl_stream_add(stream);
+                    if(stream->type == BBL_TYPE_MULTICAST) {
+                        LOG(DEBUG, "RAW multicast traffic stream %s added to %s with %0.2lf PPS\n", 
+                            config->name, network_interface->name, stream->pps);
+                    } else {
+                        g_ctx->stats.stream_traffic_flows++;
+                        LOG(DEBUG, "RAW traffic stream %s added to %s with %0.2lf PPS\n", 
+                            config->name, network_interface->name, stream->pps);
+                    }
+                    g_ctx->stats.raw_traffic_flows++;
                 }
-                stream->direction = BBL_DIRECTION_DOWN;
-                stream->tx_network_interface = network_interface;
-                stream->tx_interface = network_interface->interface;
-                if(network_interface->ldp_adjacency && 
-                   (config->ipv4_ldp_lookup_address || 
-                    *(uint64_t*)stream->config->ipv6_ldp_lookup_address)) {
-                    stream->ldp_lookup = true;
-                }
-                if(config->raw_tcp) {
-                    stream->tcp = true;
-                }
-                bbl_stream_add(stream);
-                if(stream->type == BBL_TYPE_MULTICAST) {
-                    LOG(DEBUG, "RAW multicast traffic stream %s added to %s with %0.2lf PPS\n", 
-                        config->name, network_interface->name, stream->pps);
-                } else {
-                    g_ctx->stats.stream_traffic_flows++;
-                    LOG(DEBUG, "RAW traffic stream %s added to %s with %0.2lf PPS\n", 
-                        config->name, network_interface->name, stream->pps);
-                }
-                g_ctx->stats.raw_traffic_flows++;
             }
         }
         config = config->next;
@@ -2082,7 +2269,10 @@ bbl_stream_init() {
             config->ipv4_destination_address = group;
             config->ipv4_network_address = source;
 
-            stream = calloc(1, sizeof(bbl_stream_s));
+            stream = bbl_stream_alloc();
+            if(!stream) {
+                return false;
+            }
             stream->enabled = true;
             stream->endpoint = &(g_ctx->multicast_endpoint);
             stream->flow_id = g_ctx->flow_id++;
@@ -2251,12 +2441,37 @@ bbl_stream_reset(bbl_stream_s *stream)
     stream->rx_source_port = 0;
     stream->rx_first_seq = 0;
     stream->rx_last_seq = 0;
+    stream->rx_last_ns = 0;
+    stream->rx_outages = 0;
+    stream->rx_outage_max_ns = 0;
+    stream->rx_outage_max_start_ns = 0;
+    stream->rx_outage_total_ns = 0;
 
     stream->rate_packets_tx.avg_max = 0;
     stream->rate_packets_rx.avg_max = 0;
 
     stream->reset = true;
     stream->verified = false;
+    bbl_bitmap_set(&g_ctx->streams_pending, stream->flow_id-1);
+}
+
+/**
+ * bbl_stream_ports
+ *
+ * @param stream traffic stream
+ * @param src_port returns UDP/TCP source port
+ * @param dst_port returns UDP/TCP destination port
+ */
+void
+bbl_stream_ports(bbl_stream_s *stream, uint16_t *src_port, uint16_t *dst_port)
+{
+    if(stream->direction == BBL_DIRECTION_DOWN && stream->reverse) {
+        *src_port = stream->config->dst_port;
+        *dst_port = stream->config->src_port;
+    } else {
+        *src_port = stream->config->src_port + stream->range_index * stream->config->range_src_port_step;
+        *dst_port = stream->config->dst_port + stream->range_index * stream->config->range_dst_port_step;
+    }
 }
 
 const char *
@@ -2292,6 +2507,41 @@ bbl_stream_rx_nat(bbl_ethernet_header_s *eth, bbl_stream_s *stream) {
     }
 }
 
+/*
+ * Record outage between the last packet received in
+ * sequence and the first packet after a sequence gap.
+ * The outage is accounted to the interface on which the
+ * stream was received before.
+ */
+static void
+bbl_stream_rx_outage(bbl_stream_s *stream, uint64_t rx_ns)
+{
+    bbl_interface_s *interface = NULL;
+    uint64_t duration_ns;
+
+    if(rx_ns <= stream->rx_last_ns) return;
+    duration_ns = rx_ns - stream->rx_last_ns;
+
+    stream->rx_outages++;
+    stream->rx_outage_total_ns += duration_ns;
+    if(duration_ns > stream->rx_outage_max_ns) {
+        stream->rx_outage_max_ns = duration_ns;
+        stream->rx_outage_max_start_ns = stream->rx_last_ns;
+    }
+    bbl_outage_add(&stream->config->outage, duration_ns);
+
+    if(stream->rx_network_interface) {
+        interface = stream->rx_network_interface->interface;
+    } else if(stream->rx_access_interface) {
+        interface = stream->rx_access_interface->interface;
+    } else if(stream->rx_a10nsp_interface) {
+        interface = stream->rx_a10nsp_interface->interface;
+    }
+    if(interface) {
+        bbl_outage_add(&interface->stream_outage, duration_ns);
+    }
+}
+
 bbl_stream_s *
 bbl_stream_rx(bbl_ethernet_header_s *eth, uint8_t *mac)
 {
@@ -2304,6 +2554,7 @@ bbl_stream_rx(bbl_ethernet_header_s *eth, uint8_t *mac)
     uint64_t loss = 0;
     uint64_t flow_seq;
     uint64_t rx_last_seq;
+    uint64_t rx_ns;
     static bool log_loss = true;
 
     if(!(bbl && bbl->type == BBL_TYPE_UNICAST)) {
@@ -2314,12 +2565,14 @@ bbl_stream_rx(bbl_ethernet_header_s *eth, uint8_t *mac)
     if(stream) {
         flow_seq = bbl->flow_seq; 
         rx_last_seq = stream->rx_last_seq;
+        rx_ns = eth->timestamp.tv_sec * SEC + eth->timestamp.tv_nsec;
         if(rx_last_seq) {
             /* Stream already verified */
             if(flow_seq > rx_last_seq) {
                 if(flow_seq > (rx_last_seq +1)) {
                     loss = flow_seq - (rx_last_seq +1);
                     stream->rx_loss += loss;
+                    bbl_stream_rx_outage(stream, rx_ns);
                     if(unlikely(log_loss)) {
                         log_loss = log_id[LOSS].enable;
                         LOG(LOSS, "LOSS Unicast flow: %lu seq: %lu last: %lu loss: %lu\n",
@@ -2327,6 +2580,7 @@ bbl_stream_rx(bbl_ethernet_header_s *eth, uint8_t *mac)
                     }
                 }
                 stream->rx_last_seq = flow_seq;
+                stream->rx_last_ns = rx_ns;
                 stream->rx_last_epoch = eth->timestamp.tv_sec;
                 stream->rx_packets++;
             } else {
@@ -2409,6 +2663,7 @@ bbl_stream_rx(bbl_ethernet_header_s *eth, uint8_t *mac)
             }
             stream->rx_first_seq = flow_seq;
             stream->rx_last_seq = flow_seq;
+            stream->rx_last_ns = rx_ns;
             stream->rx_first_epoch = eth->timestamp.tv_sec;
             stream->rx_last_epoch = eth->timestamp.tv_sec;
             stream->rx_packets++;
@@ -2594,13 +2849,7 @@ bbl_stream_json(bbl_stream_s *stream, bool debug)
         rx_interface = stream->rx_a10nsp_interface->name;
     }
 
-    if (stream->direction == BBL_DIRECTION_DOWN && stream->reverse) {
-        src_port = stream->config->dst_port;
-        dst_port = stream->config->src_port;
-    } else {
-        src_port = stream->config->src_port;
-        dst_port = stream->config->dst_port;
-    }
+    bbl_stream_ports(stream, &src_port, &dst_port);
 
     if(stream->ipv6_src && stream->ipv6_dst) {
         src_address = format_ipv6_address((ipv6addr_t*)stream->ipv6_src);
@@ -2666,6 +2915,12 @@ bbl_stream_json(bbl_stream_s *stream, bool debug)
             "rx-last-epoch", stream->rx_last_epoch
             );
 
+        if(stream->rx_outages) {
+            json_object_set_new(root, "rx-outages", json_integer(stream->rx_outages));
+            json_object_set_new(root, "rx-outage-max-ms", json_real((double)stream->rx_outage_max_ns / MSEC));
+            json_object_set_new(root, "rx-outage-max-start-ns", json_integer(stream->rx_outage_max_start_ns));
+            json_object_set_new(root, "rx-outage-total-ms", json_real((double)stream->rx_outage_total_ns / MSEC));
+        }
         if(stream->rx_interface_changes) { 
             json_object_set_new(root, "rx-interface-changes", json_integer(stream->rx_interface_changes));
             json_object_set_new(root, "rx-interface-changed-epoch", json_integer(stream->rx_interface_changed_epoch));
@@ -2703,6 +2958,9 @@ bbl_stream_json(bbl_stream_s *stream, bool debug)
         if(stream->reverse) {
             json_object_set_new(root, "reverse-flow-id", json_integer(stream->reverse->flow_id));
         }
+        if(stream->config->range_count > 1) {
+            json_object_set_new(root, "range-index", json_integer(stream->range_index));
+        }
         if(stream->lag && io && io->interface) {
             json_object_set_new(root, "lag-member-interface", json_string(io->interface->name));
             json_object_set_new(root, "lag-member-interface-state", json_string(interface_state_string(io->interface->state)));
@@ -2900,13 +3158,47 @@ bbl_stream_ctrl_session(int fd, uint32_t session_id, json_t *arguments __attribu
     }
 }
 
+#define BBL_STREAM_CONFIG_LISTS 8
+
+/*
+ * All lists of stream configurations with outage
+ * histograms (see bbl_stream_outage_groups_json).
+ */
+static void
+bbl_stream_config_lists(bbl_stream_config_s *lists[BBL_STREAM_CONFIG_LISTS])
+{
+    lists[0] = g_ctx->config.stream_config;
+    lists[1] = g_ctx->config.stream_config_multicast;
+    lists[2] = g_ctx->config.stream_config_session_ipv4_up;
+    lists[3] = g_ctx->config.stream_config_session_ipv4_down;
+    lists[4] = g_ctx->config.stream_config_session_ipv6_up;
+    lists[5] = g_ctx->config.stream_config_session_ipv6_down;
+    lists[6] = g_ctx->config.stream_config_session_ipv6pd_up;
+    lists[7] = g_ctx->config.stream_config_session_ipv6pd_down;
+}
+
 int
 bbl_stream_ctrl_reset(int fd, uint32_t session_id __attribute__((unused)), json_t *arguments __attribute__((unused)))
 {
     bbl_stream_s *stream = g_ctx->stream_head;
+    bbl_stream_config_s *lists[BBL_STREAM_CONFIG_LISTS];
+    bbl_stream_config_s *config;
+    bbl_interface_s *interface;
+    size_t i;
     
     g_ctx->stats.stream_traffic_flows_verified = 0;
 
+    /* Reset outage histograms */
+    bbl_stream_config_lists(lists);
+    for(i = 0; i < BBL_STREAM_CONFIG_LISTS; i++) {
+        for(config = lists[i]; config; config = config->next) {
+            memset(&config->outage, 0x0, sizeof(bbl_outage_s));
+        }
+    }
+    CIRCLEQ_FOREACH(interface, &g_ctx->interface_qhead, interface_qnode) {
+        memset(&interface->stream_outage, 0x0, sizeof(bbl_outage_s));
+    }
+
     /* Iterate over all traffic streams */
     while(stream) {
         if(!stream->session_traffic) {
@@ -2917,27 +3209,153 @@ bbl_stream_ctrl_reset(int fd, uint32_t session_id __attribute__((unused)), json_
     return bbl_ctrl_status(fd, "ok", 200, NULL);    
 }
 
+typedef struct bbl_stream_outage_group_ {
+    uint16_t stream_group_id;
+    bbl_outage_s outage;
+} bbl_stream_outage_group_s;
+
+static int
+bbl_stream_outage_group_compare(const void *a, const void *b)
+{
+    return ((bbl_stream_outage_group_s*)a)->stream_group_id - 
+           ((bbl_stream_outage_group_s*)b)->stream_group_id;
+}
+
+/*
+ * Add outages of all stream configurations per
+ * stream group identifier (optionally filtered).
+ */
+static void
+bbl_stream_outage_groups_json(json_t *json_groups, int stream_group_id)
+{
+    bbl_stream_config_s *lists[BBL_STREAM_CONFIG_LISTS];
+    bbl_stream_config_s *config;
+    bbl_stream_outage_group_s *groups = NULL;
+    json_t *json_outage;
+    size_t count = 0, size = 0, i, g;
+
+    bbl_stream_config_lists(lists);
+    for(i = 0; i < BBL_STREAM_CONFIG_LISTS; i++) {
+        for(config = lists[i]; config; config = config->next) {
+            if(stream_group_id >= 0 && config->stream_group_id != stream_group_id) {
+                continue;
+            }
+            for(g = 0; g < count; g++) {
+                if(groups[g].stream_group_id == config->stream_group_id) break;
+            }
+            if(g == count) {
+                if(count == size) {
+                    size = size ? size * 2 : 16;
+                    groups = realloc(groups, size * sizeof(bbl_stream_outage_group_s));
+                    if(!groups) return;
+                }
+                memset(&groups[g], 0x0, sizeof(bbl_stream_outage_group_s));
+                groups[g].stream_group_id = config->stream_group_id;
+                count++;
+            }
+            bbl_outage_sum(&groups[g].outage, &config->outage);
+        }
+    }
+    if(count) {
+        qsort(groups, count, sizeof(bbl_stream_outage_group_s), bbl_stream_outage_group_compare);
+    }
+    for(g = 0; g < count; g++) {
+        json_outage = bbl_outage_json(&groups[g].outage);
+        json_object_set_new(json_outage, "stream-group-id", json_integer(groups[g].stream_group_id));
+        json_array_append_new(json_groups, json_outage);
+    }
+    free(groups);
+}
+
 int
-bbl_stream_ctrl_pending(int fd, uint32_t session_id __attribute__((unused)), json_t *arguments __attribute__((unused)))
+bbl_stream_ctrl_outages(int fd, uint32_t session_id __attribute__((unused)), json_t *arguments)
 {
     int result = 0;
-    bbl_stream_s *stream = g_ctx->stream_head;
+    json_t *root, *json_groups, *json_interfaces, *json_outage;
+    bbl_interface_s *interface;
+    const char *interface_name = NULL;
+    int stream_group_id = -1;
+
+    if(json_unpack(arguments, "{s:i}", "stream-group-id", &stream_group_id) == 0) {
+        if(stream_group_id < 0 || stream_group_id > UINT16_MAX) {
+            return bbl_ctrl_status(fd, "error", 400, "invalid stream-group-id");
+        }
+    }
+    json_unpack(arguments, "{s:s}", "interface", &interface_name);
+
+    json_groups = json_array();
+    if(!interface_name) {
+        bbl_stream_outage_groups_json(json_groups, stream_group_id);
+    }
+
+    json_interfaces = json_array();
+    if(stream_group_id < 0) {
+        CIRCLEQ_FOREACH(interface, &g_ctx->interface_qhead, interface_qnode) {
+            if(interface_name && strcmp(interface_name, interface->name) != 0) {
+                continue;
+            }
+            json_outage = bbl_outage_json(&interface->stream_outage);
+            json_object_set_new(json_outage, "name", json_string(interface->name));
+            json_array_append_new(json_interfaces, json_outage);
+        }
+    }
+
+    root = json_pack("{ss si s{so so}}",
+                     "status", "ok",
+                     "code", 200,
+                     "stream-outages",
+                     "stream-groups", json_groups,
+                     "interfaces", json_interfaces);
+    if(root) {
+        result = json_dumpfd(root, fd, 0);
+        json_decref(root);
+    } else {
+        result = bbl_ctrl_status(fd, "error", 500, "internal error");
+    }
+    return result;
+}
+
+int
+bbl_stream_ctrl_pending(int fd, uint32_t session_id __attribute__((unused)), json_t *arguments)
+{
+    int result = 0;
+    json_int_t cursor = 1;
+    json_int_t limit = 0;
+    json_int_t count = 0;
+    uint32_t bit;
 
     json_t *root, *json_streams;
+
+    json_unpack(arguments, "{s:I}", "cursor", &cursor);
+    json_unpack(arguments, "{s:I}", "limit", &limit);
+    if(cursor < 1) {
+        return bbl_ctrl_status(fd, "error", 400, "invalid cursor");
+    }
+    if(limit < 0) {
+        return bbl_ctrl_status(fd, "error", 400, "invalid limit");
+    }
+
     json_streams = json_array();
 
-    /* Iterate over all traffic streams */
-    while(stream) {
-        if(!stream->verified) {
-            json_array_append_new(json_streams, json_integer(stream->flow_id));
+    /* Iterate over all pending traffic streams (flow-id >= cursor) */
+    bit = bbl_bitmap_next(&g_ctx->streams_pending, cursor > UINT32_MAX ? BBL_BITMAP_END : cursor-1);
+    while(bit != BBL_BITMAP_END) {
+        if(limit && count == limit) {
+            break;
         }
-        stream = stream->next;
+        json_array_append_new(json_streams, json_integer(bit+1));
+        count++;
+        bit = bbl_bitmap_next(&g_ctx->streams_pending, bit+1);
     }
 
-    root = json_pack("{ss si so}",
+    root = json_pack("{ss si so si}",
                      "status", "ok",
                      "code", 200,
-                     "streams-pending", json_streams);
+                     "streams-pending", json_streams,
+                     "streams-pending-count", g_ctx->streams_pending.count);
+    if(root && bit != BBL_BITMAP_END) {
+        json_object_set_new(root, "next-cursor", json_integer(bit+1));
+    }
     if(root) {
         result = json_dumpfd(root, fd, 0);
         json_decref(root);
@@ -79,6 +79,23 @@ typedef struct bbl_stream_config_
     bool     nat;
     bool     raw_tcp; /* Pseudo TCP Streams*/
 
+    /* Stream range (RAW streams only), where flow N
+     * is generated by adding N times the iterator
+     * or step to the corresponding base value. */
+    uint32_t range_count;
+    uint32_t range_ipv4_network_iter;
+    uint32_t range_ipv4_destination_iter;
+    ipv6addr_t range_ipv6_network_iter;
+    ipv6addr_t range_ipv6_destination_iter;
+    uint16_t range_src_port_step;
+    uint16_t range_dst_port_step;
+    uint16_t range_vlan_step;
+    uint8_t  range_dscp_step;
+    uint32_t range_mpls1_step;
+    uint32_t range_mpls2_step;
+
+    bbl_outage_s outage; /* Outages of all streams using this config */
+
     bbl_stream_config_s *next; /* Next stream config */
 } bbl_stream_config_s;
 
@@ -89,6 +106,7 @@ typedef struct bbl_stream_group_
     bbl_stream_s *head;
     struct timer_ *timer;
     bbl_stream_group_s *next;
+    bbl_stream_group_s *open_next;
 } bbl_stream_group_s;
 
 /**
@@ -147,11 +165,16 @@ typedef struct bbl_stream_
 
     uint16_t tx_len; /* TX length */
     uint16_t tx_bbl_hdr_len; /* TX BBL HDR length */
-    uint8_t *tx_buf; /* TX buffer */
+    uint8_t *tx_buf; /* TX packet (NULL if packet must be rebuilt) */
+    uint8_t *tx_mem; /* TX packet memory (kept for rebuild) */
+    uint16_t tx_buf_size; /* TX packet memory size */
 
     uint8_t *ipv6_src;
     uint8_t *ipv6_dst;
 
+    uint32_t range_index; /* Flow index of stream range */
+    uint8_t *range_ipv6; /* Per-flow IPv6 source and destination */
+
     bbl_stream_config_s *config;
 
     bbl_stream_s *next; /* Next stream (global) */
@@ -202,6 +225,12 @@ typedef struct bbl_stream_
     __time_t rx_first_epoch;
     __time_t rx_last_epoch;
 
+    uint64_t rx_last_ns; /* RX timestamp of last packet in sequence */
+    uint64_t rx_outage_max_ns;
+    uint64_t rx_outage_max_start_ns; /* RX timestamp of last packet before longest outage */
+    uint64_t rx_outage_total_ns;
+    uint32_t rx_outages;
+
     __time_t rx_interface_changed_epoch;
     uint8_t  rx_interface_changes;
 
@@ -238,6 +267,9 @@ bbl_stream_index_get(uint64_t flow_id);
 bool
 bbl_stream_index_init();
 
+bool
+bbl_stream_io_init();
+
 bool
 bbl_stream_session_init(bbl_session_s *session);
 
@@ -259,6 +291,15 @@ bbl_stream_rx(bbl_ethernet_header_s *eth, uint8_t *mac);
 void
 bbl_stream_reset(bbl_stream_s *stream);
 
+void
+bbl_stream_ports(bbl_stream_s *stream, uint16_t *src_port, uint16_t *dst_port);
+
+const char *
+stream_type_string(bbl_stream_s *stream);
+
+const char *
+stream_sub_type_string(bbl_stream_s *stream);
+
 json_t *
 bbl_stream_json(bbl_stream_s *stream, bool debug);
 
@@ -280,6 +321,9 @@ bbl_stream_ctrl_traffic_start(int fd, uint32_t session_id, json_t *arguments __a
 int
 bbl_stream_ctrl_traffic_stop(int fd, uint32_t session_id, json_t *arguments __attribute__((unused)));
 
+int
+bbl_stream_ctrl_outages(int fd, uint32_t session_id __attribute__((unused)), json_t *arguments);
+
 int
 bbl_stream_ctrl_reset(int fd, uint32_t session_id __attribute__((unused)), json_t *arguments __attribute__((unused)));
 
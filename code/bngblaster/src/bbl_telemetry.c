@@ -0,0 +1,386 @@
+/*
+ * BNG Blaster (BBL) - Telemetry
+ *
+ * Clients subscribe to groups of counters via control
+ * socket and receive samples in the given interval
+ * as newline delimited JSON (NDJSON) on the same
+ * connection. Only values changed since the last
+ * sample are sent.
+ *
+ * agent, October 2026
+ *
+ * Copyright (C) 2020-2025, RtBrick, Inc.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include "bbl.h"
+
+static keyval_t telemetry_counters[] = {
+    { BBL_TELEMETRY_INTERFACES, "interfaces" },
+    { BBL_TELEMETRY_SESSIONS, "sessions" },
+    { BBL_TELEMETRY_STREAMS, "streams" },
+    { BBL_TELEMETRY_PROTOCOLS, "protocols" },
+    { 0, NULL}
+};
+
+/**
+ * bbl_telemetry_subscribe
+ *
+ * @param fd response file descriptor
+ * @param arguments command arguments
+ * @return telemetry subscription or NULL
+ *         if an error response was written
+ */
+bbl_telemetry_s *
+bbl_telemetry_subscribe(int fd, json_t *arguments)
+{
+    bbl_telemetry_s *telemetry;
+    json_t *value;
+    json_t *counter;
+    uint8_t counters = 0;
+    int interval = BBL_TELEMETRY_INTERVAL_DEFAULT;
+    size_t i, c;
+
+    value = json_object_get(arguments, "counters");
+    if(value) {
+        if(!json_is_array(value)) {
+            bbl_ctrl_status(fd, "error", 400, "invalid counters");
+            return NULL;
+        }
+        json_array_foreach(value, i, counter) {
+            for(c = 0; telemetry_counters[c].key; c++) {
+                if(json_is_string(counter) &&
+                   strcmp(json_string_value(counter), telemetry_counters[c].key) == 0) {
+                    counters |= telemetry_counters[c].val;
+                    break;
+                }
+            }
+            if(!telemetry_counters[c].key) {
+                bbl_ctrl_status(fd, "error", 400, "invalid counters");
+                return NULL;
+            }
+        }
+    } else {
+        counters = BBL_TELEMETRY_INTERFACES|BBL_TELEMETRY_SESSIONS|
+                   BBL_TELEMETRY_STREAMS|BBL_TELEMETRY_PROTOCOLS;
+    }
+    value = json_object_get(arguments, "interval");
+    if(value) {
+        if(!json_is_integer(value) || json_integer_value(value) < BBL_TELEMETRY_INTERVAL_MIN) {
+            bbl_ctrl_status(fd, "error", 400, "invalid interval");
+            return NULL;
+        }
+        interval = json_integer_value(value);
+    }
+
+    telemetry = calloc(1, sizeof(bbl_telemetry_s));
+    if(!telemetry) {
+        bbl_ctrl_status(fd, "error", 500, "internal error");
+        return NULL;
+    }
+    telemetry->counters = counters;
+    telemetry->interval = (uint64_t)interval * MSEC;
+    telemetry->full = true;
+    clock_gettime(CLOCK_MONOTONIC, &telemetry->next);
+    bbl_ctrl_status(fd, "ok", 200, NULL);
+    return telemetry;
+}
+
+void
+bbl_telemetry_free(bbl_telemetry_s *telemetry)
+{
+    if(!telemetry) {
+        return;
+    }
+    if(telemetry->values) free(telemetry->values);
+    if(telemetry->buf) free(telemetry->buf);
+    free(telemetry);
+}
+
+/**
+ * bbl_telemetry_due
+ *
+ * @return nanoseconds until next sample (<= 0 if due)
+ */
+int64_t
+bbl_telemetry_due(bbl_telemetry_s *telemetry, struct timespec *now)
+{
+    return ((int64_t)telemetry->next.tv_sec - now->tv_sec) * SEC +
+           (telemetry->next.tv_nsec - now->tv_nsec);
+}
+
+static bool
+bbl_telemetry_append(bbl_telemetry_s *telemetry, const char *fmt, ...)
+{
+    va_list ap;
+    char *buf;
+    size_t size;
+    int len;
+
+    while(true) {
+        va_start(ap, fmt);
+        len = vsnprintf(telemetry->buf+telemetry->buf_len,
+                        telemetry->buf_size-telemetry->buf_len, fmt, ap);
+        va_end(ap);
+        if(len < 0) {
+            return false;
+        }
+        if(telemetry->buf_len + len < telemetry->buf_size) {
+            telemetry->buf_len += len;
+            return true;
+        }
+        size = telemetry->buf_size ? telemetry->buf_size * 2 : 4096;
+        buf = realloc(telemetry->buf, size);
+        if(!buf) {
+            return false;
+        }
+        telemetry->buf = buf;
+        telemetry->buf_size = size;
+    }
+}
+
+/**
+ * bbl_telemetry_value
+ *
+ * Add value to the current sample if changed.
+ */
+static void
+bbl_telemetry_value(bbl_telemetry_s *telemetry, const char *prefix, const char *name, uint64_t value)
+{
+    uint64_t *values;
+    uint32_t index = telemetry->index++;
+
+    if(index >= telemetry->values_size) {
+        values = realloc(telemetry->values, (index+64) * sizeof(uint64_t));
+        if(!values) {
+            return;
+        }
+        telemetry->values = values;
+        telemetry->values_size = index+64;
+    }
+    if(!telemetry->full && telemetry->values[index] == value) {
+        return;
+    }
+    telemetry->values[index] = value;
+    bbl_telemetry_append(telemetry, "%s\"%s%s%s\":%lu",
+                         telemetry->changed ? "," : "",
+                         prefix ? prefix : "", prefix ? "." : "",
+                         name, value);
+    telemetry->changed = true;
+}
+
+static void
+bbl_telemetry_interfaces(bbl_telemetry_s *telemetry)
+{
+    bbl_interface_s *interface;
+    io_handle_s *io;
+    uint64_t tx_packets, tx_bytes;
+    uint64_t rx_packets, rx_bytes;
+    char prefix[64];
+
+    CIRCLEQ_FOREACH(interface, &g_ctx->interface_qhead, interface_qnode) {
+        snprintf(prefix, sizeof(prefix), "interfaces.%s", interface->name);
+        tx_packets = 0;
+        tx_bytes = 0;
+        io = interface->io.tx;
+        while(io) {
+            tx_packets += io->stats.packets;
+            tx_bytes += io->stats.bytes;
+            io = io->next;
+        }
+        rx_packets = 0;
+        rx_bytes = 0;
+        io = interface->io.rx;
+        while(io) {
+            rx_packets += io->stats.packets;
+            rx_bytes += io->stats.bytes;
+            io = io->next;
+        }
+        bbl_telemetry_value(telemetry, prefix, "state", interface->state);
+        bbl_telemetry_value(telemetry, prefix, "tx-packets", tx_packets);
+        bbl_telemetry_value(telemetry, prefix, "tx-bytes", tx_bytes);
+        bbl_telemetry_value(telemetry, prefix, "rx-packets", rx_packets);
+        bbl_telemetry_value(telemetry, prefix, "rx-bytes", rx_bytes);
+    }
+}
+
+static void
+bbl_telemetry_sessions(bbl_telemetry_s *telemetry)
+{
+    const char *prefix = "sessions";
+
+    bbl_telemetry_value(telemetry, prefix, "sessions", g_ctx->sessions);
+    bbl_telemetry_value(telemetry, prefix, "established", g_ctx->sessions_established);
+    bbl_telemetry_value(telemetry, prefix, "outstanding", g_ctx->sessions_outstanding);
+    bbl_telemetry_value(telemetry, prefix, "terminated", g_ctx->sessions_terminated);
+    bbl_telemetry_value(telemetry, prefix, "flapped", g_ctx->sessions_flapped);
+    bbl_telemetry_value(telemetry, prefix, "dhcp-established", g_ctx->dhcp_established);
+    bbl_telemetry_value(telemetry, prefix, "dhcpv6-established", g_ctx->dhcpv6_established);
+    bbl_telemetry_value(telemetry, prefix, "l2tp-tunnels-established", g_ctx->l2tp_tunnels_established);
+    bbl_telemetry_value(telemetry, prefix, "l2tp-sessions", g_ctx->l2tp_sessions);
+}
+
+static void
+bbl_telemetry_streams(bbl_telemetry_s *telemetry)
+{
+    const char *prefix = "streams";
+    bbl_interface_s *interface;
+    bbl_network_interface_s *network_interface;
+    uint64_t tx = 0;
+    uint64_t rx = 0;
+    uint64_t loss = 0;
+
+    /* Stream counters of the interfaces are
+     * updated periodically by the main thread. */
+    CIRCLEQ_FOREACH(interface, &g_ctx->interface_qhead, interface_qnode) {
+        if(interface->access) {
+            tx += interface->access->stats.stream_tx;
+            rx += interface->access->stats.stream_rx;
+            loss += interface->access->stats.stream_loss;
+        }
+        network_interface = interface->network;
+        while(network_interface) {
+            tx += network_interface->stats.stream_tx;
+            rx += network_interface->stats.stream_rx;
+            loss += network_interface->stats.stream_loss;
+            network_interface = network_interface->next;
+        }
+    }
+    bbl_telemetry_value(telemetry, prefix, "flows", g_ctx->stats.stream_traffic_flows);
+    bbl_telemetry_value(telemetry, prefix, "flows-verified", g_ctx->stats.stream_traffic_flows_verified);
+    bbl_telemetry_value(telemetry, prefix, "session-flows", g_ctx->stats.session_traffic_flows);
+    bbl_telemetry_value(telemetry, prefix, "session-flows-verified", g_ctx->stats.session_traffic_flows_verified);
+    bbl_telemetry_value(telemetry, prefix, "multicast-flows", g_ctx->stats.multicast_traffic_flows);
+    bbl_telemetry_value(telemetry, prefix, "multicast-flows-verified", g_ctx->stats.multicast_traffic_flows_verified);
+    bbl_telemetry_value(telemetry, prefix, "tx-packets", tx);
+    bbl_telemetry_value(telemetry, prefix, "rx-packets", rx);
+    bbl_telemetry_value(telemetry, prefix, "loss", loss);
+}
+
+static void
+bbl_telemetry_protocols(bbl_telemetry_s *telemetry)
+{
+    const char *prefix = "protocols";
+    bbl_interface_s *interface;
+    bbl_network_interface_s *network_interface;
+    bgp_session_s *bgp_session = g_ctx->bgp_sessions;
+    ospf_instance_s *ospf_instance = g_ctx->ospf_instances;
+    ospf_interface_s *ospf_interface;
+    ospf_neighbor_s *ospf_neighbor;
+    ldp_instance_s *ldp_instance = g_ctx->ldp_instances;
+    ldp_session_s *ldp_session;
+    uint32_t bgp = 0, isis = 0, ospf = 0, ldp = 0;
+    int level;
+
+    while(bgp_session) {
+        if(bgp_session->state == BGP_ESTABLISHED) bgp++;
+        bgp_session = bgp_session->next;
+    }
+    CIRCLEQ_FOREACH(interface, &g_ctx->interface_qhead, interface_qnode) {
+        network_interface = interface->network;
+        while(network_interface) {
+            if(network_interface->isis_adjacency_p2p) {
+                if(network_interface->isis_adjacency_p2p->state == ISIS_P2P_ADJACENCY_STATE_UP) isis++;
+            } else {
+                for(level=0; level<ISIS_LEVELS; level++) {
+                    if(network_interface->isis_adjacency[level] &&
+                       network_interface->isis_adjacency[level]->state == ISIS_ADJACENCY_STATE_UP) isis++;
+                }
+            }
+            network_interface = network_interface->next;
+        }
+    }
+    while(ospf_instance) {
+        ospf_interface = ospf_instance->interfaces;
+        while(ospf_interface) {
+            ospf_neighbor = ospf_interface->neighbors;
+            while(ospf_neighbor) {
+                if(ospf_neighbor->state == OSPF_NBSTATE_FULL) ospf++;
+                ospf_neighbor = ospf_neighbor->next;
+            }
+            ospf_interface = ospf_interface->next;
+        }
+        ospf_instance = ospf_instance->next;
+    }
+    while(ldp_instance) {
+        ldp_session = ldp_instance->sessions;
+        while(ldp_session) {
+            if(ldp_session->state == LDP_OPERATIONAL) ldp++;
+            ldp_session = ldp_session->next;
+        }
+        ldp_instance = ldp_instance->next;
+    }
+    bbl_telemetry_value(telemetry, prefix, "bgp-sessions-established", bgp);
+    bbl_telemetry_value(telemetry, prefix, "isis-adjacencies-up", isis);
+    bbl_telemetry_value(telemetry, prefix, "ospf-neighbors-full", ospf);
+    bbl_telemetry_value(telemetry, prefix, "ldp-sessions-operational", ldp);
+}
+
+/**
+ * bbl_telemetry_sample
+ *
+ * Build the next sample as single JSON line, which
+ * is skipped if no value has changed. Counters are
+ * read directly without locking as done by all
+ * thread safe control commands.
+ *
+ * @param telemetry telemetry subscription
+ * @param now current time (CLOCK_MONOTONIC)
+ * @return length of sample in telemetry->buf (0 if no sample)
+ */
+size_t
+bbl_telemetry_sample(bbl_telemetry_s *telemetry, struct timespec *now)
+{
+    struct timespec realtime;
+    uint64_t next;
+
+    /* Schedule next sample. */
+    next = timespec_to_nsec(&telemetry->next) + telemetry->interval;
+    if(next < timespec_to_nsec(now)) {
+        /* Skip missed samples. */
+        next = timespec_to_nsec(now) + telemetry->interval;
+    }
+    telemetry->next.tv_sec = next / SEC;
+    telemetry->next.tv_nsec = next % SEC;
+
+    clock_gettime(CLOCK_REALTIME, &realtime);
+    telemetry->buf_len = 0;
+    telemetry->index = 0;
+    telemetry->changed = false;
+    bbl_telemetry_append(telemetry, "{\"telemetry\":{\"seq\":%lu,\"timestamp\":%lu,\"full\":%s,\"values\":{",
+                         telemetry->seq,
+                         (uint64_t)realtime.tv_sec * 1000 + realtime.tv_nsec / MSEC,
+                         telemetry->full ? "true" : "false");
+
+    if(telemetry->counters & BBL_TELEMETRY_INTERFACES) {
+        bbl_telemetry_interfaces(telemetry);
+    }
+    if(telemetry->counters & BBL_TELEMETRY_SESSIONS) {
+        bbl_telemetry_sessions(telemetry);
+    }
+    if(telemetry->counters & BBL_TELEMETRY_STREAMS) {
+        bbl_telemetry_streams(telemetry);
+    }
+    if(telemetry->counters & BBL_TELEMETRY_PROTOCOLS) {
+        bbl_telemetry_protocols(telemetry);
+    }
+    if(telemetry->index != telemetry->values_count) {
+        /* The set of values has changed (e.g. new
+         * sessions), send all values with next sample. */
+        telemetry->values_count = telemetry->index;
+        if(!telemetry->full) {
+            telemetry->full = true;
+            telemetry->next = *now;
+            return 0;
+        }
+    }
+    if(!(telemetry->changed || telemetry->full)) {
+        return 0;
+    }
+    if(!bbl_telemetry_append(telemetry, "}}}\n")) {
+        telemetry->full = true;
+        return 0;
+    }
+    telemetry->full = false;
+    telemetry->seq++;
+    return telemetry->buf_len;
+}
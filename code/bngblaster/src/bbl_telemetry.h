@@ -0,0 +1,55 @@
+/*
+ * BNG Blaster (BBL) - Telemetry
+ *
+ * agent, October 2026
+ *
+ * Copyright (C) 2020-2025, RtBrick, Inc.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __BBL_TELEMETRY_H__
+#define __BBL_TELEMETRY_H__
+
+#define BBL_TELEMETRY_INTERVAL_MIN      10          /* Min interval in ms */
+#define BBL_TELEMETRY_INTERVAL_DEFAULT  1000        /* Default interval in ms */
+#define BBL_TELEMETRY_BACKLOG           (1024*1024) /* Skip samples if more bytes are pending */
+
+#define BBL_TELEMETRY_INTERFACES        0x01
+#define BBL_TELEMETRY_SESSIONS          0x02
+#define BBL_TELEMETRY_STREAMS           0x04
+#define BBL_TELEMETRY_PROTOCOLS         0x08
+
+/** Telemetry subscription of a control socket connection */
+typedef struct bbl_telemetry_ {
+    uint8_t counters; /* Subscribed counter groups */
+    uint64_t interval; /* Sampling interval in nanoseconds */
+    struct timespec next; /* Next sample (CLOCK_MONOTONIC) */
+    uint64_t seq;
+    bool full; /* Send all values with next sample */
+
+    /* Values of the last sample in sample order,
+     * used to send only changed values (delta). */
+    uint64_t *values;
+    uint32_t values_size;
+    uint32_t values_count;
+    uint32_t index;
+
+    char *buf;
+    size_t buf_size;
+    size_t buf_len;
+    bool changed;
+} bbl_telemetry_s;
+
+bbl_telemetry_s *
+bbl_telemetry_subscribe(int fd, json_t *arguments);
+
+void
+bbl_telemetry_free(bbl_telemetry_s *telemetry);
+
+int64_t
+bbl_telemetry_due(bbl_telemetry_s *telemetry, struct timespec *now);
+
+size_t
+bbl_telemetry_sample(bbl_telemetry_s *telemetry, struct timespec *now);
+
+#endif
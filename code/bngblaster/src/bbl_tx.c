@@ -20,6 +20,10 @@ bbl_tx_igmp_timeout(timer_s *timer)
     int i;
     bool send = false;
 
+    if(!session->igmp) {
+        return;
+    }
+
     if(session->access_type == ACCESS_TYPE_PPPOE) {
         if(session->session_state != BBL_ESTABLISHED ||
             session->ipcp_state != BBL_PPP_OPENED) {
@@ -32,7 +36,7 @@ bbl_tx_igmp_timeout(timer_s *timer)
     }
 
     for(i=0; i < IGMP_MAX_GROUPS; i++) {
-        group = &session->igmp_groups[i];
+        group = &session->igmp->groups[i];
         if(group->state == IGMP_GROUP_JOINING) {
             if(group->robustness_count) {
                 session->send_requests |= BBL_SEND_IGMP;
@@ -80,6 +84,11 @@ bbl_tx_encode_packet_igmp(bbl_session_s *session)
     struct timespec timestamp;
     clock_gettime(CLOCK_MONOTONIC, &timestamp);
 
+    if(!session->igmp) {
+        session->send_requests &= ~BBL_SEND_IGMP;
+        return WRONG_PROTOCOL_STATE;
+    }
+
     eth.dst = session->server_mac;
     eth.src = session->client_mac;
     eth.qinq = session->access_config->qinq;
@@ -119,8 +128,8 @@ bbl_tx_encode_packet_igmp(bbl_session_s *session)
     ipv4.router_alert_option = true;
     ipv4.next = &igmp;
     for(i=0; i < IGMP_MAX_GROUPS; i++) {
-        if(session->igmp_groups[i].send && session->igmp_groups[i].state) {
-            group = &session->igmp_groups[i];
+        if(session->igmp->groups[i].send && session->igmp->groups[i].state) {
+            group = &session->igmp->groups[i];
             if(group->state == IGMP_GROUP_LEAVING) {
                 if(is_join) {
                     if(!g_ctx->config.igmp_combined_leave_join) {
@@ -444,6 +453,52 @@ bbl_tx_dhcpv6_timeout(timer_s *timer)
     }
 }
 
+static uint8_t
+bbl_session_vlans(bbl_session_s *session)
+{
+    uint8_t vlans = 0;
+
+    if(session->vlan_key.outer_vlan_id) {
+        vlans++;
+        if(session->vlan_key.inner_vlan_id) {
+            vlans++;
+            if(session->access_third_vlan) vlans++;
+        }
+    }
+    return vlans;
+}
+
+/**
+ * bbl_dhcp_template_get
+ *
+ * Get (or build) the DHCP or DHCPv6 template
+ * matching the number of VLAN tags of the session.
+ *
+ * @param session session
+ * @param templates DHCP or DHCPv6 templates of the access configuration
+ * @param eth ethernet header with DHCP or DHCPv6
+ * @return template or NULL if not applicable
+ */
+static bbl_dhcp_template_s *
+bbl_dhcp_template_get(bbl_session_s *session, bbl_dhcp_template_s **templates,
+                      bbl_ethernet_header_s *eth)
+{
+    bbl_dhcp_template_s *template;
+    uint8_t vlans = bbl_session_vlans(session);
+
+    template = templates[vlans];
+    if(!template) {
+        template = calloc(1, sizeof(bbl_dhcp_template_s));
+        if(!template) return NULL;
+        if(encode_dhcp_template(template, eth) != PROTOCOL_SUCCESS) {
+            free(template);
+            return NULL;
+        }
+        templates[vlans] = template;
+    }
+    return template;
+}
+
 static protocol_error_t
 bbl_tx_encode_packet_dhcpv6_request(bbl_session_s *session)
 {
@@ -456,6 +511,7 @@ bbl_tx_encode_packet_dhcpv6_request(bbl_session_s *session)
     bbl_dhcpv6_s dhcpv6 = {0};
     bbl_dhcpv6_s dhcpv6_relay = {0};
     access_line_s access_line = {0};
+    bbl_dhcp_template_s *template;
     struct timespec now;
     struct timespec time_diff;
     time_t elapsed = 0;
@@ -463,7 +519,8 @@ bbl_tx_encode_packet_dhcpv6_request(bbl_session_s *session)
     uint8_t mac[ETH_ADDR_LEN];
 
     if(session->dhcpv6_state == BBL_DHCP_INIT ||
-       session->dhcpv6_state == BBL_DHCP_BOUND) {
+       session->dhcpv6_state == BBL_DHCP_BOUND ||
+       !session->dhcpv6) {
         return IGNORED;
     }
 
@@ -542,16 +599,16 @@ bbl_tx_encode_packet_dhcpv6_request(bbl_session_s *session)
     }
     dhcpv6.elapsed = elapsed;
     dhcpv6.xid = session->dhcpv6_xid;
-    dhcpv6.client_duid = session->dhcpv6_duid;
+    dhcpv6.client_duid = session->dhcpv6->duid;
     dhcpv6.client_duid_len = DUID_LEN;
-    dhcpv6.server_duid = session->dhcpv6_server_duid;
-    dhcpv6.server_duid_len = session->dhcpv6_server_duid_len;
+    dhcpv6.server_duid = session->dhcpv6->server_duid;
+    dhcpv6.server_duid_len = session->dhcpv6->server_duid_len;
     dhcpv6.ia_na_iaid = session->dhcpv6_ia_na_iaid;
-    dhcpv6.ia_na_option = session->dhcpv6_ia_na_option;
-    dhcpv6.ia_na_option_len = session->dhcpv6_ia_na_option_len;
+    dhcpv6.ia_na_option = session->dhcpv6->ia_na_option;
+    dhcpv6.ia_na_option_len = session->dhcpv6->ia_na_option_len;
     dhcpv6.ia_pd_iaid = session->dhcpv6_ia_pd_iaid;
-    dhcpv6.ia_pd_option = session->dhcpv6_ia_pd_option;
-    dhcpv6.ia_pd_option_len = session->dhcpv6_ia_pd_option_len;
+    dhcpv6.ia_pd_option = session->dhcpv6->ia_pd_option;
+    dhcpv6.ia_pd_option_len = session->dhcpv6->ia_pd_option_len;
     dhcpv6.oro = true;
     switch (session->dhcpv6_state) {
         case BBL_DHCP_SELECTING:
@@ -593,6 +650,14 @@ bbl_tx_encode_packet_dhcpv6_request(bbl_session_s *session)
     session->dhcpv6_retry++;
     session->stats.dhcpv6_tx++;
     access_interface->stats.dhcpv6_tx++;
+    /* Relay messages are not encoded from templates. */
+    if(!g_ctx->config.dhcpv6_ldra) {
+        template = bbl_dhcp_template_get(session, session->access_config->dhcpv6_template, &eth);
+        if(template && encode_dhcp_ethernet_template(session->write_buf, &session->write_idx,
+                                                     template, &eth) == PROTOCOL_SUCCESS) {
+            return PROTOCOL_SUCCESS;
+        }
+    }
     return encode_ethernet(session->write_buf, &session->write_idx, &eth);
 }
 
@@ -681,9 +746,9 @@ bbl_tx_encode_packet_ip6cp_response(bbl_session_s *session)
 
     ip6cp.code = session->ip6cp_response_code;
     ip6cp.identifier = session->ip6cp_peer_identifier;
-    if(session->ip6cp_options_len) {
-        ip6cp.options = session->ip6cp_options;
-        ip6cp.options_len = session->ip6cp_options_len;
+    if(session->ppp->ip6cp_options_len) {
+        ip6cp.options = session->ppp->ip6cp_options;
+        ip6cp.options_len = session->ppp->ip6cp_options_len;
     } else {
         ip6cp.ipv6_identifier = session->ip6cp_ipv6_identifier;
     }
@@ -789,9 +854,9 @@ bbl_tx_encode_packet_ipcp_response(bbl_session_s *session)
 
     ipcp.code = session->ipcp_response_code;
     ipcp.identifier = session->ipcp_peer_identifier;
-    if(session->ipcp_options_len) {
-        ipcp.options = session->ipcp_options;
-        ipcp.options_len = session->ipcp_options_len;
+    if(session->ppp->ipcp_options_len) {
+        ipcp.options = session->ppp->ipcp_options;
+        ipcp.options_len = session->ppp->ipcp_options_len;
     }
 
     access_interface->stats.ipcp_tx++;
@@ -904,9 +969,9 @@ bbl_tx_encode_packet_lcp_response(bbl_session_s *session)
     if(lcp.code == PPP_CODE_ECHO_REPLY) {
         lcp.magic = session->magic_number;
     } else {
-        if(session->lcp_options_len) {
-            lcp.options = session->lcp_options;
-            lcp.options_len = session->lcp_options_len;
+        if(session->ppp->lcp_options_len) {
+            lcp.options = session->ppp->lcp_options;
+            lcp.options_len = session->ppp->lcp_options_len;
         } else {
             lcp.mru = session->peer_mru;
             lcp.auth = session->auth_protocol;
@@ -941,12 +1006,44 @@ bbl_padr_timeout(timer_s *timer)
     }
 }
 
+/**
+ * bbl_pppoe_template_get
+ *
+ * Get (or build) the PPPoE discovery template of the
+ * session access configuration matching the number
+ * of VLAN tags of the session.
+ *
+ * @param session session
+ * @param eth ethernet header with PPPoE discovery
+ * @return template or NULL if not applicable
+ */
+static bbl_pppoe_template_s *
+bbl_pppoe_template_get(bbl_session_s *session, bbl_ethernet_header_s *eth)
+{
+    bbl_access_config_s *access_config = session->access_config;
+    bbl_pppoe_template_s *template;
+    uint8_t vlans = bbl_session_vlans(session);
+
+    template = access_config->pppoe_template[vlans];
+    if(!template) {
+        template = calloc(1, sizeof(bbl_pppoe_template_s));
+        if(!template) return NULL;
+        if(encode_pppoe_template(template, eth) != PROTOCOL_SUCCESS) {
+            free(template);
+            return NULL;
+        }
+        access_config->pppoe_template[vlans] = template;
+    }
+    return template;
+}
+
 static protocol_error_t
 bbl_encode_padi(bbl_session_s *session)
 {
     bbl_ethernet_header_s eth = {0};
     bbl_pppoe_discovery_s pppoe = {0};
     access_line_s access_line = {0};
+    bbl_pppoe_template_s *template;
 
     eth.dst = session->server_mac;
     eth.src = session->client_mac;
@@ -981,6 +1078,13 @@ bbl_encode_padi(bbl_session_s *session)
         access_line.profile = session->access_line_profile;
         pppoe.access_line = &access_line;
     }
+    /* The template is skipped if the session does not match,
+     * e.g. if the service name was replaced by PADO. */
+    template = bbl_pppoe_template_get(session, &eth);
+    if(template && encode_pppoe_discovery_template(session->write_buf, &session->write_idx,
+                                                   template, &eth) == PROTOCOL_SUCCESS) {
+        return PROTOCOL_SUCCESS;
+    }
     return encode_ethernet(session->write_buf, &session->write_idx, &eth);
 }
 
@@ -990,6 +1094,7 @@ bbl_encode_padr(bbl_session_s *session)
     bbl_ethernet_header_s eth = {0};
     bbl_pppoe_discovery_s pppoe = {0};
     access_line_s access_line = {0};
+    bbl_pppoe_template_s *template;
 
     eth.dst = session->server_mac;
     eth.src = session->client_mac;
@@ -1025,6 +1130,13 @@ bbl_encode_padr(bbl_session_s *session)
         access_line.profile = session->access_line_profile;
         pppoe.access_line = &access_line;
     }
+    /* The template is skipped if the session does not match,
+     * e.g. if the service name was replaced by PADO. */
+    template = bbl_pppoe_template_get(session, &eth);
+    if(template && encode_pppoe_discovery_template(session->write_buf, &session->write_idx,
+                                                   template, &eth) == PROTOCOL_SUCCESS) {
+        return PROTOCOL_SUCCESS;
+    }
     return encode_ethernet(session->write_buf, &session->write_idx, &eth);
 }
 
@@ -1117,6 +1229,7 @@ bbl_tx_encode_packet_dhcp(bbl_session_s *session)
     struct dhcp_header header = {0};
     bbl_dhcp_s dhcp = {0};
     access_line_s access_line = {0};
+    bbl_dhcp_template_s *template;
     struct timespec now;
     time_t secs = 0;
 
@@ -1267,6 +1380,13 @@ bbl_tx_encode_packet_dhcp(bbl_session_s *session)
 
     session->stats.dhcp_tx++;
     access_interface->stats.dhcp_tx++;
+    /* The template is skipped if the message does not match,
+     * e.g. renew and release without parameter request list. */
+    template = bbl_dhcp_template_get(session, session->access_config->dhcp_template, &eth);
+    if(template && encode_dhcp_ethernet_template(session->write_buf, &session->write_idx,
+                                                 template, &eth) == PROTOCOL_SUCCESS) {
+        return PROTOCOL_SUCCESS;
+    }
     return encode_ethernet(session->write_buf, &session->write_idx, &eth);
 }
 
@@ -23,9 +23,11 @@
 #include "io_socket.h"
 #include "io_interface.h"
 #include "io_thread.h"
+#include "io_profile.h"
 
 #include "io_raw.h"
 #include "io_packet_mmap.h"
+#include "io_loopback.h"
 
 #ifdef BNGBLASTER_DPDK
 #include "io_dpdk.h"
@@ -37,9 +37,43 @@ typedef enum {
     IO_MODE_PACKET_MMAP,        /* packet_mmap ring */
     IO_MODE_RAW,                /* raw sockets */
     IO_MODE_DPDK,               /* DPDK */
-    IO_MODE_AF_XDP              /* AF_XDP */
+    IO_MODE_AF_XDP,             /* AF_XDP */
+    IO_MODE_LOOPBACK            /* in-process loopback rings */
 } __attribute__ ((__packed__)) io_mode_t;
 
+typedef enum {
+    IO_TIMESTAMPING_USER = 0,   /* user space timestamps per burst */
+    IO_TIMESTAMPING_KERNEL,     /* kernel software timestamps per packet */
+    IO_TIMESTAMPING_HARDWARE    /* NIC hardware timestamps per packet */
+} __attribute__ ((__packed__)) io_timestamping_t;
+
+typedef enum {
+    IO_POLL_SLEEP = 0,          /* fixed sleep per loop */
+    IO_POLL_BUSY,               /* busy polling */
+    IO_POLL_HYBRID,             /* busy polling followed by blocking poll */
+    IO_POLL_TIMER               /* sleep until next stream or interval is due */
+} __attribute__ ((__packed__)) io_poll_t;
+
+typedef enum {
+    IO_PROF_DECODE = 0,         /* decode received packets */
+    IO_PROF_CLASSIFY,           /* stream lookup and accounting in IO threads */
+    IO_PROF_HANDLER,            /* protocol handler in main thread */
+    IO_PROF_BUILD,              /* build packets to be sent */
+    IO_PROF_COPY,               /* copy packets to ring, vector or mbuf */
+    IO_PROF_SYSCALL,            /* system calls or PMD bursts */
+    IO_PROF_MAX
+} __attribute__ ((__packed__)) io_prof_stage_t;
+
+#define IO_PROF_BUCKETS 32
+
+/** Cycle histogram with log2 buckets */
+typedef struct io_prof_ {
+    uint64_t count;
+    uint64_t cycles;
+    uint64_t max;
+    uint64_t hist[IO_PROF_BUCKETS];
+} io_prof_s;
+
 typedef struct io_bucket_ {
     double pps;
     uint64_t nsec;
@@ -55,6 +89,7 @@ typedef struct io_bucket_ {
 typedef struct io_handle_ {
     io_mode_t mode;
     io_direction_t direction;
+    io_timestamping_t timestamping;
 
     int id;
     int fd;
@@ -66,16 +101,32 @@ typedef struct io_handle_ {
     volatile bool update_streams;
 
 #ifdef BNGBLASTER_DPDK
-    struct rte_eth_dev_tx_buffer *tx_buffer;
     struct rte_mempool *mbuf_pool;
-    struct rte_mbuf *mbuf;
+    struct rte_mbuf **tx_mbufs; /* TX burst vector */
+    struct rte_mbuf **tx_spare; /* allocated but unused TX mbufs */
+    uint16_t tx_head; /* first mbuf in TX burst vector not yet sent */
+    uint16_t tx_count; /* number of mbufs in TX burst vector */
+    uint16_t tx_spare_count;
     uint16_t queue;
 #endif
 
+    struct mmsghdr *mmsg; /* sendmmsg/recvmmsg vector */
+    struct iovec *mmsg_iov;
+    struct sockaddr_ll *mmsg_addr;
+    uint8_t *mmsg_buf; /* packet buffers of vector */
+    uint8_t *mmsg_ctrl; /* control buffers of vector (timestamps) */
+    uint16_t mmsg_vlen; /* size of vector */
+    uint16_t mmsg_head; /* first message in vector not yet sent */
+    uint16_t mmsg_count; /* number of messages in vector */
+
     uint8_t *ring; /* ring buffer */
     unsigned int cursor; /* ring buffer cursor */
     unsigned int queued;
 
+    bbl_txq_s *loopback; /* loopback ring (TX) */
+    bbl_txq_s **loopback_peer; /* loopback rings of peer interface (RX) */
+    uint8_t loopback_peer_count;
+
     io_thread_s *thread;
 
     io_bucket_s *bucket_head;
@@ -91,8 +142,11 @@ typedef struct io_handle_ {
 
     uint32_t stream_count;
     double stream_pps;
+    double stream_pps_selected; /* see bbl_stream_select_io */
+    bbl_arena_s stream_arena; /* stream packets, allocated by the TX thread */
     
     struct timespec timestamp; /* user space timestamps */
+    struct timespec timestamp_offset; /* CLOCK_REALTIME - CLOCK_MONOTONIC */
 
     struct {
         uint64_t packets;
@@ -104,8 +158,15 @@ typedef struct io_handle_ {
         uint64_t no_buffer;
         uint64_t polled;
         uint64_t dropped;
+        uint64_t work_ns; /* IO thread time spent with packets */
+        uint64_t poll_ns; /* IO thread time spent polling without packets */
+        uint64_t sleep_ns; /* IO thread time spent sleeping */
     } stats;
 
+#ifdef BNGBLASTER_PROFILING
+    io_prof_s prof[IO_PROF_MAX];
+#endif
+
     struct io_handle_ *next;
 } io_handle_s;
 
@@ -124,6 +185,12 @@ typedef struct io_thread_ {
     io_thread_cb_fn run_fn;
     io_thread_cb_fn teardown_fn;
 
+    io_poll_t poll;
+    uint64_t interval; /* poll interval in nsec */
+    uint64_t timestamp; /* nsec */
+    uint64_t idle; /* nsec, begin of idle polling */
+    uint64_t packets; /* IO packets of previous loop */
+
     uint8_t *sp;
 
     io_handle_s *io;
@@ -38,7 +38,7 @@
 #define NUM_MBUFS 8192
 #define MBUF_CACHE_SIZE 256
 #define BURST_SIZE_RX 256
-#define BURST_SIZE_TX 32
+#define BURST_SIZE_TX 256
 
 extern bool g_init_phase;
 extern bool g_traffic;
@@ -180,6 +180,7 @@ io_dpdk_rx_job(timer_s *timer)
 
     protocol_error_t decode_result;
     bool pcap = false;
+    IO_PROF_VAR(prof);
 
     assert(io->mode == IO_MODE_DPDK);
     assert(io->direction == IO_INGRESS);
@@ -201,7 +202,9 @@ io_dpdk_rx_job(timer_s *timer)
             io->buf_len = packet->pkt_len;
             io->stats.packets++;
             io->stats.bytes += io->buf_len;
+            IO_PROF_START(prof);
             decode_result = decode_ethernet(io->buf, io->buf_len, g_ctx->sp, SCRATCHPAD_LEN, &eth);
+            IO_PROF_STOP(io, IO_PROF_DECODE, prof);
             if(decode_result == PROTOCOL_SUCCESS) {
                 /* Copy RX timestamp */
                 eth->timestamp.tv_sec = io->timestamp.tv_sec;
@@ -212,7 +215,9 @@ io_dpdk_rx_job(timer_s *timer)
                     pcapng_push_packet_header(&io->timestamp, io->buf, io->buf_len,
                                               interface->ifindex, PCAPNG_EPB_FLAGS_INBOUND);
                 }
+                IO_PROF_START(prof);
                 bbl_rx_handler(interface, eth);
+                IO_PROF_STOP(io, IO_PROF_HANDLER, prof);
             } else {
                 /* Dump the packet into pcap file */
                 if(g_ctx->pcap.write_buf) {
@@ -234,28 +239,88 @@ io_dpdk_rx_job(timer_s *timer)
     }
 }
 
+/*
+ * Send all pending mbufs of the TX burst vector with
+ * a single rte_eth_tx_burst call. Returns false if the
+ * TX queue is full, in this case the remaining mbufs are
+ * kept in the vector and retried with the next call.
+ */
 static bool
-io_dpdk_mbuf_alloc(io_handle_s *io)
+io_dpdk_tx_flush(io_handle_s *io)
 {
-    struct rte_mbuf *mbuf = rte_pktmbuf_alloc(io->mbuf_pool);
-    if(!mbuf) {
-        io->stats.no_buffer++;
-        return false;
+    uint16_t sent;
+    IO_PROF_VAR(prof);
+
+    if(io->tx_head < io->tx_count) {
+        IO_PROF_START(prof);
+        sent = rte_eth_tx_burst(io->interface->port_id, io->queue,
+                                &io->tx_mbufs[io->tx_head],
+                                io->tx_count - io->tx_head);
+        IO_PROF_STOP(io, IO_PROF_SYSCALL, prof);
+        io->tx_head += sent;
+        if(io->tx_head < io->tx_count) {
+            io->stats.no_buffer++;
+            return false;
+        }
     }
-    if(rte_pktmbuf_append(mbuf, 2048) == NULL) {
-        rte_pktmbuf_free(mbuf);
-        io->stats.no_buffer++;
-        return false;
+    io->tx_head = 0;
+    io->tx_count = 0;
+    return true;
+}
+
+/*
+ * Ensure that the TX burst vector has space for one
+ * more packet and that a free mbuf is available. 
+ * Free mbufs are allocated in bulk and kept over
+ * multiple runs.
+ */
+static inline bool
+io_dpdk_tx_reserve(io_handle_s *io)
+{
+    if(io->tx_count == BURST_SIZE_TX) {
+        if(!io_dpdk_tx_flush(io)) {
+            return false;
+        }
+    }
+    if(io->tx_spare_count == 0) {
+        if(rte_pktmbuf_alloc_bulk(io->mbuf_pool, io->tx_spare, BURST_SIZE_TX) != 0) {
+            io->stats.no_buffer++;
+            return false;
+        }
+        io->tx_spare_count = BURST_SIZE_TX;
     }
-    mbuf->data_len = 0;
-    mbuf->next = NULL;
-    
-    io->mbuf = mbuf;
-    io->buf = rte_pktmbuf_mtod(mbuf, uint8_t *);
-    io->buf_len = 0;
     return true;
 }
 
+/*
+ * Copy packet into the next free mbuf and add 
+ * this to the TX burst vector. This requires a 
+ * successful call of io_dpdk_tx_reserve before. 
+ */
+static inline uint8_t *
+io_dpdk_tx_push(io_handle_s *io, uint8_t *buf, uint16_t len)
+{
+    struct rte_mbuf *mbuf = io->tx_spare[io->tx_spare_count-1];
+    uint8_t *data;
+    IO_PROF_VAR(prof);
+
+    if(unlikely(len > rte_pktmbuf_tailroom(mbuf))) {
+        io->stats.to_long++;
+        return NULL;
+    }
+    io->tx_spare_count--;
+    data = rte_pktmbuf_mtod(mbuf, uint8_t *);
+    IO_PROF_START(prof);
+    memcpy(data, buf, len);
+    IO_PROF_STOP(io, IO_PROF_COPY, prof);
+    mbuf->data_len = len;
+    mbuf->pkt_len = len;
+    io->tx_mbufs[io->tx_count++] = mbuf;
+    io->stats.packets++;
+    io->stats.bytes += len;
+    return data;
+}
+
 /*
  * This job is for DPDK TX in main thread!
  */
@@ -268,7 +333,9 @@ io_dpdk_tx_job(timer_s *timer)
     bbl_stream_s *stream = NULL;
     uint16_t burst = interface->config->io_burst;
     uint64_t now;
+    uint8_t *data;
     bool pcap = false;
+    IO_PROF_VAR(prof);
 
     assert(io->mode == IO_MODE_DPDK);
     assert(io->direction == IO_EGRESS);
@@ -278,82 +345,76 @@ io_dpdk_tx_job(timer_s *timer)
         io_stream_update_pps(io);
     }
 
+    /* Retry pending packets of the previous interval first. */
+    if(!io_dpdk_tx_flush(io)) {
+        return;
+    }
+
     /* Get TX timestamp */
     //clock_gettime(CLOCK_MONOTONIC, &io->timestamp);
     io->timestamp.tv_sec = timer->timestamp->tv_sec;
     io->timestamp.tv_nsec = timer->timestamp->tv_nsec;
 
     while(burst) {
-        if(!io->mbuf) {
-            if(!io_dpdk_mbuf_alloc(io)) {
-                break;
-            }
+        if(!io_dpdk_tx_reserve(io)) {
+            /* No space in the TX burst vector or no free mbuf,
+             * control traffic is generated next interval. */
+            burst = 0;
+            break;
         }
         if(likely(io->buf_len == 0)) {
+            IO_PROF_START(prof);
             if(bbl_tx(interface, io->buf, &io->buf_len) != PROTOCOL_SUCCESS) {
                 io->buf_len = 0;
                 break;
-            }        
+            }
+            IO_PROF_STOP(io, IO_PROF_BUILD, prof);
         }
-        /* Transmit the packet. */
-        io->mbuf->data_len = io->buf_len;
-        if(rte_eth_tx_burst(interface->port_id, io->queue, &io->mbuf, 1) != 0) {
+        data = io_dpdk_tx_push(io, io->buf, io->buf_len);
+        if(data) {
             /* Dump the packet into pcap file. */
             if(unlikely(g_ctx->pcap.write_buf != NULL)) {
                 pcap = true;
-                pcapng_push_packet_header(&io->timestamp, io->buf, io->buf_len,
+                pcapng_push_packet_header(&io->timestamp, data, io->buf_len,
                                           interface->ifindex, PCAPNG_EPB_FLAGS_OUTBOUND);
             }
-            io->stats.packets++;
-            io->stats.bytes += io->buf_len;
-            io->mbuf = NULL;
-            io->buf_len = 0;
-            burst--;
-        } else {
-            /* This packet will be retried next interval 
-             * because io->buf_len is not reset to zero. */
-            io->stats.io_errors++;
-            burst = 0;
         }
+        io->buf_len = 0;
+        burst--;
     }
     if(g_traffic && g_init_phase == false && interface->state == INTERFACE_UP) {
         now = timespec_to_nsec(timer->timestamp);
         while(burst) {
             /* Send traffic streams up to allowed burst. */
-            if(!io->mbuf) {
-                if(!io_dpdk_mbuf_alloc(io)) {
-                    break;
-                }
+            if(!io_dpdk_tx_reserve(io)) {
+                break;
             }
+            IO_PROF_START(prof);
             stream = bbl_stream_io_send_iter(io, now);
+            IO_PROF_STOP(io, IO_PROF_BUILD, prof);
             if(unlikely(stream == NULL)) {
                 break;
             }
-            /* Transmit the packet. */
-            io->mbuf->data_len = stream->tx_len;
-            memcpy(io->buf, stream->tx_buf, stream->tx_len);
-            if(rte_eth_tx_burst(interface->port_id, io->queue, &io->mbuf, 1) != 0) {
+            data = io_dpdk_tx_push(io, stream->tx_buf, stream->tx_len);
+            if(data) {
                 /* Dump the packet into pcap file. */
                 if(unlikely(g_ctx->pcap.write_buf && g_ctx->pcap.include_streams)) {
                     pcap = true;
-                    pcapng_push_packet_header(&io->timestamp, io->buf, stream->tx_len,
-                                            interface->ifindex, PCAPNG_EPB_FLAGS_OUTBOUND);
+                    pcapng_push_packet_header(&io->timestamp, data, stream->tx_len,
+                                              interface->ifindex, PCAPNG_EPB_FLAGS_OUTBOUND);
                 }
+                /* The packet is accounted when added to the burst 
+                 * vector, pending packets are retried next interval. */
                 stream->tx_packets++;
                 stream->flow_seq++;
-                io->stats.packets++;
-                io->stats.bytes += stream->tx_len;
-                io->mbuf = NULL;
-                burst--;
-            } else {
-                /* Failed to send stream packet */
-                io->stats.io_errors++;
-                burst = 0;
             }
+            burst--;
         }
     } else {
         bbl_stream_io_stop(io);
     }
+    /* Transmit the burst vector. */
+    io_dpdk_tx_flush(io);
     if(pcap) {
         pcapng_fflush();
     }
@@ -376,14 +437,14 @@ io_dpdk_thread_rx_run_fn(io_thread_s *thread)
     assert(io->direction == IO_INGRESS);
     assert(io->thread);
 
-    struct timespec sleep, rem;
+    struct timespec sleep;
     sleep.tv_sec = 0;
     sleep.tv_nsec = 10;
 
     while(thread->active) {
         nb_rx = rte_eth_rx_burst(port_id, io->queue, pkts_burst, BURST_SIZE_RX);
         if(nb_rx == 0) {
-            nanosleep(&sleep, &rem);
+            io_thread_wait(thread, &sleep);
             continue;
         }
         /* Get RX timestamp */
@@ -413,8 +474,9 @@ io_dpdk_thread_tx_run_fn(io_thread_s *thread)
     uint16_t io_burst = interface->config->io_burst;
     uint16_t burst = 0;
     uint64_t now;
+    IO_PROF_VAR(prof);
 
-    struct timespec sleep, rem;
+    struct timespec sleep;
     sleep.tv_sec = 0;
     sleep.tv_nsec = 1000; 
 
@@ -422,38 +484,29 @@ io_dpdk_thread_tx_run_fn(io_thread_s *thread)
     assert(io->direction == IO_EGRESS);
     assert(io->thread);
 
-
-
     while(thread->active) {
-        nanosleep(&sleep, &rem);
+        io_thread_wait(thread, &sleep);
         if(io->update_streams) {
             io_stream_update_pps(io);
         }
+
+        /* Retry pending packets of the previous run first. */
+        if(!io_dpdk_tx_flush(io)) {
+            continue;
+        }
         burst = io_burst;
 
         /* First send all control traffic which has higher priority. */
         while((slot = bbl_txq_read_slot(txq))) {
             /* This packet will be retried next interval 
              * because slot is not marked as read. */
-            if(!io->mbuf) {
-                if(!io_dpdk_mbuf_alloc(io)) {
-                    break;
-                }
-            }
-            /* Transmit the packet. */
-            io->mbuf->data_len = slot->packet_len;
-            memcpy(io->buf, slot->packet, slot->packet_len);
-            if(rte_eth_tx_burst(interface->port_id, io->queue, &io->mbuf, 1) != 0) {
-                io->stats.packets++;
-                io->stats.bytes += slot->packet_len;
-                io->mbuf = NULL;
-                bbl_txq_read_next(txq);
-                if(burst) burst--;
-            } else {
-                io->stats.io_errors++;
+            if(!io_dpdk_tx_reserve(io)) {
                 burst = 0;
                 break;
             }
+            io_dpdk_tx_push(io, slot->packet, slot->packet_len);
+            bbl_txq_read_next(txq);
+            if(burst) burst--;
         }
 
         /* Get TX timestamp */
@@ -463,36 +516,74 @@ io_dpdk_thread_tx_run_fn(io_thread_s *thread)
             now = timespec_to_nsec(&io->timestamp);
             while(burst) {
                 /* Send traffic streams up to allowed burst. */
-                if(!io->mbuf) {
-                    if(!io_dpdk_mbuf_alloc(io)) {
-                        break;
-                    }
+                if(!io_dpdk_tx_reserve(io)) {
+                    break;
                 }
+                IO_PROF_START(prof);
                 stream = bbl_stream_io_send_iter(io, now);
+                IO_PROF_STOP(io, IO_PROF_BUILD, prof);
                 if(unlikely(stream == NULL)) {
                     break;
                 }
-                /* Transmit the packet. */
-                io->mbuf->data_len = stream->tx_len;
-                memcpy(io->buf, stream->tx_buf, stream->tx_len);
-                if(rte_eth_tx_burst(interface->port_id, io->queue, &io->mbuf, 1) != 0) {
+                if(io_dpdk_tx_push(io, stream->tx_buf, stream->tx_len)) {
                     stream->tx_packets++;
                     stream->flow_seq++;
-                    io->stats.packets++;
-                    io->stats.bytes += stream->tx_len;
-                    io->mbuf = NULL;
-                    burst--;
-                } else {
-                    io->stats.io_errors++;
-                    burst = 0;
                 }
+                burst--;
             }
         } else {
             bbl_stream_io_stop(io);
         }
+
+        /* Transmit the burst vector. */
+        io_dpdk_tx_flush(io);
     }
 }
 
+/**
+ * io_dpdk_close
+ *
+ * Free all mbufs held by the TX burst vectors
+ * (pending and spare) of all DPDK IO handles.
+ * This must be called after all IO threads are stopped.
+ */
+void
+io_dpdk_close()
+{
+    bbl_interface_s *interface;
+    io_handle_s *io;
+
+    if(!g_ctx->dpdk) {
+        return;
+    }
+
+    CIRCLEQ_FOREACH(interface, &g_ctx->interface_qhead, interface_qnode) {
+        io = interface->io.tx;
+        while(io) {
+            if(io->mode == IO_MODE_DPDK) {
+                if(io->tx_mbufs) {
+                    if(io->tx_head < io->tx_count) {
+                        rte_pktmbuf_free_bulk(&io->tx_mbufs[io->tx_head],
+                                              io->tx_count - io->tx_head);
+                    }
+                    free(io->tx_mbufs);
+                    io->tx_mbufs = NULL;
+                }
+                io->tx_head = 0;
+                io->tx_count = 0;
+                if(io->tx_spare) {
+                    if(io->tx_spare_count) {
+                        rte_pktmbuf_free_bulk(io->tx_spare, io->tx_spare_count);
+                    }
+                    free(io->tx_spare);
+                    io->tx_spare = NULL;
+                }
+                io->tx_spare_count = 0;
+            }
+            io = io->next;
+        }
+    }
+}
 
 bool
 io_dpdk_add_mbuf_pool(io_handle_s *io)
@@ -709,21 +800,12 @@ io_dpdk_interface_init(bbl_interface_s *interface)
             return false;
         }
 
-        /* Initialize TX buffers */
-        io->tx_buffer = rte_zmalloc_socket("tx_buffer",
-                RTE_ETH_TX_BUFFER_SIZE(BURST_SIZE_TX), 0,
-                rte_eth_dev_socket_id(port_id));
-        if (!io->tx_buffer) {
-            LOG(ERROR, "DPDK: interface %s (%u) failed to allocate TX buffer for queue %u (error %d)\n",
-                interface->name, port_id, queue, ret);
-            return false;
-        }
-        rte_eth_tx_buffer_init(io->tx_buffer, BURST_SIZE_TX);
-        ret = rte_eth_tx_buffer_set_err_callback(io->tx_buffer, 
-            rte_eth_tx_buffer_count_callback, &io->stats.dropped);
-        if(ret < 0) {
-            LOG(ERROR, "DPDK: interface %s (%u) failed to set TX error callback for queue %u (error %d)\n",
-                interface->name, port_id, queue, ret);
+        /* Initialize TX burst vector */
+        io->tx_mbufs = calloc(BURST_SIZE_TX, sizeof(struct rte_mbuf *));
+        io->tx_spare = calloc(BURST_SIZE_TX, sizeof(struct rte_mbuf *));
+        if(!(io->tx_mbufs && io->tx_spare)) {
+            LOG(ERROR, "DPDK: interface %s (%u) failed to allocate TX burst vector for queue %u\n",
+                interface->name, port_id, queue);
             return false;
         }
     }
@@ -86,6 +86,7 @@ io_interface_init_rx(bbl_interface_s *interface)
             io->mode = IO_MODE_PACKET_MMAP;
         }
         io->direction = IO_INGRESS;
+        io->timestamping = config->io_timestamping;
         io->next = interface->io.rx;
         interface->io.rx = io;
         io->interface = interface;
@@ -105,6 +106,11 @@ io_interface_init_rx(bbl_interface_s *interface)
                     return false;
                 }
                 break;
+            case IO_MODE_LOOPBACK:
+                if(!io_loopback_init(io)) {
+                    return false;
+                }
+                break;
             default:
                 return false;
         }
@@ -132,6 +138,7 @@ io_interface_init_tx(bbl_interface_s *interface)
             io->mode = IO_MODE_RAW;
         }
         io->direction = IO_EGRESS;
+        io->timestamping = config->io_timestamping;
         io->next = interface->io.tx;
         interface->io.tx = io;
         io->interface = interface;
@@ -151,6 +158,11 @@ io_interface_init_tx(bbl_interface_s *interface)
                     return false;
                 }
                 break;
+            case IO_MODE_LOOPBACK:
+                if(!io_loopback_init(io)) {
+                    return false;
+                }
+                break;
             default:
                 return false;
         }
@@ -214,7 +226,24 @@ io_interface_init(bbl_interface_s *interface)
     }
 #endif
 
-    if(config->io_mode != IO_MODE_DPDK) {
+    if(config->io_mode == IO_MODE_LOOPBACK) {
+        /* Loopback interfaces have no kernel interface,
+         * therefore a locally administered MAC address
+         * is derived from the interface index. */
+        if(*(uint32_t*)config->mac) {
+            memcpy(interface->mac, config->mac, ETH_ADDR_LEN);
+        } else {
+            interface->mac[0] = 0x02;
+            interface->mac[4] = (interface->ifindex + 1) >> 8;
+            interface->mac[5] = (interface->ifindex + 1) & 0xff;
+        }
+        if(!io_interface_init_rx(interface)) {
+            return false;
+        }
+        if(!io_interface_init_tx(interface)) {
+            return false;
+        }
+    } else if(config->io_mode != IO_MODE_DPDK) {
         address_warning(interface);
         if(!set_kernel_info(interface)) {
             return false;
@@ -0,0 +1,542 @@
+/*
+ * BNG Blaster (BBL) - IO Loopback
+ *
+ * The loopback IO mode connects the TX of an interface
+ * with the RX of a peer interface (or itself) through
+ * lock-free rings without any network interfaces, which
+ * allows to test the full pipeline on any host.
+ *
+ * agent, October 2026
+ *
+ * Copyright (C) 2020-2025, RtBrick, Inc.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include "io.h"
+
+extern bool g_init_phase;
+extern bool g_traffic;
+
+/**
+ * Emulate the forwarding plane of a router for packets
+ * received on loopback interfaces with reflector enabled.
+ *
+ * The destination MAC address is set to the receiving
+ * interface and the source MAC address to the original
+ * destination (unicast only). The TTL or hop limit of
+ * IPv4 and IPv6 (also within PPPoE sessions) and MPLS
+ * is decremented.
+ *
+ * @param io IO handle
+ * @return false if packet must be dropped
+ */
+static bool
+io_loopback_reflect(io_handle_s *io)
+{
+    uint8_t *buf = io->buf;
+    uint16_t len = io->buf_len;
+    uint16_t offset = ETH_ADDR_LEN*2;
+    uint16_t type;
+    uint32_t check;
+
+    if(len < 14) {
+        return false;
+    }
+    if(!(buf[0] & 0x01)) {
+        memcpy(buf+ETH_ADDR_LEN, buf, ETH_ADDR_LEN);
+        memcpy(buf, io->interface->mac, ETH_ADDR_LEN);
+    }
+
+    type = be16toh(*(uint16_t*)(buf+offset));
+    offset += 2;
+    while(type == ETH_TYPE_VLAN || type == ETH_TYPE_QINQ) {
+        if(offset + 4 > len) return true;
+        type = be16toh(*(uint16_t*)(buf+offset+2));
+        offset += 4;
+    }
+    if(type == ETH_TYPE_PPPOE_SESSION) {
+        if(offset + 8 > len) return true;
+        switch(be16toh(*(uint16_t*)(buf+offset+6))) {
+            case PROTOCOL_IPV4:
+                type = ETH_TYPE_IPV4;
+                break;
+            case PROTOCOL_IPV6:
+                type = ETH_TYPE_IPV6;
+                break;
+            default:
+                return true;
+        }
+        offset += 8;
+    }
+
+    switch(type) {
+        case ETH_TYPE_IPV4:
+            if(offset + 20 > len) return true;
+            if(buf[offset+8] <= 1) return false;
+            buf[offset+8]--;
+            /* Incremental checksum update (RFC 1624) */
+            check = *(uint16_t*)(buf+offset+10);
+            check += htobe16(0x0100);
+            *(uint16_t*)(buf+offset+10) = check + (check >= 0xFFFF);
+            break;
+        case ETH_TYPE_IPV6:
+            if(offset + 40 > len) return true;
+            if(buf[offset+7] <= 1) return false;
+            buf[offset+7]--;
+            break;
+        case ETH_TYPE_MPLS:
+            if(offset + 4 > len) return true;
+            if(buf[offset+3] <= 1) return false;
+            buf[offset+3]--;
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+/**
+ * Load received packet from ring slot into io->buf,
+ * returns false if the packet should be skipped.
+ */
+static inline bool
+io_loopback_rx_load(io_handle_s *io, bbl_txq_slot_t *slot)
+{
+    io->buf = slot->packet;
+    io->buf_len = slot->packet_len;
+    if(io->interface->config->loopback_reflector) {
+        if(!io_loopback_reflect(io)) {
+            io->stats.dropped++;
+            return false;
+        }
+    }
+    return true;
+}
+
+static inline void
+io_loopback_tx_push(io_handle_s *io, bbl_txq_slot_t *slot, uint16_t len)
+{
+    slot->packet_len = len;
+    slot->timestamp.tv_sec = io->timestamp.tv_sec;
+    slot->timestamp.tv_nsec = io->timestamp.tv_nsec;
+    bbl_txq_write_next(io->loopback);
+    io->stats.packets++;
+    io->stats.bytes += len;
+}
+
+/**
+ * Send traffic streams up to allowed burst.
+ *
+ * @param io IO handle
+ * @param burst max packets
+ * @param now nsec timestamp (CLOCK_MONOTONIC)
+ * @param pcap dump stream packets to pcap if not NULL
+ */
+static void
+io_loopback_tx_streams(io_handle_s *io, uint16_t burst, uint64_t now, bool *pcap)
+{
+    bbl_interface_s *interface = io->interface;
+    bbl_txq_slot_t *slot;
+    bbl_stream_s *stream;
+    IO_PROF_VAR(prof);
+
+    while(burst) {
+        slot = bbl_txq_write_slot(io->loopback);
+        if(!slot) {
+            io->stats.no_buffer++;
+            break;
+        }
+        if(io->timestamping) {
+            /* TX timestamp per packet */
+            clock_gettime(CLOCK_MONOTONIC, &io->timestamp);
+        }
+        IO_PROF_START(prof);
+        stream = bbl_stream_io_send_iter(io, now);
+        IO_PROF_STOP(io, IO_PROF_BUILD, prof);
+        if(unlikely(stream == NULL)) {
+            break;
+        }
+        if(likely(stream->tx_len <= BBL_TXQ_BUFFER_LEN)) {
+            IO_PROF_START(prof);
+            memcpy(slot->packet, stream->tx_buf, stream->tx_len);
+            IO_PROF_STOP(io, IO_PROF_COPY, prof);
+            io_loopback_tx_push(io, slot, stream->tx_len);
+            /* Dump the packet into pcap file. */
+            if(unlikely(pcap && g_ctx->pcap.write_buf && g_ctx->pcap.include_streams)) {
+                *pcap = true;
+                pcapng_push_packet_header(&io->timestamp, stream->tx_buf, stream->tx_len,
+                                          interface->ifindex, PCAPNG_EPB_FLAGS_OUTBOUND);
+            }
+        } else {
+            io->stats.to_long++;
+        }
+        stream->tx_packets++;
+        stream->flow_seq++;
+        burst--;
+    }
+}
+
+/**
+ * This job is for loopback RX in main thread!
+ */
+void
+io_loopback_rx_job(timer_s *timer)
+{
+    io_handle_s *io = timer->data;
+    bbl_interface_s *interface = io->interface;
+
+    bbl_txq_s *ring;
+    bbl_txq_slot_t *slot;
+    bbl_ethernet_header_s *eth;
+
+    protocol_error_t decode_result;
+    bool pcap = false;
+    IO_PROF_VAR(prof);
+
+    uint16_t count;
+    uint8_t i;
+
+    assert(io->mode == IO_MODE_LOOPBACK);
+    assert(io->direction == IO_INGRESS);
+    assert(io->thread == NULL);
+
+    /* Get RX timestamp */
+    io->timestamp.tv_sec = timer->timestamp->tv_sec;
+    io->timestamp.tv_nsec = timer->timestamp->tv_nsec;
+    for(i = 0; i < io->loopback_peer_count; i++) {
+        ring = io->loopback_peer[i];
+        /* Limit to ring size per run to prevent starvation
+         * if the peer is sending faster than we can process. */
+        count = ring->size;
+        while(count-- && (slot = bbl_txq_read_slot(ring))) {
+            if(!io_loopback_rx_load(io, slot)) {
+                bbl_txq_read_next(ring);
+                continue;
+            }
+            io->stats.packets++;
+            io->stats.bytes += io->buf_len;
+            IO_PROF_START(prof);
+            decode_result = decode_ethernet(io->buf, io->buf_len, g_ctx->sp, SCRATCHPAD_LEN, &eth);
+            IO_PROF_STOP(io, IO_PROF_DECODE, prof);
+            if(decode_result == PROTOCOL_SUCCESS) {
+                /* Copy RX timestamp */
+                eth->timestamp.tv_sec = io->timestamp.tv_sec;
+                eth->timestamp.tv_nsec = io->timestamp.tv_nsec;
+                /* Dump the packet into pcap file */
+                if(g_ctx->pcap.write_buf && (!eth->bbl || g_ctx->pcap.include_streams)) {
+                    pcap = true;
+                    pcapng_push_packet_header(&io->timestamp, io->buf, io->buf_len,
+                                              interface->ifindex, PCAPNG_EPB_FLAGS_INBOUND);
+                }
+                IO_PROF_START(prof);
+                bbl_rx_handler(interface, eth);
+                IO_PROF_STOP(io, IO_PROF_HANDLER, prof);
+            } else {
+                /* Dump the packet into pcap file */
+                if(g_ctx->pcap.write_buf) {
+                    pcap = true;
+                    pcapng_push_packet_header(&io->timestamp, io->buf, io->buf_len,
+                                              interface->ifindex, PCAPNG_EPB_FLAGS_INBOUND);
+                }
+                if(decode_result == UNKNOWN_PROTOCOL) {
+                    io->stats.unknown++;
+                } else {
+                    io->stats.protocol_errors++;
+                }
+            }
+            bbl_txq_read_next(ring);
+        }
+    }
+    if(pcap) {
+        pcapng_fflush();
+    }
+}
+
+/**
+ * This job is for loopback TX in main thread!
+ */
+void
+io_loopback_tx_job(timer_s *timer)
+{
+    io_handle_s *io = timer->data;
+    bbl_interface_s *interface = io->interface;
+
+    bbl_txq_slot_t *slot;
+    uint16_t burst = interface->config->io_burst;
+    uint16_t len;
+    bool pcap = false;
+    IO_PROF_VAR(prof);
+
+    assert(io->mode == IO_MODE_LOOPBACK);
+    assert(io->direction == IO_EGRESS);
+    assert(io->thread == NULL);
+
+    if(io->update_streams) {
+        io_stream_update_pps(io);
+    }
+
+    /* Get TX timestamp */
+    io->timestamp.tv_sec = timer->timestamp->tv_sec;
+    io->timestamp.tv_nsec = timer->timestamp->tv_nsec;
+
+    while(burst) {
+        slot = bbl_txq_write_slot(io->loopback);
+        if(!slot) {
+            io->stats.no_buffer++;
+            burst = 0;
+            break;
+        }
+        IO_PROF_START(prof);
+        if(bbl_tx(interface, slot->packet, &len) != PROTOCOL_SUCCESS) {
+            break;
+        }
+        IO_PROF_STOP(io, IO_PROF_BUILD, prof);
+        io_loopback_tx_push(io, slot, len);
+        /* Dump the packet into pcap file. */
+        if(unlikely(g_ctx->pcap.write_buf != NULL)) {
+            pcap = true;
+            pcapng_push_packet_header(&io->timestamp, slot->packet, len,
+                                      interface->ifindex, PCAPNG_EPB_FLAGS_OUTBOUND);
+        }
+        burst--;
+    }
+
+    if(g_traffic && g_init_phase == false && interface->state == INTERFACE_UP) {
+        io_loopback_tx_streams(io, burst, timespec_to_nsec(timer->timestamp), &pcap);
+    } else {
+        bbl_stream_io_stop(io);
+    }
+    if(unlikely(pcap)) {
+        pcapng_fflush();
+    }
+}
+
+void
+io_loopback_thread_rx_run_fn(io_thread_s *thread)
+{
+    io_handle_s *io = thread->io;
+
+    bbl_txq_s *ring;
+    bbl_txq_slot_t *slot;
+    uint16_t count;
+    bool received;
+    uint8_t i;
+
+    assert(io->mode == IO_MODE_LOOPBACK);
+    assert(io->direction == IO_INGRESS);
+    assert(io->thread);
+
+    struct timespec sleep;
+    sleep.tv_sec = 0;
+    sleep.tv_nsec = 1000; /* 0.001ms */
+
+    while(thread->active) {
+        received = false;
+        for(i = 0; i < io->loopback_peer_count; i++) {
+            ring = io->loopback_peer[i];
+            if(bbl_txq_is_empty(ring)) {
+                continue;
+            }
+            if(!received) {
+                /* Get RX timestamp */
+                clock_gettime(CLOCK_MONOTONIC, &io->timestamp);
+                received = true;
+            }
+            count = ring->size;
+            while(count-- && (slot = bbl_txq_read_slot(ring))) {
+                if(io_loopback_rx_load(io, slot)) {
+                    /* Process packet */
+                    io_thread_rx_handler(thread, io);
+                }
+                bbl_txq_read_next(ring);
+            }
+        }
+        if(!received) {
+            io_thread_wait(thread, &sleep);
+        }
+    }
+}
+
+void
+io_loopback_thread_tx_run_fn(io_thread_s *thread)
+{
+    io_handle_s *io = thread->io;
+    bbl_interface_s *interface = io->interface;
+
+    bbl_txq_s *txq = thread->txq;
+    bbl_txq_slot_t *slot;
+    bbl_txq_slot_t *tx_slot;
+
+    uint16_t io_burst = interface->config->io_burst;
+    uint16_t burst = 0;
+    IO_PROF_VAR(prof);
+
+    struct timespec sleep;
+    sleep.tv_sec = 0;
+    sleep.tv_nsec = 1000 * io_burst;
+
+    assert(io->mode == IO_MODE_LOOPBACK);
+    assert(io->direction == IO_EGRESS);
+    assert(io->thread);
+
+    while(thread->active) {
+        io_thread_wait(thread, &sleep);
+        if(io->update_streams) {
+            io_stream_update_pps(io);
+        }
+        burst = io_burst;
+
+        /* Get TX timestamp */
+        clock_gettime(CLOCK_MONOTONIC, &io->timestamp);
+
+        /* First send all control traffic which has higher priority. */
+        while((slot = bbl_txq_read_slot(txq))) {
+            tx_slot = bbl_txq_write_slot(io->loopback);
+            if(!tx_slot) {
+                io->stats.no_buffer++;
+                burst = 0;
+                break;
+            }
+            IO_PROF_START(prof);
+            memcpy(tx_slot->packet, slot->packet, slot->packet_len);
+            IO_PROF_STOP(io, IO_PROF_COPY, prof);
+            io_loopback_tx_push(io, tx_slot, slot->packet_len);
+            bbl_txq_read_next(txq);
+            if(burst) burst--;
+        }
+
+        if(g_traffic && g_init_phase == false && interface->state == INTERFACE_UP) {
+            io_loopback_tx_streams(io, burst, timespec_to_nsec(&io->timestamp), NULL);
+        } else {
+            bbl_stream_io_stop(io);
+        }
+    }
+}
+
+/**
+ * Return the peer of a loopback interface, which is
+ * either the explicitly configured peer, the interface
+ * referencing this interface as peer or the interface
+ * itself.
+ */
+static bbl_interface_s *
+io_loopback_peer(bbl_interface_s *interface)
+{
+    bbl_interface_s *peer;
+
+    if(interface->config->loopback_peer) {
+        return bbl_interface_get(interface->config->loopback_peer);
+    }
+    CIRCLEQ_FOREACH(peer, &g_ctx->interface_qhead, interface_qnode) {
+        if(peer->config && peer->config->io_mode == IO_MODE_LOOPBACK &&
+           peer->config->loopback_peer &&
+           strcmp(peer->config->loopback_peer, interface->name) == 0) {
+            return peer;
+        }
+    }
+    return interface;
+}
+
+/**
+ * io_loopback_connect
+ *
+ * Connect the RX of all loopback interfaces with the
+ * TX rings of the corresponding peer interface. The
+ * TX rings of the peer are distributed over the RX
+ * handles, such that each ring has a single reader.
+ *
+ * @return true if all loopback interfaces are connected
+ */
+bool
+io_loopback_connect()
+{
+    bbl_interface_s *interface;
+    bbl_interface_s *peer;
+    io_handle_s *io;
+    io_handle_s *tx;
+    uint8_t rx_count;
+    uint8_t count;
+
+    CIRCLEQ_FOREACH(interface, &g_ctx->interface_qhead, interface_qnode) {
+        if(!(interface->config && interface->config->io_mode == IO_MODE_LOOPBACK)) {
+            continue;
+        }
+        peer = io_loopback_peer(interface);
+        if(!(peer && peer->config && peer->config->io_mode == IO_MODE_LOOPBACK)) {
+            LOG(ERROR, "Failed to connect loopback interface %s (peer %s is not a loopback link)\n",
+                interface->name, interface->config->loopback_peer);
+            return false;
+        }
+        if(io_loopback_peer(peer) != interface) {
+            LOG(ERROR, "Failed to connect loopback interface %s (peer %s is connected to another interface)\n",
+                interface->name, peer->name);
+            return false;
+        }
+
+        rx_count = 0;
+        for(io = interface->io.rx; io; io = io->next) {
+            rx_count++;
+        }
+        for(io = interface->io.rx; io; io = io->next) {
+            count = 0;
+            for(tx = peer->io.tx; tx; tx = tx->next) {
+                if(tx->id % rx_count == io->id) count++;
+            }
+            io->loopback_peer = calloc(count ? count : 1, sizeof(bbl_txq_s*));
+            if(!io->loopback_peer) {
+                return false;
+            }
+            io->loopback_peer_count = 0;
+            for(tx = peer->io.tx; tx; tx = tx->next) {
+                if(tx->id % rx_count == io->id) {
+                    io->loopback_peer[io->loopback_peer_count++] = tx->loopback;
+                }
+            }
+        }
+        LOG(DEBUG, "Connected loopback interface %s with %s\n", interface->name, peer->name);
+    }
+    return true;
+}
+
+void
+io_loopback_set_max_stream_len()
+{
+    uint16_t len = BBL_TXQ_BUFFER_LEN - BBL_MAX_STREAM_OVERHEAD;
+
+    if(len < g_ctx->config.io_max_stream_len) {
+        LOG(DEBUG, "Set max allowed stream length to %u because of loopback limitations\n", len);
+        g_ctx->config.io_max_stream_len = len;
+    }
+}
+
+bool
+io_loopback_init(io_handle_s *io)
+{
+    bbl_interface_s *interface = io->interface;
+    bbl_link_config_s *config = interface->config;
+
+    io_thread_s *thread = io->thread;
+
+    if(io->direction == IO_EGRESS) {
+        io->loopback = calloc(1, sizeof(bbl_txq_s));
+        if(!(io->loopback && bbl_txq_init(io->loopback, config->io_slots_tx))) {
+            return false;
+        }
+    }
+
+    if(thread) {
+        if(io->direction == IO_INGRESS) {
+            thread->run_fn = io_loopback_thread_rx_run_fn;
+        } else {
+            thread->run_fn = io_loopback_thread_tx_run_fn;
+        }
+    } else {
+        if(io->direction == IO_INGRESS) {
+            timer_add_periodic(&g_ctx->timer_root, &interface->io.rx_job, "RX", 0,
+                config->rx_interval, io, &io_loopback_rx_job);
+        } else {
+            timer_add_periodic(&g_ctx->timer_root, &interface->io.tx_job, "TX", 0,
+                config->tx_interval, io, &io_loopback_tx_job);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,21 @@
+/*
+ * BNG Blaster (BBL) - IO Loopback
+ *
+ * agent, October 2026
+ *
+ * Copyright (C) 2020-2025, RtBrick, Inc.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef __BBL_IO_LOOPBACK_H__
+#define __BBL_IO_LOOPBACK_H__
+
+bool
+io_loopback_init(io_handle_s *io);
+
+bool
+io_loopback_connect();
+
+void
+io_loopback_set_max_stream_len();
+
+#endif
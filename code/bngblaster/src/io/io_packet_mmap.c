@@ -50,7 +50,9 @@ io_packet_mmap_rx_job(timer_s *timer)
     uint16_t vlan;
 
     protocol_error_t decode_result;
+    struct timespec timestamp;
     bool pcap = false;
+    IO_PROF_VAR(prof);
 
     assert(io->mode == IO_MODE_PACKET_MMAP);
     assert(io->direction == IO_INGRESS);
@@ -68,12 +70,25 @@ io_packet_mmap_rx_job(timer_s *timer)
     //clock_gettime(CLOCK_MONOTONIC, &io->timestamp);
     io->timestamp.tv_sec = timer->timestamp->tv_sec;
     io->timestamp.tv_nsec = timer->timestamp->tv_nsec;
+    if(io->timestamping) {
+        io_socket_timestamp_offset(io);
+    }
+    timestamp = io->timestamp;
     while(tphdr->tp_status & TP_STATUS_USER) {
+        if(io->timestamping && (tphdr->tp_status & (TP_STATUS_TS_SOFTWARE|TP_STATUS_TS_RAW_HARDWARE))) {
+            /* Kernel or hardware timestamp */
+            io_socket_timestamp(io, tphdr->tp_sec, tphdr->tp_nsec);
+        } else {
+            /* Burst timestamp */
+            io->timestamp = timestamp;
+        }
         io->buf = (uint8_t*)tphdr + tphdr->tp_mac;
         io->buf_len = tphdr->tp_len;
         io->stats.packets++;
         io->stats.bytes += io->buf_len;
+        IO_PROF_START(prof);
         decode_result = decode_ethernet(io->buf, io->buf_len, g_ctx->sp, SCRATCHPAD_LEN, &eth);
+        IO_PROF_STOP(io, IO_PROF_DECODE, prof);
         if(decode_result == PROTOCOL_SUCCESS) {
             if(tphdr->tp_status & TP_STATUS_VLAN_VALID) {
                 vlan = tphdr->tp_vlan_tci & BBL_ETH_VLAN_ID_MAX;
@@ -87,8 +102,6 @@ io_packet_mmap_rx_job(timer_s *timer)
                 }
             }
             /* Copy RX timestamp */
-            //eth->timestamp.tv_sec = tphdr->tp_sec; /* ktime/hw timestamp */
-            //eth->timestamp.tv_nsec = tphdr->tp_nsec; /* ktime/hw timestamp */
             eth->timestamp.tv_sec = io->timestamp.tv_sec;
             eth->timestamp.tv_nsec = io->timestamp.tv_nsec;
             /* Dump the packet into pcap file */
@@ -97,7 +110,9 @@ io_packet_mmap_rx_job(timer_s *timer)
                 pcapng_push_packet_header(&io->timestamp, io->buf, io->buf_len,
                                           interface->ifindex, PCAPNG_EPB_FLAGS_INBOUND);
             }
+            IO_PROF_START(prof);
             bbl_rx_handler(interface, eth);
+            IO_PROF_STOP(io, IO_PROF_HANDLER, prof);
         } else {
             /* Dump the packet into pcap file */
             if(g_ctx->pcap.write_buf) {
@@ -141,6 +156,7 @@ io_packet_mmap_tx_job(timer_s *timer)
 
     bool ctrl = true;
     bool pcap = false;
+    IO_PROF_VAR(prof);
 
     assert(io->mode == IO_MODE_PACKET_MMAP);
     assert(io->direction == IO_EGRESS);
@@ -172,20 +188,30 @@ io_packet_mmap_tx_job(timer_s *timer)
 
             if(unlikely(ctrl)) {
                 /* First send all control traffic which has higher priority. */
+                IO_PROF_START(prof);
                 if(bbl_tx(interface, io->buf, &io->buf_len) != PROTOCOL_SUCCESS) {
                     ctrl = false;
                     continue;
                 }
+                IO_PROF_STOP(io, IO_PROF_BUILD, prof);
             } else {
                 if(!(g_traffic && g_init_phase == false && interface->state == INTERFACE_UP)) {
                     bbl_stream_io_stop(io);
                     break;
                 }
+                if(io->timestamping) {
+                    /* TX timestamp per packet */
+                    clock_gettime(CLOCK_MONOTONIC, &io->timestamp);
+                }
+                IO_PROF_START(prof);
                 stream = bbl_stream_io_send_iter(io, now);
+                IO_PROF_STOP(io, IO_PROF_BUILD, prof);
                 if(unlikely(stream == NULL)) {
                     break;
                 }
+                IO_PROF_START(prof);
                 memcpy(io->buf, stream->tx_buf, stream->tx_len);
+                IO_PROF_STOP(io, IO_PROF_COPY, prof);
                 io->buf_len = stream->tx_len;
                 stream->tx_packets++;
                 stream->flow_seq++;
@@ -217,6 +243,7 @@ io_packet_mmap_tx_job(timer_s *timer)
 
     if(io->queued) {
         /* Notify kernel. */
+        IO_PROF_START(prof);
         if(sendto(io->fd, NULL, 0, 0, NULL, 0) < 0) {
             LOG(IO, "PACKET_MMAP sendto on interface %s failed with error %s (%d)\n", 
                 interface->name, strerror(errno), errno);
@@ -224,6 +251,7 @@ io_packet_mmap_tx_job(timer_s *timer)
         } else {
             io->queued = 0;
         }
+        IO_PROF_STOP(io, IO_PROF_SYSCALL, prof);
     }
 }
 
@@ -239,12 +267,13 @@ io_packet_mmap_thread_rx_run_fn(io_thread_s *thread)
     uint8_t *ring = io->ring;
 
     struct tpacket2_hdr *tphdr;
+    struct timespec timestamp;
 
     assert(io->mode == IO_MODE_PACKET_MMAP);
     assert(io->direction == IO_INGRESS);
     assert(io->thread);
 
-    struct timespec sleep, rem;
+    struct timespec sleep;
 
     sleep.tv_sec = 0;
     sleep.tv_nsec = 10000; /* 0.01ms */
@@ -255,13 +284,24 @@ io_packet_mmap_thread_rx_run_fn(io_thread_s *thread)
         if(!(tphdr->tp_status & TP_STATUS_USER)) {
             /* If no buffer is available poll kernel */
             //poll_kernel(io, POLLIN);
-            nanosleep(&sleep, &rem);
+            io_thread_wait(thread, &sleep);
             continue;
         }
 
         /* Get RX timestamp */
         clock_gettime(CLOCK_MONOTONIC, &io->timestamp);
+        if(io->timestamping) {
+            io_socket_timestamp_offset(io);
+        }
+        timestamp = io->timestamp;
         while(tphdr->tp_status & TP_STATUS_USER) {
+            if(io->timestamping && (tphdr->tp_status & (TP_STATUS_TS_SOFTWARE|TP_STATUS_TS_RAW_HARDWARE))) {
+                /* Kernel or hardware timestamp */
+                io_socket_timestamp(io, tphdr->tp_sec, tphdr->tp_nsec);
+            } else {
+                /* Burst timestamp */
+                io->timestamp = timestamp;
+            }
             io->buf = (uint8_t*)tphdr + tphdr->tp_mac;
             io->buf_len = tphdr->tp_len;
             if(tphdr->tp_status & TP_STATUS_VLAN_VALID) {
@@ -281,7 +321,7 @@ io_packet_mmap_thread_rx_run_fn(io_thread_s *thread)
             frame_ptr = ring + (cursor * frame_size);
             tphdr = (struct tpacket2_hdr*)frame_ptr;
         }
-        nanosleep(&sleep, &rem);
+        io_thread_wait(thread, &sleep);
     }
 }
 
@@ -303,8 +343,9 @@ io_packet_mmap_thread_tx_run_fn(io_thread_s *thread)
     uint64_t now;
 
     bool ctrl = true;
+    IO_PROF_VAR(prof);
 
-    struct timespec sleep, rem;
+    struct timespec sleep;
     sleep.tv_sec = 0;
     sleep.tv_nsec = 10;
 
@@ -313,7 +354,7 @@ io_packet_mmap_thread_tx_run_fn(io_thread_s *thread)
     assert(io->thread);
 
     while(thread->active) {
-        nanosleep(&sleep, &rem);
+        io_thread_wait(thread, &sleep);
         if(io->update_streams) {
             io_stream_update_pps(io);
         }
@@ -346,7 +387,9 @@ io_packet_mmap_thread_tx_run_fn(io_thread_s *thread)
                 slot = bbl_txq_read_slot(txq);
                 if(slot) {
                     io->buf_len = slot->packet_len;
+                    IO_PROF_START(prof);
                     memcpy(io->buf, slot->packet, slot->packet_len);
+                    IO_PROF_STOP(io, IO_PROF_COPY, prof);
                     bbl_txq_read_next(txq);
                 } else {
                     ctrl = false;
@@ -358,11 +401,19 @@ io_packet_mmap_thread_tx_run_fn(io_thread_s *thread)
                     break;
                 }
                 /* Send traffic streams up to allowed burst. */
+                if(io->timestamping) {
+                    /* TX timestamp per packet */
+                    clock_gettime(CLOCK_MONOTONIC, &io->timestamp);
+                }
+                IO_PROF_START(prof);
                 stream = bbl_stream_io_send_iter(io, now);
+                IO_PROF_STOP(io, IO_PROF_BUILD, prof);
                 if(unlikely(stream == NULL)) {
                     break;
                 }
+                IO_PROF_START(prof);
                 memcpy(io->buf, stream->tx_buf, stream->tx_len);
+                IO_PROF_STOP(io, IO_PROF_COPY, prof);
                 io->buf_len = stream->tx_len;
                 stream->tx_packets++;
                 stream->flow_seq++;
@@ -384,6 +435,7 @@ io_packet_mmap_thread_tx_run_fn(io_thread_s *thread)
 
         if(io->queued) {
             /* Notify kernel. */
+            IO_PROF_START(prof);
             if(sendto(io->fd, NULL, 0, 0, NULL, 0) < 0) {
                 LOG(IO, "PACKET_MMAP sendto on interface %s failed with error %s (%d)\n", 
                     interface->name, strerror(errno), errno);
@@ -391,6 +443,7 @@ io_packet_mmap_thread_tx_run_fn(io_thread_s *thread)
             } else {
                 io->queued = 0;
             }
+            IO_PROF_STOP(io, IO_PROF_SYSCALL, prof);
         }
     }
 }
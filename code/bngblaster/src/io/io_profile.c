@@ -0,0 +1,145 @@
+/*
+ * BNG Blaster (BBL) - IO Profiling
+ *
+ * Cycle histograms per IO handle and pipeline stage,
+ * available if build with BNGBLASTER_PROFILING and
+ * enabled at runtime via control socket.
+ *
+ * agent, October 2026
+ *
+ * Copyright (C) 2020-2025, RtBrick, Inc.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include "io.h"
+
+#ifdef BNGBLASTER_PROFILING
+
+static const char *
+io_profile_stage_string(io_prof_stage_t stage)
+{
+    switch(stage) {
+        case IO_PROF_DECODE: return "decode";
+        case IO_PROF_CLASSIFY: return "classify";
+        case IO_PROF_HANDLER: return "handler";
+        case IO_PROF_BUILD: return "build";
+        case IO_PROF_COPY: return "copy";
+        case IO_PROF_SYSCALL: return "syscall";
+        default: return "unknown";
+    }
+}
+
+/**
+ * io_profile_json
+ *
+ * @param io IO handle list of an interface
+ * @return JSON array with one entry per IO handle
+ *         or NULL if no profiling data
+ */
+json_t *
+io_profile_json(io_handle_s *io)
+{
+    json_t *root = NULL, *jobj, *stages, *stage, *hist;
+    io_prof_s *prof;
+    int s, b, last;
+
+    while(io) {
+        stages = json_object();
+        for(s = 0; s < IO_PROF_MAX; s++) {
+            prof = &io->prof[s];
+            if(!prof->count) continue;
+            last = 0;
+            for(b = 0; b < IO_PROF_BUCKETS; b++) {
+                if(prof->hist[b]) last = b;
+            }
+            /* Bucket N counts values in range [2^N, 2^(N+1)). */
+            hist = json_array();
+            for(b = 0; b <= last; b++) {
+                json_array_append_new(hist, json_integer(prof->hist[b]));
+            }
+            stage = json_pack("{sI sI sI so}",
+                              "count", prof->count,
+                              "avg", prof->cycles / prof->count,
+                              "max", prof->max,
+                              "histogram", hist);
+            if(stage) {
+                json_object_set_new(stages, io_profile_stage_string(s), stage);
+            }
+        }
+        if(json_object_size(stages)) {
+            jobj = json_pack("{sb ss so}",
+                             "thread", io->thread ? true : false,
+                             "unit", IO_PROF_UNIT,
+                             "stages", stages);
+            if(jobj) {
+                if(!root) root = json_array();
+                json_array_append_new(root, jobj);
+            }
+        } else {
+            json_decref(stages);
+        }
+        io = io->next;
+    }
+    return root;
+}
+
+int
+io_profile_ctrl_start(int fd, uint32_t session_id __attribute__((unused)), json_t *arguments __attribute__((unused)))
+{
+    g_ctx->profiling = true;
+    return bbl_ctrl_status(fd, "ok", 200, NULL);
+}
+
+int
+io_profile_ctrl_stop(int fd, uint32_t session_id __attribute__((unused)), json_t *arguments __attribute__((unused)))
+{
+    g_ctx->profiling = false;
+    return bbl_ctrl_status(fd, "ok", 200, NULL);
+}
+
+int
+io_profile_ctrl_reset(int fd, uint32_t session_id __attribute__((unused)), json_t *arguments __attribute__((unused)))
+{
+    bbl_interface_s *interface;
+    io_handle_s *io;
+
+    if(g_ctx->profiling) {
+        return bbl_ctrl_status(fd, "warning", 409, "profiling running");
+    }
+    CIRCLEQ_FOREACH(interface, &g_ctx->interface_qhead, interface_qnode) {
+        for(io = interface->io.tx; io; io = io->next) {
+            memset(io->prof, 0x0, sizeof(io->prof));
+        }
+        for(io = interface->io.rx; io; io = io->next) {
+            memset(io->prof, 0x0, sizeof(io->prof));
+        }
+    }
+    return bbl_ctrl_status(fd, "ok", 200, NULL);
+}
+
+#else
+
+json_t *
+io_profile_json(io_handle_s *io __attribute__((unused)))
+{
+    return NULL;
+}
+
+int
+io_profile_ctrl_start(int fd, uint32_t session_id __attribute__((unused)), json_t *arguments __attribute__((unused)))
+{
+    return bbl_ctrl_status(fd, "error", 501, "profiling not supported");
+}
+
+int
+io_profile_ctrl_stop(int fd, uint32_t session_id __attribute__((unused)), json_t *arguments __attribute__((unused)))
+{
+    return bbl_ctrl_status(fd, "error", 501, "profiling not supported");
+}
+
+int
+io_profile_ctrl_reset(int fd, uint32_t session_id __attribute__((unused)), json_t *arguments __attribute__((unused)))
+{
+    return bbl_ctrl_status(fd, "error", 501, "profiling not supported");
+}
+
+#endif
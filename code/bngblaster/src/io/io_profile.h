@@ -0,0 +1,72 @@
+/*
+ * BNG Blaster (BBL) - IO Profiling
+ *
+ * agent, October 2026
+ *
+ * Copyright (C) 2020-2025, RtBrick, Inc.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef __BBL_IO_PROFILE_H__
+#define __BBL_IO_PROFILE_H__
+
+#ifdef BNGBLASTER_PROFILING
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define IO_PROF_UNIT "cycles"
+#else
+#define IO_PROF_UNIT "nsec"
+#endif
+
+static inline uint64_t
+io_prof_cycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+#endif
+}
+
+static inline void
+io_prof_record(io_prof_s *prof, uint64_t cycles)
+{
+    uint32_t bucket = cycles ? 63 - __builtin_clzll(cycles) : 0;
+    if(bucket >= IO_PROF_BUCKETS) bucket = IO_PROF_BUCKETS - 1;
+    prof->count++;
+    prof->cycles += cycles;
+    if(cycles > prof->max) prof->max = cycles;
+    prof->hist[bucket]++;
+}
+
+/* Each IO handle stage must be recorded by one thread only,
+ * which is the IO thread or the main thread if not threaded. */
+#define IO_PROF_START(_ts) do { (_ts) = g_ctx->profiling ? io_prof_cycles() : 0; } while(0)
+#define IO_PROF_STOP(_io, _stage, _ts) do { \
+    if(_ts) io_prof_record(&(_io)->prof[_stage], io_prof_cycles() - (_ts)); \
+} while(0)
+#define IO_PROF_VAR(_ts) uint64_t _ts = 0
+
+#else
+
+#define IO_PROF_START(_ts) do { } while(0)
+#define IO_PROF_STOP(_io, _stage, _ts) do { } while(0)
+#define IO_PROF_VAR(_ts)
+
+#endif
+
+json_t *
+io_profile_json(io_handle_s *io);
+
+int
+io_profile_ctrl_start(int fd, uint32_t session_id, json_t *arguments);
+
+int
+io_profile_ctrl_stop(int fd, uint32_t session_id, json_t *arguments);
+
+int
+io_profile_ctrl_reset(int fd, uint32_t session_id, json_t *arguments);
+
+#endif
@@ -8,10 +8,139 @@
  */
 #include "io.h"
 #include <linux/if_packet.h>
+#include <linux/errqueue.h>
+
+#define IO_RAW_MMSG_MAX 64
+#define IO_RAW_MMSG_CTRL_LEN CMSG_SPACE(sizeof(struct scm_timestamping))
 
 extern bool g_init_phase;
 extern bool g_traffic;
 
+/**
+ * Allocate and initialize the sendmmsg/recvmmsg 
+ * vector with one packet buffer per message.
+ */
+static bool
+io_raw_mmsg_init(io_handle_s *io)
+{
+    struct msghdr *hdr;
+    uint16_t vlen = io->interface->config->io_burst;
+    uint16_t i;
+
+    if(vlen > IO_RAW_MMSG_MAX) vlen = IO_RAW_MMSG_MAX;
+    if(vlen < 1) vlen = 1;
+
+    io->mmsg = calloc(vlen, sizeof(struct mmsghdr));
+    io->mmsg_iov = calloc(vlen, sizeof(struct iovec));
+    io->mmsg_addr = calloc(vlen, sizeof(struct sockaddr_ll));
+    io->mmsg_buf = malloc((size_t)vlen * IO_BUFFER_LEN);
+    if(!(io->mmsg && io->mmsg_iov && io->mmsg_addr && io->mmsg_buf)) {
+        return false;
+    }
+    if(io->direction == IO_INGRESS && io->timestamping) {
+        io->mmsg_ctrl = calloc(vlen, IO_RAW_MMSG_CTRL_LEN);
+        if(!io->mmsg_ctrl) {
+            return false;
+        }
+    }
+    io->mmsg_vlen = vlen;
+    for(i = 0; i < vlen; i++) {
+        io->mmsg_iov[i].iov_base = io->mmsg_buf + ((size_t)i * IO_BUFFER_LEN);
+        io->mmsg_iov[i].iov_len = IO_BUFFER_LEN;
+        hdr = &io->mmsg[i].msg_hdr;
+        hdr->msg_iov = &io->mmsg_iov[i];
+        hdr->msg_iovlen = 1;
+        if(io->direction == IO_INGRESS) {
+            hdr->msg_name = &io->mmsg_addr[i];
+        } else {
+            hdr->msg_name = &io->addr;
+        }
+        hdr->msg_namelen = sizeof(struct sockaddr_ll);
+        if(io->mmsg_ctrl) {
+            hdr->msg_control = io->mmsg_ctrl + ((size_t)i * IO_RAW_MMSG_CTRL_LEN);
+            hdr->msg_controllen = IO_RAW_MMSG_CTRL_LEN;
+        }
+    }
+    io->buf = io->mmsg_buf;
+    return true;
+}
+
+/**
+ * Receive up to vector size packets with a single
+ * recvmmsg call, returns the number of packets.
+ */
+static int
+io_raw_rx_mmsg(io_handle_s *io)
+{
+    uint16_t i;
+    int received;
+    IO_PROF_VAR(prof);
+
+    for(i = 0; i < io->mmsg_vlen; i++) {
+        io->mmsg[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_ll);
+        if(io->mmsg_ctrl) {
+            io->mmsg[i].msg_hdr.msg_controllen = IO_RAW_MMSG_CTRL_LEN;
+        }
+    }
+    IO_PROF_START(prof);
+    received = recvmmsg(io->fd, io->mmsg, io->mmsg_vlen, 0, NULL);
+    IO_PROF_STOP(io, IO_PROF_SYSCALL, prof);
+    if(received < 0) {
+        return 0;
+    }
+    if(io->mmsg_ctrl) {
+        io_socket_timestamp_offset(io);
+    }
+    return received;
+}
+
+/**
+ * Set the IO timestamp from the kernel or 
+ * hardware timestamp of the received message.
+ */
+static void
+io_raw_rx_timestamp(io_handle_s *io, struct msghdr *hdr)
+{
+    struct cmsghdr *cmsg;
+    struct scm_timestamping *ts;
+
+    for(cmsg = CMSG_FIRSTHDR(hdr); cmsg; cmsg = CMSG_NXTHDR(hdr, cmsg)) {
+        if(cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPING) {
+            ts = (struct scm_timestamping*)CMSG_DATA(cmsg);
+            if(ts->ts[2].tv_sec) {
+                /* Hardware timestamp */
+                io_socket_timestamp(io, ts->ts[2].tv_sec, ts->ts[2].tv_nsec);
+            } else if(ts->ts[0].tv_sec) {
+                /* Kernel timestamp */
+                io_socket_timestamp(io, ts->ts[0].tv_sec, ts->ts[0].tv_nsec);
+            }
+            return;
+        }
+    }
+}
+
+/**
+ * Load received packet from vector into io->buf,
+ * returns false if the packet should be skipped.
+ */
+static inline bool
+io_raw_rx_load(io_handle_s *io, int i)
+{
+    io->buf = io->mmsg_iov[i].iov_base;
+    io->buf_len = io->mmsg[i].msg_len;
+    if(io->buf_len < 14) {
+        return false;
+    }
+    /* Skip our own outgoing packets */
+    if(io->mmsg_addr[i].sll_pkttype == PACKET_OUTGOING) {
+        return false;
+    }
+    if(io->mmsg_ctrl) {
+        io_raw_rx_timestamp(io, &io->mmsg[i].msg_hdr);
+    }
+    return true;
+}
+
 /**
  * This job is for RAW RX in main thread!
  */
@@ -21,13 +150,14 @@ io_raw_rx_job(timer_s *timer)
     io_handle_s *io = timer->data;
     bbl_interface_s *interface = io->interface;
 
-    struct sockaddr_ll sll;
-    socklen_t sll_size = sizeof(sll);
-
     bbl_ethernet_header_s *eth;
 
     protocol_error_t decode_result;
     bool pcap = false;
+    IO_PROF_VAR(prof);
+
+    int received;
+    int i;
 
     assert(io->mode == IO_MODE_RAW);
     assert(io->direction == IO_INGRESS);
@@ -37,41 +167,41 @@ io_raw_rx_job(timer_s *timer)
     //clock_gettime(CLOCK_MONOTONIC, &io->timestamp);
     io->timestamp.tv_sec = timer->timestamp->tv_sec;
     io->timestamp.tv_nsec = timer->timestamp->tv_nsec;
-    while(true) {
-        sll_size = sizeof(sll);
-        io->buf_len = recvfrom(io->fd, io->buf, IO_BUFFER_LEN, 0, (struct sockaddr*)&sll, &sll_size);
-        if(io->buf_len < 14 || io->buf_len > IO_BUFFER_LEN) {
-            break;
-        }
-        /* Skip our own outgoing packets */
-        if(sll.sll_pkttype == PACKET_OUTGOING) {
-            continue;
-        }
-        io->stats.packets++;
-        io->stats.bytes += io->buf_len;
-        decode_result = decode_ethernet(io->buf, io->buf_len, g_ctx->sp, SCRATCHPAD_LEN, &eth);
-        if(decode_result == PROTOCOL_SUCCESS) {
-            /* Copy RX timestamp */
-            eth->timestamp.tv_sec = io->timestamp.tv_sec;
-            eth->timestamp.tv_nsec = io->timestamp.tv_nsec;
-            /* Dump the packet into pcap file */
-            if(g_ctx->pcap.write_buf && (!eth->bbl || g_ctx->pcap.include_streams)) {
-                pcap = true;
-                pcapng_push_packet_header(&io->timestamp, io->buf, io->buf_len,
-                                        interface->ifindex, PCAPNG_EPB_FLAGS_INBOUND);
+    while((received = io_raw_rx_mmsg(io))) {
+        for(i = 0; i < received; i++) {
+            if(!io_raw_rx_load(io, i)) {
+                continue;
             }
-            bbl_rx_handler(interface, eth);
-        } else {
-            /* Dump the packet into pcap file */
-            if(g_ctx->pcap.write_buf) {
-                pcap = true;
-                pcapng_push_packet_header(&io->timestamp, io->buf, io->buf_len,
-                                          interface->ifindex, PCAPNG_EPB_FLAGS_INBOUND);
-            }
-            if(decode_result == UNKNOWN_PROTOCOL) {
-                io->stats.unknown++;
+            io->stats.packets++;
+            io->stats.bytes += io->buf_len;
+            IO_PROF_START(prof);
+            decode_result = decode_ethernet(io->buf, io->buf_len, g_ctx->sp, SCRATCHPAD_LEN, &eth);
+            IO_PROF_STOP(io, IO_PROF_DECODE, prof);
+            if(decode_result == PROTOCOL_SUCCESS) {
+                /* Copy RX timestamp */
+                eth->timestamp.tv_sec = io->timestamp.tv_sec;
+                eth->timestamp.tv_nsec = io->timestamp.tv_nsec;
+                /* Dump the packet into pcap file */
+                if(g_ctx->pcap.write_buf && (!eth->bbl || g_ctx->pcap.include_streams)) {
+                    pcap = true;
+                    pcapng_push_packet_header(&io->timestamp, io->buf, io->buf_len,
+                                            interface->ifindex, PCAPNG_EPB_FLAGS_INBOUND);
+                }
+                IO_PROF_START(prof);
+                bbl_rx_handler(interface, eth);
+                IO_PROF_STOP(io, IO_PROF_HANDLER, prof);
             } else {
-                io->stats.protocol_errors++;
+                /* Dump the packet into pcap file */
+                if(g_ctx->pcap.write_buf) {
+                    pcap = true;
+                    pcapng_push_packet_header(&io->timestamp, io->buf, io->buf_len,
+                                              interface->ifindex, PCAPNG_EPB_FLAGS_INBOUND);
+                }
+                if(decode_result == UNKNOWN_PROTOCOL) {
+                    io->stats.unknown++;
+                } else {
+                    io->stats.protocol_errors++;
+                }
             }
         }
     }
@@ -86,17 +216,76 @@ io_raw_rx_job(timer_s *timer)
  * case we must not retry the packet, because it will always fail. 
  */
 void
-io_raw_tx_lo_long(io_handle_s *io)
+io_raw_tx_lo_long(io_handle_s *io, uint16_t len)
 {
     bbl_interface_s *interface = io->interface;
     if(io->stats.to_long == 0) {
         /* Log error for first oversized packet only! */
-        LOG(ERROR, "RAW sendto on interface %s failed because of to long packet (%u byte), please check MTU settings!\n", 
-            interface->name, io->buf_len);
+        LOG(ERROR, "RAW sendmmsg on interface %s failed because of to long packet (%u byte), please check MTU settings!\n", 
+            interface->name, len);
     }
     io->stats.to_long++;
 }
 
+/**
+ * Send all pending messages of the vector using sendmmsg. 
+ * Returns false if sending failed, in this case the remaining
+ * messages are kept in the vector and retried with the next call.
+ */
+static bool
+io_raw_tx_flush(io_handle_s *io)
+{
+    int sent;
+    int i;
+    IO_PROF_VAR(prof);
+
+    while(io->mmsg_head < io->mmsg_count) {
+        IO_PROF_START(prof);
+        sent = sendmmsg(io->fd, &io->mmsg[io->mmsg_head], io->mmsg_count - io->mmsg_head, 0);
+        IO_PROF_STOP(io, IO_PROF_SYSCALL, prof);
+        if(sent > 0) {
+            for(i = io->mmsg_head; i < io->mmsg_head + sent; i++) {
+                io->stats.packets++;
+                io->stats.bytes += io->mmsg_iov[i].iov_len;
+            }
+            io->mmsg_head += sent;
+        } else if(errno == EMSGSIZE) {
+            /* Skip this packet and continue with the next one. */
+            io_raw_tx_lo_long(io, io->mmsg_iov[io->mmsg_head].iov_len);
+            io->mmsg_head++;
+        } else {
+            LOG(IO, "RAW sendmmsg on interface %s failed with error %s (%d)\n", 
+                io->interface->name, strerror(errno), errno);
+            io->stats.io_errors++;
+            return false;
+        }
+    }
+    io->mmsg_head = 0;
+    io->mmsg_count = 0;
+    return true;
+}
+
+/**
+ * Return the packet buffer of the next free message, 
+ * the vector is sent first if there is no free message. 
+ */
+static inline uint8_t *
+io_raw_tx_buf(io_handle_s *io)
+{
+    if(io->mmsg_count == io->mmsg_vlen) {
+        if(!io_raw_tx_flush(io)) {
+            return NULL;
+        }
+    }
+    return io->mmsg_iov[io->mmsg_count].iov_base;
+}
+
+static inline void
+io_raw_tx_push(io_handle_s *io, uint16_t len)
+{
+    io->mmsg_iov[io->mmsg_count++].iov_len = len;
+}
+
 /**
  * This job is for RAW TX in main thread!
  */
@@ -108,8 +297,11 @@ io_raw_tx_job(timer_s *timer)
 
     bbl_stream_s *stream = NULL;
     uint16_t burst = interface->config->io_burst;
+    uint16_t len;
     uint64_t now;
+    uint8_t *buf;
     bool pcap = false;
+    IO_PROF_VAR(prof);
 
     assert(io->mode == IO_MODE_RAW);
     assert(io->direction == IO_EGRESS);
@@ -119,81 +311,75 @@ io_raw_tx_job(timer_s *timer)
         io_stream_update_pps(io);
     }
 
+    /* Retry pending packets of the previous interval first. */
+    if(!io_raw_tx_flush(io)) {
+        return;
+    }
+
     /* Get TX timestamp */
     //clock_gettime(CLOCK_MONOTONIC, &io->timestamp);
     io->timestamp.tv_sec = timer->timestamp->tv_sec;
     io->timestamp.tv_nsec = timer->timestamp->tv_nsec;
 
     while(burst) {
-        if(likely(io->buf_len == 0)) {
-            if(bbl_tx(interface, io->buf, &io->buf_len) != PROTOCOL_SUCCESS) {
-                io->buf_len = 0;
-                break;
-            }
+        buf = io_raw_tx_buf(io);
+        if(!buf) {
+            burst = 0;
+            break;
         }
-        if(sendto(io->fd, io->buf, io->buf_len, 0, (struct sockaddr*)&io->addr, sizeof(struct sockaddr_ll)) > 0) {
-            /* Dump the packet into pcap file. */
-            if(unlikely(g_ctx->pcap.write_buf != NULL)) {
-                pcap = true;
-                pcapng_push_packet_header(&io->timestamp, io->buf, io->buf_len,
-                                          interface->ifindex, PCAPNG_EPB_FLAGS_OUTBOUND);
-            }
-            io->stats.packets++;
-            io->stats.bytes += io->buf_len;
-            io->buf_len = 0;
-            burst--;
-        } else {
-            if(errno == EMSGSIZE) {
-                io_raw_tx_lo_long(io);
-                io->buf_len = 0;
-            } else {
-                /* This packet will be retried next interval 
-                 * because io->buf_len is not reset to zero. */
-                LOG(IO, "RAW sendto on interface %s failed with error %s (%d)\n", 
-                    interface->name, strerror(errno), errno);
-                io->stats.io_errors++;
-                burst = 0;
-            }
+        IO_PROF_START(prof);
+        if(bbl_tx(interface, buf, &len) != PROTOCOL_SUCCESS) {
+            break;
+        }
+        IO_PROF_STOP(io, IO_PROF_BUILD, prof);
+        io_raw_tx_push(io, len);
+        /* Dump the packet into pcap file. */
+        if(unlikely(g_ctx->pcap.write_buf != NULL)) {
+            pcap = true;
+            pcapng_push_packet_header(&io->timestamp, buf, len,
+                                      interface->ifindex, PCAPNG_EPB_FLAGS_OUTBOUND);
         }
+        burst--;
     }
 
     if(g_traffic && g_init_phase == false && interface->state == INTERFACE_UP) {
         now = timespec_to_nsec(timer->timestamp);
         while(burst) {
             /* Send traffic streams up to allowed burst. */
+            buf = io_raw_tx_buf(io);
+            if(!buf) {
+                break;
+            }
+            if(io->timestamping) {
+                /* TX timestamp per packet */
+                clock_gettime(CLOCK_MONOTONIC, &io->timestamp);
+            }
+            IO_PROF_START(prof);
             stream = bbl_stream_io_send_iter(io, now);
+            IO_PROF_STOP(io, IO_PROF_BUILD, prof);
             if(unlikely(stream == NULL)) {
                 break;
             }
-            if(sendto(io->fd, stream->tx_buf, stream->tx_len, 0, (struct sockaddr*)&io->addr, sizeof(struct sockaddr_ll)) > 0) {
-                /* Dump the packet into pcap file. */
-                if(unlikely(g_ctx->pcap.write_buf && g_ctx->pcap.include_streams)) {
-                    pcap = true;
-                    pcapng_push_packet_header(&io->timestamp, stream->tx_buf, stream->tx_len,
-                                              interface->ifindex, PCAPNG_EPB_FLAGS_OUTBOUND);
-                }
-                stream->tx_packets++;
-                stream->flow_seq++;
-                io->stats.packets++;
-                io->stats.bytes += stream->tx_len;
-                burst--;
-            } else {
-                if(errno == EMSGSIZE) {
-                    io->buf_len = stream->tx_len;
-                    io_raw_tx_lo_long(io);
-                    io->buf_len = 0;
-                } else {
-                    LOG(IO, "RAW sendto on interface %s failed with error %s (%d)\n", 
-                        interface->name, strerror(errno), errno);
-                    io->bucket_cur->stream_cur = stream;
-                    io->stats.io_errors++;
-                    burst = 0;
-                }
+            /* The stream TX buffer is copied because it is 
+             * updated if the same stream is sent again. */
+            IO_PROF_START(prof);
+            memcpy(buf, stream->tx_buf, stream->tx_len);
+            IO_PROF_STOP(io, IO_PROF_COPY, prof);
+            io_raw_tx_push(io, stream->tx_len);
+            /* Dump the packet into pcap file. */
+            if(unlikely(g_ctx->pcap.write_buf && g_ctx->pcap.include_streams)) {
+                pcap = true;
+                pcapng_push_packet_header(&io->timestamp, buf, stream->tx_len,
+                                          interface->ifindex, PCAPNG_EPB_FLAGS_OUTBOUND);
             }
+            stream->tx_packets++;
+            stream->flow_seq++;
+            burst--;
         }
     } else {
         bbl_stream_io_stop(io);
     }
+    io_raw_tx_flush(io);
     if(unlikely(pcap)) {
         pcapng_fflush();
     }
@@ -204,31 +390,30 @@ io_raw_thread_rx_run_fn(io_thread_s *thread)
 {
     io_handle_s *io = thread->io;
 
-    struct sockaddr_ll sll;
-    socklen_t sll_size = sizeof(sll);
+    int received;
+    int i;
 
     assert(io->direction == IO_INGRESS);
 
-    struct timespec sleep, rem;
+    struct timespec sleep;
     sleep.tv_sec = 0;
     sleep.tv_nsec = 1000; /* 0.001ms */
 
     while(thread->active) {
-        /* Get RX timestamp */
-        clock_gettime(CLOCK_MONOTONIC, &io->timestamp);
         /* Receive from socket */
-        sll_size = sizeof(sll);
-        io->buf_len = recvfrom(io->fd, io->buf, IO_BUFFER_LEN, 0, (struct sockaddr*)&sll, &sll_size);
-        if(io->buf_len < 14 || io->buf_len > IO_BUFFER_LEN) {
-            nanosleep(&sleep, &rem);
+        received = io_raw_rx_mmsg(io);
+        if(received == 0) {
+            io_thread_wait(thread, &sleep);
             continue;
         }
-        /* Skip our own outgoing packets */
-        if(sll.sll_pkttype == PACKET_OUTGOING) {
-            continue;
+        /* Get RX timestamp */
+        clock_gettime(CLOCK_MONOTONIC, &io->timestamp);
+        for(i = 0; i < received; i++) {
+            if(io_raw_rx_load(io, i)) {
+                /* Process packet */
+                io_thread_rx_handler(thread, io);
+            }
         }
-        /* Process packet */
-        io_thread_rx_handler(thread, io);
     }
 }
 
@@ -245,8 +430,10 @@ io_raw_thread_tx_run_fn(io_thread_s *thread)
     uint16_t io_burst = interface->config->io_burst;
     uint16_t burst = 0;
     uint64_t now;
+    uint8_t *buf;
+    IO_PROF_VAR(prof);
 
-    struct timespec sleep, rem;
+    struct timespec sleep;
     sleep.tv_sec = 0;
     sleep.tv_nsec = 1000 * io_burst; 
 
@@ -255,26 +442,30 @@ io_raw_thread_tx_run_fn(io_thread_s *thread)
     assert(io->thread);
 
     while(thread->active) {
-        nanosleep(&sleep, &rem);
+        io_thread_wait(thread, &sleep);
         if(io->update_streams) {
             io_stream_update_pps(io);
         }
+
+        /* Retry pending packets of the previous run first. */
+        if(!io_raw_tx_flush(io)) {
+            continue;
+        }
         burst = io_burst;
 
         /* First send all control traffic which has higher priority. */
         while((slot = bbl_txq_read_slot(txq))) {
-            if(sendto(io->fd, slot->packet, slot->packet_len, 0, (struct sockaddr*)&io->addr, sizeof(struct sockaddr_ll)) >= 0 ) {
-                io->stats.packets++;
-                io->stats.bytes += slot->packet_len;
-                bbl_txq_read_next(txq);
-                if(burst) burst--;
-            } else {
-                LOG(IO, "RAW sendto on interface %s failed with error %s (%d)\n", 
-                    io->interface->name, strerror(errno), errno);
-                io->stats.io_errors++;
+            buf = io_raw_tx_buf(io);
+            if(!buf) {
                 burst = 0;
                 break;
             }
+            IO_PROF_START(prof);
+            memcpy(buf, slot->packet, slot->packet_len);
+            IO_PROF_STOP(io, IO_PROF_COPY, prof);
+            io_raw_tx_push(io, slot->packet_len);
+            bbl_txq_read_next(txq);
+            if(burst) burst--;
         }
 
         /* Get TX timestamp */
@@ -283,33 +474,32 @@ io_raw_thread_tx_run_fn(io_thread_s *thread)
             now = timespec_to_nsec(&io->timestamp);
             while(burst) {
                 /* Send traffic streams up to allowed burst. */
+                buf = io_raw_tx_buf(io);
+                if(!buf) {
+                    break;
+                }
+                if(io->timestamping) {
+                    /* TX timestamp per packet */
+                    clock_gettime(CLOCK_MONOTONIC, &io->timestamp);
+                }
+                IO_PROF_START(prof);
                 stream = bbl_stream_io_send_iter(io, now);
+                IO_PROF_STOP(io, IO_PROF_BUILD, prof);
                 if(unlikely(stream == NULL)) {
                     break;
                 }
-                if(unlikely(sendto(io->fd, stream->tx_buf, stream->tx_len, 0, (struct sockaddr*)&io->addr, sizeof(struct sockaddr_ll)) >=0)) {
-                    stream->tx_packets++;
-                    stream->flow_seq++;
-                    io->stats.packets++;
-                    io->stats.bytes += stream->tx_len;
-                    burst--;
-                } else {
-                    if(errno == EMSGSIZE) {
-                        io->buf_len = stream->tx_len;
-                        io_raw_tx_lo_long(io);
-                        io->buf_len = 0;
-                    } else {
-                        LOG(IO, "RAW sendto on interface %s failed with error %s (%d)\n", 
-                            io->interface->name, strerror(errno), errno);
-                        io->bucket_cur->stream_cur = stream;
-                        io->stats.io_errors++;
-                        burst = 0;
-                    }
-                }
+                IO_PROF_START(prof);
+                memcpy(buf, stream->tx_buf, stream->tx_len);
+                IO_PROF_STOP(io, IO_PROF_COPY, prof);
+                io_raw_tx_push(io, stream->tx_len);
+                stream->tx_packets++;
+                stream->flow_seq++;
+                burst--;
             }
         } else {
             bbl_stream_io_stop(io);
         }
+        io_raw_tx_flush(io);
     }
 }
 
@@ -321,8 +511,9 @@ io_raw_init(io_handle_s *io)
     
     io_thread_s *thread = io->thread;
     
-    io->buf = malloc(IO_BUFFER_LEN);
-
+    if(!io_raw_mmsg_init(io)) {
+        return false;
+    }
     if(!io_socket_open(io)) {
         return false;
     }
@@ -7,6 +7,8 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 #include "io.h"
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
 
 /* Bypass TC_QDISC, such that the kernel is hammered 30% less with 
  * processing packets. Only for the TX FD. */
@@ -48,6 +50,56 @@ set_fanout(io_handle_s *io)
     return true;
 }
 
+/* Enable kernel or hardware RX timestamps. */
+static bool
+set_timestamping(io_handle_s *io)
+{
+    struct hwtstamp_config hwconfig = {0};
+    struct ifreq ifr = {0};
+    int flags = 0;
+
+    if(io->timestamping == IO_TIMESTAMPING_HARDWARE) {
+        /* Enable hardware timestamps for all received packets. */
+        hwconfig.tx_type = HWTSTAMP_TX_OFF;
+        hwconfig.rx_filter = HWTSTAMP_FILTER_ALL;
+        snprintf(ifr.ifr_name, sizeof(ifr.ifr_name), "%s", io->interface->name);
+        ifr.ifr_data = (void*)&hwconfig;
+        if(ioctl(io->fd, SIOCSHWTSTAMP, &ifr) == -1) {
+            LOG(ERROR, "Failed to enable hardware timestamps for interface %s - %s (%d)\n",
+                io->interface->name, strerror(errno), errno);
+            return false;
+        }
+    }
+
+    /* The kernel records software RX timestamps only if enabled
+     * by at least one socket, this applies to the PACKET_MMAP
+     * ring (TP_STATUS_TS_SOFTWARE) as well. */
+    flags = SOF_TIMESTAMPING_RX_SOFTWARE|SOF_TIMESTAMPING_SOFTWARE;
+    if(io->timestamping == IO_TIMESTAMPING_HARDWARE) {
+        flags |= SOF_TIMESTAMPING_RX_HARDWARE|SOF_TIMESTAMPING_RAW_HARDWARE;
+    }
+    if(setsockopt(io->fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == -1) {
+        LOG(ERROR, "Failed to set socket timestamping for interface %s - %s (%d)\n",
+            io->interface->name, strerror(errno), errno);
+        return false;
+    }
+
+    if(io->mode == IO_MODE_PACKET_MMAP) {
+        /* Select the timestamp stored in the PACKET_MMAP ring. */
+        if(io->timestamping == IO_TIMESTAMPING_HARDWARE) {
+            flags = SOF_TIMESTAMPING_RAW_HARDWARE;
+        } else {
+            flags = SOF_TIMESTAMPING_SOFTWARE;
+        }
+        if(setsockopt(io->fd, SOL_PACKET, PACKET_TIMESTAMP, &flags, sizeof(flags)) == -1) {
+            LOG(ERROR, "Failed to set packet timestamp for interface %s - %s (%d)\n",
+                io->interface->name, strerror(errno), errno);
+            return false;
+        }
+    }
+    return true;
+}
+
 /* Set packet version (TPACKET_V1, TPACKET_V2 or TPACKET_V3). */
 static bool
 set_packet_version(io_handle_s *io, int version)
@@ -146,8 +198,41 @@ io_socket_open(io_handle_s *io) {
         }
     }
 
+    if(io->direction == IO_INGRESS && io->timestamping) {
+        if(!set_timestamping(io)) {
+            return false;
+        }
+    }
+
     if(!set_fanout(io)) {
         return false;
     }
     return true;
+}
+
+/**
+ * Update the offset between CLOCK_REALTIME, used 
+ * for kernel and hardware timestamps, and CLOCK_MONOTONIC
+ * used for all other timestamps. 
+ */
+void
+io_socket_timestamp_offset(io_handle_s *io)
+{
+    struct timespec realtime;
+    struct timespec monotonic;
+
+    clock_gettime(CLOCK_MONOTONIC, &monotonic);
+    clock_gettime(CLOCK_REALTIME, &realtime);
+    timespec_sub(&io->timestamp_offset, &realtime, &monotonic);
+}
+
+/**
+ * Set the IO timestamp from a kernel or 
+ * hardware timestamp (CLOCK_REALTIME). 
+ */
+void
+io_socket_timestamp(io_handle_s *io, time_t sec, long nsec)
+{
+    struct timespec timestamp = { .tv_sec = sec, .tv_nsec = nsec };
+    timespec_sub(&io->timestamp, &timestamp, &io->timestamp_offset);
 }
\ No newline at end of file
@@ -12,4 +12,10 @@
 bool
 io_socket_open(io_handle_s *io);
 
+void
+io_socket_timestamp_offset(io_handle_s *io);
+
+void
+io_socket_timestamp(io_handle_s *io, time_t sec, long nsec);
+
 #endif
\ No newline at end of file
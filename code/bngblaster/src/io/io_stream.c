@@ -190,4 +190,35 @@ io_stream_update_pps(io_handle_s *io)
     }
     io_stream_smear(io);
     io->update_streams = false;
-}
\ No newline at end of file
+}
+
+/**
+ * Get the time in nsec (CLOCK_MONOTONIC) at which the 
+ * next stream packet is due to be sent or zero if no 
+ * stream packet is scheduled.
+ */
+uint64_t
+io_stream_next_due(io_handle_s *io)
+{
+    io_bucket_s *io_bucket = io->bucket_head;
+    bbl_stream_s *stream;
+    uint64_t next = 0;
+    uint64_t due;
+
+    while(io_bucket) {
+        if(io_bucket->base) {
+            stream = io_bucket->stream_cur;
+            if(stream) {
+                due = io_bucket->base + stream->expired;
+            } else {
+                due = io_bucket->base + io_bucket->nsec;
+                if(io_bucket->stream_head) {
+                    due += io_bucket->stream_head->expired;
+                }
+            }
+            if(!next || due < next) next = due;
+        }
+        io_bucket = io_bucket->next;
+    }
+    return next;
+}
@@ -24,4 +24,7 @@ io_stream_smear_all();
 void
 io_stream_update_pps(io_handle_s *io);
 
+uint64_t
+io_stream_next_due(io_handle_s *io);
+
 #endif
\ No newline at end of file
@@ -8,6 +8,18 @@
  */
 #include "io.h"
 
+#define IO_POLL_SPIN_NSEC 50000 /* 50us busy polling before blocking */
+
+static inline void
+io_thread_pause()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
 /** 
  * This function redirects the packet in the
  * IO buffer to the main thread via the TXQ 
@@ -59,12 +71,15 @@ io_thread_rx_handler(io_thread_s *thread, io_handle_s *io)
     uint16_t vlan;
 
     protocol_error_t decode_result;
+    IO_PROF_VAR(prof);
 
     io->stats.packets++;
     io->stats.bytes += io->buf_len;
     if(packet_is_bbl(io->buf, io->buf_len)) {
         /** Process */
+        IO_PROF_START(prof);
         decode_result = decode_ethernet(io->buf, io->buf_len, thread->sp, SCRATCHPAD_LEN, &eth);
+        IO_PROF_STOP(io, IO_PROF_DECODE, prof);
         if(decode_result == PROTOCOL_SUCCESS) {
             if(io->vlan_tci) {
                 vlan = io->vlan_tci & BBL_ETH_VLAN_ID_MAX;
@@ -80,9 +95,12 @@ io_thread_rx_handler(io_thread_s *thread, io_handle_s *io)
             /* Copy RX timestamp */
             eth->timestamp.tv_sec = io->timestamp.tv_sec;
             eth->timestamp.tv_nsec = io->timestamp.tv_nsec;
+            IO_PROF_START(prof);
             if(bbl_rx_thread(io->interface, eth)) {
+                IO_PROF_STOP(io, IO_PROF_CLASSIFY, prof);
                 return IO_SUCCESS;
             }
+            IO_PROF_STOP(io, IO_PROF_CLASSIFY, prof);
         } else if(decode_result == UNKNOWN_PROTOCOL) {
             io->stats.unknown++;
         } else {
@@ -111,10 +129,14 @@ io_thread_main_rx_job(timer_s *timer)
 
     protocol_error_t decode_result;
     bool pcap = false;
+    IO_PROF_VAR(prof);
     while(io) {
         thread = io->thread;
         if(thread) {
             while((slot = bbl_txq_read_slot(thread->txq))) {
+                /* The decode stage is recorded by the IO thread,
+                 * therefore decode and handler are recorded together. */
+                IO_PROF_START(prof);
                 decode_result = decode_ethernet(slot->packet, slot->packet_len, g_ctx->sp, SCRATCHPAD_LEN, &eth);
                 if(decode_result == PROTOCOL_SUCCESS) {
                     if(slot->vlan_tci) {
@@ -138,6 +160,7 @@ io_thread_main_rx_job(timer_s *timer)
                                                   interface->ifindex, PCAPNG_EPB_FLAGS_INBOUND);
                     }
                     bbl_rx_handler(interface, eth);
+                    IO_PROF_STOP(io, IO_PROF_HANDLER, prof);
                 } else {
                     /* Dump the packet into pcap file. */
                     if(g_ctx->pcap.write_buf) {
@@ -261,6 +284,13 @@ io_thread_init(io_handle_s *io)
     /* Default run function which might be overwritten */
     thread->run_fn = NULL;
 
+    thread->poll = config->io_poll;
+    if(io->direction == IO_INGRESS) {
+        thread->interval = config->rx_interval;
+    } else {
+        thread->interval = config->tx_interval;
+    }
+
     /* Add thread main loop timers/jobs */
     if(io->direction == IO_INGRESS && !interface->io.rx_job) {
         /** Start job reading from RX thread TXQ */
@@ -296,6 +326,86 @@ io_thread_init(io_handle_s *io)
     return true;
 }
 
+/** 
+ * This function is called by the IO thread run
+ * functions between two loops, waiting according
+ * to the configured poll strategy. The time spent 
+ * with and without packets and sleeping is accounted
+ * in the IO stats.
+ * 
+ * @param thread thread handle
+ * @param sleep sleep time for IO_POLL_SLEEP
+ */
+void
+io_thread_wait(io_thread_s *thread, struct timespec *sleep)
+{
+    io_handle_s *io = thread->io;
+
+    struct timespec timestamp;
+    struct timespec rem;
+    struct pollfd fds[1];
+    uint64_t now;
+    uint64_t due;
+    bool work = false;
+
+    clock_gettime(CLOCK_MONOTONIC, &timestamp);
+    now = timespec_to_nsec(&timestamp);
+    if(io->stats.packets != thread->packets) {
+        thread->packets = io->stats.packets;
+        work = true;
+    }
+    if(thread->timestamp) {
+        if(work) {
+            io->stats.work_ns += now - thread->timestamp;
+        } else {
+            io->stats.poll_ns += now - thread->timestamp;
+        }
+    }
+    thread->timestamp = now;
+
+    switch(thread->poll) {
+        case IO_POLL_BUSY:
+            if(!work) io_thread_pause();
+            return;
+        case IO_POLL_HYBRID:
+            if(work || !thread->idle) {
+                thread->idle = now;
+            }
+            if(now - thread->idle < IO_POLL_SPIN_NSEC) {
+                io_thread_pause();
+                return;
+            }
+            if(io->direction == IO_INGRESS && io->mode != IO_MODE_DPDK && io->mode != IO_MODE_LOOPBACK) {
+                fds[0].fd = io->fd;
+                fds[0].events = POLLIN;
+                fds[0].revents = 0;
+                poll(fds, 1, thread->interval / MSEC ? thread->interval / MSEC : 1);
+            } else {
+                timestamp.tv_sec = thread->interval / SEC;
+                timestamp.tv_nsec = thread->interval % SEC;
+                nanosleep(&timestamp, &rem);
+            }
+            break;
+        case IO_POLL_TIMER:
+            due = now + thread->interval;
+            if(io->direction == IO_EGRESS) {
+                now = io_stream_next_due(io);
+                if(now && now < due) due = now;
+            }
+            timestamp.tv_sec = due / SEC;
+            timestamp.tv_nsec = due % SEC;
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &timestamp, NULL);
+            break;
+        default:
+            nanosleep(sleep, &rem);
+            break;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &timestamp);
+    now = timespec_to_nsec(&timestamp);
+    io->stats.sleep_ns += now - thread->timestamp;
+    thread->timestamp = now;
+}
+
 void
 io_thread_start_all()
 {
@@ -18,6 +18,9 @@ io_thread_start_all();
 void
 io_thread_stop_all();
 
+void
+io_thread_wait(io_thread_s *thread, struct timespec *sleep);
+
 io_result_t
 io_thread_rx_handler(io_thread_s *thread, io_handle_s *io);
 
@@ -323,17 +323,54 @@ isis_ctrl_load_mrt(int fd, uint32_t session_id __attribute__((unused)), json_t *
     return bbl_ctrl_status(fd, "ok", 200, NULL);
 }
 
+static const char *
+isis_ctrl_lsp_update_raw(isis_instance_s *instance, isis_pdu_s *pdu, uint8_t *buf, uint16_t len)
+{
+    if(isis_pdu_load(pdu, buf, len) != PROTOCOL_SUCCESS) {
+        return "failed to decode ISIS PDU";
+    }
+    /* Update external LSP */
+    if(!isis_lsp_update_external(instance, pdu, false)) {
+        return "failed to update ISIS LSP";
+    }
+    return NULL;
+}
+
+/**
+ * isis_ctrl_lsp_update_pdu
+ *
+ * Update external LSP from raw PDU
+ * received via binary PDU stream.
+ *
+ * @param instance_id ISIS instance identifier
+ * @param buf PDU
+ * @param len PDU length
+ * @return NULL on success or error message
+ */
+const char *
+isis_ctrl_lsp_update_pdu(uint16_t instance_id, uint8_t *buf, uint16_t len)
+{
+    static isis_pdu_s pdu;
+    isis_instance_s *instance = g_ctx->isis_instances;
+
+    while(instance) {
+        if(instance->config->id == instance_id) {
+            return isis_ctrl_lsp_update_raw(instance, &pdu, buf, len);
+        }
+        instance = instance->next;
+    }
+    return "ISIS instance not found";
+}
+
 int
 isis_ctrl_lsp_update(int fd, uint32_t session_id __attribute__((unused)), json_t *arguments)
 {
-    protocol_error_t result;
-
     json_t *value;
     size_t pdu_count;
 
-
     isis_pdu_s pdu = {0};
     const char *pdu_string;
+    const char *error;
     uint16_t pdu_string_len;
 
     uint8_t buf[ISIS_MAX_PDU_LEN];
@@ -359,13 +396,9 @@ isis_ctrl_lsp_update(int fd, uint32_t session_id __attribute__((unused)), json_t
             for (len = 0; len < (pdu_string_len/2); len++) {
                 sscanf(pdu_string + len*2, "%02hhx", &buf[len]);
             }
-            result = isis_pdu_load(&pdu, (uint8_t*)buf, len);
-            if(result != PROTOCOL_SUCCESS) {
-                return bbl_ctrl_status(fd, "error", 500, "failed to decode ISIS PDU");
-            }
-            /* Update external LSP */
-            if(!isis_lsp_update_external(instance, &pdu, false)) {
-                return bbl_ctrl_status(fd, "error", 500, "failed to update ISIS LSP");
+            error = isis_ctrl_lsp_update_raw(instance, &pdu, buf, len);
+            if(error) {
+                return bbl_ctrl_status(fd, "error", 500, error);
             }
         }
     } else {
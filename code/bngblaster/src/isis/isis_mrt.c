@@ -8,142 +8,242 @@
  */
 #include "isis.h"
 
-bool
-isis_mrt_load(isis_instance_s *instance, char *file_path, bool startup)
+static bool
+isis_mrt_load_record(isis_mrt_load_s *load, bbl_mrt_record_s *record, struct timespec *now)
 {
-    FILE *mrt_file;
+    isis_instance_s *instance = load->instance;
+    char *file_path = load->mrt->file_path;
 
-    isis_mrt_hdr_t mrt = {0};
-    isis_pdu_s pdu = {0};
+    isis_pdu_s pdu;
     uint8_t level;
-    uint8_t pdu_buf[ISIS_MAX_PDU_LEN];
 
     isis_lsp_s *lsp = NULL;
     uint64_t lsp_id;
     uint32_t seq;
-    uint16_t refresh_interval = 0;
 
     hb_tree *lsdb;
     void **search = NULL;
     dict_insert_result result;
 
-    struct timespec now;
-    clock_gettime(CLOCK_MONOTONIC, &now);
-
-    LOG(ISIS, "Load ISIS MRT file %s\n", file_path);
-
-    mrt_file = fopen(file_path, "r");
-    if(!mrt_file) {
-        LOG(ERROR, "Failed to open MRT file %s\n", file_path);
+    if(!(record->type == ISIS_MRT_TYPE &&
+         record->subtype == 0 &&
+         record->length >= ISIS_HDR_LEN_COMMON &&
+         record->length <= ISIS_MAX_PDU_LEN)) {
+        LOG(DEBUG, "MRT type: %u subtype: %u length: %u\n", record->type, record->subtype, record->length);
+        LOG(ERROR, "Invalid MRT file (invalid MRT header) %s \n", file_path);
+        return false;
+    }
+    switch(*(record->data+4) & 0x1f) {
+        case ISIS_PDU_L1_LSP:
+            level = ISIS_LEVEL_1;
+            break;
+        case ISIS_PDU_L2_LSP:
+            level = ISIS_LEVEL_2;
+            break;
+        default:
+            if(isis_pdu_load(&pdu, record->data, record->length) != PROTOCOL_SUCCESS) {
+                LOG(ERROR, "Failed to load PDU from MRT file %s\n", file_path);
+                return false;
+            }
+            LOG(ERROR, "Skip record from MRT file %s\n", file_path);
+            return true;
+    }
+    if(record->length < ISIS_HDR_LEN_COMMON+ISIS_HDR_LEN_LSP) {
+        LOG(ERROR, "Failed to load PDU from MRT file %s\n", file_path);
         return false;
     }
 
-    while(fread(&mrt, sizeof(isis_mrt_hdr_t), 1, mrt_file) == 1) {
-        mrt.type = be16toh(mrt.type);
-        mrt.subtype = be16toh(mrt.subtype);
-        mrt.length = be32toh(mrt.length);
-        if(!(mrt.type == ISIS_MRT_TYPE && 
-             mrt.subtype == 0 &&
-             mrt.length >= ISIS_HDR_LEN_COMMON &&
-             mrt.length <= ISIS_MAX_PDU_LEN)) {
-            LOG(DEBUG, "MRT type: %u subtype: %u length: %u\n", mrt.type, mrt.subtype, mrt.length);
-            LOG(ERROR, "Invalid MRT file (invalid MRT header) %s \n", file_path);
-            fclose(mrt_file);
+    lsp_id = be64toh(*(uint64_t*)(record->data+ISIS_OFFSET_LSP_ID));
+    seq = be32toh(*(uint32_t*)(record->data+ISIS_OFFSET_LSP_SEQ));
+
+    LOG(DEBUG, "ISIS ADD %s-LSP %s (seq %u) from MRT file to instance %u\n",
+        isis_level_string(level),
+        isis_lsp_id_to_str(&lsp_id),
+        seq, instance->config->id);
+
+    /* Get LSDB */
+    lsdb = instance->level[level-1].lsdb;
+    search = hb_tree_search(lsdb, &lsp_id);
+    if(search) {
+        /* Update existing LSP. */
+        lsp = *search;
+        if(lsp->source.type == ISIS_SOURCE_SELF) {
+            LOG_NOARG(ISIS, "Failed to add LSP to LSDB (overwriting self LSP not permitted)\n");
             return false;
         }
-        if(fread(pdu_buf, mrt.length, 1, mrt_file) != 1) {
-            LOG(ERROR, "Invalid MRT file (read error) %s\n", file_path);
-            fclose(mrt_file);
+        /* Decode into a temporary PDU first to keep
+         * the existing LSP unchanged on errors. */
+        if(isis_pdu_load(&pdu, record->data, record->length) != PROTOCOL_SUCCESS) {
+            LOG(ERROR, "Failed to load PDU from MRT file %s\n", file_path);
             return false;
         }
-        if(isis_pdu_load(&pdu, pdu_buf, mrt.length) != PROTOCOL_SUCCESS) {
+        memcpy(&lsp->pdu, &pdu, sizeof(isis_pdu_s));
+    } else {
+        /* Create new LSP and decode the PDU directly
+         * from the file mapping into the LSP. */
+        lsp = isis_lsp_new(lsp_id, level, instance);
+        if(isis_pdu_load(&lsp->pdu, record->data, record->length) != PROTOCOL_SUCCESS) {
             LOG(ERROR, "Failed to load PDU from MRT file %s\n", file_path);
-            fclose(mrt_file);
+            free(lsp);
             return false;
         }
-        switch(pdu.pdu_type) {
-            case ISIS_PDU_L1_LSP:
-                level = ISIS_LEVEL_1;
-                break;
-            case ISIS_PDU_L2_LSP:
-                level = ISIS_LEVEL_2;
-                break;
-            default:
-                LOG(ERROR, "Skip record from MRT file %s\n", file_path);
-                continue;
+        result = hb_tree_insert(lsdb,  &lsp->id);
+        if(result.inserted) {
+            *result.datum_ptr = lsp;
+        } else {
+            LOG_NOARG(ISIS, "Failed to add LSP to LSDB\n");
+            free(lsp);
+            return false;
         }
+    }
 
-        lsp_id = be64toh(*(uint64_t*)ISIS_PDU_OFFSET(&pdu, ISIS_OFFSET_LSP_ID));
-        seq = be32toh(*(uint32_t*)ISIS_PDU_OFFSET(&pdu, ISIS_OFFSET_LSP_SEQ));
-
-        LOG(DEBUG, "ISIS ADD %s-LSP %s (seq %u) from MRT file to instance %u\n", 
-            isis_level_string(level), 
-            isis_lsp_id_to_str(&lsp_id), 
-            seq, instance->config->id);
-
-        /* Get LSDB */
-        lsdb = instance->level[level-1].lsdb;
-        search = hb_tree_search(lsdb, &lsp_id);
-        if(search) {
-            /* Update existing LSP. */
-            lsp = *search;
-            if(lsp->source.type == ISIS_SOURCE_SELF) {
-                LOG_NOARG(ISIS, "Failed to add LSP to LSDB (overwriting self LSP not permitted)\n");
-                fclose(mrt_file);
-                return false;
-            }
+    lsp->level = level;
+    lsp->source.type = ISIS_SOURCE_EXTERNAL;
+    lsp->source.adjacency = NULL;
+    lsp->seq = seq;
+    lsp->lifetime = be16toh(*(uint16_t*)ISIS_PDU_OFFSET(&lsp->pdu, ISIS_OFFSET_LSP_LIFETIME));
+    lsp->expired = false;
+    lsp->deleted = false;
+    lsp->instance = instance;
+    lsp->timestamp.tv_sec = now->tv_sec;
+    lsp->timestamp.tv_nsec = now->tv_nsec;
+
+    ISIS_PDU_CURSOR_RST(&lsp->pdu);
+
+    if(lsp->lifetime > 0 && instance->config->external_auto_refresh) {
+        if(level == ISIS_LEVEL_1) {
+            lsp->auth_key = instance->config->level1_key;
         } else {
-            /* Create new LSP. */
-            lsp = isis_lsp_new(lsp_id, level, instance);
-            result = hb_tree_insert(lsdb,  &lsp->id);
-            if(result.inserted) {
-                *result.datum_ptr = lsp;
-            } else {
-                LOG_NOARG(ISIS, "Failed to add LSP to LSDB\n");
-                fclose(mrt_file);
-                return false;
-            }
+            lsp->auth_key = instance->config->level2_key;
+        }
+        if(lsp->lifetime < ISIS_DEFAULT_LSP_LIFETIME_MIN) {
+            /* Increase ISIS lifetime. */
+            lsp->lifetime = ISIS_DEFAULT_LSP_LIFETIME_MIN;
+            isis_lsp_refresh(lsp);
         }
+        load->refresh_interval = lsp->lifetime - 300;
+        timer_add_periodic(&g_ctx->timer_root, &lsp->timer_refresh,
+                           "ISIS LSP REFRESH", load->refresh_interval, 3, lsp,
+                           &isis_lsp_refresh_job);
+    } else {
+        isis_lsp_lifetime(lsp);
+    }
 
-        lsp->level = level;
-        lsp->source.type = ISIS_SOURCE_EXTERNAL;
-        lsp->source.adjacency = NULL;
-        lsp->seq = seq;
-        lsp->lifetime = be16toh(*(uint16_t*)ISIS_PDU_OFFSET(&pdu, ISIS_OFFSET_LSP_LIFETIME));
-        lsp->expired = false;
-        lsp->deleted = false;
-        lsp->instance = instance;
-        lsp->timestamp.tv_sec = now.tv_sec;
-        lsp->timestamp.tv_nsec = now.tv_nsec;
-
-        ISIS_PDU_CURSOR_RST(&pdu);
-        memcpy(&lsp->pdu, &pdu, sizeof(isis_pdu_s));
+    /* Start flooding while the rest of
+     * the file is still being loaded. */
+    isis_lsp_flood(lsp);
+    return true;
+}
 
-        if(lsp->lifetime > 0 && instance->config->external_auto_refresh) {
-            if(level == ISIS_LEVEL_1) {
-                lsp->auth_key = instance->config->level1_key;
-            } else {
-                lsp->auth_key = instance->config->level2_key;
-            }
-            if(lsp->lifetime < ISIS_DEFAULT_LSP_LIFETIME_MIN) {
-                /* Increase ISIS lifetime. */
-                lsp->lifetime = ISIS_DEFAULT_LSP_LIFETIME_MIN;
-                isis_lsp_refresh(lsp); 
-            }
-            refresh_interval = lsp->lifetime - 300;
-            timer_add_periodic(&g_ctx->timer_root, &lsp->timer_refresh, 
-                               "ISIS LSP REFRESH", refresh_interval, 3, lsp, 
-                               &isis_lsp_refresh_job);
-        } else {
-            isis_lsp_lifetime(lsp);
+/**
+ * isis_mrt_load_chunk
+ *
+ * Index and load the next chunk of MRT records.
+ *
+ * @param load MRT load context
+ * @return number of loaded records or -1 on error
+ */
+static int
+isis_mrt_load_chunk(isis_mrt_load_s *load)
+{
+    bbl_mrt_record_s record;
+    struct timespec now;
+    int count;
+
+    count = bbl_mrt_index(load->mrt);
+    if(count < 0) {
+        return -1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    for(int i = 0; i < count; i++) {
+        bbl_mrt_record(load->mrt, i, &record);
+        if(!isis_mrt_load_record(load, &record, &now)) {
+            return -1;
         }
     }
+    return count;
+}
+
+static void
+isis_mrt_load_free(isis_mrt_load_s *load)
+{
+    if(load->timer) {
+        load->timer->periodic = false;
+        load->timer->ptimer = NULL; /* Reset field such that timer library does not late ref */
+    }
+    bbl_mrt_close(load->mrt);
+    free(load);
+}
 
-    if(startup && refresh_interval) {
+static void
+isis_mrt_load_finish(isis_mrt_load_s *load)
+{
+    LOG(ISIS, "Loaded %lu records from ISIS MRT file %s\n",
+        load->mrt->records, load->mrt->file_path);
+
+    if(load->startup && load->refresh_interval) {
         /* Adding 3 nanoseconds to enforce a dedicated timer bucket. */
-        timer_smear_bucket(&g_ctx->timer_root, refresh_interval, 3);
+        timer_smear_bucket(&g_ctx->timer_root, load->refresh_interval, 3);
+    }
+    isis_mrt_load_free(load);
+}
+
+static void
+isis_mrt_load_job(timer_s *timer)
+{
+    isis_mrt_load_s *load = timer->data;
+
+    if(isis_mrt_load_chunk(load) < 0) {
+        LOG(ERROR, "Failed to load ISIS MRT file %s\n", load->mrt->file_path);
+        isis_mrt_load_free(load);
+        return;
     }
+    if(bbl_mrt_done(load->mrt)) {
+        isis_mrt_load_finish(load);
+    }
+}
 
-    fclose(mrt_file);
+/**
+ * isis_mrt_load
+ *
+ * The first chunk of the MRT file is loaded
+ * immediately, all remaining chunks are loaded
+ * by a periodic job to keep the event loop running.
+ *
+ * @param instance ISIS instance
+ * @param file_path MRT file path
+ * @param startup true if called during startup
+ * @return false on error
+ */
+bool
+isis_mrt_load(isis_instance_s *instance, char *file_path, bool startup)
+{
+    isis_mrt_load_s *load;
+    bbl_mrt_file_s *mrt;
+
+    LOG(ISIS, "Load ISIS MRT file %s\n", file_path);
+
+    mrt = bbl_mrt_open(file_path);
+    if(!mrt) {
+        return false;
+    }
+
+    load = calloc(1, sizeof(isis_mrt_load_s));
+    load->instance = instance;
+    load->mrt = mrt;
+    load->startup = startup;
+
+    if(isis_mrt_load_chunk(load) < 0) {
+        isis_mrt_load_free(load);
+        return false;
+    }
+    if(bbl_mrt_done(mrt)) {
+        isis_mrt_load_finish(load);
+    } else {
+        timer_add_periodic(&g_ctx->timer_root, &load->timer,
+                           "ISIS MRT LOAD", 0, BBL_MRT_LOAD_INTERVAL, load,
+                           &isis_mrt_load_job);
+    }
     return true;
-}
\ No newline at end of file
+}
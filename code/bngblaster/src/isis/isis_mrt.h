@@ -11,14 +11,15 @@
 
 #define ISIS_MRT_TYPE 32
 
-typedef struct isis_mrt_hdr_ {
-    uint32_t  timestamp;
-    uint16_t  type;
-    uint16_t  subtype;
-    uint32_t  length;
-} __attribute__ ((__packed__)) isis_mrt_hdr_t;
+typedef struct isis_mrt_load_ {
+    isis_instance_s *instance;
+    bbl_mrt_file_s *mrt;
+    timer_s *timer;
+    uint16_t refresh_interval;
+    bool startup;
+} isis_mrt_load_s;
 
 bool
 isis_mrt_load(isis_instance_s *instance, char *file_path, bool startup);
 
-#endif
\ No newline at end of file
+#endif
@@ -24,6 +24,9 @@ ospf_ctrl_load_mrt(int fd, uint32_t session_id __attribute__((unused)), json_t *
 int
 ospf_ctrl_lsa_update(int fd, uint32_t session_id __attribute__((unused)), json_t *arguments);
 
+const char *
+ospf_ctrl_pdu_update_pdu(uint16_t instance_id, uint8_t *buf, uint16_t len);
+
 int
 ospf_ctrl_pdu_update(int fd, uint32_t session_id __attribute__((unused)), json_t *arguments);
 
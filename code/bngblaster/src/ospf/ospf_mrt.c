@@ -8,105 +8,178 @@
  */
 #include "ospf.h"
 
-extern uint8_t g_pdu_buf[];
-
-bool
-ospf_mrt_load(ospf_instance_s *instance, char *file_path, bool startup)
+static bool
+ospf_mrt_load_record(ospf_mrt_load_s *load, bbl_mrt_record_s *record)
 {
-    FILE *mrt_file = NULL;
-    ospf_mrt_hdr_t mrt = {0};
+    ospf_instance_s *instance = load->instance;
+    char *file_path = load->mrt->file_path;
 
     ospf_pdu_s pdu = {0};
     uint32_t lsa_count = 0;
 
-    LOG(OSPF, "Load OSPF MRT file %s\n", file_path);
+    //LOG(DEBUG, "MRT type: %u subtype: %u length: %u\n", record->type, record->subtype, record->length);
 
-    mrt_file = fopen(file_path, "r");
-    if(!mrt_file) {
-        LOG(ERROR, "Failed to open MRT file %s\n", file_path);
+    if(!(record->subtype == 0 && record->length <= OSPF_PDU_LEN_MAX)) {
+        LOG(ERROR, "Invalid MRT file %s\n", file_path);
         return false;
     }
 
-    while(fread(&mrt, sizeof(ospf_mrt_hdr_t), 1, mrt_file) == 1) {
-        mrt.type = be16toh(mrt.type);
-        mrt.subtype = be16toh(mrt.subtype);
-        mrt.length = be32toh(mrt.length);
-        //LOG(DEBUG, "MRT type: %u subtype: %u length: %u\n", mrt.type, mrt.subtype, mrt.length);
-
-        if(!(mrt.subtype == 0 && mrt.length <= OSPF_PDU_LEN_MAX)) {
-            LOG(ERROR, "Invalid MRT file %s\n", file_path);
-            fclose(mrt_file);
+    /* The PDU is loaded directly from the file mapping. */
+    if(record->type == OSPFv2_MRT_TYPE && record->length >= (OSPFv2_MRT_PDU_OFFSET+OSPF_PDU_LEN_MIN)) {
+        if(ospf_pdu_load(&pdu, record->data+OSPFv2_MRT_PDU_OFFSET, record->length-OSPFv2_MRT_PDU_OFFSET) != PROTOCOL_SUCCESS) {
+            LOG(ERROR, "Invalid OSPFv2 MRT file %s (PDU load error)\n", file_path);
             return false;
         }
-        if(fread(g_pdu_buf, mrt.length, 1, mrt_file) != 1) {
-            LOG(ERROR, "Invalid MRT file %s\n", file_path);
-            fclose(mrt_file);
+        if(pdu.pdu_version != OSPF_VERSION_2) {
+            LOG(ERROR, "Invalid OSPFv2 MRT file %s (wrong PDU version)\n", file_path);
             return false;
         }
-
-        if(mrt.type == OSPFv2_MRT_TYPE && mrt.length >= (OSPFv2_MRT_PDU_OFFSET+OSPF_PDU_LEN_MIN)) {
-            if(ospf_pdu_load(&pdu, g_pdu_buf+OSPFv2_MRT_PDU_OFFSET, mrt.length-OSPFv2_MRT_PDU_OFFSET) != PROTOCOL_SUCCESS) {
-                LOG(ERROR, "Invalid OSPFv2 MRT file %s (PDU load error)\n", file_path);
-                fclose(mrt_file);
-                return false;
-            }
-            if(pdu.pdu_version != OSPF_VERSION_2) {
-                LOG(ERROR, "Invalid OSPFv2 MRT file %s (wrong PDU version)\n", file_path);
-                fclose(mrt_file);
-                return false;
-            }
-            if(pdu.pdu_len < OSPFV2_LS_UPDATE_LEN_MIN) {
-                LOG(ERROR, "Invalid OSPFv2 MRT file %s (wrong PDU len)\n", file_path);
-                fclose(mrt_file);
-                return false;
-            }
-            lsa_count = be32toh(*(uint32_t*)OSPF_PDU_OFFSET(&pdu, OSPFV2_OFFSET_LS_UPDATE_COUNT));
-            OSPF_PDU_CURSOR_SET(&pdu, OSPFV2_OFFSET_LS_UPDATE_LSA);
-        } else if(mrt.type == OSPFv3_MRT_TYPE && mrt.length >= (OSPFv3_MRT_PDU_OFFSET+OSPF_PDU_LEN_MIN)) {
-            if(ospf_pdu_load(&pdu, g_pdu_buf+OSPFv3_MRT_PDU_OFFSET, mrt.length-OSPFv3_MRT_PDU_OFFSET) != PROTOCOL_SUCCESS) {
-                LOG(ERROR, "Invalid OSPFv3 MRT file %s (PDU load error)\n", file_path);
-                fclose(mrt_file);
-                return false;
-            }
-            if(pdu.pdu_version != OSPF_VERSION_3) {
-                LOG(ERROR, "Invalid OSPFv3 MRT file %s (wrong PDU version)\n", file_path);
-                fclose(mrt_file);
-                return false;
-            }
-            if(pdu.pdu_len < OSPFV3_LS_UPDATE_LEN_MIN) {
-                LOG(ERROR, "Invalid OSPFv3 MRT file %s (wrong PDU len)\n", file_path);
-                fclose(mrt_file);
-                return false;
-            }
-            lsa_count = be32toh(*(uint32_t*)OSPF_PDU_OFFSET(&pdu, OSPFV3_OFFSET_LS_UPDATE_COUNT));
-            OSPF_PDU_CURSOR_SET(&pdu, OSPFV3_OFFSET_LS_UPDATE_LSA);
-        } else {
-            LOG(ERROR, "Invalid MRT file %s (wrong MRT type)\n", file_path);
-            fclose(mrt_file);
+        if(pdu.pdu_len < OSPFV2_LS_UPDATE_LEN_MIN) {
+            LOG(ERROR, "Invalid OSPFv2 MRT file %s (wrong PDU len)\n", file_path);
             return false;
         }
-        if(pdu.pdu_type != OSPF_PDU_LS_UPDATE) {
-            LOG(ERROR, "Invalid MRT file %s (wrong PDU type)\n", file_path);
-            fclose(mrt_file);
+        lsa_count = be32toh(*(uint32_t*)OSPF_PDU_OFFSET(&pdu, OSPFV2_OFFSET_LS_UPDATE_COUNT));
+        OSPF_PDU_CURSOR_SET(&pdu, OSPFV2_OFFSET_LS_UPDATE_LSA);
+    } else if(record->type == OSPFv3_MRT_TYPE && record->length >= (OSPFv3_MRT_PDU_OFFSET+OSPF_PDU_LEN_MIN)) {
+        if(ospf_pdu_load(&pdu, record->data+OSPFv3_MRT_PDU_OFFSET, record->length-OSPFv3_MRT_PDU_OFFSET) != PROTOCOL_SUCCESS) {
+            LOG(ERROR, "Invalid OSPFv3 MRT file %s (PDU load error)\n", file_path);
             return false;
         }
-        if(pdu.pdu_version != instance->config->version) {
-            LOG(ERROR, "Invalid MRT file %s (wrong version)\n", file_path);
-            fclose(mrt_file);
+        if(pdu.pdu_version != OSPF_VERSION_3) {
+            LOG(ERROR, "Invalid OSPFv3 MRT file %s (wrong PDU version)\n", file_path);
             return false;
         }
-        if(!ospf_lsa_load_external(instance, lsa_count, OSPF_PDU_CURSOR(&pdu), OSPF_PDU_CURSOR_LEN(&pdu))) {
-            LOG(ERROR, "Invalid MRT file %s (LSA load error)\n", file_path);
-            fclose(mrt_file);
+        if(pdu.pdu_len < OSPFV3_LS_UPDATE_LEN_MIN) {
+            LOG(ERROR, "Invalid OSPFv3 MRT file %s (wrong PDU len)\n", file_path);
             return false;
         }
+        lsa_count = be32toh(*(uint32_t*)OSPF_PDU_OFFSET(&pdu, OSPFV3_OFFSET_LS_UPDATE_COUNT));
+        OSPF_PDU_CURSOR_SET(&pdu, OSPFV3_OFFSET_LS_UPDATE_LSA);
+    } else {
+        LOG(ERROR, "Invalid MRT file %s (wrong MRT type)\n", file_path);
+        return false;
+    }
+    if(pdu.pdu_type != OSPF_PDU_LS_UPDATE) {
+        LOG(ERROR, "Invalid MRT file %s (wrong PDU type)\n", file_path);
+        return false;
+    }
+    if(pdu.pdu_version != instance->config->version) {
+        LOG(ERROR, "Invalid MRT file %s (wrong version)\n", file_path);
+        return false;
+    }
+    if(!ospf_lsa_load_external(instance, lsa_count, OSPF_PDU_CURSOR(&pdu), OSPF_PDU_CURSOR_LEN(&pdu))) {
+        LOG(ERROR, "Invalid MRT file %s (LSA load error)\n", file_path);
+        return false;
     }
+    return true;
+}
+
+/**
+ * ospf_mrt_load_chunk
+ *
+ * Index and load the next chunk of MRT records.
+ *
+ * @param load MRT load context
+ * @return number of loaded records or -1 on error
+ */
+static int
+ospf_mrt_load_chunk(ospf_mrt_load_s *load)
+{
+    bbl_mrt_record_s record;
+    int count;
 
-    if(startup) {
+    count = bbl_mrt_index(load->mrt);
+    if(count < 0) {
+        return -1;
+    }
+    for(int i = 0; i < count; i++) {
+        bbl_mrt_record(load->mrt, i, &record);
+        if(!ospf_mrt_load_record(load, &record)) {
+            return -1;
+        }
+    }
+    return count;
+}
+
+static void
+ospf_mrt_load_free(ospf_mrt_load_s *load)
+{
+    if(load->timer) {
+        load->timer->periodic = false;
+        load->timer->ptimer = NULL; /* Reset field such that timer library does not late ref */
+    }
+    bbl_mrt_close(load->mrt);
+    free(load);
+}
+
+static void
+ospf_mrt_load_finish(ospf_mrt_load_s *load)
+{
+    LOG(OSPF, "Loaded %lu records from OSPF MRT file %s\n",
+        load->mrt->records, load->mrt->file_path);
+
+    if(load->startup) {
         /* Adding 3 nanoseconds to enforce a dedicated timer bucket. */
         timer_smear_bucket(&g_ctx->timer_root, OSPF_LSA_REFRESH_TIME, 3);
     }
+    ospf_mrt_load_free(load);
+}
+
+static void
+ospf_mrt_load_job(timer_s *timer)
+{
+    ospf_mrt_load_s *load = timer->data;
+
+    if(ospf_mrt_load_chunk(load) < 0) {
+        LOG(ERROR, "Failed to load OSPF MRT file %s\n", load->mrt->file_path);
+        ospf_mrt_load_free(load);
+        return;
+    }
+    if(bbl_mrt_done(load->mrt)) {
+        ospf_mrt_load_finish(load);
+    }
+}
+
+/**
+ * ospf_mrt_load
+ *
+ * The first chunk of the MRT file is loaded
+ * immediately, all remaining chunks are loaded
+ * by a periodic job to keep the event loop running.
+ *
+ * @param instance OSPF instance
+ * @param file_path MRT file path
+ * @param startup true if called during startup
+ * @return false on error
+ */
+bool
+ospf_mrt_load(ospf_instance_s *instance, char *file_path, bool startup)
+{
+    ospf_mrt_load_s *load;
+    bbl_mrt_file_s *mrt;
+
+    LOG(OSPF, "Load OSPF MRT file %s\n", file_path);
+
+    mrt = bbl_mrt_open(file_path);
+    if(!mrt) {
+        return false;
+    }
+
+    load = calloc(1, sizeof(ospf_mrt_load_s));
+    load->instance = instance;
+    load->mrt = mrt;
+    load->startup = startup;
 
-    fclose(mrt_file);
+    if(ospf_mrt_load_chunk(load) < 0) {
+        ospf_mrt_load_free(load);
+        return false;
+    }
+    if(bbl_mrt_done(mrt)) {
+        ospf_mrt_load_finish(load);
+    } else {
+        timer_add_periodic(&g_ctx->timer_root, &load->timer,
+                           "OSPF MRT LOAD", 0, BBL_MRT_LOAD_INTERVAL, load,
+                           &ospf_mrt_load_job);
+    }
     return true;
-}
\ No newline at end of file
+}
@@ -15,12 +15,12 @@
 #define OSPFv2_MRT_PDU_OFFSET 8
 #define OSPFv3_MRT_PDU_OFFSET 34
 
-typedef struct ospf_mrt_hdr_ {
-    uint32_t  timestamp;
-    uint16_t  type;
-    uint16_t  subtype;
-    uint32_t  length;
-} __attribute__ ((__packed__)) ospf_mrt_hdr_t;
+typedef struct ospf_mrt_load_ {
+    ospf_instance_s *instance;
+    bbl_mrt_file_s *mrt;
+    timer_s *timer;
+    bool startup;
+} ospf_mrt_load_s;
 
 bool
 ospf_mrt_load(ospf_instance_s *instance, char *file_path, bool startup);
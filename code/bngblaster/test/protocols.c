@@ -46,9 +46,327 @@ test_protocols_decode_pppoe_ipcp_conf_request(void **unused) {
 
 }
 
+static void
+test_protocols_pppoe_template_eth(bbl_ethernet_header_s *eth, bbl_pppoe_discovery_s *pppoe,
+                                  access_line_s *access_line, uint32_t variant, uint8_t code) {
+    static uint8_t server_mac[ETH_ADDR_LEN] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+    static uint8_t client_mac[ETH_ADDR_LEN] = {0x02, 0x00, 0x00, 0x00, 0x01, 0x02};
+    static uint8_t service_name[] = "service";
+    static uint8_t host_uniq[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+    static uint8_t ac_cookie[] = {0xca, 0xfe, 0xba, 0xbe, 0x00, 0x01};
+
+    memset(eth, 0x0, sizeof(bbl_ethernet_header_s));
+    memset(pppoe, 0x0, sizeof(bbl_pppoe_discovery_s));
+    memset(access_line, 0x0, sizeof(access_line_s));
+
+    eth->dst = server_mac;
+    eth->src = client_mac;
+    eth->type = ETH_TYPE_PPPOE_DISCOVERY;
+    eth->next = pppoe;
+    /* Untagged, single tagged, double tagged and triple tagged. */
+    switch(variant & 0x3) {
+        case 3:
+            eth->vlan_three = 300 + code;
+            /* fall through */
+        case 2:
+            eth->vlan_inner = 200 + code;
+            /* fall through */
+        case 1:
+            eth->vlan_outer = 100 + code;
+            break;
+        default:
+            break;
+    }
+    eth->qinq = variant & 0x4;
+    if(variant & 0x8) {
+        eth->vlan_outer_priority = 5;
+        eth->vlan_inner_priority = 5;
+    }
+    pppoe->code = code;
+    if(variant & 0x10) {
+        pppoe->service_name = service_name;
+        pppoe->service_name_len = sizeof(service_name) - 1;
+    }
+    if(variant & 0x20) {
+        host_uniq[0] = code;
+        pppoe->host_uniq = host_uniq;
+        pppoe->host_uniq_len = sizeof(host_uniq);
+    }
+    if(variant & 0x40) {
+        pppoe->max_payload = 1500;
+    }
+    if(variant & 0x80 && code == PPPOE_PADR) {
+        pppoe->ac_cookie = ac_cookie;
+        pppoe->ac_cookie_len = sizeof(ac_cookie);
+    }
+    if(variant & 0x100) {
+        access_line->aci = "0.0.0.0/0.0.0.0 eth 0:1";
+        access_line->ari = "DEU.RTBRICK.1";
+        access_line->up = 1024;
+        access_line->down = 16384;
+        access_line->dsl_type = 5;
+        pppoe->access_line = access_line;
+    }
+}
+
+static void
+test_protocols_encode_pppoe_template(void **unused) {
+    (void) unused;
+
+    bbl_pppoe_template_s *template = calloc(1, sizeof(bbl_pppoe_template_s));
+    uint8_t *buf = calloc(1, 2048);
+    uint8_t *expected = calloc(1, 2048);
+    uint16_t len, expected_len;
+    bbl_ethernet_header_s eth;
+    bbl_pppoe_discovery_s pppoe;
+    access_line_s access_line;
+    uint8_t codes[] = {PPPOE_PADI, PPPOE_PADR};
+    uint32_t variant;
+    uint8_t i;
+
+    for(variant = 0; variant < 0x200; variant++) {
+        test_protocols_pppoe_template_eth(&eth, &pppoe, &access_line, variant, PPPOE_PADI);
+        assert_int_equal(encode_pppoe_template(template, &eth), PROTOCOL_SUCCESS);
+        for(i = 0; i < sizeof(codes); i++) {
+            test_protocols_pppoe_template_eth(&eth, &pppoe, &access_line, variant, codes[i]);
+            len = 0;
+            assert_int_equal(encode_pppoe_discovery_template(buf, &len, template, &eth), PROTOCOL_SUCCESS);
+            expected_len = 0;
+            assert_int_equal(encode_ethernet(expected, &expected_len, &eth), PROTOCOL_SUCCESS);
+            assert_int_equal(len, expected_len);
+            assert_memory_equal(buf, expected, len);
+        }
+    }
+
+    /* Template must not be used if tags or VLAN tags differ. */
+    test_protocols_pppoe_template_eth(&eth, &pppoe, &access_line, 0x31, PPPOE_PADI);
+    assert_int_equal(encode_pppoe_template(template, &eth), PROTOCOL_SUCCESS);
+    pppoe.service_name = (uint8_t*)"SERVICE";
+    len = 0;
+    assert_int_equal(encode_pppoe_discovery_template(buf, &len, template, &eth), ENCODE_ERROR);
+    assert_int_equal(len, 0);
+    test_protocols_pppoe_template_eth(&eth, &pppoe, &access_line, 0x11, PPPOE_PADI);
+    assert_int_equal(encode_pppoe_discovery_template(buf, &len, template, &eth), ENCODE_ERROR);
+    test_protocols_pppoe_template_eth(&eth, &pppoe, &access_line, 0x32, PPPOE_PADI);
+    assert_int_equal(encode_pppoe_discovery_template(buf, &len, template, &eth), ENCODE_ERROR);
+    test_protocols_pppoe_template_eth(&eth, &pppoe, &access_line, 0x35, PPPOE_PADI);
+    assert_int_equal(encode_pppoe_discovery_template(buf, &len, template, &eth), ENCODE_ERROR);
+
+    free(expected);
+    free(buf);
+    free(template);
+}
+
+typedef struct test_protocols_dhcp_ {
+    bbl_ethernet_header_s eth;
+    bbl_pppoe_session_s pppoe;
+    bbl_ipv4_s ipv4;
+    bbl_ipv6_s ipv6;
+    bbl_udp_s udp;
+    struct dhcp_header header;
+    bbl_dhcp_s dhcp;
+    bbl_dhcpv6_s dhcpv6;
+    access_line_s access_line;
+} test_protocols_dhcp_s;
+
+static void
+test_protocols_dhcp_template_eth(test_protocols_dhcp_s *p, bool v6, uint32_t variant, uint8_t seq) {
+    static uint8_t server_mac[ETH_ADDR_LEN] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+    static uint8_t client_mac[ETH_ADDR_LEN] = {0x02, 0x00, 0x00, 0x00, 0x01, 0x02};
+    static uint8_t multicast_mac[ETH_ADDR_LEN] = {0x33, 0x33, 0x00, 0x01, 0x00, 0x02};
+    static uint8_t link_local[IPV6_ADDR_LEN] = {0xfe, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02};
+    static uint8_t all_dhcp[IPV6_ADDR_LEN] = {0xff, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                              0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02};
+    static uint8_t client_duid[] = {0x00, 0x03, 0x00, 0x01, 0x02, 0x00, 0x00, 0x00, 0x01, 0x02};
+    static uint8_t server_duid[] = {0x00, 0x01, 0x00, 0x01, 0xca, 0xfe, 0xba, 0xbe, 0x00, 0x01};
+    static uint8_t ia_option[] = {0x00, 0x05, 0x00, 0x18, 0x20, 0x01, 0x0d, 0xb8,
+                                  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                  0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x0e, 0x10,
+                                  0x00, 0x00, 0x1c, 0x20};
+    static uint8_t client_identifier[] = {0x01, 0x02, 0x00, 0x00, 0x00, 0x01, 0x02};
+
+    memset(p, 0x0, sizeof(test_protocols_dhcp_s));
+
+    client_mac[5] = seq;
+    p->eth.src = client_mac;
+    /* Untagged, single tagged, double tagged and triple tagged. */
+    switch(variant & 0x3) {
+        case 3:
+            p->eth.vlan_three = 300 + seq;
+            /* fall through */
+        case 2:
+            p->eth.vlan_inner = 200 + seq;
+            /* fall through */
+        case 1:
+            p->eth.vlan_outer = 100 + seq;
+            break;
+        default:
+            break;
+    }
+    p->eth.qinq = variant & 0x4;
+    if(variant & 0x8) {
+        p->eth.vlan_outer_priority = 5;
+        p->eth.vlan_inner_priority = 5;
+    }
+    if(variant & 0x20) {
+        p->access_line.aci = "0.0.0.0/0.0.0.0 eth 0:1";
+        p->access_line.ari = "DEU.RTBRICK.1";
+        p->access_line.up = 1024 + seq;
+        p->access_line.down = 16384;
+        p->access_line.dsl_type = 5;
+    }
+    p->udp.next = v6 ? (void*)&p->dhcpv6 : (void*)&p->dhcp;
+
+    if(v6) {
+        if(variant & 0x40) {
+            p->eth.dst = server_mac;
+            p->eth.type = ETH_TYPE_PPPOE_SESSION;
+            p->eth.next = &p->pppoe;
+            p->pppoe.session_id = seq + 1;
+            p->pppoe.protocol = PROTOCOL_IPV6;
+            p->pppoe.next = &p->ipv6;
+        } else {
+            p->eth.dst = multicast_mac;
+            p->eth.type = ETH_TYPE_IPV6;
+            p->eth.next = &p->ipv6;
+        }
+        link_local[15] = seq;
+        p->ipv6.src = link_local;
+        p->ipv6.dst = all_dhcp;
+        p->ipv6.ttl = 64;
+        p->ipv6.tos = 0x20;
+        p->ipv6.protocol = IPV6_NEXT_HEADER_UDP;
+        p->ipv6.next = &p->udp;
+        p->udp.src = DHCPV6_UDP_CLIENT;
+        p->udp.dst = DHCPV6_UDP_SERVER;
+        p->udp.protocol = UDP_PROTOCOL_DHCPV6;
+        p->dhcpv6.type = seq & 0x1 ? DHCPV6_MESSAGE_REQUEST : DHCPV6_MESSAGE_SOLICIT;
+        p->dhcpv6.xid = 0x123456 + seq;
+        p->dhcpv6.elapsed = seq * 100;
+        p->dhcpv6.client_duid = client_duid;
+        p->dhcpv6.client_duid_len = sizeof(client_duid);
+        p->dhcpv6.oro = true;
+        if(variant & 0x10) {
+            p->dhcpv6.ia_na_iaid = 1;
+            p->dhcpv6.ia_pd_iaid = 2;
+            if(p->dhcpv6.type == DHCPV6_MESSAGE_REQUEST) {
+                p->dhcpv6.server_duid = server_duid;
+                p->dhcpv6.server_duid_len = sizeof(server_duid);
+                p->dhcpv6.ia_na_option = ia_option;
+                p->dhcpv6.ia_na_option_len = sizeof(ia_option);
+            }
+        }
+        if(variant & 0x20) {
+            p->dhcpv6.access_line = &p->access_line;
+        }
+        if(variant & 0x80 && p->dhcpv6.type == DHCPV6_MESSAGE_SOLICIT) {
+            p->dhcpv6.rapid = true;
+        }
+    } else {
+        p->eth.type = ETH_TYPE_IPV4;
+        p->eth.next = &p->ipv4;
+        p->ipv4.ttl = 255;
+        p->ipv4.tos = 0xc0;
+        p->ipv4.protocol = PROTOCOL_IPV4_UDP;
+        p->ipv4.next = &p->udp;
+        p->udp.src = DHCP_UDP_CLIENT;
+        p->udp.dst = DHCP_UDP_SERVER;
+        p->udp.protocol = UDP_PROTOCOL_DHCP;
+        p->dhcp.header = &p->header;
+        p->header.op = BOOTREQUEST;
+        p->header.htype = 1;
+        p->header.hlen = 6;
+        p->header.xid = htobe32(0x123456 + seq);
+        p->header.secs = htobe16(seq);
+        memcpy(p->header.chaddr, client_mac, ETH_ADDR_LEN);
+        p->ipv4.dst = IPV4_BROADCAST;
+        p->dhcp.parameter_request_list = true;
+        p->dhcp.option_netmask = true;
+        p->dhcp.option_dns1 = true;
+        p->dhcp.option_router = true;
+        p->dhcp.option_domain_name = variant & 0x40;
+        if(seq & 0x1) {
+            p->dhcp.type = DHCP_MESSAGE_REQUEST;
+            p->dhcp.option_address = true;
+            p->dhcp.address = htobe32(0x0a000000 + seq);
+            p->dhcp.option_server_identifier = true;
+            p->dhcp.server_identifier = htobe32(0x0a0000fe);
+        } else {
+            p->dhcp.type = DHCP_MESSAGE_DISCOVER;
+        }
+        if(variant & 0x10) {
+            p->dhcp.vendor_class_id = "BNG Blaster";
+            client_identifier[6] = seq;
+            p->dhcp.client_identifier = client_identifier;
+            p->dhcp.client_identifier_len = sizeof(client_identifier);
+        }
+        if(variant & 0x20) {
+            p->dhcp.access_line = &p->access_line;
+        }
+    }
+}
+
+static void
+test_protocols_encode_dhcp_template(void **unused) {
+    (void) unused;
+
+    bbl_dhcp_template_s *template = calloc(1, sizeof(bbl_dhcp_template_s));
+    test_protocols_dhcp_s *p = calloc(1, sizeof(test_protocols_dhcp_s));
+    uint8_t *buf = calloc(1, 2048);
+    uint8_t *expected = calloc(1, 2048);
+    uint16_t len, expected_len;
+    uint32_t variant;
+    uint8_t v6, seq;
+
+    for(v6 = 0; v6 < 2; v6++) {
+        for(variant = 0; variant < 0x100; variant++) {
+            test_protocols_dhcp_template_eth(p, v6, variant, 0);
+            assert_int_equal(encode_dhcp_template(template, &p->eth), PROTOCOL_SUCCESS);
+            for(seq = 0; seq < 4; seq++) {
+                test_protocols_dhcp_template_eth(p, v6, variant, seq);
+                /* Start with an offset to verify that
+                 * lengths and checksums are relative. */
+                len = 3;
+                assert_int_equal(encode_dhcp_ethernet_template(buf, &len, template, &p->eth), PROTOCOL_SUCCESS);
+                test_protocols_dhcp_template_eth(p, v6, variant, seq);
+                expected_len = 3;
+                assert_int_equal(encode_ethernet(expected, &expected_len, &p->eth), PROTOCOL_SUCCESS);
+                assert_int_equal(len, expected_len);
+                assert_memory_equal(buf, expected, len - 3);
+            }
+        }
+    }
+
+    /* Template must not be used if VLAN tags, the parameter
+     * request list or the IP version differ. */
+    test_protocols_dhcp_template_eth(p, false, 0x01, 0);
+    assert_int_equal(encode_dhcp_template(template, &p->eth), PROTOCOL_SUCCESS);
+    len = 0;
+    test_protocols_dhcp_template_eth(p, false, 0x02, 0);
+    assert_int_equal(encode_dhcp_ethernet_template(buf, &len, template, &p->eth), ENCODE_ERROR);
+    test_protocols_dhcp_template_eth(p, false, 0x41, 0);
+    assert_int_equal(encode_dhcp_ethernet_template(buf, &len, template, &p->eth), ENCODE_ERROR);
+    test_protocols_dhcp_template_eth(p, true, 0x01, 0);
+    assert_int_equal(encode_dhcp_ethernet_template(buf, &len, template, &p->eth), ENCODE_ERROR);
+    assert_int_equal(len, 0);
+
+    /* DHCPv6 relay messages are not supported. */
+    test_protocols_dhcp_template_eth(p, true, 0x00, 0);
+    p->dhcpv6.type = DHCPV6_MESSAGE_RELAY_FORW;
+    assert_int_equal(encode_dhcp_template(template, &p->eth), ENCODE_ERROR);
+
+    free(expected);
+    free(buf);
+    free(p);
+    free(template);
+}
+
 int main() {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_protocols_decode_pppoe_ipcp_conf_request),
+        cmocka_unit_test(test_protocols_encode_pppoe_template),
+        cmocka_unit_test(test_protocols_encode_dhcp_template),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
\ No newline at end of file
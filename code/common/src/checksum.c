@@ -9,6 +9,415 @@
  */
 #include "checksum.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CHECKSUM_X86
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define CHECKSUM_NEON
+#endif
+
+/* Number of SIMD blocks summed up before the
+ * vector lanes are folded into the scalar sums,
+ * to prevent overflow of the 32-bit lanes. */
+#define CHECKSUM_SIMD_CHUNK 1024
+
+typedef uint32_t (*checksum_partial_fn)(const uint8_t *buf, size_t len);
+typedef void (*fletcher_sum_fn)(const uint8_t *buf, size_t len, int64_t *c0, int64_t *c1);
+
+static uint32_t checksum_partial_scalar(const uint8_t *buf, size_t len);
+static void fletcher_sum_scalar(const uint8_t *buf, size_t len, int64_t *c0, int64_t *c1);
+
+/* The scalar implementation is used until checksum_set_impl
+ * is called, which must happen before any threads are started. */
+static checksum_impl_t g_checksum_impl = CHECKSUM_IMPL_SCALAR;
+static checksum_partial_fn g_checksum_partial = checksum_partial_scalar;
+static fletcher_sum_fn g_fletcher_sum = fletcher_sum_scalar;
+
+static uint32_t
+checksum_fold(uint64_t sum)
+{
+    while(sum >> 16) {
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+    return sum;
+}
+
+/*
+ * SCALAR
+ * ------------------------------------------------------------------------*/
+
+static uint32_t
+checksum_partial_scalar(const uint8_t *buf, size_t len)
+{
+    uint64_t sum = 0;
+    uint16_t word;
+
+    while(len > 1) {
+        memcpy(&word, buf, sizeof(word));
+        sum += word;
+        buf += 2;
+        len -= 2;
+    }
+    /* Add left-over byte, if any */
+    if(len) {
+        sum += *buf;
+    }
+    return checksum_fold(sum);
+}
+
+static void
+fletcher_sum_scalar(const uint8_t *buf, size_t len, int64_t *_c0, int64_t *_c1)
+{
+    int64_t c0 = *_c0;
+    int64_t c1 = *_c1;
+
+    /* 10x loop unrolling */
+    while(len >= 10) {
+        c0 += *buf++;
+        c1 += c0;
+        c0 += *buf++;
+        c1 += c0;
+        c0 += *buf++;
+        c1 += c0;
+        c0 += *buf++;
+        c1 += c0;
+        c0 += *buf++;
+        c1 += c0;
+        c0 += *buf++;
+        c1 += c0;
+        c0 += *buf++;
+        c1 += c0;
+        c0 += *buf++;
+        c1 += c0;
+        c0 += *buf++;
+        c1 += c0;
+        c0 += *buf++;
+        c1 += c0;
+
+        len -= 10;
+    }
+
+    /* remainder */
+    while(len--) {
+        c0 += *buf++;
+        c1 += c0;
+    }
+
+    *_c0 = c0;
+    *_c1 = c1;
+}
+
+#ifdef CHECKSUM_X86
+
+/*
+ * SSE4.2
+ * ------------------------------------------------------------------------*/
+
+__attribute__((target("sse4.2")))
+static uint32_t
+checksum_partial_sse42(const uint8_t *buf, size_t len)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i v, acc, sum64 = zero;
+    uint64_t lanes[2];
+    size_t blocks;
+
+    while(len >= 16) {
+        blocks = len / 16;
+        if(blocks > CHECKSUM_SIMD_CHUNK) blocks = CHECKSUM_SIMD_CHUNK;
+        len -= blocks * 16;
+        acc = zero;
+        while(blocks--) {
+            v = _mm_loadu_si128((const __m128i*)buf);
+            acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(v, zero));
+            acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(v, zero));
+            buf += 16;
+        }
+        sum64 = _mm_add_epi64(sum64, _mm_unpacklo_epi32(acc, zero));
+        sum64 = _mm_add_epi64(sum64, _mm_unpackhi_epi32(acc, zero));
+    }
+    _mm_storeu_si128((__m128i*)lanes, sum64);
+    return checksum_fold(lanes[0] + lanes[1] + checksum_partial_scalar(buf, len));
+}
+
+__attribute__((target("sse4.2")))
+static void
+fletcher_sum_sse42(const uint8_t *buf, size_t len, int64_t *c0, int64_t *c1)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i weights = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9,
+                                          8, 7, 6, 5, 4, 3, 2, 1);
+    __m128i v, s0, s1, ps;
+    uint64_t l0[2], lps[2];
+    uint32_t l1[4];
+    size_t blocks;
+
+    while(len >= 16) {
+        blocks = len / 16;
+        if(blocks > CHECKSUM_SIMD_CHUNK) blocks = CHECKSUM_SIMD_CHUNK;
+        len -= blocks * 16;
+        /* Each byte already summed up is added
+         * once more for every following byte. */
+        *c1 += (int64_t)blocks * 16 * *c0;
+        s0 = s1 = ps = zero;
+        while(blocks--) {
+            v = _mm_loadu_si128((const __m128i*)buf);
+            ps = _mm_add_epi64(ps, s0);
+            s0 = _mm_add_epi64(s0, _mm_sad_epu8(v, zero));
+            s1 = _mm_add_epi32(s1, _mm_madd_epi16(_mm_maddubs_epi16(v, weights), ones));
+            buf += 16;
+        }
+        _mm_storeu_si128((__m128i*)l0, s0);
+        _mm_storeu_si128((__m128i*)lps, ps);
+        _mm_storeu_si128((__m128i*)l1, s1);
+        *c0 += l0[0] + l0[1];
+        *c1 += 16 * (lps[0] + lps[1]) + l1[0] + l1[1] + l1[2] + l1[3];
+    }
+    fletcher_sum_scalar(buf, len, c0, c1);
+}
+
+/*
+ * AVX2
+ * ------------------------------------------------------------------------*/
+
+__attribute__((target("avx2")))
+static uint32_t
+checksum_partial_avx2(const uint8_t *buf, size_t len)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i v, acc, sum64 = zero;
+    uint64_t lanes[4];
+    size_t blocks;
+
+    while(len >= 32) {
+        blocks = len / 32;
+        if(blocks > CHECKSUM_SIMD_CHUNK) blocks = CHECKSUM_SIMD_CHUNK;
+        len -= blocks * 32;
+        acc = zero;
+        while(blocks--) {
+            v = _mm256_loadu_si256((const __m256i*)buf);
+            acc = _mm256_add_epi32(acc, _mm256_unpacklo_epi16(v, zero));
+            acc = _mm256_add_epi32(acc, _mm256_unpackhi_epi16(v, zero));
+            buf += 32;
+        }
+        sum64 = _mm256_add_epi64(sum64, _mm256_unpacklo_epi32(acc, zero));
+        sum64 = _mm256_add_epi64(sum64, _mm256_unpackhi_epi32(acc, zero));
+    }
+    _mm256_storeu_si256((__m256i*)lanes, sum64);
+    return checksum_fold(lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+                         checksum_partial_scalar(buf, len));
+}
+
+__attribute__((target("avx2")))
+static void
+fletcher_sum_avx2(const uint8_t *buf, size_t len, int64_t *c0, int64_t *c1)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi16(1);
+    const __m256i weights = _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25,
+                                             24, 23, 22, 21, 20, 19, 18, 17,
+                                             16, 15, 14, 13, 12, 11, 10, 9,
+                                             8, 7, 6, 5, 4, 3, 2, 1);
+    __m256i v, s0, s1, ps;
+    uint64_t l0[4], lps[4];
+    uint32_t l1[8];
+    size_t blocks;
+    int i;
+
+    while(len >= 32) {
+        blocks = len / 32;
+        if(blocks > CHECKSUM_SIMD_CHUNK) blocks = CHECKSUM_SIMD_CHUNK;
+        len -= blocks * 32;
+        *c1 += (int64_t)blocks * 32 * *c0;
+        s0 = s1 = ps = zero;
+        while(blocks--) {
+            v = _mm256_loadu_si256((const __m256i*)buf);
+            ps = _mm256_add_epi64(ps, s0);
+            s0 = _mm256_add_epi64(s0, _mm256_sad_epu8(v, zero));
+            s1 = _mm256_add_epi32(s1, _mm256_madd_epi16(_mm256_maddubs_epi16(v, weights), ones));
+            buf += 32;
+        }
+        _mm256_storeu_si256((__m256i*)l0, s0);
+        _mm256_storeu_si256((__m256i*)lps, ps);
+        _mm256_storeu_si256((__m256i*)l1, s1);
+        for(i = 0; i < 4; i++) {
+            *c0 += l0[i];
+            *c1 += 32 * lps[i] + l1[i] + l1[i+4];
+        }
+    }
+    fletcher_sum_scalar(buf, len, c0, c1);
+}
+
+#endif
+
+#ifdef CHECKSUM_NEON
+
+/*
+ * NEON
+ * ------------------------------------------------------------------------*/
+
+static uint32_t
+checksum_partial_neon(const uint8_t *buf, size_t len)
+{
+    uint64x2_t sum64 = vdupq_n_u64(0);
+    uint32x4_t acc;
+    size_t blocks;
+
+    while(len >= 16) {
+        blocks = len / 16;
+        if(blocks > CHECKSUM_SIMD_CHUNK) blocks = CHECKSUM_SIMD_CHUNK;
+        len -= blocks * 16;
+        acc = vdupq_n_u32(0);
+        while(blocks--) {
+            acc = vpadalq_u16(acc, vreinterpretq_u16_u8(vld1q_u8(buf)));
+            buf += 16;
+        }
+        sum64 = vpadalq_u32(sum64, acc);
+    }
+    return checksum_fold(vaddvq_u64(sum64) + checksum_partial_scalar(buf, len));
+}
+
+static void
+fletcher_sum_neon(const uint8_t *buf, size_t len, int64_t *c0, int64_t *c1)
+{
+    static const uint8_t w[16] = { 16, 15, 14, 13, 12, 11, 10, 9,
+                                   8, 7, 6, 5, 4, 3, 2, 1 };
+    const uint8x16_t weights = vld1q_u8(w);
+    uint8x16_t v;
+    uint16x8_t prod;
+    uint32x4_t s0, s1, ps;
+    size_t blocks;
+
+    while(len >= 16) {
+        blocks = len / 16;
+        if(blocks > CHECKSUM_SIMD_CHUNK) blocks = CHECKSUM_SIMD_CHUNK;
+        len -= blocks * 16;
+        *c1 += (int64_t)blocks * 16 * *c0;
+        s0 = s1 = ps = vdupq_n_u32(0);
+        while(blocks--) {
+            v = vld1q_u8(buf);
+            ps = vaddq_u32(ps, s0);
+            s0 = vpadalq_u16(s0, vpaddlq_u8(v));
+            prod = vmull_u8(vget_low_u8(v), vget_low_u8(weights));
+            prod = vmlal_u8(prod, vget_high_u8(v), vget_high_u8(weights));
+            s1 = vpadalq_u16(s1, prod);
+            buf += 16;
+        }
+        *c0 += vaddlvq_u32(s0);
+        *c1 += 16 * vaddlvq_u32(ps) + vaddlvq_u32(s1);
+    }
+    fletcher_sum_scalar(buf, len, c0, c1);
+}
+
+#endif
+
+/*
+ * DISPATCH
+ * ------------------------------------------------------------------------*/
+
+static bool
+checksum_impl_supported(checksum_impl_t impl)
+{
+    switch(impl) {
+        case CHECKSUM_IMPL_SCALAR:
+            return true;
+#ifdef CHECKSUM_X86
+        case CHECKSUM_IMPL_SSE42:
+            return __builtin_cpu_supports("sse4.2");
+        case CHECKSUM_IMPL_AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+#ifdef CHECKSUM_NEON
+        case CHECKSUM_IMPL_NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief checksum_set_impl
+ *
+ * Select the checksum implementation used by
+ * checksum_partial and calculate_fletcher_checksum.
+ * CHECKSUM_IMPL_AUTO selects the best implementation
+ * supported by the CPU. The selection is not thread-safe
+ * and must be done at startup before any threads are started.
+ *
+ * Returns false if not supported by this CPU or build.
+ */
+bool
+checksum_set_impl(checksum_impl_t impl)
+{
+    if(impl == CHECKSUM_IMPL_AUTO) {
+        impl = CHECKSUM_IMPL_SCALAR;
+        if(checksum_impl_supported(CHECKSUM_IMPL_NEON)) {
+            impl = CHECKSUM_IMPL_NEON;
+        } else if(checksum_impl_supported(CHECKSUM_IMPL_AVX2)) {
+            impl = CHECKSUM_IMPL_AVX2;
+        } else if(checksum_impl_supported(CHECKSUM_IMPL_SSE42)) {
+            impl = CHECKSUM_IMPL_SSE42;
+        }
+    } else if(!checksum_impl_supported(impl)) {
+        return false;
+    }
+
+    switch(impl) {
+#ifdef CHECKSUM_X86
+        case CHECKSUM_IMPL_SSE42:
+            g_checksum_partial = checksum_partial_sse42;
+            g_fletcher_sum = fletcher_sum_sse42;
+            break;
+        case CHECKSUM_IMPL_AVX2:
+            g_checksum_partial = checksum_partial_avx2;
+            g_fletcher_sum = fletcher_sum_avx2;
+            break;
+#endif
+#ifdef CHECKSUM_NEON
+        case CHECKSUM_IMPL_NEON:
+            g_checksum_partial = checksum_partial_neon;
+            g_fletcher_sum = fletcher_sum_neon;
+            break;
+#endif
+        default:
+            g_checksum_partial = checksum_partial_scalar;
+            g_fletcher_sum = fletcher_sum_scalar;
+            break;
+    }
+    g_checksum_impl = impl;
+    return true;
+}
+
+const char *
+checksum_impl_name(void)
+{
+    switch(g_checksum_impl) {
+        case CHECKSUM_IMPL_SCALAR: return "scalar";
+        case CHECKSUM_IMPL_SSE42: return "sse4.2";
+        case CHECKSUM_IMPL_AVX2: return "avx2";
+        case CHECKSUM_IMPL_NEON: return "neon";
+        default: return "auto";
+    }
+}
+
+/**
+ * @brief checksum_partial
+ *
+ * Internet checksum (RFC 1071) one's complement sum of
+ * 16-bit words in host byte order, folded to 16 bits.
+ * Partial sums of multiple buffers (e.g. pseudo header
+ * and payload) can be added and folded again before
+ * the final complement.
+ */
+uint32_t
+checksum_partial(const void *buf, size_t len)
+{
+    return g_checksum_partial(buf, len);
+}
+
 /**
  * @brief validate_fletcher_checksum
  * 
@@ -46,7 +455,6 @@ uint16_t
 calculate_fletcher_checksum(uint8_t *pptr, uint checksum_offset, uint length)
 {
     int64_t c0, c1;
-    int tlen;
 
     c0 = 0;
     c1 = 0;
@@ -55,38 +463,7 @@ calculate_fletcher_checksum(uint8_t *pptr, uint checksum_offset, uint length)
     *(pptr + checksum_offset) = 0;
     *(pptr + checksum_offset + 1) = 0;
 
-    /* 10x loop unrolling */
-    tlen = length;
-    while(tlen >= 10) {
-        c0 += *pptr++;
-        c1 += c0;
-        c0 += *pptr++;
-        c1 += c0;
-        c0 += *pptr++;
-        c1 += c0;
-        c0 += *pptr++;
-        c1 += c0;
-        c0 += *pptr++;
-        c1 += c0;
-        c0 += *pptr++;
-        c1 += c0;
-        c0 += *pptr++;
-        c1 += c0;
-        c0 += *pptr++;
-        c1 += c0;
-        c0 += *pptr++;
-        c1 += c0;
-        c0 += *pptr++;
-        c1 += c0;
-
-        tlen -= 10;
-    }
-
-    /* remainder */
-    while (--tlen >= 0) {
-        c0 += *pptr++;
-        c1 += c0;
-    }
+    g_fletcher_sum(pptr, length, &c0, &c1);
 
     c0 = c0 % 255;
     c1 = (c1 - (length - checksum_offset) * c0) % 255;
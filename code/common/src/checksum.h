@@ -12,6 +12,24 @@
 #define __COMMON_CHECKSUM_H__
 #include "common.h"
 
+typedef enum checksum_impl_ {
+    CHECKSUM_IMPL_AUTO = 0,
+    CHECKSUM_IMPL_SCALAR,
+    CHECKSUM_IMPL_SSE42,
+    CHECKSUM_IMPL_AVX2,
+    CHECKSUM_IMPL_NEON,
+    CHECKSUM_IMPL_MAX
+} checksum_impl_t;
+
+bool
+checksum_set_impl(checksum_impl_t impl);
+
+const char *
+checksum_impl_name(void);
+
+uint32_t
+checksum_partial(const void *buf, size_t len);
+
 uint16_t
 validate_fletcher_checksum(const uint8_t *pptr, uint length);
 
@@ -39,6 +39,17 @@
 
 #define CACHE_LINE_SIZE             64
 
+/* Binary PDU stream over the control socket (LSPGEN to BNG Blaster).
+ * The stream header (magic, version, protocol, instance) is followed
+ * by frames of 2 bytes PDU length and the raw PDU. A frame with
+ * length zero terminates the stream. */
+#define CTRL_PDU_STREAM_MAGIC       0x42424c53 /* "BBLS" */
+#define CTRL_PDU_STREAM_VERSION     1
+#define CTRL_PDU_STREAM_HDR_LEN     8
+#define CTRL_PDU_STREAM_FRAME_MAX   (2+UINT16_MAX)
+#define CTRL_PDU_STREAM_ISIS        1
+#define CTRL_PDU_STREAM_OSPF        2
+
 /* Macro Definitions */
 
 #define UNUSED(x) (void)x
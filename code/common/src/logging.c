@@ -73,6 +73,7 @@ log_open()
 void
 log_close()
 {
+    log_async_stop();
     if(g_log_fp) {
         fclose(g_log_fp);
         g_log_fp = NULL;
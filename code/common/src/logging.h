@@ -16,6 +16,7 @@ extern char *g_log_file;
 
 extern FILE *g_log_fp;
 extern keyval_t log_names[];
+extern volatile bool g_log_async;
 
 /*
  * List of log-ids.
@@ -70,6 +71,12 @@ extern uint8_t g_log_buf_cur;
 
 #define LOG(log_id_, fmt_, ...) \
     do { \
+        if(g_log_async && !g_interactive) { \
+            if (log_id[log_id_].enable) { \
+                log_async(fmt_, ##__VA_ARGS__); \
+            } \
+            break; \
+        } \
         if(g_log_fp) { \
             if (log_id[log_id_].enable) { \
                 fprintf(g_log_fp, "%s "fmt_, log_format_timestamp(), ##__VA_ARGS__); \
@@ -95,6 +102,12 @@ extern uint8_t g_log_buf_cur;
 
 #define LOG_NOARG(log_id_, fmt_) \
     do { \
+        if(g_log_async && !g_interactive) { \
+            if (log_id[log_id_].enable) { \
+                log_async(fmt_); \
+            } \
+            break; \
+        } \
         if(g_log_fp) { \
             if (log_id[log_id_].enable) { \
                 fprintf(g_log_fp, "%s "fmt_, log_format_timestamp()); \
@@ -121,7 +134,11 @@ extern uint8_t g_log_buf_cur;
 #else 
 #define LOG(log_id_, fmt_, ...) \
     do { \
-        if(g_log_fp) { \
+        if(g_log_async) { \
+            if (log_id[log_id_].enable) { \
+                log_async(fmt_, ##__VA_ARGS__); \
+            } \
+        } else if(g_log_fp) { \
             if (log_id[log_id_].enable) { \
                 fprintf(g_log_fp, "%s "fmt_, log_format_timestamp(), ##__VA_ARGS__); \
             }\
@@ -134,7 +151,11 @@ extern uint8_t g_log_buf_cur;
 
 #define LOG_NOARG(log_id_, fmt_) \
     do { \
-        if(g_log_fp) { \
+        if(g_log_async) { \
+            if (log_id[log_id_].enable) { \
+                log_async(fmt_); \
+            } \
+        } else if(g_log_fp) { \
             if (log_id[log_id_].enable) { \
                 fprintf(g_log_fp, "%s "fmt_, log_format_timestamp()); \
             }\
@@ -166,4 +187,13 @@ log_format_timestamp(void);
 char *
 log_usage();
 
+void
+log_async(const char *fmt, ...) __attribute__ ((format (printf, 1, 2)));
+
+bool
+log_async_start(bool log_stdout);
+
+void
+log_async_stop();
+
 #endif
\ No newline at end of file
@@ -0,0 +1,654 @@
+/*
+ * Asynchronous Logging
+ *
+ * Each thread logs into its own lock-free single producer single
+ * consumer ring. Records are stored in binary format with a pointer
+ * to the format string (which is always a string literal), the
+ * arguments and a raw timestamp. A background thread formats and
+ * writes those records ordered by timestamp.
+ *
+ * agent, October 2026
+ *
+ * Copyright (C) 2020-2025, RtBrick, Inc.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include "logging.h"
+#include <pthread.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define LOG_ASYNC_RING_SIZE     (1024*1024) /* Must be a power of two. */
+#define LOG_ASYNC_ARGS_MAX      1024
+#define LOG_ASYNC_STR_MAX       256
+#define LOG_ASYNC_LINE_MAX      2048
+#define LOG_ASYNC_SPEC_MAX      32
+#define LOG_ASYNC_INTERVAL_NS   1000000 /* 1ms */
+
+typedef enum {
+    LOG_ASYNC_PAD = 0,
+    LOG_ASYNC_BINARY,
+    LOG_ASYNC_TEXT
+} log_async_record_type_t;
+
+typedef enum {
+    LOG_ARG_NONE = 0,
+    LOG_ARG_INT,
+    LOG_ARG_DOUBLE,
+    LOG_ARG_LDOUBLE,
+    LOG_ARG_STRING,
+    LOG_ARG_POINTER,
+    LOG_ARG_UNSUPPORTED
+} log_arg_t;
+
+typedef struct log_async_spec_ {
+    log_arg_t arg;
+    char length; /* 0, 'H' (hh), 'h', 'l', 'q' (ll), 'L', 'j', 'z', 't' */
+    bool width_star;
+    bool precision_star;
+    int precision; /* -1 if not set */
+    const char *start; /* Pointer to % */
+    size_t len; /* Length of conversion specification */
+} log_async_spec_s;
+
+typedef struct log_async_record_ {
+    uint32_t len; /* Record length including header */
+    uint32_t type;
+    uint64_t ticks;
+    const char *fmt;
+    uint8_t data[];
+} log_async_record_s;
+
+typedef struct log_async_ring_ {
+    volatile uint64_t head; /* Written by producer */
+    char _pad0 __attribute__((__aligned__(CACHE_LINE_SIZE)));
+    volatile uint64_t tail; /* Written by consumer */
+    char _pad1 __attribute__((__aligned__(CACHE_LINE_SIZE)));
+    volatile uint64_t drops; /* Written by producer */
+    uint64_t drops_reported;
+    struct log_async_ring_ *next;
+    uint8_t buf[LOG_ASYNC_RING_SIZE] __attribute__((__aligned__(CACHE_LINE_SIZE)));
+} log_async_ring_s;
+
+/* Globals */
+
+volatile bool g_log_async = false;
+
+static __thread log_async_ring_s *t_ring = NULL;
+static log_async_ring_s *g_ring_head = NULL;
+static pthread_t g_log_thread;
+static volatile bool g_log_thread_stop = false;
+static bool g_log_stdout = false;
+
+/* Reference points to convert ticks into realtime. */
+static uint64_t g_ticks_start;
+static struct timespec g_time_start;
+
+static inline uint64_t
+log_async_ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+#endif
+}
+
+/*
+ * Parse printf conversion specification
+ * starting at p which points to '%'.
+ */
+static bool
+log_async_spec_parse(const char *p, log_async_spec_s *spec)
+{
+    const char *start = p++;
+
+    memset(spec, 0x0, sizeof(log_async_spec_s));
+    spec->precision = -1;
+    spec->start = start;
+
+    /* Flags */
+    while(*p && strchr("-+ #0'I", *p)) p++;
+    /* Width */
+    if(*p == '*') {
+        spec->width_star = true;
+        p++;
+    } else {
+        while(*p >= '0' && *p <= '9') p++;
+    }
+    /* Precision */
+    if(*p == '.') {
+        p++;
+        if(*p == '*') {
+            spec->precision_star = true;
+            p++;
+        } else {
+            spec->precision = 0;
+            while(*p >= '0' && *p <= '9') {
+                spec->precision = spec->precision * 10 + (*p - '0');
+                p++;
+            }
+        }
+    }
+    /* Length modifier */
+    switch(*p) {
+        case 'h':
+            p++;
+            if(*p == 'h') {
+                spec->length = 'H';
+                p++;
+            } else {
+                spec->length = 'h';
+            }
+            break;
+        case 'l':
+            p++;
+            if(*p == 'l') {
+                spec->length = 'q';
+                p++;
+            } else {
+                spec->length = 'l';
+            }
+            break;
+        case 'q':
+            spec->length = 'q';
+            p++;
+            break;
+        case 'L':
+        case 'j':
+        case 'z':
+        case 't':
+            spec->length = *p++;
+            break;
+        case 'Z':
+            spec->length = 'z';
+            p++;
+            break;
+        default:
+            break;
+    }
+    /* Conversion */
+    switch(*p) {
+        case 'd': case 'i': case 'u': case 'o':
+        case 'x': case 'X': case 'c':
+            spec->arg = LOG_ARG_INT;
+            break;
+        case 'f': case 'F': case 'e': case 'E':
+        case 'g': case 'G': case 'a': case 'A':
+            spec->arg = spec->length == 'L' ? LOG_ARG_LDOUBLE : LOG_ARG_DOUBLE;
+            break;
+        case 's':
+            spec->arg = LOG_ARG_STRING;
+            break;
+        case 'p':
+            spec->arg = LOG_ARG_POINTER;
+            break;
+        case '%':
+            spec->arg = LOG_ARG_NONE;
+            break;
+        default:
+            /* %n, %m, wide characters, ... */
+            spec->arg = LOG_ARG_UNSUPPORTED;
+            return false;
+    }
+    p++;
+    spec->len = p - start;
+    return true;
+}
+
+/*
+ * Copy all arguments into binary buffer.
+ *
+ * Returns the number of bytes used or
+ * zero if arguments can't be encoded.
+ */
+static size_t
+log_async_encode(uint8_t *buf, size_t size, const char *fmt, va_list ap)
+{
+    log_async_spec_s spec;
+    size_t len = 0;
+    size_t str_len;
+    int64_t i64;
+    double d;
+    long double ld;
+    const char *s;
+    void *ptr;
+    int star;
+
+    while((fmt = strchr(fmt, '%'))) {
+        if(!log_async_spec_parse(fmt, &spec)) {
+            return 0;
+        }
+        fmt += spec.len;
+        if(spec.arg == LOG_ARG_NONE) continue;
+
+        if(spec.width_star) {
+            if(len + sizeof(int) > size) return 0;
+            star = va_arg(ap, int);
+            memcpy(buf+len, &star, sizeof(int));
+            len += sizeof(int);
+        }
+        if(spec.precision_star) {
+            if(len + sizeof(int) > size) return 0;
+            star = va_arg(ap, int);
+            memcpy(buf+len, &star, sizeof(int));
+            len += sizeof(int);
+            spec.precision = star;
+        }
+        switch(spec.arg) {
+            case LOG_ARG_INT:
+                switch(spec.length) {
+                    case 'l': i64 = va_arg(ap, long); break;
+                    case 'q': i64 = va_arg(ap, long long); break;
+                    case 'j': i64 = va_arg(ap, intmax_t); break;
+                    case 'z': i64 = va_arg(ap, size_t); break;
+                    case 't': i64 = va_arg(ap, ptrdiff_t); break;
+                    default: i64 = va_arg(ap, int); break;
+                }
+                if(len + sizeof(i64) > size) return 0;
+                memcpy(buf+len, &i64, sizeof(i64));
+                len += sizeof(i64);
+                break;
+            case LOG_ARG_DOUBLE:
+                d = va_arg(ap, double);
+                if(len + sizeof(d) > size) return 0;
+                memcpy(buf+len, &d, sizeof(d));
+                len += sizeof(d);
+                break;
+            case LOG_ARG_LDOUBLE:
+                ld = va_arg(ap, long double);
+                if(len + sizeof(ld) > size) return 0;
+                memcpy(buf+len, &ld, sizeof(ld));
+                len += sizeof(ld);
+                break;
+            case LOG_ARG_POINTER:
+                ptr = va_arg(ap, void*);
+                if(len + sizeof(ptr) > size) return 0;
+                memcpy(buf+len, &ptr, sizeof(ptr));
+                len += sizeof(ptr);
+                break;
+            case LOG_ARG_STRING:
+                /* Strings are copied as those are often
+                 * formatted into static buffers. */
+                s = va_arg(ap, const char*);
+                if(!s) s = "(null)";
+                if(spec.precision >= 0) {
+                    str_len = strnlen(s, spec.precision);
+                } else {
+                    str_len = strnlen(s, LOG_ASYNC_STR_MAX);
+                }
+                if(str_len >= LOG_ASYNC_STR_MAX) return 0;
+                if(len + str_len + 1 > size) return 0;
+                memcpy(buf+len, s, str_len);
+                buf[len+str_len] = 0;
+                len += str_len + 1;
+                break;
+            default:
+                return 0;
+        }
+    }
+    return len;
+}
+
+/*
+ * Format binary record into line.
+ */
+static size_t
+log_async_decode(char *line, size_t size, const char *fmt, const uint8_t *buf, size_t buf_len)
+{
+    log_async_spec_s spec;
+    char spec_str[LOG_ASYNC_SPEC_MAX];
+    size_t len = 0;
+    size_t pos = 0;
+    int64_t i64;
+    double d;
+    long double ld;
+    const char *s;
+    void *ptr;
+    int star[2];
+    int stars;
+    int n;
+
+    while(*fmt && len < size-1) {
+        if(*fmt != '%') {
+            line[len++] = *fmt++;
+            continue;
+        }
+        if(!log_async_spec_parse(fmt, &spec) || spec.len >= LOG_ASYNC_SPEC_MAX) {
+            break;
+        }
+        fmt += spec.len;
+        if(spec.arg == LOG_ARG_NONE) {
+            line[len++] = '%';
+            continue;
+        }
+        memcpy(spec_str, spec.start, spec.len);
+        spec_str[spec.len] = 0;
+
+        stars = 0;
+        if(spec.width_star) {
+            if(pos + sizeof(int) > buf_len) break;
+            memcpy(&star[stars++], buf+pos, sizeof(int));
+            pos += sizeof(int);
+        }
+        if(spec.precision_star) {
+            if(pos + sizeof(int) > buf_len) break;
+            memcpy(&star[stars++], buf+pos, sizeof(int));
+            pos += sizeof(int);
+        }
+
+#define LOG_ASYNC_SNPRINTF(_arg) \
+        switch(stars) { \
+            case 0: n = snprintf(line+len, size-len, spec_str, _arg); break; \
+            case 1: n = snprintf(line+len, size-len, spec_str, star[0], _arg); break; \
+            default: n = snprintf(line+len, size-len, spec_str, star[0], star[1], _arg); break; \
+        }
+
+        switch(spec.arg) {
+            case LOG_ARG_INT:
+                if(pos + sizeof(i64) > buf_len) return len;
+                memcpy(&i64, buf+pos, sizeof(i64));
+                pos += sizeof(i64);
+                switch(spec.length) {
+                    case 'l': LOG_ASYNC_SNPRINTF((long)i64); break;
+                    case 'q': LOG_ASYNC_SNPRINTF((long long)i64); break;
+                    case 'j': LOG_ASYNC_SNPRINTF((intmax_t)i64); break;
+                    case 'z': LOG_ASYNC_SNPRINTF((size_t)i64); break;
+                    case 't': LOG_ASYNC_SNPRINTF((ptrdiff_t)i64); break;
+                    default: LOG_ASYNC_SNPRINTF((int)i64); break;
+                }
+                break;
+            case LOG_ARG_DOUBLE:
+                if(pos + sizeof(d) > buf_len) return len;
+                memcpy(&d, buf+pos, sizeof(d));
+                pos += sizeof(d);
+                LOG_ASYNC_SNPRINTF(d);
+                break;
+            case LOG_ARG_LDOUBLE:
+                if(pos + sizeof(ld) > buf_len) return len;
+                memcpy(&ld, buf+pos, sizeof(ld));
+                pos += sizeof(ld);
+                LOG_ASYNC_SNPRINTF(ld);
+                break;
+            case LOG_ARG_POINTER:
+                if(pos + sizeof(ptr) > buf_len) return len;
+                memcpy(&ptr, buf+pos, sizeof(ptr));
+                pos += sizeof(ptr);
+                LOG_ASYNC_SNPRINTF(ptr);
+                break;
+            case LOG_ARG_STRING:
+                s = (const char*)buf+pos;
+                pos += strnlen(s, buf_len-pos) + 1;
+                if(pos > buf_len) return len;
+                LOG_ASYNC_SNPRINTF(s);
+                break;
+            default:
+                return len;
+        }
+#undef LOG_ASYNC_SNPRINTF
+        if(n < 0) break;
+        len += n;
+        if(len >= size) {
+            len = size-1;
+            break;
+        }
+    }
+    line[len] = 0;
+    return len;
+}
+
+/*
+ * Allocate ring for the calling thread and add
+ * to the global lock-free list of rings.
+ */
+static log_async_ring_s *
+log_async_ring_add()
+{
+    log_async_ring_s *ring = NULL;
+
+    if(posix_memalign((void**)&ring, CACHE_LINE_SIZE, sizeof(log_async_ring_s)) != 0) {
+        return NULL;
+    }
+    memset(ring, 0x0, offsetof(log_async_ring_s, buf));
+    ring->next = __atomic_load_n(&g_ring_head, __ATOMIC_ACQUIRE);
+    while(!__atomic_compare_exchange_n(&g_ring_head, &ring->next, ring, false,
+                                       __ATOMIC_RELEASE, __ATOMIC_ACQUIRE));
+    t_ring = ring;
+    return ring;
+}
+
+/**
+ * log_async
+ *
+ * Add log record to the ring of the calling thread,
+ * which never blocks but drops the record if the
+ * ring is full.
+ *
+ * @param fmt format string literal
+ */
+void
+log_async(const char *fmt, ...)
+{
+    log_async_ring_s *ring = t_ring;
+    log_async_record_s *record;
+    uint8_t args[LOG_ASYNC_ARGS_MAX];
+    uint64_t ticks = log_async_ticks();
+    uint64_t head, tail, offset;
+    uint32_t type = LOG_ASYNC_BINARY;
+    size_t args_len;
+    size_t len, pad;
+    va_list ap;
+
+    if(!ring) {
+        ring = log_async_ring_add();
+        if(!ring) return;
+    }
+
+    va_start(ap, fmt);
+    args_len = log_async_encode(args, sizeof(args), fmt, ap);
+    va_end(ap);
+    if(!args_len && strchr(fmt, '%')) {
+        /* Fallback to text for unsupported formats. */
+        va_start(ap, fmt);
+        vsnprintf((char*)args, sizeof(args), fmt, ap);
+        va_end(ap);
+        args_len = strlen((char*)args) + 1;
+        type = LOG_ASYNC_TEXT;
+    }
+
+    len = (sizeof(log_async_record_s) + args_len + 7) & ~7UL;
+    head = ring->head;
+    tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    offset = head & (LOG_ASYNC_RING_SIZE-1);
+    pad = 0;
+    if(offset + len > LOG_ASYNC_RING_SIZE) {
+        pad = LOG_ASYNC_RING_SIZE - offset;
+    }
+    if(LOG_ASYNC_RING_SIZE - (head - tail) < pad + len) {
+        ring->drops++;
+        return;
+    }
+    if(pad) {
+        record = (log_async_record_s*)(ring->buf+offset);
+        record->len = pad;
+        record->type = LOG_ASYNC_PAD;
+        head += pad;
+        offset = 0;
+    }
+    record = (log_async_record_s*)(ring->buf+offset);
+    record->len = len;
+    record->type = type;
+    record->ticks = ticks;
+    record->fmt = fmt;
+    memcpy(record->data, args, args_len);
+    __atomic_store_n(&ring->head, head + len, __ATOMIC_RELEASE);
+}
+
+/*
+ * Return next record of ring or NULL if empty,
+ * skipping padding at the end of the ring.
+ */
+static log_async_record_s *
+log_async_ring_peek(log_async_ring_s *ring)
+{
+    log_async_record_s *record;
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint64_t tail = ring->tail;
+
+    while(tail != head) {
+        record = (log_async_record_s*)(ring->buf + (tail & (LOG_ASYNC_RING_SIZE-1)));
+        if(record->type != LOG_ASYNC_PAD) {
+            return record;
+        }
+        tail += record->len;
+        __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+static void
+log_async_write(const char *line)
+{
+    if(g_log_fp) {
+        fputs(line, g_log_fp);
+    }
+    if(g_log_stdout || !g_log_fp) {
+        fputs(line, stdout);
+    }
+}
+
+/*
+ * Format and write all records of all rings,
+ * ordered by timestamp.
+ */
+static void
+log_async_drain()
+{
+    log_async_ring_s *ring, *min_ring;
+    log_async_record_s *record, *min_record;
+    char line[LOG_ASYNC_LINE_MAX];
+    struct timespec now, ts;
+    struct tm tm;
+    uint64_t ticks, elapsed_ns, ns;
+    double ns_per_tick = 1.0;
+    size_t len;
+    bool written = false;
+
+    /* Calibrate ticks against realtime clock. */
+    ticks = log_async_ticks();
+    clock_gettime(CLOCK_REALTIME, &now);
+    elapsed_ns = (now.tv_sec - g_time_start.tv_sec) * 1000000000ULL + now.tv_nsec - g_time_start.tv_nsec;
+    if(ticks > g_ticks_start && elapsed_ns) {
+        ns_per_tick = (double)elapsed_ns / (double)(ticks - g_ticks_start);
+    }
+
+    while(true) {
+        min_ring = NULL;
+        min_record = NULL;
+        ring = __atomic_load_n(&g_ring_head, __ATOMIC_ACQUIRE);
+        while(ring) {
+            if(ring->drops != ring->drops_reported) {
+                ns = ring->drops;
+                snprintf(line, sizeof(line), "%s Asynchronous logging dropped %lu records\n",
+                         log_format_timestamp(), ns - ring->drops_reported);
+                ring->drops_reported = ns;
+                log_async_write(line);
+            }
+            record = log_async_ring_peek(ring);
+            if(record && (!min_record || record->ticks < min_record->ticks)) {
+                min_ring = ring;
+                min_record = record;
+            }
+            ring = ring->next;
+        }
+        if(!min_record) break;
+
+        if(min_record->ticks > g_ticks_start) {
+            ns = (min_record->ticks - g_ticks_start) * ns_per_tick;
+        } else {
+            ns = 0;
+        }
+        ts.tv_sec = g_time_start.tv_sec + (g_time_start.tv_nsec + ns) / 1000000000ULL;
+        ts.tv_nsec = (g_time_start.tv_nsec + ns) % 1000000000ULL;
+        localtime_r(&ts.tv_sec, &tm);
+        len = strftime(line, sizeof(line), "%b %d %H:%M:%S", &tm);
+        len += snprintf(line+len, sizeof(line)-len, ".%06lu ", ts.tv_nsec / 1000);
+
+        if(min_record->type == LOG_ASYNC_TEXT) {
+            snprintf(line+len, sizeof(line)-len, "%s", (char*)min_record->data);
+        } else {
+            log_async_decode(line+len, sizeof(line)-len, min_record->fmt, min_record->data,
+                             min_record->len - sizeof(log_async_record_s));
+        }
+        log_async_write(line);
+        written = true;
+
+        __atomic_store_n(&min_ring->tail, min_ring->tail + min_record->len, __ATOMIC_RELEASE);
+    }
+    if(written) {
+        if(g_log_fp) fflush(g_log_fp);
+        fflush(stdout);
+    }
+}
+
+static void *
+log_async_thread(void *arg)
+{
+    struct timespec sleep = {0, LOG_ASYNC_INTERVAL_NS};
+    (void)arg;
+
+    while(!__atomic_load_n(&g_log_thread_stop, __ATOMIC_ACQUIRE)) {
+        log_async_drain();
+        nanosleep(&sleep, NULL);
+    }
+    log_async_drain();
+    return NULL;
+}
+
+/**
+ * log_async_start
+ *
+ * Start background thread for asynchronous logging.
+ *
+ * @param log_stdout log to standard output even if log file is open
+ * @return true if started
+ */
+bool
+log_async_start(bool log_stdout)
+{
+    if(g_log_async) {
+        return true;
+    }
+    g_log_stdout = log_stdout;
+    g_ticks_start = log_async_ticks();
+    clock_gettime(CLOCK_REALTIME, &g_time_start);
+    g_log_thread_stop = false;
+    if(pthread_create(&g_log_thread, NULL, log_async_thread, NULL) != 0) {
+        return false;
+    }
+    g_log_async = true;
+    return true;
+}
+
+/**
+ * log_async_stop
+ *
+ * Stop background thread after all pending
+ * records are written. Rings are kept as
+ * other threads might still hold a reference.
+ */
+void
+log_async_stop()
+{
+    if(!g_log_async) {
+        return;
+    }
+    g_log_async = false;
+    __atomic_store_n(&g_log_thread_stop, true, __ATOMIC_RELEASE);
+    pthread_join(g_log_thread, NULL);
+}
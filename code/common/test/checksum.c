@@ -30,13 +30,143 @@ test_calculate_fletcher_checksum(void **unused) {
     };
     uint16_t pdu1_checksum = 0x3bd4;
 
-    uint16_t checksum = calculate_fletcher_checksum((void*)pdu1, 12, sizeof(pdu1));
-    assert_int_equal(checksum, pdu1_checksum);
+    uint16_t checksum;
+    int impl;
+
+    for(impl = CHECKSUM_IMPL_SCALAR; impl < CHECKSUM_IMPL_MAX; impl++) {
+        if(!checksum_set_impl(impl)) continue;
+        checksum = calculate_fletcher_checksum((void*)pdu1, 12, sizeof(pdu1));
+        assert_int_equal(checksum, pdu1_checksum);
+    }
+    checksum_set_impl(CHECKSUM_IMPL_AUTO);
+}
+
+/* Reference implementations (byte loops) */
+
+static uint32_t
+reference_checksum_partial(const uint8_t *buf, size_t len)
+{
+    uint64_t sum = 0;
+    uint16_t word;
+    size_t i;
+
+    for(i = 0; i + 1 < len; i += 2) {
+        memcpy(&word, buf + i, sizeof(word));
+        sum += word;
+    }
+    if(len & 1) {
+        sum += buf[len-1];
+    }
+    while(sum >> 16) {
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+    return sum;
+}
+
+static uint16_t
+reference_fletcher_checksum(uint8_t *pptr, uint checksum_offset, uint length)
+{
+    int64_t c0 = 0, c1 = 0;
+    uint i;
+
+    pptr[checksum_offset] = 0;
+    pptr[checksum_offset+1] = 0;
+    for(i = 0; i < length; i++) {
+        c0 += pptr[i];
+        c1 += c0;
+    }
+    c0 = c0 % 255;
+    c1 = (c1 - (length - checksum_offset) * c0) % 255;
+    if(c1 <= 0) c1 += 255;
+    c0 = 255 - c1 - c0;
+    if(c0 <= 0) c0 += 255;
+    return (c0 << 8 | c1);
+}
+
+#define TEST_BUF_LEN 9216
+
+static void
+test_checksum_partial(void **unused) {
+    (void) unused;
+
+    static uint8_t buf[TEST_BUF_LEN+64];
+    size_t len, offset, i;
+    int impl;
+
+    srand(1);
+    for(i = 0; i < sizeof(buf); i++) {
+        buf[i] = rand();
+    }
+
+    for(impl = CHECKSUM_IMPL_SCALAR; impl < CHECKSUM_IMPL_MAX; impl++) {
+        if(!checksum_set_impl(impl)) continue;
+        /* All lengths up to jumbo frames and unaligned buffers. */
+        for(offset = 0; offset < 4; offset++) {
+            for(len = 0; len <= 1600; len++) {
+                assert_int_equal(checksum_partial(buf+offset, len),
+                                 reference_checksum_partial(buf+offset, len));
+            }
+        }
+        assert_int_equal(checksum_partial(buf+1, TEST_BUF_LEN),
+                         reference_checksum_partial(buf+1, TEST_BUF_LEN));
+    }
+
+    /* Worst case for lane overflow. */
+    memset(buf, 0xff, sizeof(buf));
+    for(impl = CHECKSUM_IMPL_SCALAR; impl < CHECKSUM_IMPL_MAX; impl++) {
+        if(!checksum_set_impl(impl)) continue;
+        assert_int_equal(checksum_partial(buf, TEST_BUF_LEN), 0xffff);
+        assert_int_equal(checksum_partial(buf, TEST_BUF_LEN+1),
+                         reference_checksum_partial(buf, TEST_BUF_LEN+1));
+    }
+    checksum_set_impl(CHECKSUM_IMPL_AUTO);
+}
+
+static void
+test_fletcher_checksum_impl(void **unused) {
+    (void) unused;
+
+    static uint8_t buf[TEST_BUF_LEN];
+    static uint8_t ref[TEST_BUF_LEN];
+    size_t i;
+    uint len;
+    int impl;
+
+    srand(2);
+    for(i = 0; i < sizeof(buf); i++) {
+        buf[i] = rand();
+    }
+    memcpy(ref, buf, sizeof(buf));
+
+    for(impl = CHECKSUM_IMPL_SCALAR; impl < CHECKSUM_IMPL_MAX; impl++) {
+        if(!checksum_set_impl(impl)) continue;
+        for(len = 14; len <= 1600; len++) {
+            assert_int_equal(calculate_fletcher_checksum(buf+1, 12, len),
+                             reference_fletcher_checksum(ref+1, 12, len));
+        }
+        assert_int_equal(calculate_fletcher_checksum(buf, 14, TEST_BUF_LEN),
+                         reference_fletcher_checksum(ref, 14, TEST_BUF_LEN));
+    }
+
+    memset(buf, 0xff, sizeof(buf));
+    memset(ref, 0xff, sizeof(ref));
+    for(impl = CHECKSUM_IMPL_SCALAR; impl < CHECKSUM_IMPL_MAX; impl++) {
+        if(!checksum_set_impl(impl)) continue;
+        assert_int_equal(calculate_fletcher_checksum(buf, 12, TEST_BUF_LEN),
+                         reference_fletcher_checksum(ref, 12, TEST_BUF_LEN));
+        /* Validation of the inserted checksum. */
+        len = 1492;
+        *(uint16_t*)(buf+12) = htobe16(calculate_fletcher_checksum(buf, 12, len));
+        assert_int_equal(validate_fletcher_checksum(buf, len), 0);
+    }
+    checksum_set_impl(CHECKSUM_IMPL_AUTO);
 }
 
 int main() {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_calculate_fletcher_checksum),
+        cmocka_unit_test(test_checksum_partial),
+        cmocka_unit_test(test_fletcher_checksum_impl),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
\ No newline at end of file
@@ -48,6 +48,7 @@ static struct option long_options[] = {
     {"connector", required_argument, NULL, 'C'},
     {"control-socket", required_argument, NULL, 'S'},
     {"control-instance", required_argument, NULL, 'I'},
+    {"control-json", no_argument, NULL, 'J'},
     {"ipv4-link-prefix", required_argument, NULL, 'l'},
     {"ipv6-link-prefix", required_argument, NULL, 'L'},
     {"ipv4-node-prefix", required_argument, NULL, 'n'},
@@ -72,6 +73,8 @@ static struct option long_options[] = {
     {"quit-loop", no_argument, NULL, 'Q'},
     {"level", required_argument, NULL, 'V'},
     {"log", required_argument,  NULL, 't' },
+    {"threads", required_argument, NULL, 'j'},
+    {"cache-file", required_argument, NULL, 'k'},
     {NULL, 0, NULL, 0}
 };
 
@@ -360,592 +363,581 @@ lspgen_get_prefix_inc(uint32_t afi, uint32_t prefix_len)
 }
 
 /*
- * Walk the graph of the LSDB and add the required node/link attributes for IS-IS LSP generation.
+ * Distribution of the external prefixes to a node.
  */
-void
-lspgen_gen_isis_attr(struct lsdb_ctx_ *ctx)
+typedef struct lspgen_attr_ext_ {
+    uint32_t start; /* index of the first external prefix of this node */
+    uint32_t count; /* number of external prefixes of this node */
+} lspgen_attr_ext_t;
+
+/*
+ * Walk the graph of the LSDB and call the protocol specific
+ * attribute generation for each node.
+ *
+ * The external prefixes are distributed upfront in node DB order,
+ * such that all nodes can be processed in parallel.
+ */
+static void
+lspgen_gen_attr(struct lsdb_ctx_ *ctx, lspgen_thread_job_cb job)
 {
-    struct lsdb_node_ *node;
-    struct lsdb_link_ *link;
-    struct lsdb_attr_ attr_template;
-    dict_itor *itor;
-    __uint128_t addr, inc, ext_addr4, ext_incr4, ext_addr6, ext_incr6;
-    uint32_t ext_per_node, idx, nodes_left, ext_left;
+    struct lsdb_node_ **nodes;
+    lspgen_attr_ext_t *ext;
+    uint32_t count, idx, nodes_left, ext_left, ext_start;
 
     /*
      * Walk the node DB.
      */
-    itor = dict_itor_new(ctx->node_dict);
-    if (!itor) {
+    nodes = lspgen_thread_get_nodes(ctx, &count);
+    if (!nodes) {
+        LOG_NOARG(ERROR, "Empty LSDB.\n");
         return;
     }
 
-    /*
-     * Node DB empty ?
-     */
-    if (!dict_itor_first(itor)) {
-        dict_itor_free(itor);
-        LOG_NOARG(ERROR, "Empty LSDB.\n");
+    ext = calloc(count, sizeof(lspgen_attr_ext_t));
+    if (!ext) {
+        free(nodes);
         return;
     }
 
-    /*
-     * For external routes load the first address of the pool.
-     */
-    ext_addr4 = lspgen_load_addr((uint8_t*)&ctx->ipv4_ext_prefix.address, sizeof(ipv4addr_t));
-    ext_incr4 = lspgen_get_prefix_inc(AF_INET, ctx->ipv4_ext_prefix.len);
-    ext_addr6 = lspgen_load_addr((uint8_t*)&ctx->ipv6_ext_prefix.address, IPV6_ADDR_LEN);
-    ext_incr6 = lspgen_get_prefix_inc(AF_INET6, ctx->ipv6_ext_prefix.len);
-
     nodes_left = ctx->num_nodes;
     ext_left = ctx->num_ext;
+    ext_start = 0;
+    for (idx = 0; idx < count && nodes_left; idx++) {
+        ext[idx].start = ext_start;
+        ext[idx].count = ext_left / nodes_left;
+        ext_left -= ext[idx].count;
+        ext_start += ext[idx].count;
+        nodes_left--;
+    }
 
-    do {
-        node = *dict_itor_datum(itor);
+    lspgen_thread_run(ctx, nodes, count, job, ext);
 
-	LOG(LSDB, "Generating node %s (%s) attributes\n",
-            lsdb_format_node(node),
-            lsdb_format_node_id(node->key.node_id));
+    free(ext);
+    free(nodes);
+}
 
-        /* Area */
-        for (idx = 0; idx < ctx->num_area; idx++) {
-            lsdb_reset_attr_template(&attr_template);
-            memcpy(&attr_template.key.area, &ctx->area[idx], sizeof(attr_template.key.area));
-            attr_template.key.ordinal = 1;
-            attr_template.key.attr_type = ISIS_TLV_AREA;
-            lsdb_add_node_attr(node, &attr_template);
-        }
+/*
+ * Add the required node/link attributes for IS-IS LSP generation to a node.
+ */
+static void
+lspgen_gen_isis_attr_node(struct lsdb_ctx_ *ctx, struct lsdb_node_ *node, uint32_t idx, void *arg)
+{
+    struct lsdb_link_ *link;
+    struct lsdb_attr_ attr_template;
+    lspgen_attr_ext_t *ext;
+    __uint128_t addr, inc, ext_addr4, ext_incr4, ext_addr6, ext_incr6;
+    uint32_t ext_per_node, area_idx;
+
+    ext = (lspgen_attr_ext_t *)arg + idx;
 
-        /* Protocols */
+    LOG(LSDB, "Generating node %s (%s) attributes\n",
+        lsdb_format_node(node),
+        lsdb_format_node_id(node->key.node_id));
+
+    /* Area */
+    for (area_idx = 0; area_idx < ctx->num_area; area_idx++) {
         lsdb_reset_attr_template(&attr_template);
+        memcpy(&attr_template.key.area, &ctx->area[area_idx], sizeof(attr_template.key.area));
         attr_template.key.ordinal = 1;
-        attr_template.key.protocol = NLPID_IPV4; /* ipv4 */
-        attr_template.key.attr_type = ISIS_TLV_PROTOCOLS;
+        attr_template.key.attr_type = ISIS_TLV_AREA;
         lsdb_add_node_attr(node, &attr_template);
-        attr_template.key.protocol = NLPID_IPV6; /* ipv6 */
+    }
+
+    /* Protocols */
+    lsdb_reset_attr_template(&attr_template);
+    attr_template.key.ordinal = 1;
+    attr_template.key.protocol = NLPID_IPV4; /* ipv4 */
+    attr_template.key.attr_type = ISIS_TLV_PROTOCOLS;
+    lsdb_add_node_attr(node, &attr_template);
+    attr_template.key.protocol = NLPID_IPV6; /* ipv6 */
+    lsdb_add_node_attr(node, &attr_template);
+
+    /* Host name */
+    if (node->node_name) {
+        lsdb_reset_attr_template(&attr_template);
+        attr_template.key.ordinal = 1;
+        attr_template.key.attr_type = ISIS_TLV_HOSTNAME;
+        strncpy(attr_template.key.hostname, node->node_name, sizeof(attr_template.key.hostname)-1);
         lsdb_add_node_attr(node, &attr_template);
+    }
 
-        /* Host name */
-        if (node->node_name) {
-            lsdb_reset_attr_template(&attr_template);
-            attr_template.key.ordinal = 1;
-            attr_template.key.attr_type = ISIS_TLV_HOSTNAME;
-            strncpy(attr_template.key.hostname, node->node_name, sizeof(attr_template.key.hostname)-1);
-            lsdb_add_node_attr(node, &attr_template);
-        }
+    /* LSP Buffer size */
+    lsdb_reset_attr_template(&attr_template);
+    attr_template.key.ordinal = 1;
+    attr_template.key.attr_type = ISIS_TLV_LSP_BUFFER_SIZE;
+    attr_template.key.lsp_buffer_size = ISIS_DEFAULT_LSP_BUFFER_SIZE;
+    lsdb_add_node_attr(node, &attr_template);
+
+    /* IPv4 loopback address */
+    lsdb_reset_attr_template(&attr_template);
+    addr = lspgen_load_addr((uint8_t*)&ctx->ipv4_node_prefix.address, sizeof(ipv4addr_t));
+    addr += node->node_index;
+    lspgen_store_addr(addr, attr_template.key.ipv4_addr, sizeof(ipv4addr_t));
+    attr_template.key.ordinal = 1;
+    attr_template.key.attr_type = ISIS_TLV_IPV4_ADDR;
+    lsdb_add_node_attr(node, &attr_template);
+
+    /* IPv4 loopback prefix */
+    lsdb_reset_attr_template(&attr_template);
+    lspgen_store_addr(addr, (uint8_t*)&attr_template.key.prefix.ipv4_prefix.address, sizeof(ipv4addr_t));
+    attr_template.key.prefix.ipv4_prefix.len = ctx->ipv4_node_prefix.len;
+    if (!ctx->no_sr) {
+        attr_template.key.prefix.sid = node->node_index;
+        attr_template.key.prefix.adv_sid = true;
+    }
+    attr_template.key.prefix.node_flag = true;
+    attr_template.key.ordinal = 1;
+    attr_template.key.attr_type = ISIS_TLV_EXTD_IPV4_REACH;
+    lsdb_add_node_attr(node, &attr_template);
+
+    /* IPv6 loopback address */
+    lsdb_reset_attr_template(&attr_template);
+    addr = lspgen_load_addr(ctx->ipv6_node_prefix.address, IPV6_ADDR_LEN);
+    addr += node->node_index;
+    lspgen_store_addr(addr, attr_template.key.ipv6_addr, IPV6_ADDR_LEN);
+    attr_template.key.ordinal = 1;
+    attr_template.key.attr_type = ISIS_TLV_IPV6_ADDR;
+    lsdb_add_node_attr(node, &attr_template);
+
+    /* IPv6 loopback prefix */
+    lsdb_reset_attr_template(&attr_template);
+    lspgen_store_addr(addr, attr_template.key.prefix.ipv6_prefix.address, IPV6_ADDR_LEN);
+    attr_template.key.prefix.ipv6_prefix.len = ctx->ipv6_node_prefix.len;
+    if (!ctx->no_sr) {
+        attr_template.key.prefix.sid = ctx->srgb_range/2 + node->node_index;
+        attr_template.key.prefix.adv_sid = true;
+    }
+    attr_template.key.prefix.node_flag = true;
+    attr_template.key.ordinal = 1;
+    attr_template.key.attr_type = ISIS_TLV_EXTD_IPV6_REACH;
+    lsdb_add_node_attr(node, &attr_template);
 
-	/* LSP Buffer size */
+    /* external prefixes */
+    ext_per_node = ext->count;
+    ext_addr4 = lspgen_load_addr((uint8_t*)&ctx->ipv4_ext_prefix.address, sizeof(ipv4addr_t));
+    ext_incr4 = lspgen_get_prefix_inc(AF_INET, ctx->ipv4_ext_prefix.len);
+    ext_addr4 += ext->start * ext_incr4;
+    ext_addr6 = lspgen_load_addr((uint8_t*)&ctx->ipv6_ext_prefix.address, IPV6_ADDR_LEN);
+    ext_incr6 = lspgen_get_prefix_inc(AF_INET6, ctx->ipv6_ext_prefix.len);
+    ext_addr6 += ext->start * ext_incr6;
+    while (ext_per_node--) {
+        /* ipv4 external prefix */
         lsdb_reset_attr_template(&attr_template);
-	attr_template.key.ordinal = 1;
-	attr_template.key.attr_type = ISIS_TLV_LSP_BUFFER_SIZE;
-        attr_template.key.lsp_buffer_size = ISIS_DEFAULT_LSP_BUFFER_SIZE;
-	lsdb_add_node_attr(node, &attr_template);
+        lspgen_store_addr(ext_addr4, (uint8_t*)&attr_template.key.prefix.ipv4_prefix.address, 4);
+        attr_template.key.prefix.ipv4_prefix.len = ctx->ipv4_ext_prefix.len;
+        attr_template.key.prefix.metric = 100;
+        attr_template.key.attr_type = ISIS_TLV_EXTD_IPV4_REACH;
+        lsdb_add_node_attr(node, &attr_template);
+        ext_addr4 += ext_incr4;
 
-        /* IPv4 loopback address */
+        /* ipv6 external prefix */
+        lsdb_reset_attr_template(&attr_template);
+        lspgen_store_addr(ext_addr6, attr_template.key.prefix.ipv6_prefix.address, IPV6_ADDR_LEN);
+        attr_template.key.prefix.ipv6_prefix.len = ctx->ipv6_ext_prefix.len;
+        attr_template.key.prefix.metric = 100;
+        attr_template.key.attr_type = ISIS_TLV_EXTD_IPV6_REACH;
+        lsdb_add_node_attr(node, &attr_template);
+        ext_addr6 += ext_incr6;
+    }
+
+    if (!ctx->no_sr) {
+        /* SR capability */
         lsdb_reset_attr_template(&attr_template);
         addr = lspgen_load_addr((uint8_t*)&ctx->ipv4_node_prefix.address, sizeof(ipv4addr_t));
         addr += node->node_index;
-        lspgen_store_addr(addr, attr_template.key.ipv4_addr, sizeof(ipv4addr_t));
+        lspgen_store_addr(addr, attr_template.key.cap.router_id, sizeof(ipv4addr_t));
+        attr_template.key.cap.srgb_base = ctx->srgb_base;
+        attr_template.key.cap.srgb_range = ctx->srgb_range;
+        if (!ctx->no_ipv4) {
+            attr_template.key.cap.mpls_ipv4_flag = true; /* mpls ipv4 */
+        }
+        if (!ctx->no_ipv6) {
+            attr_template.key.cap.mpls_ipv6_flag = true; /* mpls ipv6 */
+        }
+        attr_template.key.attr_type = ISIS_TLV_CAP;
         attr_template.key.ordinal = 1;
-        attr_template.key.attr_type = ISIS_TLV_IPV4_ADDR;
         lsdb_add_node_attr(node, &attr_template);
+    }
+
+    /*
+     * Walk all of our neighbors.
+     */
+    CIRCLEQ_FOREACH(link, &node->link_qhead, link_qnode) {
 
-        /* IPv4 loopback prefix */
+        /* Generate an IS reach for each link */
         lsdb_reset_attr_template(&attr_template);
-        lspgen_store_addr(addr, (uint8_t*)&attr_template.key.prefix.ipv4_prefix.address, sizeof(ipv4addr_t));
-        attr_template.key.prefix.ipv4_prefix.len = ctx->ipv4_node_prefix.len;
-        if (!ctx->no_sr) {
-            attr_template.key.prefix.sid = node->node_index;
-            attr_template.key.prefix.adv_sid = true;
-        }
-        attr_template.key.prefix.node_flag = true;
-        attr_template.key.ordinal = 1;
-        attr_template.key.attr_type = ISIS_TLV_EXTD_IPV4_REACH;
+        attr_template.key.attr_type = ISIS_TLV_EXTD_IS_REACH;
+        memcpy(attr_template.key.link.remote_node_id, link->key.remote_node_id, 7);
+        attr_template.key.link.metric = link->link_metric;
         lsdb_add_node_attr(node, &attr_template);
 
-        /* IPv6 loopback address */
+        /* Generate an IPv4 prefix for each link */
         lsdb_reset_attr_template(&attr_template);
-        addr = lspgen_load_addr(ctx->ipv6_node_prefix.address, IPV6_ADDR_LEN);
-        addr += node->node_index;
-        lspgen_store_addr(addr, attr_template.key.ipv6_addr, IPV6_ADDR_LEN);
-        attr_template.key.ordinal = 1;
-        attr_template.key.attr_type = ISIS_TLV_IPV6_ADDR;
+        addr = lspgen_load_addr((uint8_t*)&ctx->ipv4_link_prefix.address, sizeof(ipv4addr_t));
+        inc = lspgen_get_prefix_inc(AF_INET, ctx->ipv4_link_prefix.len);
+        addr += link->link_index * inc;
+        lspgen_store_addr(addr, (uint8_t*)&attr_template.key.prefix.ipv4_prefix.address, sizeof(ipv4addr_t));
+        attr_template.key.prefix.ipv4_prefix.len = ctx->ipv4_link_prefix.len;
+        attr_template.key.prefix.metric = link->link_metric;
+        attr_template.key.attr_type = ISIS_TLV_EXTD_IPV4_REACH;
         lsdb_add_node_attr(node, &attr_template);
 
-        /* IPv6 loopback prefix */
+        /* Generate an IPv6 prefix for each link */
         lsdb_reset_attr_template(&attr_template);
+        addr = lspgen_load_addr(ctx->ipv6_link_prefix.address, IPV6_ADDR_LEN);
+        inc = lspgen_get_prefix_inc(AF_INET6, ctx->ipv6_link_prefix.len);
+        addr += link->link_index * inc;
         lspgen_store_addr(addr, attr_template.key.prefix.ipv6_prefix.address, IPV6_ADDR_LEN);
-        attr_template.key.prefix.ipv6_prefix.len = ctx->ipv6_node_prefix.len;
-        if (!ctx->no_sr) {
-            attr_template.key.prefix.sid = ctx->srgb_range/2 + node->node_index;
-            attr_template.key.prefix.adv_sid = true;
-        }
-        attr_template.key.prefix.node_flag = true;
-        attr_template.key.ordinal = 1;
+        attr_template.key.prefix.ipv6_prefix.len = ctx->ipv6_link_prefix.len;
+        attr_template.key.prefix.metric = link->link_metric;
         attr_template.key.attr_type = ISIS_TLV_EXTD_IPV6_REACH;
         lsdb_add_node_attr(node, &attr_template);
-
-        /* external prefixes */
-	ext_per_node = ext_left / nodes_left;
-	ext_left -= ext_per_node;
-        while (ext_per_node--) {
-            /* ipv4 external prefix */
-            lsdb_reset_attr_template(&attr_template);
-            lspgen_store_addr(ext_addr4, (uint8_t*)&attr_template.key.prefix.ipv4_prefix.address, 4);
-            attr_template.key.prefix.ipv4_prefix.len = ctx->ipv4_ext_prefix.len;
-            attr_template.key.prefix.metric = 100;
-            attr_template.key.attr_type = ISIS_TLV_EXTD_IPV4_REACH;
-            lsdb_add_node_attr(node, &attr_template);
-            ext_addr4 += ext_incr4;
-
-            /* ipv6 external prefix */
-            lsdb_reset_attr_template(&attr_template);
-            lspgen_store_addr(ext_addr6, attr_template.key.prefix.ipv6_prefix.address, IPV6_ADDR_LEN);
-            attr_template.key.prefix.ipv6_prefix.len = ctx->ipv6_ext_prefix.len;
-            attr_template.key.prefix.metric = 100;
-            attr_template.key.attr_type = ISIS_TLV_EXTD_IPV6_REACH;
-            lsdb_add_node_attr(node, &attr_template);
-            ext_addr6 += ext_incr6;
-        }
-
-        if (!ctx->no_sr) {
-            /* SR capability */
-            lsdb_reset_attr_template(&attr_template);
-            addr = lspgen_load_addr((uint8_t*)&ctx->ipv4_node_prefix.address, sizeof(ipv4addr_t));
-            addr += node->node_index;
-            lspgen_store_addr(addr, attr_template.key.cap.router_id, sizeof(ipv4addr_t));
-            attr_template.key.cap.srgb_base = ctx->srgb_base;
-            attr_template.key.cap.srgb_range = ctx->srgb_range;
-            if (!ctx->no_ipv4) {
-                attr_template.key.cap.mpls_ipv4_flag = true; /* mpls ipv4 */
-            }
-            if (!ctx->no_ipv6) {
-                attr_template.key.cap.mpls_ipv6_flag = true; /* mpls ipv6 */
-            }
-            attr_template.key.attr_type = ISIS_TLV_CAP;
-            attr_template.key.ordinal = 1;
-            lsdb_add_node_attr(node, &attr_template);
-        }
-
-        /*
-         * Walk all of our neighbors.
-         */
-        CIRCLEQ_FOREACH(link, &node->link_qhead, link_qnode) {
-
-            /* Generate an IS reach for each link */
-            lsdb_reset_attr_template(&attr_template);
-            attr_template.key.attr_type = ISIS_TLV_EXTD_IS_REACH;
-            memcpy(attr_template.key.link.remote_node_id, link->key.remote_node_id, 7);
-            attr_template.key.link.metric = link->link_metric;
-            lsdb_add_node_attr(node, &attr_template);
-
-            /* Generate an IPv4 prefix for each link */
-            lsdb_reset_attr_template(&attr_template);
-            addr = lspgen_load_addr((uint8_t*)&ctx->ipv4_link_prefix.address, sizeof(ipv4addr_t));
-            inc = lspgen_get_prefix_inc(AF_INET, ctx->ipv4_link_prefix.len);
-            addr += link->link_index * inc;
-            lspgen_store_addr(addr, (uint8_t*)&attr_template.key.prefix.ipv4_prefix.address, sizeof(ipv4addr_t));
-            attr_template.key.prefix.ipv4_prefix.len = ctx->ipv4_link_prefix.len;
-            attr_template.key.prefix.metric = link->link_metric;
-            attr_template.key.attr_type = ISIS_TLV_EXTD_IPV4_REACH;
-            lsdb_add_node_attr(node, &attr_template);
-
-            /* Generate an IPv6 prefix for each link */
-            lsdb_reset_attr_template(&attr_template);
-            addr = lspgen_load_addr(ctx->ipv6_link_prefix.address, IPV6_ADDR_LEN);
-            inc = lspgen_get_prefix_inc(AF_INET6, ctx->ipv6_link_prefix.len);
-            addr += link->link_index * inc;
-            lspgen_store_addr(addr, attr_template.key.prefix.ipv6_prefix.address, IPV6_ADDR_LEN);
-            attr_template.key.prefix.ipv6_prefix.len = ctx->ipv6_link_prefix.len;
-            attr_template.key.prefix.metric = link->link_metric;
-            attr_template.key.attr_type = ISIS_TLV_EXTD_IPV6_REACH;
-            lsdb_add_node_attr(node, &attr_template);
-        }
-
-	nodes_left--;
-    } while (dict_itor_next(itor));
-
-    dict_itor_free(itor);
+    }
 }
 
 /*
- * Walk the graph of the LSDB and add the required node/link attributes for OSPFv2 LSP generation.
+ * Walk the graph of the LSDB and add the required node/link attributes for IS-IS LSP generation.
  */
 void
-lspgen_gen_ospf2_attr(struct lsdb_ctx_ *ctx)
+lspgen_gen_isis_attr(struct lsdb_ctx_ *ctx)
+{
+    lspgen_gen_attr(ctx, lspgen_gen_isis_attr_node);
+}
+
+/*
+ * Add the required node/link attributes for OSPFv2 LSP generation to a node.
+ */
+static void
+lspgen_gen_ospf2_attr_node(struct lsdb_ctx_ *ctx, struct lsdb_node_ *node, uint32_t idx, void *arg)
 {
-    struct lsdb_node_ *node;
     struct lsdb_link_ *link;
     struct lsdb_attr_ attr_template;
-    dict_itor *itor;
+    lspgen_attr_ext_t *ext;
     __uint128_t addr, inc, ext_addr4, ext_incr4, addr_offset;
-    uint32_t ext_per_node, metric, nodes_left, ext_left;
+    uint32_t ext_per_node, metric;
 
-    /*
-     * Walk the node DB.
-     */
-    itor = dict_itor_new(ctx->node_dict);
-    if (!itor) {
-        return;
+    ext = (lspgen_attr_ext_t *)arg + idx;
+
+    LOG(LSDB, "Generating node %s (%s) attributes\n",
+        lsdb_format_node(node),
+        lsdb_format_node_id(node->key.node_id));
+
+    /* Host name */
+    if (node->node_name) {
+        lsdb_reset_attr_template(&attr_template);
+        attr_template.key.ordinal = 1;
+        attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
+        attr_template.key.attr_cp[1] = OSPF_LSA_OPAQUE_AREA_RI;
+        attr_template.key.attr_cp[2] = OSPF_TLV_HOSTNAME;
+        strncpy(attr_template.key.hostname, node->node_name, sizeof(attr_template.key.hostname)-1);
+        lsdb_add_node_attr(node, &attr_template);
     }
 
-    /*
-     * Node DB empty ?
-     */
-    if (!dict_itor_first(itor)) {
-        dict_itor_free(itor);
-        LOG_NOARG(ERROR, "Empty LSDB.\n");
-        return;
+    /* IPv4 loopback prefix */
+    lsdb_reset_attr_template(&attr_template);
+    addr = lspgen_load_addr((uint8_t*)&ctx->ipv4_node_prefix.address, sizeof(ipv4addr_t));
+    addr += node->node_index;
+    lspgen_store_addr(addr, (uint8_t*)&attr_template.key.prefix.ipv4_prefix.address, sizeof(ipv4addr_t));
+    attr_template.key.prefix.ipv4_prefix.len = ctx->ipv4_node_prefix.len;
+    attr_template.key.prefix.node_flag = true;
+    attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
+    attr_template.key.attr_cp[1] = OSPF_LSA_ROUTER;
+    attr_template.key.attr_cp[2] = OSPF_ROUTER_LSA_LINK_STUB;
+    lsdb_add_node_attr(node, &attr_template);
+
+    if (!ctx->no_sr) {
+        lsdb_reset_attr_template(&attr_template);
+        lspgen_store_addr(addr, (uint8_t*)&attr_template.key.prefix.ipv4_prefix.address, sizeof(ipv4addr_t));
+        attr_template.key.prefix.ipv4_prefix.len = ctx->ipv4_node_prefix.len;
+        attr_template.key.prefix.sid = node->node_index;
+        attr_template.key.prefix.adv_sid = true;
+
+        attr_template.key.ordinal = 1;
+        attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
+        attr_template.key.attr_cp[1] = OSPF_LSA_OPAQUE_AREA_EP;
+        attr_template.key.attr_cp[2] = OSPF_TLV_EXTENDED_PREFIX;
+        attr_template.key.attr_cp[3] = OSPF_SUBTLV_PREFIX_SID;
+        lsdb_add_node_attr(node, &attr_template);
     }
 
-    /*
-     * For external routes load the first address of the pool.
-     */
+    /* external prefixes */
+    ext_per_node = ext->count;
     ext_addr4 = lspgen_load_addr((uint8_t*)&ctx->ipv4_ext_prefix.address, sizeof(ipv4addr_t));
     ext_incr4 = lspgen_get_prefix_inc(AF_INET, ctx->ipv4_ext_prefix.len);
+    ext_addr4 += ext->start * ext_incr4;
+    while (ext_per_node--) {
+        /* ipv4 external prefix */
+        lsdb_reset_attr_template(&attr_template);
+        lspgen_store_addr(ext_addr4, (uint8_t*)&attr_template.key.prefix.ipv4_prefix.address, 4);
+        attr_template.key.prefix.ipv4_prefix.len = ctx->ipv4_ext_prefix.len;
+        attr_template.key.prefix.metric = 100;
+        attr_template.key.prefix.ext_flag = true;
+
+        attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
+        attr_template.key.attr_cp[1] = OSPF_LSA_EXTERNAL;
+        attr_template.key.start_tlv = true;
+        lsdb_add_node_attr(node, &attr_template);
+        ext_addr4 += ext_incr4;
+    }
 
-    nodes_left = ctx->num_nodes;
-    ext_left = ctx->num_ext;
-
-    do {
-        node = *dict_itor_datum(itor);
-
-        LOG(LSDB, "Generating node %s (%s) attributes\n",
-            lsdb_format_node(node),
-            lsdb_format_node_id(node->key.node_id));
-
-        /* Host name */
-        if (node->node_name) {
-            lsdb_reset_attr_template(&attr_template);
-            attr_template.key.ordinal = 1;
-	    attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
-	    attr_template.key.attr_cp[1] = OSPF_LSA_OPAQUE_AREA_RI;
-            attr_template.key.attr_cp[2] = OSPF_TLV_HOSTNAME;
-            strncpy(attr_template.key.hostname, node->node_name, sizeof(attr_template.key.hostname)-1);
-            lsdb_add_node_attr(node, &attr_template);
-        }
-
-        /* IPv4 loopback prefix */
+    if (!ctx->no_sr) {
+        /* SR capability */
         lsdb_reset_attr_template(&attr_template);
         addr = lspgen_load_addr((uint8_t*)&ctx->ipv4_node_prefix.address, sizeof(ipv4addr_t));
         addr += node->node_index;
-        lspgen_store_addr(addr, (uint8_t*)&attr_template.key.prefix.ipv4_prefix.address, sizeof(ipv4addr_t));
-        attr_template.key.prefix.ipv4_prefix.len = ctx->ipv4_node_prefix.len;
-	attr_template.key.prefix.node_flag = true;
-	attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
-	attr_template.key.attr_cp[1] = OSPF_LSA_ROUTER;
-	attr_template.key.attr_cp[2] = OSPF_ROUTER_LSA_LINK_STUB;
+        lspgen_store_addr(addr, attr_template.key.cap.router_id, sizeof(ipv4addr_t));
+        attr_template.key.cap.srgb_base = ctx->srgb_base;
+        attr_template.key.cap.srgb_range = ctx->srgb_range;
+        attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
+        attr_template.key.attr_cp[1] = OSPF_LSA_OPAQUE_AREA_RI;
+        attr_template.key.attr_cp[2] = OSPF_TLV_SID_LABEL_RANGE;
+        attr_template.key.ordinal = 1;
         lsdb_add_node_attr(node, &attr_template);
+    }
 
-        if (!ctx->no_sr) {
-	    lsdb_reset_attr_template(&attr_template);
-	    lspgen_store_addr(addr, (uint8_t*)&attr_template.key.prefix.ipv4_prefix.address, sizeof(ipv4addr_t));
-	    attr_template.key.prefix.ipv4_prefix.len = ctx->ipv4_node_prefix.len;
-	    attr_template.key.prefix.sid = node->node_index;
-	    attr_template.key.prefix.adv_sid = true;
-
-            attr_template.key.ordinal = 1;
-	    attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
-	    attr_template.key.attr_cp[1] = OSPF_LSA_OPAQUE_AREA_EP;
-	    attr_template.key.attr_cp[2] = OSPF_TLV_EXTENDED_PREFIX;
-	    attr_template.key.attr_cp[3] = OSPF_SUBTLV_PREFIX_SID;
-	    lsdb_add_node_attr(node, &attr_template);
-	}
-
-        /* external prefixes */
-	ext_per_node = ext_left / nodes_left;
-	ext_left -= ext_per_node;
-        while (ext_per_node--) {
-            /* ipv4 external prefix */
-            lsdb_reset_attr_template(&attr_template);
-            lspgen_store_addr(ext_addr4, (uint8_t*)&attr_template.key.prefix.ipv4_prefix.address, 4);
-            attr_template.key.prefix.ipv4_prefix.len = ctx->ipv4_ext_prefix.len;
-            attr_template.key.prefix.metric = 100;
-            attr_template.key.prefix.ext_flag = true;
-
-	    attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
-	    attr_template.key.attr_cp[1] = OSPF_LSA_EXTERNAL;
-	    attr_template.key.start_tlv = true;
-            lsdb_add_node_attr(node, &attr_template);
-            ext_addr4 += ext_incr4;
-        }
+    /*
+     * Walk all of our neighbors.
+     */
+    CIRCLEQ_FOREACH(link, &node->link_qhead, link_qnode) {
 
-        if (!ctx->no_sr) {
-            /* SR capability */
-            lsdb_reset_attr_template(&attr_template);
-            addr = lspgen_load_addr((uint8_t*)&ctx->ipv4_node_prefix.address, sizeof(ipv4addr_t));
-            addr += node->node_index;
-            lspgen_store_addr(addr, attr_template.key.cap.router_id, sizeof(ipv4addr_t));
-            attr_template.key.cap.srgb_base = ctx->srgb_base;
-            attr_template.key.cap.srgb_range = ctx->srgb_range;
-	    attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
-	    attr_template.key.attr_cp[1] = OSPF_LSA_OPAQUE_AREA_RI;
-	    attr_template.key.attr_cp[2] = OSPF_TLV_SID_LABEL_RANGE;
-	    attr_template.key.ordinal = 1;
-            lsdb_add_node_attr(node, &attr_template);
+        /*
+         * Is this a connector link ?
+         */
+        if (link->key.remote_node_id[7] == CONNECTOR_MARKER) {
+    	lsdb_reset_attr_template(&attr_template);
+
+    	attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
+    	attr_template.key.attr_cp[1] = OSPF_LSA_ROUTER;
+    	attr_template.key.attr_cp[2] = OSPF_ROUTER_LSA_LINK_PTP;
+
+    	memcpy(attr_template.key.link.remote_node_id, link->key.remote_node_id, 4);
+    	memcpy(attr_template.key.link.remote_link_id, link->key.remote_link_id, 4);
+    	memcpy(attr_template.key.link.local_link_id, link->key.local_link_id, 4);
+    	attr_template.key.link.metric = link->link_metric;
+    	lsdb_add_node_attr(node, &attr_template);
+    	continue;
         }
 
         /*
-         * Walk all of our neighbors.
+         * Generate a ptp neighbor for each link
+         * TODO Type-2 LSA handling.
          */
-        CIRCLEQ_FOREACH(link, &node->link_qhead, link_qnode) {
-
-	    /*
-	     * Is this a connector link ?
-	     */
-	    if (link->key.remote_node_id[7] == CONNECTOR_MARKER) {
-		lsdb_reset_attr_template(&attr_template);
-
-		attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
-		attr_template.key.attr_cp[1] = OSPF_LSA_ROUTER;
-		attr_template.key.attr_cp[2] = OSPF_ROUTER_LSA_LINK_PTP;
-
-		memcpy(attr_template.key.link.remote_node_id, link->key.remote_node_id, 4);
-		memcpy(attr_template.key.link.remote_link_id, link->key.remote_link_id, 4);
-		memcpy(attr_template.key.link.local_link_id, link->key.local_link_id, 4);
-		attr_template.key.link.metric = link->link_metric;
-		lsdb_add_node_attr(node, &attr_template);
-		continue;
-	    }
+        lsdb_reset_attr_template(&attr_template);
 
-            /*
-	     * Generate a ptp neighbor for each link
-	     * TODO Type-2 LSA handling.
-	     */
-            lsdb_reset_attr_template(&attr_template);
-
-            addr = lspgen_load_addr((uint8_t*)&ctx->ipv4_link_prefix.address, sizeof(ipv4addr_t));
-            inc = lspgen_get_prefix_inc(AF_INET, ctx->ipv4_link_prefix.len);
-            addr += link->link_index * inc;
-	    addr_offset = 0;
-	    if (lspgen_load_addr(link->key.remote_node_id, 4) < lspgen_load_addr(link->key.local_node_id, 4)) {
-		addr_offset = 1;
-	    }
+        addr = lspgen_load_addr((uint8_t*)&ctx->ipv4_link_prefix.address, sizeof(ipv4addr_t));
+        inc = lspgen_get_prefix_inc(AF_INET, ctx->ipv4_link_prefix.len);
+        addr += link->link_index * inc;
+        addr_offset = 0;
+        if (lspgen_load_addr(link->key.remote_node_id, 4) < lspgen_load_addr(link->key.local_node_id, 4)) {
+    	addr_offset = 1;
+        }
 
-	    lspgen_store_addr(addr + addr_offset, attr_template.key.link.local_link_id, 4);
+        lspgen_store_addr(addr + addr_offset, attr_template.key.link.local_link_id, 4);
 
-	    attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
-	    attr_template.key.attr_cp[1] = OSPF_LSA_ROUTER;
-	    attr_template.key.attr_cp[2] = OSPF_ROUTER_LSA_LINK_PTP;
-            memcpy(attr_template.key.link.remote_node_id, link->key.remote_node_id, 4);
-	    metric = link->link_metric;
-	    if (metric > 65535) {
-		metric = 65535;
-	    }
-            attr_template.key.link.metric = metric;
-            lsdb_add_node_attr(node, &attr_template);
-
-            /* Generate an IPv4 prefix for each link */
-            lsdb_reset_attr_template(&attr_template);
-            lspgen_store_addr(addr, (uint8_t*)&attr_template.key.prefix.ipv4_prefix.address, sizeof(ipv4addr_t));
-            attr_template.key.prefix.ipv4_prefix.len = ctx->ipv4_link_prefix.len;
-            attr_template.key.prefix.metric = metric;
-
-	    attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
-	    attr_template.key.attr_cp[1] = OSPF_LSA_ROUTER;
-	    attr_template.key.attr_cp[2] = OSPF_ROUTER_LSA_LINK_STUB;
-            lsdb_add_node_attr(node, &attr_template);
+        attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
+        attr_template.key.attr_cp[1] = OSPF_LSA_ROUTER;
+        attr_template.key.attr_cp[2] = OSPF_ROUTER_LSA_LINK_PTP;
+        memcpy(attr_template.key.link.remote_node_id, link->key.remote_node_id, 4);
+        metric = link->link_metric;
+        if (metric > 65535) {
+    	metric = 65535;
         }
+        attr_template.key.link.metric = metric;
+        lsdb_add_node_attr(node, &attr_template);
 
-	nodes_left--;
-    } while (dict_itor_next(itor));
+        /* Generate an IPv4 prefix for each link */
+        lsdb_reset_attr_template(&attr_template);
+        lspgen_store_addr(addr, (uint8_t*)&attr_template.key.prefix.ipv4_prefix.address, sizeof(ipv4addr_t));
+        attr_template.key.prefix.ipv4_prefix.len = ctx->ipv4_link_prefix.len;
+        attr_template.key.prefix.metric = metric;
 
-    dict_itor_free(itor);
+        attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
+        attr_template.key.attr_cp[1] = OSPF_LSA_ROUTER;
+        attr_template.key.attr_cp[2] = OSPF_ROUTER_LSA_LINK_STUB;
+        lsdb_add_node_attr(node, &attr_template);
+    }
 }
 
 /*
- * Walk the graph of the LSDB and add the required node/link attributes for OSPFv3 LSP generation.
+ * Walk the graph of the LSDB and add the required node/link attributes for OSPFv2 LSP generation.
  */
 void
-lspgen_gen_ospf3_attr(struct lsdb_ctx_ *ctx)
+lspgen_gen_ospf2_attr(struct lsdb_ctx_ *ctx)
+{
+    lspgen_gen_attr(ctx, lspgen_gen_ospf2_attr_node);
+}
+
+/*
+ * Add the required node/link attributes for OSPFv3 LSP generation to a node.
+ */
+static void
+lspgen_gen_ospf3_attr_node(struct lsdb_ctx_ *ctx, struct lsdb_node_ *node, uint32_t idx, void *arg)
 {
-    struct lsdb_node_ *node;
     struct lsdb_link_ *link;
     struct lsdb_attr_ attr_template;
-    dict_itor *itor;
+    lspgen_attr_ext_t *ext;
     __uint128_t addr, inc, ext_addr6, ext_incr6;
-    uint32_t ext_per_node, metric, nodes_left, ext_left;
+    uint32_t ext_per_node, metric;
 
-    /*
-     * Walk the node DB.
-     */
-    itor = dict_itor_new(ctx->node_dict);
-    if (!itor) {
-        return;
+    ext = (lspgen_attr_ext_t *)arg + idx;
+
+    LOG(LSDB, "Generating node %s (%s) attributes\n",
+        lsdb_format_node(node),
+        lsdb_format_node_id(node->key.node_id));
+
+    /* Host name */
+    if (node->node_name) {
+        lsdb_reset_attr_template(&attr_template);
+        attr_template.key.ordinal = 1;
+        attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
+        attr_template.key.attr_cp[1] = OSPF_LSA_OPAQUE_AREA_RI;
+        attr_template.key.attr_cp[2] = OSPF_TLV_HOSTNAME;
+        strncpy(attr_template.key.hostname, node->node_name, sizeof(attr_template.key.hostname)-1);
+        lsdb_add_node_attr(node, &attr_template);
     }
 
-    /*
-     * Node DB empty ?
-     */
-    if (!dict_itor_first(itor)) {
-        dict_itor_free(itor);
-        LOG_NOARG(ERROR, "Empty LSDB.\n");
-        return;
+    /* IPv6 loopback prefix */
+    lsdb_reset_attr_template(&attr_template);
+    addr = lspgen_load_addr((uint8_t*)&ctx->ipv6_node_prefix.address, IPV6_ADDR_LEN);
+    addr += node->node_index;
+    lspgen_store_addr(addr, attr_template.key.prefix.ipv6_prefix.address, IPV6_ADDR_LEN);
+    attr_template.key.prefix.ipv6_prefix.len = ctx->ipv6_node_prefix.len;
+    attr_template.key.prefix.node_flag = true;
+    attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
+    attr_template.key.attr_cp[1] = OSPF_LSA_INTRA_AREA_PREFIX;
+    attr_template.key.attr_cp[2] = OSPF_IA_PREFIX_LSA_PREFIX;
+    lsdb_add_node_attr(node, &attr_template);
+
+    if (!ctx->no_sr) {
+        lsdb_reset_attr_template(&attr_template);
+        lspgen_store_addr(addr, attr_template.key.prefix.ipv6_prefix.address, IPV6_ADDR_LEN);
+        attr_template.key.prefix.ipv6_prefix.len = ctx->ipv6_node_prefix.len;
+        attr_template.key.prefix.sid = node->node_index;
+        attr_template.key.prefix.adv_sid = true;
+
+        /* For SR use the Extended-Intra-Area-Router-LSA */
+        attr_template.key.ordinal = 1;
+        attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
+        attr_template.key.attr_cp[1] = OSPF_LSA_E_INTRA_AREA_PREFIX;
+        attr_template.key.attr_cp[2] = OSPF_TLV_INTRA_AREA_PREFIX;
+        attr_template.key.attr_cp[3] = OSPF_SUBTLV_PREFIX_SID;
+        lsdb_add_node_attr(node, &attr_template);
     }
 
-    /*
-     * For external routes load the first address of the pool.
-     */
+    /* external prefixes */
+    ext_per_node = ext->count;
     ext_addr6 = lspgen_load_addr((uint8_t*)&ctx->ipv6_ext_prefix.address, IPV6_ADDR_LEN);
     ext_incr6 = lspgen_get_prefix_inc(AF_INET6, ctx->ipv6_ext_prefix.len);
+    ext_addr6 += ext->start * ext_incr6;
+    while (ext_per_node--) {
+        /* ipv6 external prefix */
+        lsdb_reset_attr_template(&attr_template);
+        lspgen_store_addr(ext_addr6, attr_template.key.prefix.ipv6_prefix.address, IPV6_ADDR_LEN);
+        attr_template.key.prefix.ipv6_prefix.len = ctx->ipv6_ext_prefix.len;
+        attr_template.key.prefix.metric = 100;
+        attr_template.key.prefix.tag = ext_per_node;
+        attr_template.key.prefix.ext_flag = true;
+        attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
+        attr_template.key.attr_cp[1] = OSPF_LSA_EXTERNAL6;
+        attr_template.key.start_tlv = true;
+        lsdb_add_node_attr(node, &attr_template);
+        ext_addr6 += ext_incr6;
+    }
 
-    nodes_left = ctx->num_nodes;
-    ext_left = ctx->num_ext;
-
-    do {
-        node = *dict_itor_datum(itor);
-
-	LOG(LSDB, "Generating node %s (%s) attributes\n",
-            lsdb_format_node(node),
-            lsdb_format_node_id(node->key.node_id));
-
-	/* Host name */
-        if (node->node_name) {
-	    lsdb_reset_attr_template(&attr_template);
-	    attr_template.key.ordinal = 1;
-	    attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
-	    attr_template.key.attr_cp[1] = OSPF_LSA_OPAQUE_AREA_RI;
-	    attr_template.key.attr_cp[2] = OSPF_TLV_HOSTNAME;
-	    strncpy(attr_template.key.hostname, node->node_name, sizeof(attr_template.key.hostname)-1);
-	    lsdb_add_node_attr(node, &attr_template);
-        }
-
-        /* IPv6 loopback prefix */
+    if (!ctx->no_sr) {
+        /* SR capability */
         lsdb_reset_attr_template(&attr_template);
-        addr = lspgen_load_addr((uint8_t*)&ctx->ipv6_node_prefix.address, IPV6_ADDR_LEN);
+        addr = lspgen_load_addr((uint8_t*)&ctx->ipv4_node_prefix.address, sizeof(ipv4addr_t));
         addr += node->node_index;
-        lspgen_store_addr(addr, attr_template.key.prefix.ipv6_prefix.address, IPV6_ADDR_LEN);
-	attr_template.key.prefix.ipv6_prefix.len = ctx->ipv6_node_prefix.len;
-	attr_template.key.prefix.node_flag = true;
-	attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
-	attr_template.key.attr_cp[1] = OSPF_LSA_INTRA_AREA_PREFIX;
-	attr_template.key.attr_cp[2] = OSPF_IA_PREFIX_LSA_PREFIX;
-	lsdb_add_node_attr(node, &attr_template);
-
-        if (!ctx->no_sr) {
-	    lsdb_reset_attr_template(&attr_template);
-	    lspgen_store_addr(addr, attr_template.key.prefix.ipv6_prefix.address, IPV6_ADDR_LEN);
-	    attr_template.key.prefix.ipv6_prefix.len = ctx->ipv6_node_prefix.len;
-	    attr_template.key.prefix.sid = node->node_index;
-	    attr_template.key.prefix.adv_sid = true;
-
-	    /* For SR use the Extended-Intra-Area-Router-LSA */
-	    attr_template.key.ordinal = 1;
-	    attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
-	    attr_template.key.attr_cp[1] = OSPF_LSA_E_INTRA_AREA_PREFIX;
-	    attr_template.key.attr_cp[2] = OSPF_TLV_INTRA_AREA_PREFIX;
-	    attr_template.key.attr_cp[3] = OSPF_SUBTLV_PREFIX_SID;
-	    lsdb_add_node_attr(node, &attr_template);
-	}
+        lspgen_store_addr(addr, attr_template.key.cap.router_id, sizeof(ipv4addr_t));
+        attr_template.key.cap.srgb_base = ctx->srgb_base;
+        attr_template.key.cap.srgb_range = ctx->srgb_range;
+        attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
+        attr_template.key.attr_cp[1] = OSPF_LSA_OPAQUE_AREA_RI;
+        attr_template.key.attr_cp[2] = OSPF_TLV_SID_LABEL_RANGE;
+        attr_template.key.ordinal = 1;
+        lsdb_add_node_attr(node, &attr_template);
+    }
 
-        /* external prefixes */
-	ext_per_node = ext_left / nodes_left;
-	ext_left -= ext_per_node;
-        while (ext_per_node--) {
-            /* ipv6 external prefix */
-            lsdb_reset_attr_template(&attr_template);
-            lspgen_store_addr(ext_addr6, attr_template.key.prefix.ipv6_prefix.address, IPV6_ADDR_LEN);
-            attr_template.key.prefix.ipv6_prefix.len = ctx->ipv6_ext_prefix.len;
-            attr_template.key.prefix.metric = 100;
-            attr_template.key.prefix.tag = ext_per_node;
-            attr_template.key.prefix.ext_flag = true;
-	    attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
-	    attr_template.key.attr_cp[1] = OSPF_LSA_EXTERNAL6;
-	    attr_template.key.start_tlv = true;
-            lsdb_add_node_attr(node, &attr_template);
-            ext_addr6 += ext_incr6;
-        }
+    /*
+     * Walk all of our neighbors.
+     */
+    CIRCLEQ_FOREACH(link, &node->link_qhead, link_qnode) {
 
-        if (!ctx->no_sr) {
-            /* SR capability */
-            lsdb_reset_attr_template(&attr_template);
-            addr = lspgen_load_addr((uint8_t*)&ctx->ipv4_node_prefix.address, sizeof(ipv4addr_t));
-            addr += node->node_index;
-            lspgen_store_addr(addr, attr_template.key.cap.router_id, sizeof(ipv4addr_t));
-            attr_template.key.cap.srgb_base = ctx->srgb_base;
-            attr_template.key.cap.srgb_range = ctx->srgb_range;
-	    attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
-	    attr_template.key.attr_cp[1] = OSPF_LSA_OPAQUE_AREA_RI;
-	    attr_template.key.attr_cp[2] = OSPF_TLV_SID_LABEL_RANGE;
-	    attr_template.key.ordinal = 1;
-            lsdb_add_node_attr(node, &attr_template);
+        /*
+         * Is this a connector link ?
+         */
+        if (link->key.remote_node_id[7] == CONNECTOR_MARKER) {
+    	lsdb_reset_attr_template(&attr_template);
+
+    	attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
+    	attr_template.key.attr_cp[1] = OSPF_LSA_ROUTER;
+    	attr_template.key.attr_cp[2] = OSPF_ROUTER_LSA_LINK_PTP;
+
+    	memcpy(attr_template.key.link.remote_node_id, link->key.remote_node_id, 4);
+    	memcpy(attr_template.key.link.remote_link_id, link->key.remote_link_id, 4);
+    	memcpy(attr_template.key.link.local_link_id, link->key.local_link_id, 4);
+    	attr_template.key.link.metric = link->link_metric;
+    	lsdb_add_node_attr(node, &attr_template);
+    	continue;
         }
 
         /*
-         * Walk all of our neighbors.
+         * Generate a ptp neighbor for each link
+         * TODO Type-2 LSA handling.
          */
-        CIRCLEQ_FOREACH(link, &node->link_qhead, link_qnode) {
-
-	    /*
-	     * Is this a connector link ?
-	     */
-	    if (link->key.remote_node_id[7] == CONNECTOR_MARKER) {
-		lsdb_reset_attr_template(&attr_template);
-
-		attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
-		attr_template.key.attr_cp[1] = OSPF_LSA_ROUTER;
-		attr_template.key.attr_cp[2] = OSPF_ROUTER_LSA_LINK_PTP;
-
-		memcpy(attr_template.key.link.remote_node_id, link->key.remote_node_id, 4);
-		memcpy(attr_template.key.link.remote_link_id, link->key.remote_link_id, 4);
-		memcpy(attr_template.key.link.local_link_id, link->key.local_link_id, 4);
-		attr_template.key.link.metric = link->link_metric;
-		lsdb_add_node_attr(node, &attr_template);
-		continue;
-	    }
+        lsdb_reset_attr_template(&attr_template);
 
-	    /*
-	     * Generate a ptp neighbor for each link
-	     * TODO Type-2 LSA handling.
-	     */
-            lsdb_reset_attr_template(&attr_template);
-
-            addr = lspgen_load_addr((uint8_t*)&ctx->ipv4_link_prefix.address, sizeof(ipv4addr_t));
-            inc = lspgen_get_prefix_inc(AF_INET, ctx->ipv4_link_prefix.len);
-            addr += link->link_index * inc;
-	    if (lspgen_load_addr(link->key.remote_node_id, 4) < lspgen_load_addr(link->key.local_node_id, 4)) {
-		lspgen_store_addr(addr, attr_template.key.link.remote_link_id, 4);
-		lspgen_store_addr(addr+1, attr_template.key.link.local_link_id, 4);
-	    } else {
-		lspgen_store_addr(addr+1, attr_template.key.link.remote_link_id, 4);
-		lspgen_store_addr(addr, attr_template.key.link.local_link_id, 4);
-	    }
+        addr = lspgen_load_addr((uint8_t*)&ctx->ipv4_link_prefix.address, sizeof(ipv4addr_t));
+        inc = lspgen_get_prefix_inc(AF_INET, ctx->ipv4_link_prefix.len);
+        addr += link->link_index * inc;
+        if (lspgen_load_addr(link->key.remote_node_id, 4) < lspgen_load_addr(link->key.local_node_id, 4)) {
+    	lspgen_store_addr(addr, attr_template.key.link.remote_link_id, 4);
+    	lspgen_store_addr(addr+1, attr_template.key.link.local_link_id, 4);
+        } else {
+    	lspgen_store_addr(addr+1, attr_template.key.link.remote_link_id, 4);
+    	lspgen_store_addr(addr, attr_template.key.link.local_link_id, 4);
+        }
 
-	    attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
-	    attr_template.key.attr_cp[1] = OSPF_LSA_ROUTER;
-	    attr_template.key.attr_cp[2] = OSPF_ROUTER_LSA_LINK_PTP;
-            memcpy(attr_template.key.link.remote_node_id, link->key.remote_node_id, 4);
-	    metric = link->link_metric;
-	    if (metric > 65535) {
-		metric = 65535;
-	    }
-	    attr_template.key.link.metric = metric;
-	    lsdb_add_node_attr(node, &attr_template);
-
-            /* Generate an IPv6 prefix for each link */
-            lsdb_reset_attr_template(&attr_template);
-
-            addr = lspgen_load_addr(ctx->ipv6_link_prefix.address, IPV6_ADDR_LEN);
-            inc = lspgen_get_prefix_inc(AF_INET6, ctx->ipv6_link_prefix.len);
-            addr += link->link_index * inc;
-            lspgen_store_addr(addr, attr_template.key.prefix.ipv6_prefix.address, IPV6_ADDR_LEN);
-            attr_template.key.prefix.ipv6_prefix.len = ctx->ipv6_link_prefix.len;
-	    metric = link->link_metric;
-	    if (metric > 65535) {
-		metric = 65535;
-	    }
-            attr_template.key.prefix.metric = metric;
+        attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
+        attr_template.key.attr_cp[1] = OSPF_LSA_ROUTER;
+        attr_template.key.attr_cp[2] = OSPF_ROUTER_LSA_LINK_PTP;
+        memcpy(attr_template.key.link.remote_node_id, link->key.remote_node_id, 4);
+        metric = link->link_metric;
+        if (metric > 65535) {
+    	metric = 65535;
+        }
+        attr_template.key.link.metric = metric;
+        lsdb_add_node_attr(node, &attr_template);
 
-	    attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
-	    attr_template.key.attr_cp[1] = OSPF_LSA_INTRA_AREA_PREFIX;
-	    attr_template.key.attr_cp[2] = OSPF_IA_PREFIX_LSA_PREFIX;
-            lsdb_add_node_attr(node, &attr_template);
-	}
+        /* Generate an IPv6 prefix for each link */
+        lsdb_reset_attr_template(&attr_template);
 
-	nodes_left--;
-    } while (dict_itor_next(itor));
+        addr = lspgen_load_addr(ctx->ipv6_link_prefix.address, IPV6_ADDR_LEN);
+        inc = lspgen_get_prefix_inc(AF_INET6, ctx->ipv6_link_prefix.len);
+        addr += link->link_index * inc;
+        lspgen_store_addr(addr, attr_template.key.prefix.ipv6_prefix.address, IPV6_ADDR_LEN);
+        attr_template.key.prefix.ipv6_prefix.len = ctx->ipv6_link_prefix.len;
+        metric = link->link_metric;
+        if (metric > 65535) {
+    	metric = 65535;
+        }
+        attr_template.key.prefix.metric = metric;
 
-    dict_itor_free(itor);
+        attr_template.key.attr_cp[0] = OSPF_MSG_LSUPDATE;
+        attr_template.key.attr_cp[1] = OSPF_LSA_INTRA_AREA_PREFIX;
+        attr_template.key.attr_cp[2] = OSPF_IA_PREFIX_LSA_PREFIX;
+        lsdb_add_node_attr(node, &attr_template);
+    }
+}
+
+/*
+ * Walk the graph of the LSDB and add the required node/link attributes for OSPFv3 LSP generation.
+ */
+void
+lspgen_gen_ospf3_attr(struct lsdb_ctx_ *ctx)
+{
+    lspgen_gen_attr(ctx, lspgen_gen_ospf3_attr_node);
 }
 
 void
@@ -972,6 +964,7 @@ lspgen_init_ctx(struct lsdb_ctx_ *ctx)
     ctx->lsp_buffer_size = ISIS_DEFAULT_LSP_BUFFER_SIZE;
 
     ctx->link_multiplier = 1;
+    ctx->num_threads = 1;
 
     /* ipv4 link prefix */
     inet_pton(AF_INET, "172.16.0.0", &ctx->ipv4_link_prefix.address);
@@ -1085,6 +1078,9 @@ lspgen_log_ctx(struct lsdb_ctx_ *ctx)
     if (ctx->link_multiplier) {
         LOG(NORMAL, " Link-multiplier %u\n", ctx->link_multiplier);
     }
+    if (ctx->num_threads > 1) {
+        LOG(NORMAL, " Threads %u\n", ctx->num_threads);
+    }
     if (!ctx->no_ipv4) {
         end_prefix4 = lspgen_compute_end_prefix4(&ctx->ipv4_node_prefix, ctx->num_nodes);
         LOG(NORMAL, " IPv4 Node Base Prefix %s, End Prefix %s, %u prefixes\n",
@@ -1277,6 +1273,11 @@ main(int argc, char *argv[])
     log_id[NORMAL].enable = true;
     log_id[ERROR].enable = true;
 
+    /*
+     * Select checksum implementation before any worker threads are started.
+     */
+    checksum_set_impl(CHECKSUM_IMPL_AUTO);
+
     ctx = lsdb_alloc_ctx("default");
     if (!ctx) {
         exit(EXIT_FAILURE);
@@ -1287,7 +1288,7 @@ main(int argc, char *argv[])
      * Parse options.
      */
     idx = 0;
-    while ((opt = getopt_long(argc, argv, "vha:c:C:I:e:f:g:Gl:L:m:M:n:K:N:p:P:q:Qr:s:S:t:T:u:V:w:x:X:yzZ",
+    while ((opt = getopt_long(argc, argv, "vha:c:C:I:Je:f:g:Gj:k:l:L:m:M:n:K:N:p:P:q:Qr:s:S:t:T:u:V:w:x:X:yzZ",
                               long_options, &idx)) != -1) {
         switch (opt) {
             case 'v':
@@ -1458,6 +1459,10 @@ main(int argc, char *argv[])
                 /* routing instance-id used by BNG Blaster */
                 ctx->ctrl_instance = strtol(optarg, NULL, 0);
                 break;
+            case 'J':
+                /* hex encoded PDUs in JSON commands for older BNG Blaster versions */
+                ctx->ctrl_json = true;
+                break;
             case 'V':
                 /* level */
                 if (ctx->protocol_id != PROTO_ISIS) {
@@ -1470,6 +1475,20 @@ main(int argc, char *argv[])
                     exit(EXIT_FAILURE);
                 }
                 break;
+            case 'j':
+                /* threads for attribute and packet generation */
+                ctx->num_threads = strtol(optarg, NULL, 10);
+                if (ctx->num_threads < 1) {
+                    ctx->num_threads = 1;
+                }
+                if (ctx->num_threads > LSPGEN_MAX_THREADS) {
+                    ctx->num_threads = LSPGEN_MAX_THREADS;
+                    LOG(ERROR, "Set threads to maximum %u\n", ctx->num_threads);
+                }
+                break;
+            case 'k':
+                ctx->cache_filename = strdup(optarg);
+                break;
             case 'h': /* fall through */
             default:
                 lspgen_print_usage();
@@ -1477,10 +1496,19 @@ main(int argc, char *argv[])
         }
     }
 
+    /*
+     * Load the link-state database from a matching cache file.
+     */
+    if (ctx->cache_filename) {
+        ctx->cache_loaded = lspgen_read_cache(ctx);
+    }
+
     /*
      * Read the link-state database from a config file.
      */
-    if (ctx->config_read && ctx->config_filename) {
+    if (ctx->cache_loaded) {
+        /* nothing to generate */
+    } else if (ctx->config_read && ctx->config_filename) {
         lspgen_read_config(ctx);
     } else {
 
@@ -1516,6 +1544,13 @@ main(int argc, char *argv[])
      */
     lspgen_gen_packet(ctx);
 
+    /*
+     * Write the cache file, such that the next run can skip the generation.
+     */
+    if (ctx->cache_filename && !ctx->cache_loaded) {
+        lspgen_write_cache(ctx);
+    }
+
     /*
      * Dump the lsdb into a PCAP file.
      */
@@ -33,6 +33,13 @@
 #define CTRL_SOCKET_BUFSIZE 1024*4096
 #define PAD4(X) ((X+3)&(~3)) /* 32-Bit padding */
 #define CONNECTOR_MARKER 1 /* Marker for connector link */
+#define LSPGEN_MAX_THREADS 64
+
+/* https://datatracker.ietf.org/doc/html/rfc6396#section-4 */
+#define MRT_TYPE_OSPFV2 11
+#define MRT_TYPE_OSPFV3 48
+#define MRT_TYPE_ISIS   32
+#define MRT_TYPE_LSPGEN 0xff00 /* private, LSDB cache records */
 
 __uint128_t lspgen_load_addr(uint8_t *, uint32_t);
 void lspgen_store_addr(__uint128_t, uint8_t *, uint32_t);
@@ -41,6 +48,7 @@ void lspgen_quit_loop(void);
 
 /* lspgen_mrt.c */
 void lspgen_dump_mrt(lsdb_ctx_t *);
+void lspgen_dump_mrt_node(lsdb_ctx_t *, lsdb_node_t *, FILE *);
 
 /* lspgen_pcap.c */
 void lspgen_dump_pcap(lsdb_ctx_t *);
@@ -60,8 +68,18 @@ extern struct keyval_ isis_level_names[];
 /* lspgen_packet.c */
 void lspgen_serialize_attr(lsdb_ctx_t *, lsdb_attr_t *, lsdb_packet_t *);
 void lspgen_gen_packet(lsdb_ctx_t *);
+void lspgen_update_node(lsdb_node_t *);
 void lspgen_reset_packet_buffer(struct lsdb_packet_ *);
 
+/* lspgen_thread.c */
+typedef void (*lspgen_thread_job_cb)(lsdb_ctx_t *, lsdb_node_t *, uint32_t, void *);
+lsdb_node_t **lspgen_thread_get_nodes(lsdb_ctx_t *, uint32_t *);
+void lspgen_thread_run(lsdb_ctx_t *, lsdb_node_t **, uint32_t, lspgen_thread_job_cb, void *);
+
+/* lspgen_cache.c */
+bool lspgen_read_cache(lsdb_ctx_t *);
+void lspgen_write_cache(lsdb_ctx_t *);
+
 /* lspgen_seq_cache.c */
 void lspgen_read_seq_cache(lsdb_ctx_t *);
 void lspgen_write_seq_cache(lsdb_ctx_t *);
@@ -0,0 +1,764 @@
+/*
+ * Generic Link State Packet generation for link-state protocols.
+ *
+ * Binary LSDB cache file support.
+ *
+ * The cache file is a MRT file. The LSDB (nodes, links and attributes)
+ * is stored in records of the private type MRT_TYPE_LSPGEN, each node
+ * record is followed by the regular protocol MRT records of the
+ * serialized packets of this node. Other MRT readers (e.g. BNG Blaster)
+ * skip the private records and load the packets like from any MRT file.
+ *
+ * Copyright (C) 2020-2025, RtBrick, Inc.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include "lspgen.h"
+#include "lspgen_lsdb.h"
+#include "lspgen_isis.h"
+
+#define LSPGEN_CACHE_MAGIC   0x4c535047 /* "LSPG" */
+#define LSPGEN_CACHE_VERSION 1
+#define LSPGEN_CACHE_BOM     0x01020304 /* written in host byte order */
+
+/* MRT subtypes of MRT_TYPE_LSPGEN */
+#define LSPGEN_CACHE_HEADER  0
+#define LSPGEN_CACHE_NODE    1
+#define LSPGEN_CACHE_LINKS   2
+
+#define LSPGEN_CACHE_HEADER_LEN 52
+#define LSPGEN_CACHE_NODE_LEN   30 /* w/o hostname, attributes and packets */
+
+/* Node flags */
+#define LSPGEN_CACHE_OVERLOAD          0x01
+#define LSPGEN_CACHE_ATTACH            0x02
+#define LSPGEN_CACHE_DIRECT_NEIGHBOR   0x04
+#define LSPGEN_CACHE_PSEUDONODE        0x08
+#define LSPGEN_CACHE_LOCAL_PSEUDONODE  0x10
+#define LSPGEN_CACHE_ROOT              0x20
+
+#define LSPGEN_CACHE_ATTR_KEY_LEN sizeof(((struct lsdb_attr_ *) 0)->key)
+#define LSPGEN_CACHE_LINK_KEY_LEN sizeof(((struct lsdb_link_ *) 0)->key)
+
+/*
+ * FNV-1a digest over a chunk of data.
+ */
+static uint64_t
+lspgen_cache_hash(uint64_t digest, const void *data, size_t len)
+{
+    const uint8_t *p;
+
+    p = data;
+    while (len--) {
+        digest ^= *p++;
+        digest *= 0x100000001b3;
+    }
+    return digest;
+}
+
+#define LSPGEN_CACHE_HASH(_digest, _field) \
+    _digest = lspgen_cache_hash(_digest, &(_field), sizeof(_field))
+
+/*
+ * Digest of all parameters which have an impact on the generated LSDB.
+ * A cache file is only used if it has been written with the same parameters.
+ */
+static uint64_t
+lspgen_cache_digest(lsdb_ctx_t *ctx)
+{
+    struct stat sb;
+    uint64_t digest;
+
+    digest = 0xcbf29ce484222325;
+    LSPGEN_CACHE_HASH(digest, ctx->protocol_id);
+    LSPGEN_CACHE_HASH(digest, ctx->topology_id);
+    LSPGEN_CACHE_HASH(digest, ctx->num_nodes);
+    LSPGEN_CACHE_HASH(digest, ctx->ipv4_node_prefix);
+    LSPGEN_CACHE_HASH(digest, ctx->ipv4_link_prefix);
+    LSPGEN_CACHE_HASH(digest, ctx->ipv4_ext_prefix);
+    LSPGEN_CACHE_HASH(digest, ctx->ipv6_node_prefix);
+    LSPGEN_CACHE_HASH(digest, ctx->ipv6_link_prefix);
+    LSPGEN_CACHE_HASH(digest, ctx->ipv6_ext_prefix);
+    LSPGEN_CACHE_HASH(digest, ctx->area);
+    LSPGEN_CACHE_HASH(digest, ctx->num_area);
+    LSPGEN_CACHE_HASH(digest, ctx->sequence);
+    LSPGEN_CACHE_HASH(digest, ctx->srgb_base);
+    LSPGEN_CACHE_HASH(digest, ctx->srgb_range);
+    LSPGEN_CACHE_HASH(digest, ctx->authentication_type);
+    if (ctx->authentication_key) {
+        digest = lspgen_cache_hash(digest, ctx->authentication_key, strlen(ctx->authentication_key));
+    }
+    LSPGEN_CACHE_HASH(digest, ctx->seed);
+    LSPGEN_CACHE_HASH(digest, ctx->connector);
+    LSPGEN_CACHE_HASH(digest, ctx->num_connector);
+    LSPGEN_CACHE_HASH(digest, ctx->num_ext);
+    LSPGEN_CACHE_HASH(digest, ctx->link_multiplier);
+    LSPGEN_CACHE_HASH(digest, ctx->no_sr);
+    LSPGEN_CACHE_HASH(digest, ctx->no_ipv4);
+    LSPGEN_CACHE_HASH(digest, ctx->no_ipv6);
+    LSPGEN_CACHE_HASH(digest, ctx->purge);
+    LSPGEN_CACHE_HASH(digest, ctx->lsp_lifetime);
+    LSPGEN_CACHE_HASH(digest, ctx->lsp_buffer_size);
+
+    /*
+     * Topology read from a config file.
+     */
+    if (ctx->config_read && ctx->config_filename) {
+        digest = lspgen_cache_hash(digest, ctx->config_filename, strlen(ctx->config_filename));
+        if (stat(ctx->config_filename, &sb) == 0) {
+            LSPGEN_CACHE_HASH(digest, sb.st_size);
+            LSPGEN_CACHE_HASH(digest, sb.st_mtime);
+        }
+    }
+    return digest;
+}
+
+/*
+ * Length of the IP header in front of the serialized packets.
+ */
+static uint32_t
+lspgen_cache_ip_hdr_len(lsdb_ctx_t *ctx)
+{
+    switch (ctx->protocol_id) {
+    case PROTO_OSPF2:
+        return 20;
+    case PROTO_OSPF3:
+        return 40;
+    default:
+        return 0;
+    }
+}
+
+/*
+ * Write a MRT record of type MRT_TYPE_LSPGEN.
+ */
+static bool
+lspgen_cache_write_record(lsdb_ctx_t *ctx, FILE *file, uint16_t subtype, io_buffer_t *buf)
+{
+    uint8_t mrt_hdr[12];
+
+    write_be_uint(mrt_hdr, 4, ctx->now); /* timestamp */
+    write_be_uint(mrt_hdr+4, 2, MRT_TYPE_LSPGEN); /* type */
+    write_be_uint(mrt_hdr+6, 2, subtype); /* subtype */
+    write_be_uint(mrt_hdr+8, 4, buf->idx); /* length */
+
+    if (fwrite(mrt_hdr, sizeof(mrt_hdr), 1, file) != 1) {
+        return false;
+    }
+    if (buf->idx && fwrite(buf->data, buf->idx, 1, file) != 1) {
+        return false;
+    }
+    return true;
+}
+
+static bool
+lspgen_cache_write_header(lsdb_ctx_t *ctx, FILE *file)
+{
+    io_buffer_t buf;
+    uint8_t data[LSPGEN_CACHE_HEADER_LEN];
+    uint32_t bom;
+
+    memset(&buf, 0, sizeof(buf));
+    buf.data = data;
+    buf.size = sizeof(data);
+
+    push_be_uint(&buf, 4, LSPGEN_CACHE_MAGIC);
+    push_be_uint(&buf, 2, LSPGEN_CACHE_VERSION);
+    push_be_uint(&buf, 1, ctx->protocol_id);
+    push_be_uint(&buf, 1, 0); /* reserved */
+    bom = LSPGEN_CACHE_BOM;
+    push_data(&buf, (uint8_t *)&bom, sizeof(bom));
+    push_be_uint(&buf, 2, LSPGEN_CACHE_ATTR_KEY_LEN);
+    push_be_uint(&buf, 2, LSPGEN_CACHE_LINK_KEY_LEN);
+    push_be_uint(&buf, 8, ctx->cache_digest);
+    push_data(&buf, ctx->root_node_id, LSDB_MAX_NODE_ID_SIZE);
+    push_be_uint(&buf, 4, ctx->node_index);
+    push_be_uint(&buf, 4, ctx->link_index);
+    push_be_uint(&buf, 4, ctx->nodecount);
+    push_be_uint(&buf, 4, ctx->linkcount);
+    push_be_uint(&buf, 4, 0); /* reserved */
+
+    return lspgen_cache_write_record(ctx, file, LSPGEN_CACHE_HEADER, &buf);
+}
+
+/*
+ * Write the node record, which includes all attributes and
+ * the list of packets which follow as protocol MRT records.
+ */
+static bool
+lspgen_cache_write_node(lsdb_ctx_t *ctx, lsdb_node_t *node, FILE *file)
+{
+    struct lsdb_attr_ *attr;
+    struct lsdb_packet_ *packet;
+    dict_itor *itor;
+    io_buffer_t buf;
+    uint32_t attr_count, packet_count, ip_hdr_len, name_len;
+    uint8_t flags;
+    bool res;
+
+    attr_count = node->attr_dict ? dict_count(node->attr_dict) : 0;
+    packet_count = node->packet_dict ? dict_count(node->packet_dict) : 0;
+    ip_hdr_len = lspgen_cache_ip_hdr_len(ctx);
+    name_len = node->node_name ? strnlen(node->node_name, UINT8_MAX) : 0;
+
+    memset(&buf, 0, sizeof(buf));
+    buf.size = LSPGEN_CACHE_NODE_LEN + name_len +
+               attr_count * (LSPGEN_CACHE_ATTR_KEY_LEN + 4) +
+               packet_count * (5 + ip_hdr_len);
+    buf.data = malloc(buf.size);
+    if (!buf.data) {
+        return false;
+    }
+
+    flags = 0;
+    if (node->overload) flags |= LSPGEN_CACHE_OVERLOAD;
+    if (node->attach) flags |= LSPGEN_CACHE_ATTACH;
+    if (node->is_direct_neighbor) flags |= LSPGEN_CACHE_DIRECT_NEIGHBOR;
+    if (node->is_pseudonode) flags |= LSPGEN_CACHE_PSEUDONODE;
+    if (node->is_local_pseudonode) flags |= LSPGEN_CACHE_LOCAL_PSEUDONODE;
+    if (node->is_root) flags |= LSPGEN_CACHE_ROOT;
+
+    push_data(&buf, node->key.node_id, LSDB_MAX_NODE_ID_SIZE);
+    push_be_uint(&buf, 4, node->node_index);
+    push_be_uint(&buf, 4, node->sequence);
+    push_be_uint(&buf, 2, node->lsp_lifetime);
+    push_be_uint(&buf, 2, node->lsp_buffer_size);
+    push_be_uint(&buf, 1, flags);
+    push_be_uint(&buf, 1, name_len);
+    if (name_len) {
+        push_data(&buf, (uint8_t *)node->node_name, name_len);
+    }
+
+    /*
+     * Attributes, the key is stored in host representation.
+     */
+    push_be_uint(&buf, 4, attr_count);
+    if (attr_count) {
+        itor = dict_itor_new(node->attr_dict);
+        if (itor && dict_itor_first(itor)) {
+            do {
+                attr = *dict_itor_datum(itor);
+                push_data(&buf, (uint8_t *)&attr->key, LSPGEN_CACHE_ATTR_KEY_LEN);
+                push_be_uint(&buf, 4, attr->size);
+            } while (dict_itor_next(itor));
+        }
+        dict_itor_free(itor);
+    }
+
+    /*
+     * Packets, the IP header is not part of the protocol
+     * MRT record, hence store it along with the packet id.
+     */
+    push_be_uint(&buf, 4, packet_count);
+    if (packet_count) {
+        itor = dict_itor_new(node->packet_dict);
+        if (itor && dict_itor_first(itor)) {
+            do {
+                packet = *dict_itor_datum(itor);
+                push_be_uint(&buf, 4, packet->key.id);
+                push_be_uint(&buf, 1, ip_hdr_len);
+                if (ip_hdr_len) {
+                    push_data(&buf, packet->data, ip_hdr_len);
+                }
+            } while (dict_itor_next(itor));
+        }
+        dict_itor_free(itor);
+    }
+
+    res = lspgen_cache_write_record(ctx, file, LSPGEN_CACHE_NODE, &buf);
+    free(buf.data);
+    return res;
+}
+
+static bool
+lspgen_cache_write_links(lsdb_ctx_t *ctx, lsdb_node_t *node, FILE *file)
+{
+    struct lsdb_link_ *link;
+    io_buffer_t buf;
+    bool res;
+
+    memset(&buf, 0, sizeof(buf));
+    buf.size = 4 + node->linkcount * (LSPGEN_CACHE_LINK_KEY_LEN + 8);
+    buf.data = malloc(buf.size);
+    if (!buf.data) {
+        return false;
+    }
+
+    push_be_uint(&buf, 4, node->linkcount);
+    CIRCLEQ_FOREACH(link, &node->link_qhead, link_qnode) {
+        push_data(&buf, (uint8_t *)&link->key, LSPGEN_CACHE_LINK_KEY_LEN);
+        push_be_uint(&buf, 4, link->link_index);
+        push_be_uint(&buf, 4, link->link_metric);
+    }
+
+    res = lspgen_cache_write_record(ctx, file, LSPGEN_CACHE_LINKS, &buf);
+    free(buf.data);
+    return res;
+}
+
+/*
+ * Walk the LSDB and write the cache file.
+ * The file is written to a temporary file first and then
+ * renamed, such that readers never see a partial file.
+ */
+void
+lspgen_write_cache(lsdb_ctx_t *ctx)
+{
+    struct lsdb_node_ *node;
+    dict_itor *itor;
+    char tmp_filename[PATH_MAX];
+    FILE *file;
+    bool res;
+
+    snprintf(tmp_filename, sizeof(tmp_filename), "%s.tmp", ctx->cache_filename);
+    file = fopen(tmp_filename, "w");
+    if (!file) {
+        LOG(ERROR, "Error opening cache file %s\n", tmp_filename);
+        return;
+    }
+
+    time(&ctx->now);
+
+    res = lspgen_cache_write_header(ctx, file);
+
+    /*
+     * Walk the node DB.
+     */
+    itor = dict_itor_new(ctx->node_dict);
+    if (itor && dict_itor_first(itor)) {
+        do {
+            node = *dict_itor_datum(itor);
+            res = res && lspgen_cache_write_node(ctx, node, file);
+            res = res && lspgen_cache_write_links(ctx, node, file);
+            if (res && node->packet_dict) {
+                lspgen_dump_mrt_node(ctx, node, file);
+            }
+        } while (res && dict_itor_next(itor));
+    }
+    dict_itor_free(itor);
+
+    if (ferror(file)) {
+        res = false;
+    }
+    if (fclose(file) != 0) {
+        res = false;
+    }
+    if (!res || rename(tmp_filename, ctx->cache_filename) != 0) {
+        LOG(ERROR, "Error writing cache file %s\n", ctx->cache_filename);
+        unlink(tmp_filename);
+        return;
+    }
+
+    LOG(NORMAL, "Wrote %u nodes to cache file %s\n", ctx->nodecount, ctx->cache_filename);
+}
+
+/*
+ * Cursor over the records of the mapped cache file.
+ */
+typedef struct lspgen_cache_cursor_ {
+    uint8_t *map;
+    size_t size;
+    size_t offset;
+
+    /* current record */
+    uint16_t type;
+    uint16_t subtype;
+    uint32_t length;
+    uint8_t *data;
+} lspgen_cache_cursor_t;
+
+static bool
+lspgen_cache_next_record(lspgen_cache_cursor_t *cursor)
+{
+    uint8_t *hdr;
+
+    if (cursor->size - cursor->offset < 12) {
+        return false;
+    }
+    hdr = cursor->map + cursor->offset;
+    cursor->type = read_be_uint(hdr+4, 2);
+    cursor->subtype = read_be_uint(hdr+6, 2);
+    cursor->length = read_be_uint(hdr+8, 4);
+    if (cursor->size - cursor->offset - 12 < cursor->length) {
+        return false;
+    }
+    cursor->data = hdr + 12;
+    cursor->offset += 12 + cursor->length;
+    return true;
+}
+
+/*
+ * Bounds checked reader for the record payload.
+ */
+typedef struct lspgen_cache_reader_ {
+    uint8_t *data;
+    uint32_t length;
+    uint32_t idx;
+    bool error;
+} lspgen_cache_reader_t;
+
+static uint8_t *
+lspgen_cache_read_data(lspgen_cache_reader_t *reader, uint32_t length)
+{
+    uint8_t *data;
+
+    if (reader->error || reader->length - reader->idx < length) {
+        reader->error = true;
+        return NULL;
+    }
+    data = reader->data + reader->idx;
+    reader->idx += length;
+    return data;
+}
+
+static uint64_t
+lspgen_cache_read_uint(lspgen_cache_reader_t *reader, uint32_t length)
+{
+    uint8_t *data;
+
+    data = lspgen_cache_read_data(reader, length);
+    if (!data) {
+        return 0;
+    }
+    return read_be_uint(data, length);
+}
+
+static void
+lspgen_cache_reader_init(lspgen_cache_reader_t *reader, lspgen_cache_cursor_t *cursor)
+{
+    reader->data = cursor->data;
+    reader->length = cursor->length;
+    reader->idx = 0;
+    reader->error = false;
+}
+
+/*
+ * Add an attribute without re-calculating its size.
+ */
+static bool
+lspgen_cache_add_attr(lsdb_node_t *node, uint8_t *key, uint32_t size)
+{
+    struct lsdb_attr_ *attr;
+    dict_insert_result result;
+
+    attr = calloc(1, sizeof(struct lsdb_attr_));
+    if (!attr) {
+        return false;
+    }
+    memcpy(&attr->key, key, sizeof(attr->key));
+    attr->size = size;
+    attr->parent = node;
+
+    result = dict_insert(node->attr_dict, &attr->key);
+    if (!result.inserted) {
+        free(attr);
+        return false;
+    }
+    *result.datum_ptr = attr;
+    node->attr_count++;
+    return true;
+}
+
+/*
+ * Add a packet from a protocol MRT record.
+ */
+static bool
+lspgen_cache_add_packet(lsdb_ctx_t *ctx, lsdb_node_t *node, uint32_t id,
+                        uint8_t *ip_hdr, uint32_t ip_hdr_len,
+                        lspgen_cache_cursor_t *cursor)
+{
+    struct lsdb_packet_ *packet;
+    dict_insert_result result;
+    uint32_t skip, expected_type;
+
+    switch (ctx->protocol_id) {
+    case PROTO_ISIS:
+        expected_type = MRT_TYPE_ISIS;
+        skip = 0;
+        break;
+    case PROTO_OSPF2:
+        expected_type = MRT_TYPE_OSPFV2;
+        skip = 8; /* remote and local IPv4 address */
+        break;
+    case PROTO_OSPF3:
+        expected_type = MRT_TYPE_OSPFV3;
+        skip = 34; /* address family, remote and local IPv6 address */
+        break;
+    default:
+        return false;
+    }
+    if (cursor->type != expected_type || cursor->length < skip ||
+        ip_hdr_len + cursor->length - skip > sizeof(packet->data)) {
+        return false;
+    }
+
+    packet = calloc(1, sizeof(struct lsdb_packet_));
+    if (!packet) {
+        return false;
+    }
+    packet->key.id = id;
+    result = dict_insert(node->packet_dict, &packet->key);
+    if (!result.inserted) {
+        free(packet);
+        return false;
+    }
+    *result.datum_ptr = packet;
+    packet->parent = node;
+
+    lspgen_reset_packet_buffer(packet);
+    if (ip_hdr_len) {
+        push_data(&packet->buf[0], ip_hdr, ip_hdr_len);
+    }
+    push_data(&packet->buf[0], cursor->data + skip, cursor->length - skip);
+
+    /*
+     * Loaded packets get enqueued to the packet change list.
+     */
+    packet->changed = true;
+    return true;
+}
+
+static bool
+lspgen_cache_read_node(lsdb_ctx_t *ctx, lspgen_cache_cursor_t *cursor)
+{
+    struct lsdb_node_ node_template;
+    struct lsdb_node_ *node;
+    struct lsdb_link_ link_template;
+    struct lsdb_link_ *link;
+    lspgen_cache_reader_t reader;
+    uint32_t count, idx, id, size, ip_hdr_len, node_index;
+    uint8_t *key, *ip_hdr, *name, flags, name_len;
+    char node_name[UINT8_MAX+1];
+    lspgen_cache_reader_t packets;
+
+    lspgen_cache_reader_init(&reader, cursor);
+
+    memset(&node_template, 0, sizeof(node_template));
+    key = lspgen_cache_read_data(&reader, LSDB_MAX_NODE_ID_SIZE);
+    if (!key) {
+        return false;
+    }
+    memcpy(node_template.key.node_id, key, LSDB_MAX_NODE_ID_SIZE);
+    node_index = lspgen_cache_read_uint(&reader, 4);
+    node_template.sequence = lspgen_cache_read_uint(&reader, 4);
+    node_template.lsp_lifetime = lspgen_cache_read_uint(&reader, 2);
+    node_template.lsp_buffer_size = lspgen_cache_read_uint(&reader, 2);
+    flags = lspgen_cache_read_uint(&reader, 1);
+    name_len = lspgen_cache_read_uint(&reader, 1);
+    name = lspgen_cache_read_data(&reader, name_len);
+    if (reader.error) {
+        return false;
+    }
+    if (name_len) {
+        memcpy(node_name, name, name_len);
+        node_name[name_len] = 0;
+        node_template.node_name = node_name;
+    }
+
+    node = lsdb_add_node(ctx, &node_template);
+    if (!node) {
+        return false;
+    }
+    node->node_index = node_index;
+    node->lsp_buffer_size = node_template.lsp_buffer_size;
+    node->overload = flags & LSPGEN_CACHE_OVERLOAD ? true : false;
+    node->attach = flags & LSPGEN_CACHE_ATTACH ? true : false;
+    node->is_direct_neighbor = flags & LSPGEN_CACHE_DIRECT_NEIGHBOR ? true : false;
+    node->is_pseudonode = flags & LSPGEN_CACHE_PSEUDONODE ? true : false;
+    node->is_local_pseudonode = flags & LSPGEN_CACHE_LOCAL_PSEUDONODE ? true : false;
+    node->is_root = flags & LSPGEN_CACHE_ROOT ? true : false;
+
+    /*
+     * Attributes.
+     */
+    count = lspgen_cache_read_uint(&reader, 4);
+    if (count && !node->attr_dict) {
+        node->attr_dict = hb_dict_new((dict_compare_func)lsdb_compare_attr);
+    }
+    for (idx = 0; idx < count; idx++) {
+        key = lspgen_cache_read_data(&reader, LSPGEN_CACHE_ATTR_KEY_LEN);
+        size = lspgen_cache_read_uint(&reader, 4);
+        if (reader.error || !lspgen_cache_add_attr(node, key, size)) {
+            return false;
+        }
+    }
+
+    /*
+     * The packet list is read once the links have been loaded.
+     */
+    packets = reader;
+    count = lspgen_cache_read_uint(&packets, 4);
+    if (packets.error) {
+        return false;
+    }
+
+    /*
+     * Links.
+     */
+    if (!lspgen_cache_next_record(cursor) ||
+        cursor->type != MRT_TYPE_LSPGEN || cursor->subtype != LSPGEN_CACHE_LINKS) {
+        return false;
+    }
+    lspgen_cache_reader_init(&reader, cursor);
+    size = lspgen_cache_read_uint(&reader, 4);
+    for (idx = 0; idx < size; idx++) {
+        memset(&link_template, 0, sizeof(link_template));
+        key = lspgen_cache_read_data(&reader, LSPGEN_CACHE_LINK_KEY_LEN);
+        if (!key) {
+            return false;
+        }
+        memcpy(&link_template.key, key, sizeof(link_template.key));
+        link_template.link_index = lspgen_cache_read_uint(&reader, 4);
+        link_template.link_metric = lspgen_cache_read_uint(&reader, 4);
+        if (reader.error) {
+            return false;
+        }
+        link = lsdb_add_link(ctx, node, &link_template);
+        if (!link) {
+            return false;
+        }
+        link->link_index = link_template.link_index;
+    }
+
+    /*
+     * Packets.
+     */
+    if (count && !node->packet_dict) {
+        node->packet_dict = hb_dict_new((dict_compare_func)lsdb_compare_packet);
+    }
+    for (idx = 0; idx < count; idx++) {
+        id = lspgen_cache_read_uint(&packets, 4);
+        ip_hdr_len = lspgen_cache_read_uint(&packets, 1);
+        ip_hdr = lspgen_cache_read_data(&packets, ip_hdr_len);
+        if (packets.error || ip_hdr_len != lspgen_cache_ip_hdr_len(ctx)) {
+            return false;
+        }
+        if (!lspgen_cache_next_record(cursor) ||
+            !lspgen_cache_add_packet(ctx, node, id, ip_hdr, ip_hdr_len, cursor)) {
+            return false;
+        }
+    }
+
+    node->dirty = 0;
+    return true;
+}
+
+/*
+ * Read the header record and check if the cache file
+ * matches the current parameters.
+ */
+static bool
+lspgen_cache_read_header(lsdb_ctx_t *ctx, lspgen_cache_cursor_t *cursor)
+{
+    lspgen_cache_reader_t reader;
+    uint8_t *bom, *root_node_id;
+    uint32_t magic, version, protocol_id, attr_key_len, link_key_len;
+    uint64_t digest;
+
+    if (!lspgen_cache_next_record(cursor) ||
+        cursor->type != MRT_TYPE_LSPGEN || cursor->subtype != LSPGEN_CACHE_HEADER) {
+        LOG(ERROR, "Invalid cache file %s\n", ctx->cache_filename);
+        return false;
+    }
+
+    lspgen_cache_reader_init(&reader, cursor);
+    magic = lspgen_cache_read_uint(&reader, 4);
+    version = lspgen_cache_read_uint(&reader, 2);
+    protocol_id = lspgen_cache_read_uint(&reader, 1);
+    lspgen_cache_read_uint(&reader, 1); /* reserved */
+    bom = lspgen_cache_read_data(&reader, 4);
+    attr_key_len = lspgen_cache_read_uint(&reader, 2);
+    link_key_len = lspgen_cache_read_uint(&reader, 2);
+    digest = lspgen_cache_read_uint(&reader, 8);
+    root_node_id = lspgen_cache_read_data(&reader, LSDB_MAX_NODE_ID_SIZE);
+    if (reader.error || magic != LSPGEN_CACHE_MAGIC) {
+        LOG(ERROR, "Invalid cache file %s\n", ctx->cache_filename);
+        return false;
+    }
+    if (version != LSPGEN_CACHE_VERSION ||
+        *(uint32_t *)bom != LSPGEN_CACHE_BOM ||
+        attr_key_len != LSPGEN_CACHE_ATTR_KEY_LEN ||
+        link_key_len != LSPGEN_CACHE_LINK_KEY_LEN) {
+        LOG(NORMAL, "Cache file %s has been written by an incompatible version\n", ctx->cache_filename);
+        return false;
+    }
+    if (protocol_id != ctx->protocol_id || digest != ctx->cache_digest) {
+        LOG(NORMAL, "Cache file %s does not match the parameters\n", ctx->cache_filename);
+        return false;
+    }
+
+    memcpy(ctx->root_node_id, root_node_id, LSDB_MAX_NODE_ID_SIZE);
+    ctx->node_index = lspgen_cache_read_uint(&reader, 4);
+    ctx->link_index = lspgen_cache_read_uint(&reader, 4);
+    return true;
+}
+
+/*
+ * Load the LSDB and the serialized packets from the cache file.
+ * Returns false if there is no matching cache file,
+ * in which case the LSDB must be generated.
+ */
+bool
+lspgen_read_cache(lsdb_ctx_t *ctx)
+{
+    lspgen_cache_cursor_t cursor;
+    uint32_t node_index, link_index;
+    struct stat sb;
+    int fd;
+
+    /*
+     * The digest must be calculated before the generation,
+     * which modifies some of the parameters.
+     */
+    ctx->cache_digest = lspgen_cache_digest(ctx);
+
+    fd = open(ctx->cache_filename, O_RDONLY);
+    if (fd < 0) {
+        /* Probably no file found */
+        return false;
+    }
+    if (fstat(fd, &sb) < 0 || !sb.st_size) {
+        close(fd);
+        return false;
+    }
+
+    memset(&cursor, 0, sizeof(cursor));
+    cursor.size = sb.st_size;
+    cursor.map = mmap(NULL, cursor.size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (cursor.map == MAP_FAILED) {
+        LOG(ERROR, "Failed to map cache file %s (%s)\n", ctx->cache_filename, strerror(errno));
+        return false;
+    }
+    madvise(cursor.map, cursor.size, MADV_SEQUENTIAL);
+
+    if (!lspgen_cache_read_header(ctx, &cursor)) {
+        ctx->node_index = 0;
+        ctx->link_index = 0;
+        munmap(cursor.map, cursor.size);
+        return false;
+    }
+    node_index = ctx->node_index;
+    link_index = ctx->link_index;
+
+    while (cursor.offset < cursor.size) {
+        if (!lspgen_cache_next_record(&cursor) ||
+            cursor.type != MRT_TYPE_LSPGEN || cursor.subtype != LSPGEN_CACHE_NODE ||
+            !lspgen_cache_read_node(ctx, &cursor)) {
+            /*
+             * The LSDB is partially loaded at this point.
+             */
+            LOG(ERROR, "Invalid cache file %s, remove it to regenerate the LSDB\n", ctx->cache_filename);
+            exit(EXIT_FAILURE);
+        }
+    }
+    munmap(cursor.map, cursor.size);
+
+    ctx->node_index = node_index;
+    ctx->link_index = link_index;
+
+    LOG(NORMAL, "Read %u nodes and %u links from cache file %s\n",
+        ctx->nodecount, ctx->linkcount, ctx->cache_filename);
+    return true;
+}
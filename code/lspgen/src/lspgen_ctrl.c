@@ -7,6 +7,7 @@
  *
  * Copyright (C) 2015-2022, RtBrick, Inc.
  */
+#include <fcntl.h>
 #include "lspgen.h"
 #include "lspgen_lsdb.h"
 #include "lspgen_isis.h"
@@ -197,6 +198,36 @@ lspgen_ctrl_encode_packet(lsdb_ctx_t *ctx, lsdb_packet_t *packet)
     ctx->ctrl_stats.packets_sent++;
 }
 
+/*
+ * Encode a packet as binary PDU stream frame.
+ */
+static void
+lspgen_ctrl_encode_frame(lsdb_ctx_t *ctx, lsdb_packet_t *packet)
+{
+    struct io_buffer_ *buf, *src_buf;
+    uint32_t idx;
+
+    buf = &ctx->ctrl_io_buf;
+
+    idx = 0;
+    if (ctx->protocol_id == PROTO_OSPF2) {
+        /* Omit the IPv4 header (the first 20 bytes). */
+        idx = 20;
+    } else if (ctx->protocol_id == PROTO_OSPF3) {
+        /* Omit the IPv6 header (the first 40 bytes). */
+        idx = 40;
+    }
+
+    src_buf = &packet->buf[0];
+    if (src_buf->idx <= idx) {
+        return;
+    }
+    push_be_uint(buf, 2, src_buf->idx - idx); /* length */
+    push_data(buf, src_buf->data + idx, src_buf->idx - idx);
+
+    ctx->ctrl_stats.packets_sent++;
+}
+
 void
 lspgen_ctrl_close_cb(timer_s *timer)
 {
@@ -244,6 +275,86 @@ lspgen_buffer_is_empty (lsdb_ctx_t *ctx) {
     }
 }
 
+/*
+ * Write the change queue as binary PDU stream.
+ *
+ * Unlike the JSON encoding, the stream is not limited to a single buffer.
+ * The buffer gets refilled as long as the socket accepts data.
+ * If the socket is full, the next run of the write timer continues.
+ */
+static void
+lspgen_ctrl_write_stream(lsdb_ctx_t *ctx)
+{
+    struct lsdb_packet_ *packet;
+    uint32_t protocol;
+
+    while (true) {
+        lspgen_write_ctrl_buffer(ctx);
+        if (!lspgen_buffer_is_empty(ctx)) {
+            /* Back-pressure, socket is full. */
+            return;
+        }
+
+        if (ctx->ctrl_stream_end) {
+            timer_del(ctx->ctrl_socket_write_timer);
+
+            LOG(NORMAL, "Sent %u packets, %u bytes to %s\n",
+                ctx->ctrl_stats.packets_sent,
+                ctx->ctrl_stats.octets_sent,
+                ctx->ctrl_socket_path);
+
+            /*
+             * For once, close the connection.
+             */
+            timer_add(&ctx->timer_root, &ctx->ctrl_socket_close_timer, "close",
+                      1, 0, ctx, &lspgen_ctrl_close_cb);
+            return;
+        }
+
+        if (ctx->ctrl_packet_first) {
+            /*
+             * Write stream header.
+             */
+            if (ctx->protocol_id == PROTO_ISIS) {
+                protocol = CTRL_PDU_STREAM_ISIS;
+            } else if (ctx->protocol_id == PROTO_OSPF2 || ctx->protocol_id == PROTO_OSPF3) {
+                protocol = CTRL_PDU_STREAM_OSPF;
+            } else {
+                LOG_NOARG(ERROR, "Unknown protocol\n");
+                return;
+            }
+            push_be_uint(&ctx->ctrl_io_buf, 4, CTRL_PDU_STREAM_MAGIC);
+            push_be_uint(&ctx->ctrl_io_buf, 1, CTRL_PDU_STREAM_VERSION);
+            push_be_uint(&ctx->ctrl_io_buf, 1, protocol);
+            push_be_uint(&ctx->ctrl_io_buf, 2, ctx->ctrl_instance);
+            ctx->ctrl_packet_first = false;
+        }
+
+        /*
+         * Drain the change queue as long as there is buffer left.
+         */
+        while (!CIRCLEQ_EMPTY(&ctx->packet_change_qhead)) {
+            packet = CIRCLEQ_FIRST(&ctx->packet_change_qhead);
+            if (ctx->ctrl_io_buf.size - ctx->ctrl_io_buf.idx < sizeof(packet->data) + 2) {
+                break;
+            }
+            lspgen_ctrl_encode_frame(ctx, packet);
+
+            /*
+             * Packet got encoded, take packet off the change queue.
+             */
+            CIRCLEQ_REMOVE(&ctx->packet_change_qhead, packet, packet_change_qnode);
+            packet->on_change_list = false;
+            ctx->ctrl_stats.packets_queued--;
+        }
+
+        if (CIRCLEQ_EMPTY(&ctx->packet_change_qhead)) {
+            push_be_uint(&ctx->ctrl_io_buf, 2, 0); /* end of stream */
+            ctx->ctrl_stream_end = true;
+        }
+    }
+}
+
 void
 lspgen_ctrl_write_cb(timer_s *timer)
 {
@@ -254,6 +365,11 @@ lspgen_ctrl_write_cb(timer_s *timer)
 
     ctx = timer->data;
 
+    if (!ctx->ctrl_json) {
+        lspgen_ctrl_write_stream(ctx);
+        return;
+    }
+
     /*
      * First flush the ctrl socket buffer.
      */
@@ -404,6 +520,15 @@ lspgen_ctrl_connect_cb(timer_s *timer)
          * Write header before the first packet.
          */
         ctx->ctrl_packet_first = true;
+        ctx->ctrl_stream_end = false;
+
+        /*
+         * The binary PDU stream is written until the socket
+         * blocks, the write timer continues once there is space.
+         */
+        if (!ctx->ctrl_json) {
+            fcntl(ctx->ctrl_socket_sockfd, F_SETFL, O_NONBLOCK);
+        }
 
         LOG(NORMAL, "%u packets enqueued to %s\n", ctx->ctrl_stats.packets_queued, ctx->ctrl_socket_path);
         return;
@@ -1020,6 +1020,7 @@ lsdb_add_node_attr(lsdb_node_t *node, lsdb_attr_t *attr_template)
          */
         node->attr_count++;
 	attr->parent = node;
+	node->dirty |= LSDB_NODE_DIRTY_ATTR;
 
         LOG(LSDB, "  Add attr %s, size %u\n",
             lsdb_format_attr(ctx, attr),
@@ -1067,6 +1068,7 @@ lsdb_delete_ctx(struct lsdb_ctx_ *ctx)
     lsdb_free_name(&ctx->mrt_filename);
     lsdb_free_name(&ctx->stream_filename);
     lsdb_free_name(&ctx->config_filename);
+    lsdb_free_name(&ctx->cache_filename);
     lsdb_free_name(&ctx->ctrl_socket_path);
     lsdb_free_name(&ctx->authentication_key);
 
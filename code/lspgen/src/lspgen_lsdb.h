@@ -24,6 +24,13 @@
 
 #define LSP_LIFETIME_MIN 120 /* secs */
 
+/*
+ * Node dirty flags. Attribute changes require re-serialization,
+ * sequence number changes are patched into the serialized packets.
+ */
+#define LSDB_NODE_DIRTY_ATTR 0x01
+#define LSDB_NODE_DIRTY_SEQ  0x02
+
 typedef enum {
     PROTO_UNKNOWN = 0,
     PROTO_ISIS = 1,
@@ -89,6 +96,7 @@ typedef struct lsdb_ctx_
     bool purge;
     uint16_t lsp_lifetime;
     uint16_t lsp_buffer_size;
+    uint32_t num_threads; /* worker threads for attribute and packet generation */
 
     uint32_t node_index;
     uint32_t link_index;
@@ -111,6 +119,8 @@ typedef struct lsdb_ctx_
     struct io_buffer_ ctrl_io_buf;
     int ctrl_socket_sockfd;
     bool ctrl_packet_first;
+    bool ctrl_json; /* Hex encoded PDUs in JSON commands instead of binary PDU stream */
+    bool ctrl_stream_end; /* End of binary PDU stream has been written */
     bool quit_loop; /* Terminate loop after draining the LSDB */
     struct {
     uint32_t octets_sent;
@@ -128,6 +138,9 @@ typedef struct lsdb_ctx_
     bool config_read;
     bool config_write;
     FILE *seq_cache_file;       /* File handle for sequence number cache file. */
+    char *cache_filename;       /* File name for the binary LSDB cache. */
+    uint64_t cache_digest;      /* Digest of the parameters of the cache file. */
+    bool cache_loaded;          /* LSDB has been loaded from the cache file. */
 } lsdb_ctx_t;
 
 /*
@@ -153,6 +166,11 @@ typedef struct lsdb_node_ {
 
     timer_s *refresh_timer;
 
+    /*
+     * Dirty flags for incremental LSP generation.
+     */
+    uint8_t dirty;
+
     /*
      * List of links
      */
@@ -325,6 +343,9 @@ typedef struct lsdb_packet_ {
     CIRCLEQ_ENTRY(lsdb_packet_ ) packet_change_qnode;
     struct lsdb_node_ *parent;
     bool on_change_list;
+    bool stale; /* not yet re-serialized */
+    bool changed; /* content changed by last serialization */
+    uint64_t digest; /* digest of last serialized packet */
 
     /*
      * Key in the dict
@@ -365,6 +386,7 @@ void lsdb_delete_ctx(lsdb_ctx_t *);
 void lsdb_dump_graphviz(lsdb_ctx_t *);
 int lsdb_compare_node(void *, void *);
 int lsdb_compare_link(void *, void *);
+int lsdb_compare_attr(void *, void *);
 int lsdb_compare_packet(void *, void *);
 void lsdb_free_packet(void *, void *);
 void lsdb_free_attr(void *, void *);
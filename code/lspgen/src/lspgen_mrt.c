@@ -12,16 +12,11 @@
 #include "lspgen_lsdb.h"
 #include "lspgen_isis.h"
 
-/* https://datatracker.ietf.org/doc/html/rfc6396#section-4 */
-#define MRT_TYPE_OSPFV2 11
-#define MRT_TYPE_OSPFV3 48
-#define MRT_TYPE_ISIS   32
-
 /*
  * Write all the generated LSPs of a single node into a MRT file.
  */
 void
-lspgen_dump_mrt_node(lsdb_ctx_t *ctx, lsdb_node_t *node)
+lspgen_dump_mrt_node(lsdb_ctx_t *ctx, lsdb_node_t *node, FILE *file)
 {
     struct lsdb_packet_ *packet;
     dict_itor *itor;
@@ -120,7 +115,7 @@ lspgen_dump_mrt_node(lsdb_ctx_t *ctx, lsdb_node_t *node)
         length = buf.idx-12;
         write_be_uint(buf.data+8, 4, length); /* overwrite length field */
 
-        fwrite(buf.data, buf.idx, 1, ctx->mrt_file);
+        fwrite(buf.data, buf.idx, 1, file);
 
         LOG(DEBUG, "wrote %u bytes mrt packet data\n", buf.idx);
     } while (dict_itor_next(itor));
@@ -163,7 +158,7 @@ lspgen_dump_mrt(lsdb_ctx_t *ctx)
 
     do {
         node = *dict_itor_datum(itor);
-        lspgen_dump_mrt_node(ctx, node);
+        lspgen_dump_mrt_node(ctx, node, ctx->mrt_file);
     } while (dict_itor_next(itor));
     dict_itor_free(itor);
 
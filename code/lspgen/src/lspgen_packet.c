@@ -19,6 +19,7 @@
 void lspgen_gen_packet_node(lsdb_node_t *);
 void lspgen_serialize_ospf2_state(lsdb_attr_t *, lsdb_packet_t *, uint16_t);
 void lspgen_serialize_ospf3_state(lsdb_attr_t *, lsdb_packet_t *, uint16_t);
+void lspgen_update_isis_packet(lsdb_ctx_t *, lsdb_node_t *, lsdb_packet_t *);
 
 void
 lspgen_gen_isis_packet_header(lsdb_ctx_t *ctx, lsdb_node_t *node, lsdb_packet_t *packet)
@@ -191,7 +192,6 @@ void
 lspgen_finalize_isis_packet(lsdb_ctx_t *ctx, lsdb_node_t *node, lsdb_packet_t *packet)
 {
     struct io_buffer_ *buf;
-    uint16_t checksum, lsp_lifetime;
     uint8_t auth_len;
 
     buf = &packet->buf[0];
@@ -217,14 +217,37 @@ lspgen_finalize_isis_packet(lsdb_ctx_t *ctx, lsdb_node_t *node, lsdb_packet_t *p
         if (ctx->authentication_type == ISIS_AUTH_MD5) {
             push_be_uint(buf, 8, 0);
             push_be_uint(buf, 8, 0);
-            /* Update PDU length field. */
-            write_be_uint(packet->data+8, 2, buf->idx);
-            hmac_md5(buf->data, buf->idx,
-                (unsigned char *)ctx->authentication_key, strlen(ctx->authentication_key),
-                buf->data+buf->idx-16);
         }
     }
 
+    lspgen_update_isis_packet(ctx, node, packet);
+}
+
+/*
+ * Calculate HMAC, remaining lifetime and checksum of a serialized IS-IS LSP.
+ * The authentication TLV must be already present at the end of the LSP.
+ */
+void
+lspgen_update_isis_packet(lsdb_ctx_t *ctx, lsdb_node_t *node, lsdb_packet_t *packet)
+{
+    struct io_buffer_ *buf;
+    uint16_t checksum, lsp_lifetime;
+
+    buf = &packet->buf[0];
+
+    /*
+     * Calculate HMAC with zero lifetime and checksum.
+     */
+    if (ctx->authentication_key && ctx->authentication_type == ISIS_AUTH_MD5) {
+        write_be_uint(packet->data+8, 2, buf->idx); /* Update PDU length field. */
+        write_be_uint(packet->data+10, 2, 0);
+        write_be_uint(packet->data+24, 2, 0);
+        memset(buf->data+buf->idx-16, 0, 16);
+        hmac_md5(buf->data, buf->idx,
+            (unsigned char *)ctx->authentication_key, strlen(ctx->authentication_key),
+            buf->data+buf->idx-16);
+    }
+
     /*
      * Set remaining lifetime
      */
@@ -279,6 +302,41 @@ lspgen_close_all_message_levels (lsdb_packet_t *packet)
     return state;
 }
 
+/*
+ * FNV-1a digest of a serialized packet.
+ */
+static uint64_t
+lspgen_packet_digest(lsdb_packet_t *packet)
+{
+    uint64_t digest;
+    uint32_t idx;
+
+    digest = 0xcbf29ce484222325;
+    for (idx = 0; idx < packet->buf[0].idx; idx++) {
+	digest ^= packet->data[idx];
+	digest *= 0x100000001b3;
+    }
+    return digest;
+}
+
+/*
+ * Mark a serialized packet as changed, if its content has changed.
+ * Changed packets get enqueued by lspgen_queue_node_packets().
+ */
+static void
+lspgen_commit_packet(lsdb_packet_t *packet)
+{
+    uint64_t digest;
+
+    digest = lspgen_packet_digest(packet);
+    if (digest == packet->digest) {
+	packet->changed = false;
+	return;
+    }
+    packet->digest = digest;
+    packet->changed = true;
+}
+
 void
 lspgen_finalize_packet(lsdb_ctx_t *ctx, lsdb_node_t *node, lsdb_packet_t *packet)
 {
@@ -294,7 +352,79 @@ lspgen_finalize_packet(lsdb_ctx_t *ctx, lsdb_node_t *node, lsdb_packet_t *packet
 	break;
     default:
 	LOG_NOARG(ERROR, "Unknown protocol\n");
+	return;
+    }
+    lspgen_commit_packet(packet);
+}
+
+/*
+ * Patch the sequence number of all LSAs of a serialized OSPF LS-Update packet
+ * and recalculate the LSA and packet checksums.
+ */
+static void
+lspgen_update_ospf_packet_seq(lsdb_ctx_t *ctx, lsdb_node_t *node, lsdb_packet_t *packet)
+{
+    io_buffer_t *buf;
+    uint32_t ip_hdr_len, lsa_idx, lsa_count, lsa_len;
+    uint16_t checksum;
+    uint8_t *lsa;
+
+    buf = &packet->buf[0];
+    if (ctx->protocol_id == PROTO_OSPF2) {
+	ip_hdr_len = 20;
+	lsa_idx = ip_hdr_len + 24;
+    } else {
+	ip_hdr_len = 40;
+	lsa_idx = ip_hdr_len + 16;
+    }
+    if (buf->idx < lsa_idx + 4) {
+	return;
+    }
+    lsa_count = read_be_uint(buf->data+lsa_idx, 4);
+    lsa_idx += 4;
+
+    while (lsa_count-- && lsa_idx + 20 <= buf->idx) {
+	lsa = buf->data+lsa_idx;
+	lsa_len = read_be_uint(lsa+18, 2);
+	if (lsa_len < 20 || lsa_idx + lsa_len > buf->idx) {
+	    break;
+	}
+	write_be_uint(lsa+12, 4, node->sequence); /* Sequence */
+	write_be_uint(lsa+16, 2, 0); /* reset checksum field */
+	checksum = calculate_fletcher_checksum(lsa+2, 14, lsa_len-2);
+	write_be_uint(lsa+16, 2, checksum); /* LSA Checksum */
+	lsa_idx += lsa_len;
+    }
+
+    write_be_uint(buf->data+ip_hdr_len+12, 2, 0); /* reset checksum field */
+    if (ctx->protocol_id == PROTO_OSPF2) {
+	write_be_uint(buf->data+20+12, 2, calculate_cksum(buf->data+20, buf->idx-20));
+    } else {
+	write_le_uint(buf->data+40+12, 2, calculate_ospf3_cksum(buf->data, buf->idx));
+    }
+}
+
+/*
+ * Patch the current node sequence number into an already serialized packet.
+ * This avoids re-serialization of all attributes if only the sequence number changes.
+ */
+static void
+lspgen_update_packet_seq(lsdb_ctx_t *ctx, lsdb_node_t *node, lsdb_packet_t *packet)
+{
+    switch (ctx->protocol_id) {
+    case PROTO_ISIS:
+	write_be_uint(packet->data+20, 4, node->sequence); /* Sequence */
+	lspgen_update_isis_packet(ctx, node, packet);
+	break;
+    case PROTO_OSPF2: /* fall through */
+    case PROTO_OSPF3:
+	lspgen_update_ospf_packet_seq(ctx, node, packet);
+	break;
+    default:
+	LOG_NOARG(ERROR, "Unknown protocol\n");
+	return;
     }
+    lspgen_commit_packet(packet);
 }
 
 bool
@@ -1637,54 +1767,56 @@ lspgen_add_packet(lsdb_ctx_t *ctx, lsdb_node_t *node, uint32_t id)
 
     packet_template.key.id = id;
     p = dict_search(node->packet_dict, &packet_template.key);
-    if (!p) {
+    if (p) {
+        packet = *p;
+        if (packet->stale) {
 
-        packet = calloc(1, sizeof(struct lsdb_packet_));
-        if (!packet) {
-            return NULL;
-        }
-
-        /*
-        * Insert packet into dictionary hanging off a node.
-        */
-        packet->key.id = id;
-        result = dict_insert(node->packet_dict, &packet->key);
-        if (!result.inserted) {
-            free(packet);
-            return NULL;
+            /*
+             * Re-serialize into the existing packet.
+             */
+            packet->stale = false;
+            lspgen_reset_packet_buffer(packet);
+            lspgen_gen_packet_header(ctx, node, packet);
         }
-        *result.datum_ptr = packet;
+        return packet;
+    }
 
-        /*
-        * Enqueue the packet to the packet change list.
-        */
-        CIRCLEQ_INSERT_TAIL(&ctx->packet_change_qhead, packet, packet_change_qnode);
-        packet->on_change_list = true;
-	ctx->ctrl_stats.packets_queued++;
+    packet = calloc(1, sizeof(struct lsdb_packet_));
+    if (!packet) {
+        return NULL;
+    }
 
-        /*
-        * Parent
-        */
-        packet->parent = node;
+    /*
+     * Insert packet into dictionary hanging off a node.
+     */
+    packet->key.id = id;
+    result = dict_insert(node->packet_dict, &packet->key);
+    if (!result.inserted) {
+        free(packet);
+        return NULL;
+    }
+    *result.datum_ptr = packet;
 
-	/*
-	 * Reset buffers.
-	 */
-	lspgen_reset_packet_buffer(packet);
+    /*
+     * Parent
+     */
+    packet->parent = node;
 
-        /*
-        * Write header for link-state packet.
-        */
-        lspgen_gen_packet_header(ctx, node, packet);
+    /*
+     * Reset buffers.
+     */
+    lspgen_reset_packet_buffer(packet);
 
-        return packet;
-    }
+    /*
+     * Write header for link-state packet.
+     */
+    lspgen_gen_packet_header(ctx, node, packet);
 
-    return *p;
+    return packet;
 }
 
 /*
- * Refresh timer has expired. Bump the sequence number of the node and rebuild all fragments.
+ * Refresh timer has expired. Bump the sequence number of the node and update all fragments.
  */
 void
 lspgen_refresh_cb (timer_s *timer)
@@ -1696,9 +1828,10 @@ lspgen_refresh_cb (timer_s *timer)
     ctx = node->ctx;
 
     node->sequence++;
+    node->dirty |= LSDB_NODE_DIRTY_SEQ;
     LOG(LSDB, "Refresh LSP for %s, sequence 0x%0x\n", lsdb_format_node(node), node->sequence);
 
-    lspgen_gen_packet_node(node);
+    lspgen_update_node(node);
 
     /*
      * Set up a ctrl session to drain the refreshed LSPs.
@@ -1811,11 +1944,6 @@ lspgen_gen_isis_packet_node(lsdb_node_t *node)
     last_attr = 0;
     tlv_start_idx = 0;
 
-    /*
-     * Flush old serialized packets.
-     */
-    dict_clear(node->packet_dict, lsdb_free_packet);
-
     if (!node->attr_dict || ctx->purge) {
 
         /*
@@ -1843,14 +1971,6 @@ lspgen_gen_isis_packet_node(lsdb_node_t *node)
         return;
     }
 
-    /*
-     * Start refresh timer.
-     */
-    if (ctx->ctrl_socket_path) {
-    timer_add_periodic(&ctx->timer_root, &node->refresh_timer, "refresh",
-               lspgen_refresh_interval(ctx), 0, node, &lspgen_refresh_cb);
-    }
-
     do {
         attr = *dict_itor_datum(itor);
 
@@ -1923,11 +2043,6 @@ lspgen_gen_ospf_packet_node(lsdb_node_t *node)
     packet = NULL;
     id = 0;
 
-    /*
-     * Flush old serialized packets.
-     */
-    dict_clear(node->packet_dict, lsdb_free_packet);
-
     if (!node->attr_dict) {
         /*
          * No attributes. This is a purge.
@@ -1954,14 +2069,6 @@ lspgen_gen_ospf_packet_node(lsdb_node_t *node)
         return;
     }
 
-    /*
-     * Start refresh timer.
-     */
-    if (ctx->ctrl_socket_path) {
-	timer_add_periodic(&ctx->timer_root, &node->refresh_timer, "refresh",
-			   lspgen_refresh_interval(ctx), 0, node, &lspgen_refresh_cb);
-    }
-
     do {
         attr = *dict_itor_datum(itor);
 
@@ -2002,12 +2109,91 @@ lspgen_gen_ospf_packet_node(lsdb_node_t *node)
     dict_itor_free(itor);
 }
 
+/*
+ * Mark all serialized packets of a node as stale.
+ */
+static void
+lspgen_mark_stale_packets(lsdb_node_t *node)
+{
+    struct lsdb_packet_ *packet;
+    dict_itor *itor;
+
+    itor = dict_itor_new(node->packet_dict);
+    if (!itor) {
+        return;
+    }
+    if (dict_itor_first(itor)) {
+        do {
+            packet = *dict_itor_datum(itor);
+            packet->stale = true;
+        } while (dict_itor_next(itor));
+    }
+    dict_itor_free(itor);
+}
+
+/*
+ * Flush all packets which have not been re-serialized.
+ * IS-IS fragments are kept as empty fragments, such that the
+ * receiver replaces the old content. Stale OSPF packets are deleted.
+ */
+static void
+lspgen_flush_stale_packets(lsdb_ctx_t *ctx, lsdb_node_t *node)
+{
+    struct lsdb_packet_ *packet;
+    dict_itor *itor;
+    uint32_t stale_ids[MAX_OSPF_PACKET];
+    uint32_t stale_count, idx;
+    dict_remove_result removed;
+
+    itor = dict_itor_new(node->packet_dict);
+    if (!itor) {
+        return;
+    }
+    stale_count = 0;
+    if (dict_itor_first(itor)) {
+        do {
+            packet = *dict_itor_datum(itor);
+            if (packet->stale && stale_count < MAX_OSPF_PACKET) {
+                stale_ids[stale_count++] = packet->key.id;
+            }
+        } while (dict_itor_next(itor));
+    }
+    dict_itor_free(itor);
+
+    for (idx = 0; idx < stale_count; idx++) {
+        if (ctx->protocol_id == PROTO_ISIS) {
+            packet = lspgen_add_packet(ctx, node, stale_ids[idx]);
+            lspgen_finalize_packet(ctx, node, packet);
+        } else {
+            removed = dict_remove(node->packet_dict, &stale_ids[idx]);
+            if (removed.removed) {
+                lsdb_free_packet(NULL, removed.datum);
+            }
+        }
+    }
+}
+
+/*
+ * Serialize all packets of a node. Existing packets are re-used and
+ * only packets whose content has changed are marked as changed.
+ *
+ * This only modifies the node itself and may run in a worker thread.
+ */
 void
 lspgen_gen_packet_node(lsdb_node_t *node)
 {
     lsdb_ctx_t *ctx;
 
     ctx = node->ctx;
+
+    /*
+     * Init per-packet tree for this node.
+     */
+    if (!node->packet_dict) {
+        node->packet_dict = hb_dict_new((dict_compare_func)lsdb_compare_packet);
+    }
+    lspgen_mark_stale_packets(node);
+
     switch (ctx->protocol_id) {
     case PROTO_ISIS:
 	lspgen_gen_isis_packet_node(node);
@@ -2019,52 +2205,142 @@ lspgen_gen_packet_node(lsdb_node_t *node)
     default:
 	LOG_NOARG(ERROR, "Unknown protocol\n");
     }
+
+    lspgen_flush_stale_packets(ctx, node);
+    node->dirty &= ~LSDB_NODE_DIRTY_ATTR;
 }
 
 /*
- * Walk the graph of the LSDB and serialize packets.
+ * Enqueue all changed packets of a node to the packet change list
+ * and (re-)start the refresh timer of the node.
  */
-void
-lspgen_gen_packet(lsdb_ctx_t *ctx)
+static void
+lspgen_queue_node_packets(lsdb_ctx_t *ctx, lsdb_node_t *node)
 {
-    struct lsdb_node_ *node;
+    struct lsdb_packet_ *packet;
     dict_itor *itor;
 
-    /*
-     * Walk the node DB.
-     */
-    itor = dict_itor_new(ctx->node_dict);
+    itor = dict_itor_new(node->packet_dict);
     if (!itor) {
         return;
     }
+    if (dict_itor_first(itor)) {
+        do {
+            packet = *dict_itor_datum(itor);
+            if (packet->changed && !packet->on_change_list) {
+                CIRCLEQ_INSERT_TAIL(&ctx->packet_change_qhead, packet, packet_change_qnode);
+                packet->on_change_list = true;
+                ctx->ctrl_stats.packets_queued++;
+            }
+        } while (dict_itor_next(itor));
+    }
+    dict_itor_free(itor);
 
     /*
-     * Node DB empty ?
+     * Start refresh timer, unless the node gets purged.
      */
-    if (!dict_itor_first(itor)) {
-        dict_itor_free(itor);
-        LOG_NOARG(ERROR, "Empty LSDB.\n");
+    if (!ctx->ctrl_socket_path || !node->attr_dict || !dict_count(node->attr_dict)) {
         return;
     }
+    if (ctx->protocol_id == PROTO_ISIS && ctx->purge) {
+        return;
+    }
+    timer_add_periodic(&ctx->timer_root, &node->refresh_timer, "refresh",
+                       lspgen_refresh_interval(ctx), 0, node, &lspgen_refresh_cb);
+}
 
-    do {
-        node = *dict_itor_datum(itor);
+/*
+ * Patch a changed sequence number (e.g. refresh) into all existing packets of a node.
+ * Attribute changes (LSDB_NODE_DIRTY_ATTR) require a full serialization
+ * using lspgen_gen_packet_node().
+ */
+static void
+lspgen_update_node_packets(lsdb_node_t *node)
+{
+    struct lsdb_packet_ *packet;
+    lsdb_ctx_t *ctx;
+    dict_itor *itor;
 
-	/*
-	 * Init per-packet tree for this node.
-	 */
-	if (!node->packet_dict) {
-	    node->packet_dict = hb_dict_new((dict_compare_func)lsdb_compare_packet);
-	}
+    ctx = node->ctx;
+
+    if (!node->packet_dict) {
+        /*
+         * First serialization, nothing to patch.
+         */
+        lspgen_gen_packet_node(node);
+        node->dirty = 0;
+        return;
+    }
+
+    if (!(node->dirty & LSDB_NODE_DIRTY_SEQ)) {
+        return;
+    }
+    node->dirty &= ~LSDB_NODE_DIRTY_SEQ;
+
+    itor = dict_itor_new(node->packet_dict);
+    if (!itor) {
+        return;
+    }
+    if (dict_itor_first(itor)) {
+        do {
+            packet = *dict_itor_datum(itor);
+            lspgen_update_packet_seq(ctx, node, packet);
+        } while (dict_itor_next(itor));
+    }
+    dict_itor_free(itor);
+}
 
+void
+lspgen_update_node(lsdb_node_t *node)
+{
+    lspgen_update_node_packets(node);
+    lspgen_queue_node_packets(node->ctx, node);
+}
+
+static void
+lspgen_gen_packet_job(__attribute__((unused))lsdb_ctx_t *ctx, lsdb_node_t *node,
+                      __attribute__((unused))uint32_t idx, __attribute__((unused))void *arg)
+{
+    if (node->packet_dict && !(node->dirty & LSDB_NODE_DIRTY_ATTR)) {
 	/*
-	 * Generate the link-state packets for this node.
+	 * Packets loaded from the cache file, only
+	 * patch the (possibly bumped) sequence number.
 	 */
-	lspgen_gen_packet_node(node);
+	node->dirty |= LSDB_NODE_DIRTY_SEQ;
+	lspgen_update_node_packets(node);
+	return;
+    }
+    lspgen_gen_packet_node(node);
+}
 
-    } while (dict_itor_next(itor));
+/*
+ * Walk the graph of the LSDB and serialize packets.
+ *
+ * The nodes are serialized in parallel, the changed packets
+ * are enqueued afterwards in node DB order, such that the
+ * packet order does not depend on the number of threads.
+ */
+void
+lspgen_gen_packet(lsdb_ctx_t *ctx)
+{
+    lsdb_node_t **nodes;
+    uint32_t count, idx;
 
-    dict_itor_free(itor);
+    nodes = lspgen_thread_get_nodes(ctx, &count);
+    if (!nodes) {
+        LOG_NOARG(ERROR, "Empty LSDB.\n");
+        return;
+    }
+
+    /*
+     * Generate the link-state packets for all nodes.
+     */
+    lspgen_thread_run(ctx, nodes, count, lspgen_gen_packet_job, NULL);
+
+    for (idx = 0; idx < count; idx++) {
+        lspgen_queue_node_packets(ctx, nodes[idx]);
+    }
+    free(nodes);
 
     /*
      * Do not smear if this is a one-off LSDB drain.
@@ -0,0 +1,160 @@
+/*
+ * Generic Link State Packet generation for link-state protocols.
+ *
+ * Worker threads for parallel per-node processing.
+ *
+ * Copyright (C) 2020-2025, RtBrick, Inc.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <pthread.h>
+#include "lspgen.h"
+
+/*
+ * Number of nodes claimed at once by a worker.
+ */
+#define LSPGEN_THREAD_BATCH 64
+
+typedef struct lspgen_thread_pool_ {
+    lsdb_ctx_t *ctx;
+    lsdb_node_t **nodes;
+    uint32_t count;
+    uint32_t next; /* next unclaimed node index */
+    lspgen_thread_job_cb job;
+    void *arg;
+} lspgen_thread_pool_t;
+
+/*
+ * Return an array of all nodes in node DB order.
+ * The caller must free the array.
+ */
+lsdb_node_t **
+lspgen_thread_get_nodes(lsdb_ctx_t *ctx, uint32_t *count)
+{
+    lsdb_node_t **nodes;
+    dict_itor *itor;
+    uint32_t idx, size;
+
+    *count = 0;
+    size = dict_count(ctx->node_dict);
+    if (!size) {
+        return NULL;
+    }
+    nodes = calloc(size, sizeof(lsdb_node_t *));
+    if (!nodes) {
+        return NULL;
+    }
+
+    itor = dict_itor_new(ctx->node_dict);
+    if (!itor) {
+        free(nodes);
+        return NULL;
+    }
+    idx = 0;
+    if (dict_itor_first(itor)) {
+        do {
+            if (idx == size) {
+                break;
+            }
+            nodes[idx++] = *dict_itor_datum(itor);
+        } while (dict_itor_next(itor));
+    }
+    dict_itor_free(itor);
+
+    *count = idx;
+    return nodes;
+}
+
+/*
+ * Claim batches of nodes until all nodes are processed.
+ * Workers which are done early take over the remaining
+ * batches, such that the load is balanced across all workers.
+ */
+static void *
+lspgen_thread_worker(void *arg)
+{
+    lspgen_thread_pool_t *pool;
+    uint32_t idx, last;
+
+    pool = arg;
+    while (true) {
+        idx = __atomic_fetch_add(&pool->next, LSPGEN_THREAD_BATCH, __ATOMIC_RELAXED);
+        if (idx >= pool->count) {
+            break;
+        }
+        last = idx + LSPGEN_THREAD_BATCH;
+        if (last > pool->count) {
+            last = pool->count;
+        }
+        for (; idx < last; idx++) {
+            pool->job(pool->ctx, pool->nodes[idx], idx, pool->arg);
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Call the job function for all nodes using the configured number of threads.
+ *
+ * The job function must only modify the node passed in.
+ * Anything which depends on the processing order, like
+ * enqueuing to the packet change list, must be done
+ * by the caller after all jobs are done.
+ */
+void
+lspgen_thread_run(lsdb_ctx_t *ctx, lsdb_node_t **nodes, uint32_t count,
+                  lspgen_thread_job_cb job, void *arg)
+{
+    lspgen_thread_pool_t pool;
+    pthread_t *threads;
+    uint32_t num_threads, idx;
+
+    memset(&pool, 0, sizeof(pool));
+    pool.ctx = ctx;
+    pool.nodes = nodes;
+    pool.count = count;
+    pool.job = job;
+    pool.arg = arg;
+
+    num_threads = ctx->num_threads;
+    if (num_threads > (count / LSPGEN_THREAD_BATCH)) {
+        num_threads = count / LSPGEN_THREAD_BATCH;
+    }
+
+    /*
+     * The per-node logging uses static format buffers,
+     * run single-threaded if it is enabled.
+     */
+    if (log_id[LSDB].enable || log_id[PACKET].enable) {
+        num_threads = 1;
+    }
+
+    if (num_threads < 2) {
+        lspgen_thread_worker(&pool);
+        return;
+    }
+
+    threads = calloc(num_threads-1, sizeof(pthread_t));
+    if (!threads) {
+        lspgen_thread_worker(&pool);
+        return;
+    }
+
+    /*
+     * The calling thread is a worker too.
+     */
+    for (idx = 0; idx < num_threads-1; idx++) {
+        if (pthread_create(&threads[idx], NULL, lspgen_thread_worker, &pool) != 0) {
+            LOG(ERROR, "Failed to create worker thread %u\n", idx+1);
+            break;
+        }
+    }
+    num_threads = idx;
+
+    lspgen_thread_worker(&pool);
+
+    for (idx = 0; idx < num_threads; idx++) {
+        pthread_join(threads[idx], NULL);
+    }
+    free(threads);
+}